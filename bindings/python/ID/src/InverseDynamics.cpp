@@ -68,6 +68,8 @@ void CreateInverseDynamics(pybind11::module& module)
                 return id.updateExtWrenchesMeasurements(wrenches);
             },
             py::arg("wrenches"))
+        .def("setActiveWrenchSources", &HumanID::setActiveWrenchSources, py::arg("active_sources"))
+        .def("getActiveWrenchSources", &HumanID::getActiveWrenchSources)
         .def("solve", &HumanID::solve)
         .def("getJointTorques",
              [](HumanID& id) -> Eigen::VectorXd {
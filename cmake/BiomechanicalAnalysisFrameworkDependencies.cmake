@@ -27,6 +27,16 @@ find_package(YARP QUIET)
 option(FRAMEWORK_COMPILE_YarpImplementation "Compile utilities for YARP" ${YARP_FOUND})
 
 
+find_package(Arrow QUIET)
+find_package(Parquet QUIET)
+
+# the coroutine API of the pipeline requires a compiler supporting the C++20 coroutines
+include(CheckCXXSourceCompiles)
+set(CMAKE_REQUIRED_FLAGS ${CMAKE_CXX20_STANDARD_COMPILE_OPTION})
+check_cxx_source_compiles("#include <coroutine>
+int main() { std::coroutine_handle<> handle; return handle ? 1 : 0; }" FRAMEWORK_HAS_CXX20_COROUTINES)
+unset(CMAKE_REQUIRED_FLAGS)
+
 find_package(pybind11 2.4.3 CONFIG QUIET)
 find_package(Python3 3.6 COMPONENTS Interpreter Development QUIET)
 
@@ -36,10 +46,22 @@ framework_dependent_option(FRAMEWORK_COMPILE_tests
   "Compile tests?" ON
   "Catch2_FOUND;BUILD_TESTING" OFF)
 
+framework_dependent_option(FRAMEWORK_RUN_LONG_SOAK_TEST
+  "Run the soak test for 10^7 frames?" OFF
+  "FRAMEWORK_COMPILE_tests" OFF)
+
 framework_dependent_option(FRAMEWORK_COMPILE_examples
   "Compile examples?" ON
   "BUILD_EXAMPLES" OFF)
   
+framework_dependent_option(FRAMEWORK_COMPILE_ArrowImplementation
+  "Compile the Arrow and Parquet output?" ON
+  "Arrow_FOUND;Parquet_FOUND" OFF)
+
+framework_dependent_option(FRAMEWORK_COMPILE_Coroutines
+  "Compile the coroutine API of the pipeline?" ON
+  "FRAMEWORK_HAS_CXX20_COROUTINES;UNIX;NOT APPLE" OFF)
+
 framework_dependent_option(FRAMEWORK_COMPILE_PYTHON_BINDINGS
   "Compile the python bindings?" ON
   "Python3_FOUND;pybind11_FOUND" OFF)
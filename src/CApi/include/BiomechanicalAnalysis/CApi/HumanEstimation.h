@@ -0,0 +1,220 @@
+/**
+ * @file HumanEstimation.h
+ * @authors Davide Gorbani <davide.gorbani@iit.it>
+ */
+
+#ifndef BIOMECHANICAL_ANALYSIS_CAPI_HUMAN_ESTIMATION_H
+#define BIOMECHANICAL_ANALYSIS_CAPI_HUMAN_ESTIMATION_H
+
+/*
+ * C interface of HumanIK and HumanID, meant to embed the solvers in C programs or through the FFI
+ * of other languages. The objects are opaque handles created and destroyed by the library, while
+ * all the inputs and outputs of the estimation loop are arrays owned by the caller. After the
+ * creation and the calibration, the functions of the loop do not allocate memory in this layer
+ * when they succeed. The functions never throw: on failure they return a negative status and the
+ * description of the error of the calling thread can be read with baf_get_last_error(). The error
+ * is also sent to the logger of the library, which may allocate memory.
+ * The orientations are quaternions stored as (w, x, y, z) and the wrenches as
+ * (fx, fy, fz, tx, ty, tz).
+ */
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Status returned by the functions of the interface
+ */
+typedef enum baf_status
+{
+    BAF_STATUS_OK = 0, /** the call succeeded */
+    BAF_STATUS_INVALID_ARGUMENT = -1, /** null pointers or wrong sizes of the arrays */
+    BAF_STATUS_FAILURE = -2, /** the solver reported an error */
+} baf_status;
+
+/** model and kinematic state shared by the solvers of a subject */
+typedef struct baf_model baf_model;
+
+/** HumanIK solver */
+typedef struct baf_human_ik baf_human_ik;
+
+/** HumanID solver */
+typedef struct baf_human_id baf_human_id;
+
+/**
+ * get the description of the last error of the calling thread
+ * @return null terminated string, empty if no error occurred
+ */
+const char* baf_get_last_error(void);
+
+/**
+ * load a model from a URDF file
+ * @param urdf_path path of the URDF file
+ * @param joints names of the joints to be considered, NULL to consider all the joints
+ * @param nr_of_joints number of elements of joints
+ * @param floating_base name of the floating base link, NULL to keep the default one
+ * @param model created model, to be destroyed with baf_model_destroy()
+ * @return BAF_STATUS_OK if the model has been loaded
+ */
+baf_status baf_model_create(const char* urdf_path,
+                            const char* const* joints,
+                            size_t nr_of_joints,
+                            const char* floating_base,
+                            baf_model** model);
+
+/**
+ * destroy a model, the solvers created with it keep it alive until they are destroyed
+ * @param model model to be destroyed, it can be NULL
+ */
+void baf_model_destroy(baf_model* model);
+
+/**
+ * get the number of degrees of freedom of a model
+ * @param model model
+ * @return number of degrees of freedom, 0 if model is NULL
+ */
+size_t baf_model_get_nr_of_dofs(const baf_model* model);
+
+/**
+ * create a HumanIK solver
+ * @param model model of the subject
+ * @param config_path path of the TOML configuration file of HumanIK
+ * @param dt sampling time, in seconds
+ * @param ik created solver, to be destroyed with baf_ik_destroy()
+ * @return BAF_STATUS_OK if the solver has been initialized
+ */
+baf_status baf_ik_create(baf_model* model, const char* config_path, double dt, baf_human_ik** ik);
+
+/**
+ * destroy a HumanIK solver
+ * @param ik solver to be destroyed, it can be NULL
+ */
+void baf_ik_destroy(baf_human_ik* ik);
+
+/**
+ * compute the calibration matrices between the IMUs and the links, see
+ * HumanIK::calibrateAllWithWorld(). This function allocates memory.
+ * @param ik solver
+ * @param nodes node numbers of the IMUs
+ * @param orientations 4 * nr_of_nodes quaternions of the IMUs
+ * @param nr_of_nodes number of IMUs
+ * @param frame_ref reference frame used as world, NULL to use the world frame
+ * @return BAF_STATUS_OK if the calibration succeeded
+ */
+baf_status baf_ik_calibrate_all_with_world(baf_human_ik* ik, const int* nodes, const double* orientations, size_t nr_of_nodes, const char* frame_ref);
+
+/**
+ * update the orientation and gravity tasks with the measurements of the IMUs
+ * @param ik solver
+ * @param nodes node numbers of the IMUs
+ * @param orientations 4 * nr_of_nodes quaternions of the IMUs
+ * @param angular_velocities 3 * nr_of_nodes angular velocities of the IMUs, NULL if not available
+ * @param nr_of_nodes number of IMUs
+ * @return BAF_STATUS_OK if all the nodes belong to a task and the tasks have been updated
+ */
+baf_status baf_ik_update_nodes(baf_human_ik* ik, const int* nodes, const double* orientations, const double* angular_velocities, size_t nr_of_nodes);
+
+/**
+ * update the floor contact tasks with the wrenches measured by the shoes
+ * @param ik solver
+ * @param nodes node numbers of the shoes
+ * @param wrenches 6 * nr_of_nodes wrenches
+ * @param nr_of_nodes number of shoes
+ * @param link_height height of the contact links with respect to the floor
+ * @return BAF_STATUS_OK if the tasks have been updated
+ */
+baf_status baf_ik_update_floor_contacts(baf_human_ik* ik, const int* nodes, const double* wrenches, size_t nr_of_nodes, double link_height);
+
+/**
+ * solve the inverse kinematics and integrate the state
+ * @param ik solver
+ * @return BAF_STATUS_OK if the problem has been solved
+ */
+baf_status baf_ik_advance(baf_human_ik* ik);
+
+/**
+ * get the joint positions and velocities
+ * @param ik solver
+ * @param joint_positions array of size elements, NULL if not needed
+ * @param joint_velocities array of size elements, NULL if not needed
+ * @param size number of degrees of freedom of the model
+ * @return BAF_STATUS_OK if the arrays have been filled
+ */
+baf_status baf_ik_get_joint_state(const baf_human_ik* ik, double* joint_positions, double* joint_velocities, size_t size);
+
+/**
+ * get the pose and the velocity of the base
+ * @param ik solver
+ * @param position array of 3 elements, NULL if not needed
+ * @param orientation quaternion of 4 elements, NULL if not needed
+ * @param linear_velocity array of 3 elements, NULL if not needed
+ * @param angular_velocity array of 3 elements, NULL if not needed
+ * @return BAF_STATUS_OK if the arrays have been filled
+ */
+baf_status
+baf_ik_get_base_state(const baf_human_ik* ik, double* position, double* orientation, double* linear_velocity, double* angular_velocity);
+
+/**
+ * create a HumanID solver, which uses the kinematic state of the model updated by HumanIK
+ * @param model model of the subject
+ * @param config_path path of the TOML configuration file of HumanID
+ * @param wrench_sources output frames of the measured wrench sources, it defines the order of the
+ * wrenches passed to baf_id_update_wrenches()
+ * @param nr_of_wrench_sources number of elements of wrench_sources
+ * @param id created solver, to be destroyed with baf_id_destroy()
+ * @return BAF_STATUS_OK if the solver has been initialized
+ */
+baf_status baf_id_create(baf_model* model,
+                         const char* config_path,
+                         const char* const* wrench_sources,
+                         size_t nr_of_wrench_sources,
+                         baf_human_id** id);
+
+/**
+ * destroy a HumanID solver
+ * @param id solver to be destroyed, it can be NULL
+ */
+void baf_id_destroy(baf_human_id* id);
+
+/**
+ * get the number of estimated joint torques, i.e. the number of degrees of freedom of the model
+ * used by the solver, which excludes the fixed joints and the joints lumped by the model
+ * simplification
+ * @param id solver
+ * @return number of degrees of freedom, 0 if id is NULL
+ */
+size_t baf_id_get_nr_of_dofs(const baf_human_id* id);
+
+/**
+ * update the measured wrenches
+ * @param id solver
+ * @param wrenches 6 * nr_of_wrench_sources wrenches, ordered as the wrench_sources passed to
+ * baf_id_create()
+ * @param nr_of_wrench_sources number of wrench sources
+ * @return BAF_STATUS_OK if the measurements have been updated
+ */
+baf_status baf_id_update_wrenches(baf_human_id* id, const double* wrenches, size_t nr_of_wrench_sources);
+
+/**
+ * estimate the external wrenches and the joint torques
+ * @param id solver
+ * @return BAF_STATUS_OK if the problem has been solved
+ */
+baf_status baf_id_solve(baf_human_id* id);
+
+/**
+ * get the estimated joint torques
+ * @param id solver
+ * @param joint_torques array of size elements
+ * @param size number of degrees of freedom returned by baf_id_get_nr_of_dofs()
+ * @return BAF_STATUS_OK if the array has been filled
+ */
+baf_status baf_id_get_joint_torques(baf_human_id* id, double* joint_torques, size_t size);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // BIOMECHANICAL_ANALYSIS_CAPI_HUMAN_ESTIMATION_H
@@ -0,0 +1,434 @@
+#include <BiomechanicalAnalysis/CApi/HumanEstimation.h>
+#include <BiomechanicalAnalysis/ID/InverseDynamics.h>
+#include <BiomechanicalAnalysis/IK/InverseKinematics.h>
+#include <BiomechanicalAnalysis/Logging/Logger.h>
+
+#include <cstdio>
+#include <exception>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// iDynTree headers
+#include <iDynTree/KinDynComputations.h>
+#include <iDynTree/ModelLoader.h>
+
+// BipedalLocomotion headers
+#include <BipedalLocomotion/ParametersHandler/TomlImplementation.h>
+
+struct baf_model
+{
+    iDynTree::Model model;
+    std::shared_ptr<iDynTree::KinDynComputations> kinDyn;
+};
+
+struct baf_human_ik
+{
+    std::shared_ptr<iDynTree::KinDynComputations> kinDyn;
+    BiomechanicalAnalysis::IK::HumanIK ik;
+    std::size_t nrOfDoFs{0};
+};
+
+struct baf_human_id
+{
+    std::shared_ptr<iDynTree::KinDynComputations> kinDyn;
+    BiomechanicalAnalysis::ID::HumanID id;
+    std::size_t nrOfDoFs{0};
+    std::unordered_map<std::string, iDynTree::Wrench> wrenches; /** measurements, the entries are
+                                                                   created once */
+    std::vector<iDynTree::Wrench*> orderedWrenches; /** entries of wrenches, in the order of the
+                                                       caller */
+};
+
+namespace
+{
+
+// the message is stored in a fixed buffer, so that baf_get_last_error() does not allocate; the
+// logger called by fail() may allocate instead
+thread_local char lastError[512] = "";
+
+template <typename... Args> baf_status fail(baf_status status, const char* format, Args... args)
+{
+    std::snprintf(lastError, sizeof(lastError), format, args...);
+    BiomechanicalAnalysis::log()->error("{}", lastError);
+    return status;
+}
+
+baf_status success()
+{
+    lastError[0] = '\0';
+    return BAF_STATUS_OK;
+}
+
+manif::SO3d toSO3(const double* quaternion)
+{
+    return manif::SO3d(Eigen::Quaterniond(quaternion[0], quaternion[1], quaternion[2], quaternion[3]).normalized());
+}
+
+/**
+ * Run the body of a function of the interface, converting the exceptions in a failure status
+ */
+template <typename Function> baf_status guarded(const char* function, Function body)
+{
+    try
+    {
+        return body();
+    } catch (const std::exception& e)
+    {
+        return fail(BAF_STATUS_FAILURE, "[%s] Exception: %s", function, e.what());
+    } catch (...)
+    {
+        return fail(BAF_STATUS_FAILURE, "[%s] Unknown exception.", function);
+    }
+}
+
+} // namespace
+
+const char* baf_get_last_error(void)
+{
+    return lastError;
+}
+
+baf_status baf_model_create(const char* urdf_path, const char* const* joints, size_t nr_of_joints, const char* floating_base, baf_model** model)
+{
+    constexpr auto logPrefix = "baf_model_create";
+
+    if (urdf_path == nullptr || model == nullptr || (joints == nullptr && nr_of_joints > 0))
+    {
+        return fail(BAF_STATUS_INVALID_ARGUMENT, "[%s] Invalid arguments.", logPrefix);
+    }
+
+    return guarded(logPrefix, [&]() {
+        iDynTree::ModelLoader loader;
+        bool ok = false;
+        if (joints == nullptr)
+        {
+            ok = loader.loadModelFromFile(urdf_path);
+        } else
+        {
+            ok = loader.loadReducedModelFromFile(urdf_path, std::vector<std::string>(joints, joints + nr_of_joints));
+        }
+        if (!ok)
+        {
+            return fail(BAF_STATUS_FAILURE, "[%s] Unable to load the model '%s'.", logPrefix, urdf_path);
+        }
+
+        auto created = std::make_unique<baf_model>();
+        created->model = loader.model();
+        created->kinDyn = std::make_shared<iDynTree::KinDynComputations>();
+        if (!created->kinDyn->loadRobotModel(created->model)
+            || (floating_base != nullptr && !created->kinDyn->setFloatingBase(floating_base)))
+        {
+            return fail(BAF_STATUS_FAILURE, "[%s] Unable to set up the model '%s'.", logPrefix, urdf_path);
+        }
+        *model = created.release();
+        return success();
+    });
+}
+
+void baf_model_destroy(baf_model* model)
+{
+    delete model;
+}
+
+size_t baf_model_get_nr_of_dofs(const baf_model* model)
+{
+    return model == nullptr ? 0 : model->kinDyn->getNrOfDegreesOfFreedom();
+}
+
+baf_status baf_ik_create(baf_model* model, const char* config_path, double dt, baf_human_ik** ik)
+{
+    constexpr auto logPrefix = "baf_ik_create";
+
+    if (model == nullptr || config_path == nullptr || ik == nullptr)
+    {
+        return fail(BAF_STATUS_INVALID_ARGUMENT, "[%s] Invalid arguments.", logPrefix);
+    }
+
+    return guarded(logPrefix, [&]() {
+        auto handler = std::make_shared<BipedalLocomotion::ParametersHandler::TomlImplementation>();
+        if (!handler->setFromFile(config_path))
+        {
+            return fail(BAF_STATUS_FAILURE, "[%s] Unable to read the configuration file '%s'.", logPrefix, config_path);
+        }
+
+        auto created = std::make_unique<baf_human_ik>();
+        created->kinDyn = model->kinDyn;
+        created->nrOfDoFs = model->kinDyn->getNrOfDegreesOfFreedom();
+        if (!created->ik.initialize(handler, created->kinDyn) || !created->ik.setDt(dt))
+        {
+            return fail(BAF_STATUS_FAILURE, "[%s] Unable to initialize HumanIK.", logPrefix);
+        }
+        *ik = created.release();
+        return success();
+    });
+}
+
+void baf_ik_destroy(baf_human_ik* ik)
+{
+    delete ik;
+}
+
+baf_status baf_ik_calibrate_all_with_world(baf_human_ik* ik, const int* nodes, const double* orientations, size_t nr_of_nodes, const char* frame_ref)
+{
+    constexpr auto logPrefix = "baf_ik_calibrate_all_with_world";
+
+    if (ik == nullptr || ((nodes == nullptr || orientations == nullptr) && nr_of_nodes > 0))
+    {
+        return fail(BAF_STATUS_INVALID_ARGUMENT, "[%s] Invalid arguments.", logPrefix);
+    }
+
+    return guarded(logPrefix, [&]() {
+        std::unordered_map<int, BiomechanicalAnalysis::IK::nodeData> nodeStruct;
+        for (std::size_t i = 0; i < nr_of_nodes; i++)
+        {
+            nodeStruct[nodes[i]].I_R_IMU = toSO3(orientations + 4 * i);
+        }
+        if (!ik->ik.calibrateAllWithWorld(nodeStruct, frame_ref == nullptr ? "" : frame_ref))
+        {
+            return fail(BAF_STATUS_FAILURE, "[%s] Unable to calibrate HumanIK.", logPrefix);
+        }
+        return success();
+    });
+}
+
+baf_status baf_ik_update_nodes(baf_human_ik* ik, const int* nodes, const double* orientations, const double* angular_velocities, size_t nr_of_nodes)
+{
+    constexpr auto logPrefix = "baf_ik_update_nodes";
+
+    if (ik == nullptr || ((nodes == nullptr || orientations == nullptr) && nr_of_nodes > 0))
+    {
+        return fail(BAF_STATUS_INVALID_ARGUMENT, "[%s] Invalid arguments.", logPrefix);
+    }
+
+    return guarded(logPrefix, [&]() {
+        for (std::size_t i = 0; i < nr_of_nodes; i++)
+        {
+            const manif::SO3Tangentd I_omega_IMU = angular_velocities == nullptr
+                                                       ? manif::SO3Tangentd::Zero()
+                                                       : manif::SO3Tangentd(Eigen::Map<const Eigen::Vector3d>(angular_velocities + 3 * i));
+            if (!ik->ik.updateOrientationOrGravityTask(nodes[i], toSO3(orientations + 4 * i), I_omega_IMU))
+            {
+                return fail(BAF_STATUS_FAILURE, "[%s] Unable to update the task of the node %d.", logPrefix, nodes[i]);
+            }
+        }
+        return success();
+    });
+}
+
+baf_status baf_ik_update_floor_contacts(baf_human_ik* ik, const int* nodes, const double* wrenches, size_t nr_of_nodes, double link_height)
+{
+    constexpr auto logPrefix = "baf_ik_update_floor_contacts";
+
+    if (ik == nullptr || ((nodes == nullptr || wrenches == nullptr) && nr_of_nodes > 0))
+    {
+        return fail(BAF_STATUS_INVALID_ARGUMENT, "[%s] Invalid arguments.", logPrefix);
+    }
+
+    return guarded(logPrefix, [&]() {
+        for (std::size_t i = 0; i < nr_of_nodes; i++)
+        {
+            // the floor contact task uses only the vertical force
+            if (!ik->ik.updateFloorContactTask(nodes[i], wrenches[6 * i + 2], link_height))
+            {
+                return fail(BAF_STATUS_FAILURE, "[%s] Unable to update the floor contact task of the node %d.", logPrefix, nodes[i]);
+            }
+        }
+        return success();
+    });
+}
+
+baf_status baf_ik_advance(baf_human_ik* ik)
+{
+    constexpr auto logPrefix = "baf_ik_advance";
+
+    if (ik == nullptr)
+    {
+        return fail(BAF_STATUS_INVALID_ARGUMENT, "[%s] Invalid arguments.", logPrefix);
+    }
+
+    return guarded(logPrefix, [&]() {
+        if (!ik->ik.advance())
+        {
+            return fail(BAF_STATUS_FAILURE, "[%s] Unable to advance HumanIK.", logPrefix);
+        }
+        return success();
+    });
+}
+
+baf_status baf_ik_get_joint_state(const baf_human_ik* ik, double* joint_positions, double* joint_velocities, size_t size)
+{
+    constexpr auto logPrefix = "baf_ik_get_joint_state";
+
+    if (ik == nullptr || size != ik->nrOfDoFs)
+    {
+        return fail(BAF_STATUS_INVALID_ARGUMENT, "[%s] Invalid arguments.", logPrefix);
+    }
+
+    // the results are written directly in the arrays of the caller
+    const Eigen::Index nrOfDoFs = static_cast<Eigen::Index>(size);
+    if (joint_positions != nullptr && !ik->ik.getJointPositions(Eigen::Map<Eigen::VectorXd>(joint_positions, nrOfDoFs)))
+    {
+        return fail(BAF_STATUS_FAILURE, "[%s] Unable to get the joint positions.", logPrefix);
+    }
+    if (joint_velocities != nullptr && !ik->ik.getJointVelocities(Eigen::Map<Eigen::VectorXd>(joint_velocities, nrOfDoFs)))
+    {
+        return fail(BAF_STATUS_FAILURE, "[%s] Unable to get the joint velocities.", logPrefix);
+    }
+    return success();
+}
+
+baf_status
+baf_ik_get_base_state(const baf_human_ik* ik, double* position, double* orientation, double* linear_velocity, double* angular_velocity)
+{
+    constexpr auto logPrefix = "baf_ik_get_base_state";
+
+    if (ik == nullptr)
+    {
+        return fail(BAF_STATUS_INVALID_ARGUMENT, "[%s] Invalid arguments.", logPrefix);
+    }
+
+    if (position != nullptr && !ik->ik.getBasePosition(Eigen::Map<Eigen::Vector3d>(position)))
+    {
+        return fail(BAF_STATUS_FAILURE, "[%s] Unable to get the base position.", logPrefix);
+    }
+    if (orientation != nullptr)
+    {
+        Eigen::Matrix3d baseOrientation;
+        if (!ik->ik.getBaseOrientation(baseOrientation))
+        {
+            return fail(BAF_STATUS_FAILURE, "[%s] Unable to get the base orientation.", logPrefix);
+        }
+        const Eigen::Quaterniond quaternion(baseOrientation);
+        orientation[0] = quaternion.w();
+        orientation[1] = quaternion.x();
+        orientation[2] = quaternion.y();
+        orientation[3] = quaternion.z();
+    }
+    if (linear_velocity != nullptr && !ik->ik.getBaseLinearVelocity(Eigen::Map<Eigen::Vector3d>(linear_velocity)))
+    {
+        return fail(BAF_STATUS_FAILURE, "[%s] Unable to get the base linear velocity.", logPrefix);
+    }
+    if (angular_velocity != nullptr && !ik->ik.getBaseAngularVelocity(Eigen::Map<Eigen::Vector3d>(angular_velocity)))
+    {
+        return fail(BAF_STATUS_FAILURE, "[%s] Unable to get the base angular velocity.", logPrefix);
+    }
+    return success();
+}
+
+baf_status baf_id_create(baf_model* model,
+                         const char* config_path,
+                         const char* const* wrench_sources,
+                         size_t nr_of_wrench_sources,
+                         baf_human_id** id)
+{
+    constexpr auto logPrefix = "baf_id_create";
+
+    if (model == nullptr || config_path == nullptr || id == nullptr || (wrench_sources == nullptr && nr_of_wrench_sources > 0))
+    {
+        return fail(BAF_STATUS_INVALID_ARGUMENT, "[%s] Invalid arguments.", logPrefix);
+    }
+
+    return guarded(logPrefix, [&]() {
+        auto handler = std::make_shared<BipedalLocomotion::ParametersHandler::TomlImplementation>();
+        if (!handler->setFromFile(config_path))
+        {
+            return fail(BAF_STATUS_FAILURE, "[%s] Unable to read the configuration file '%s'.", logPrefix, config_path);
+        }
+
+        auto created = std::make_unique<baf_human_id>();
+        created->kinDyn = model->kinDyn;
+        if (!created->id.initialize(handler, created->kinDyn, model->model))
+        {
+            return fail(BAF_STATUS_FAILURE, "[%s] Unable to initialize HumanID.", logPrefix);
+        }
+        created->nrOfDoFs = created->id.getNrOfDOFs();
+
+        // the map is filled once, then only the values of its entries are updated, which is safe
+        // since the pointers to the elements of an unordered_map are stable
+        created->wrenches.reserve(nr_of_wrench_sources);
+        for (std::size_t i = 0; i < nr_of_wrench_sources; i++)
+        {
+            iDynTree::Wrench& wrench = created->wrenches[wrench_sources[i]];
+            wrench.zero();
+            created->orderedWrenches.push_back(&wrench);
+        }
+        if (created->wrenches.size() != nr_of_wrench_sources)
+        {
+            return fail(BAF_STATUS_INVALID_ARGUMENT, "[%s] The wrench sources must be unique.", logPrefix);
+        }
+        *id = created.release();
+        return success();
+    });
+}
+
+void baf_id_destroy(baf_human_id* id)
+{
+    delete id;
+}
+
+size_t baf_id_get_nr_of_dofs(const baf_human_id* id)
+{
+    return id == nullptr ? 0 : id->nrOfDoFs;
+}
+
+baf_status baf_id_update_wrenches(baf_human_id* id, const double* wrenches, size_t nr_of_wrench_sources)
+{
+    constexpr auto logPrefix = "baf_id_update_wrenches";
+
+    if (id == nullptr || (wrenches == nullptr && nr_of_wrench_sources > 0) || nr_of_wrench_sources != id->orderedWrenches.size())
+    {
+        return fail(BAF_STATUS_INVALID_ARGUMENT, "[%s] Invalid arguments.", logPrefix);
+    }
+
+    return guarded(logPrefix, [&]() {
+        for (std::size_t i = 0; i < nr_of_wrench_sources; i++)
+        {
+            for (int k = 0; k < 3; k++)
+            {
+                id->orderedWrenches[i]->getLinearVec3()(k) = wrenches[6 * i + k];
+                id->orderedWrenches[i]->getAngularVec3()(k) = wrenches[6 * i + 3 + k];
+            }
+        }
+        if (!id->id.updateExtWrenchesMeasurements(id->wrenches))
+        {
+            return fail(BAF_STATUS_FAILURE, "[%s] Unable to update the wrench measurements.", logPrefix);
+        }
+        return success();
+    });
+}
+
+baf_status baf_id_solve(baf_human_id* id)
+{
+    constexpr auto logPrefix = "baf_id_solve";
+
+    if (id == nullptr)
+    {
+        return fail(BAF_STATUS_INVALID_ARGUMENT, "[%s] Invalid arguments.", logPrefix);
+    }
+
+    return guarded(logPrefix, [&]() {
+        if (!id->id.solve())
+        {
+            return fail(BAF_STATUS_FAILURE, "[%s] Unable to solve HumanID.", logPrefix);
+        }
+        return success();
+    });
+}
+
+baf_status baf_id_get_joint_torques(baf_human_id* id, double* joint_torques, size_t size)
+{
+    constexpr auto logPrefix = "baf_id_get_joint_torques";
+
+    if (id == nullptr || joint_torques == nullptr || size != id->nrOfDoFs)
+    {
+        return fail(BAF_STATUS_INVALID_ARGUMENT, "[%s] Invalid arguments.", logPrefix);
+    }
+
+    if (!id->id.getJointTorques(Eigen::Map<Eigen::VectorXd>(joint_torques, static_cast<Eigen::Index>(size))))
+    {
+        return fail(BAF_STATUS_FAILURE, "[%s] Unable to get the joint torques.", logPrefix);
+    }
+    return success();
+}
@@ -0,0 +1,223 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <BiomechanicalAnalysis/CApi/HumanEstimation.h>
+#include <BiomechanicalAnalysis/ID/InverseDynamics.h>
+#include <BiomechanicalAnalysis/IK/InverseKinematics.h>
+#include <BipedalLocomotion/ParametersHandler/TomlImplementation.h>
+#include <iDynTree/FixedJoint.h>
+#include <iDynTree/ModelExporter.h>
+#include <iDynTree/ModelLoader.h>
+#include <iDynTree/ModelTestUtils.h>
+
+#include <filesystem>
+#include <limits>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <unistd.h>
+
+namespace
+{
+
+manif::SO3d toSO3(const double* quaternion)
+{
+    return manif::SO3d(Eigen::Quaterniond(quaternion[0], quaternion[1], quaternion[2], quaternion[3]).normalized());
+}
+
+std::string exportModel(const iDynTree::Model& model, const std::string& name)
+{
+    // the interface loads the model from a URDF file, written in a temporary directory
+    const std::string urdfPath = (std::filesystem::temp_directory_path() / (name + std::to_string(getpid()) + ".urdf")).string();
+    iDynTree::ModelExporter exporter;
+    REQUIRE(exporter.init(model));
+    REQUIRE(exporter.exportModelToFile(urdfPath));
+    return urdfPath;
+}
+
+} // namespace
+
+TEST_CASE("C interface test")
+{
+    const int nrDoFs = 20;
+    const std::string urdfPath = exportModel(iDynTree::getRandomModel(nrDoFs), "CApiTestModel");
+
+    baf_model* model = nullptr;
+    REQUIRE(baf_model_create(nullptr, nullptr, 0, nullptr, &model) == BAF_STATUS_INVALID_ARGUMENT);
+    REQUIRE(std::string(baf_get_last_error()).find("baf_model_create") != std::string::npos);
+    REQUIRE(baf_model_create("notAFile.urdf", nullptr, 0, nullptr, &model) == BAF_STATUS_FAILURE);
+    REQUIRE(baf_model_create(urdfPath.c_str(), nullptr, 0, nullptr, &model) == BAF_STATUS_OK);
+    REQUIRE(std::string(baf_get_last_error()).empty());
+    const size_t nrOfDoFs = baf_model_get_nr_of_dofs(model);
+    REQUIRE(nrOfDoFs == nrDoFs);
+
+    baf_human_ik* ik = nullptr;
+    REQUIRE(baf_ik_create(model, CAPI_TEST_IK_CONFIG, 0.01, &ik) == BAF_STATUS_OK);
+
+    const char* wrenchSources[] = {"link0", "link1"};
+    baf_human_id* id = nullptr;
+    REQUIRE(baf_id_create(model, CAPI_TEST_ID_CONFIG, wrenchSources, 2, &id) == BAF_STATUS_OK);
+
+    // the solvers keep the model alive
+    baf_model_destroy(model);
+
+    // the C++ solvers, on the same model and with the same configuration, are the reference
+    iDynTree::ModelLoader loader;
+    REQUIRE(loader.loadModelFromFile(urdfPath));
+    std::filesystem::remove(urdfPath);
+    auto kinDyn = std::make_shared<iDynTree::KinDynComputations>();
+    REQUIRE(kinDyn->loadRobotModel(loader.model()));
+    auto ikHandler = std::make_shared<BipedalLocomotion::ParametersHandler::TomlImplementation>();
+    REQUIRE(ikHandler->setFromFile(CAPI_TEST_IK_CONFIG));
+    BiomechanicalAnalysis::IK::HumanIK referenceIK;
+    REQUIRE(referenceIK.initialize(ikHandler, kinDyn));
+    REQUIRE(referenceIK.setDt(0.01));
+    auto idHandler = std::make_shared<BipedalLocomotion::ParametersHandler::TomlImplementation>();
+    REQUIRE(idHandler->setFromFile(CAPI_TEST_ID_CONFIG));
+    BiomechanicalAnalysis::ID::HumanID referenceID;
+    REQUIRE(referenceID.initialize(idHandler, kinDyn, loader.model()));
+
+    // the buffers are owned by the caller and allocated once
+    const std::vector<int> nodes{3, 6, 7, 10};
+    std::vector<double> orientations(4 * nodes.size(), 0.0);
+    std::vector<double> angularVelocities(3 * nodes.size(), 0.0);
+    for (size_t i = 0; i < nodes.size(); i++)
+    {
+        orientations[4 * i] = 1.0;
+        orientations[4 * i + 1] = 0.1 * i;
+        angularVelocities[3 * i + 2] = 0.1;
+    }
+    const int shoeNodes[] = {10};
+    double shoeWrenches[6] = {0.0, 0.0, 100.0, 0.0, 0.0, 0.0};
+    double wrenches[12] = {0.0, 0.0, 100.0, 0.0, 0.0, 0.0, 0.0, 0.0, 100.0, 0.0, 0.0, 0.0};
+    std::vector<double> jointPositions(nrOfDoFs), jointVelocities(nrOfDoFs);
+    std::vector<double> jointTorques(baf_id_get_nr_of_dofs(id));
+    REQUIRE(jointTorques.size() == referenceID.getNrOfDOFs());
+    double basePosition[3], baseOrientation[4];
+
+    std::unordered_map<int, BiomechanicalAnalysis::IK::nodeData> referenceNodes;
+    for (size_t i = 0; i < nodes.size(); i++)
+    {
+        referenceNodes[nodes[i]].I_R_IMU = toSO3(orientations.data() + 4 * i);
+        referenceNodes[nodes[i]].I_omega_IMU = manif::SO3Tangentd(Eigen::Map<const Eigen::Vector3d>(angularVelocities.data() + 3 * i));
+    }
+    std::unordered_map<std::string, iDynTree::Wrench> referenceWrenches;
+    for (int i = 0; i < 2; i++)
+    {
+        iDynTree::Wrench& wrench = referenceWrenches[wrenchSources[i]];
+        for (int k = 0; k < 3; k++)
+        {
+            wrench.getLinearVec3()(k) = wrenches[6 * i + k];
+            wrench.getAngularVec3()(k) = wrenches[6 * i + 3 + k];
+        }
+    }
+    Eigen::VectorXd referenceJointPositions(nrOfDoFs), referenceJointVelocities(nrOfDoFs);
+    Eigen::VectorXd referenceJointTorques(jointTorques.size());
+    Eigen::Vector3d referenceBasePosition;
+
+    REQUIRE(baf_ik_calibrate_all_with_world(ik, nodes.data(), orientations.data(), nodes.size(), nullptr) == BAF_STATUS_OK);
+    REQUIRE(referenceIK.calibrateAllWithWorld(referenceNodes));
+    for (int i = 0; i < 10; i++)
+    {
+        REQUIRE(baf_ik_update_nodes(ik, nodes.data(), orientations.data(), angularVelocities.data(), nodes.size()) == BAF_STATUS_OK);
+        REQUIRE(baf_ik_update_floor_contacts(ik, shoeNodes, shoeWrenches, 1, 0.0) == BAF_STATUS_OK);
+        REQUIRE(baf_ik_advance(ik) == BAF_STATUS_OK);
+        REQUIRE(baf_ik_get_joint_state(ik, jointPositions.data(), jointVelocities.data(), nrOfDoFs) == BAF_STATUS_OK);
+        REQUIRE(baf_ik_get_base_state(ik, basePosition, baseOrientation, nullptr, nullptr) == BAF_STATUS_OK);
+
+        REQUIRE(baf_id_update_wrenches(id, wrenches, 2) == BAF_STATUS_OK);
+        REQUIRE(baf_id_solve(id) == BAF_STATUS_OK);
+        REQUIRE(baf_id_get_joint_torques(id, jointTorques.data(), jointTorques.size()) == BAF_STATUS_OK);
+
+        for (size_t k = 0; k < nodes.size(); k++)
+        {
+            REQUIRE(referenceIK.updateOrientationOrGravityTask(nodes[k], referenceNodes[nodes[k]].I_R_IMU, referenceNodes[nodes[k]].I_omega_IMU));
+        }
+        REQUIRE(referenceIK.updateFloorContactTask(shoeNodes[0], shoeWrenches[2], 0.0));
+        REQUIRE(referenceIK.advance());
+        REQUIRE(referenceIK.getJointPositions(referenceJointPositions));
+        REQUIRE(referenceIK.getJointVelocities(referenceJointVelocities));
+        REQUIRE(referenceIK.getBasePosition(referenceBasePosition));
+        REQUIRE(referenceID.updateExtWrenchesMeasurements(referenceWrenches));
+        REQUIRE(referenceID.solve());
+        REQUIRE(referenceID.getJointTorques(referenceJointTorques));
+
+        // the interface only forwards the data, so the results are the same of the C++ solvers
+        REQUIRE(Eigen::Map<const Eigen::VectorXd>(jointPositions.data(), nrOfDoFs).isApprox(referenceJointPositions, 1e-12));
+        REQUIRE(Eigen::Map<const Eigen::VectorXd>(jointVelocities.data(), nrOfDoFs).isApprox(referenceJointVelocities, 1e-12));
+        REQUIRE(Eigen::Map<const Eigen::Vector3d>(basePosition).isApprox(referenceBasePosition, 1e-12));
+        REQUIRE(Eigen::Map<const Eigen::VectorXd>(jointTorques.data(), jointTorques.size()).isApprox(referenceJointTorques, 1e-12));
+    }
+
+    // wrong inputs
+    const int unknownNode[] = {100};
+    REQUIRE(baf_ik_update_nodes(ik, unknownNode, orientations.data(), nullptr, 1) == BAF_STATUS_FAILURE);
+    REQUIRE(baf_ik_get_joint_state(ik, jointPositions.data(), nullptr, nrOfDoFs + 1) == BAF_STATUS_INVALID_ARGUMENT);
+    REQUIRE(baf_id_update_wrenches(id, wrenches, 1) == BAF_STATUS_INVALID_ARGUMENT);
+    REQUIRE(baf_ik_advance(nullptr) == BAF_STATUS_INVALID_ARGUMENT);
+
+    baf_id_destroy(id);
+    baf_ik_destroy(ik);
+}
+
+TEST_CASE("C interface with fixed joints test")
+{
+    // the joint torques are as many as the degrees of freedom, not as the joints
+    iDynTree::Model fixedJointModel = iDynTree::getRandomModel(20);
+    iDynTree::Link fixedLink = iDynTree::getRandomLink();
+    iDynTree::FixedJoint fixedJoint(iDynTree::getRandomTransform());
+    REQUIRE(fixedJointModel.addJointAndLink("link0", "fixedJoint", &fixedJoint, "fixedLink", fixedLink) != iDynTree::JOINT_INVALID_INDEX);
+    REQUIRE(fixedJointModel.getNrOfDOFs() < fixedJointModel.getNrOfJoints());
+    const std::string urdfPath = exportModel(fixedJointModel, "CApiTestFixedJointModel");
+
+    baf_model* model = nullptr;
+    REQUIRE(baf_model_create(urdfPath.c_str(), nullptr, 0, nullptr, &model) == BAF_STATUS_OK);
+    const char* wrenchSources[] = {"link0", "link1"};
+    baf_human_id* id = nullptr;
+    REQUIRE(baf_id_create(model, CAPI_TEST_ID_CONFIG, wrenchSources, 2, &id) == BAF_STATUS_OK);
+    baf_model_destroy(model);
+
+    iDynTree::ModelLoader loader;
+    REQUIRE(loader.loadModelFromFile(urdfPath));
+    std::filesystem::remove(urdfPath);
+    auto kinDyn = std::make_shared<iDynTree::KinDynComputations>();
+    REQUIRE(kinDyn->loadRobotModel(loader.model()));
+    auto idHandler = std::make_shared<BipedalLocomotion::ParametersHandler::TomlImplementation>();
+    REQUIRE(idHandler->setFromFile(CAPI_TEST_ID_CONFIG));
+    BiomechanicalAnalysis::ID::HumanID referenceID;
+    REQUIRE(referenceID.initialize(idHandler, kinDyn, loader.model()));
+    REQUIRE(referenceID.getNrOfDOFs() == loader.model().getNrOfDOFs());
+    REQUIRE(referenceID.getNrOfDOFs() < referenceID.getJointsList().size());
+
+    const size_t nrOfDoFs = baf_id_get_nr_of_dofs(id);
+    REQUIRE(nrOfDoFs == referenceID.getNrOfDOFs());
+
+    double wrenches[12] = {0.0, 0.0, 100.0, 0.0, 0.0, 0.0, 0.0, 0.0, 100.0, 0.0, 0.0, 0.0};
+    std::unordered_map<std::string, iDynTree::Wrench> referenceWrenches;
+    for (int i = 0; i < 2; i++)
+    {
+        iDynTree::Wrench& wrench = referenceWrenches[wrenchSources[i]];
+        wrench.zero();
+        wrench.getLinearVec3()(2) = wrenches[6 * i + 2];
+    }
+    REQUIRE(baf_id_update_wrenches(id, wrenches, 2) == BAF_STATUS_OK);
+    REQUIRE(baf_id_solve(id) == BAF_STATUS_OK);
+    REQUIRE(referenceID.updateExtWrenchesMeasurements(referenceWrenches));
+    REQUIRE(referenceID.solve());
+
+    // the buffer of the caller is filled, so it must not keep its initial value
+    std::vector<double> jointTorques(nrOfDoFs, std::numeric_limits<double>::quiet_NaN());
+    Eigen::VectorXd referenceJointTorques(nrOfDoFs);
+    REQUIRE(baf_id_get_joint_torques(id, jointTorques.data(), jointTorques.size()) == BAF_STATUS_OK);
+    REQUIRE(referenceID.getJointTorques(referenceJointTorques));
+    REQUIRE(Eigen::Map<const Eigen::VectorXd>(jointTorques.data(), nrOfDoFs).allFinite());
+    REQUIRE(Eigen::Map<const Eigen::VectorXd>(jointTorques.data(), nrOfDoFs).isApprox(referenceJointTorques, 1e-12));
+
+    // a buffer sized with the number of joints is rejected
+    std::vector<double> jointsSizedTorques(referenceID.getJointsList().size());
+    REQUIRE(baf_id_get_joint_torques(id, jointsSizedTorques.data(), jointsSizedTorques.size()) == BAF_STATUS_INVALID_ARGUMENT);
+    Eigen::VectorXd wrongSizeTorques(referenceID.getJointsList().size());
+    REQUIRE_FALSE(referenceID.getJointTorques(wrongSizeTorques));
+
+    baf_id_destroy(id);
+}
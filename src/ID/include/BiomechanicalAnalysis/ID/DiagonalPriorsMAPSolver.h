@@ -0,0 +1,116 @@
+/**
+ * @file DiagonalPriorsMAPSolver.h
+ * @authors Davide Gorbani <davide.gorbani@iit.it>
+ */
+
+#ifndef BIOMECHANICAL_ANALYSIS_DIAGONAL_PRIORS_MAP_SOLVER_H
+#define BIOMECHANICAL_ANALYSIS_DIAGONAL_PRIORS_MAP_SOLVER_H
+
+#include <vector>
+
+// Eigen headers
+#include <Eigen/Dense>
+#include <Eigen/SparseCholesky>
+
+// iDynTree headers
+#include <iDynTree/BerdyHelper.h>
+#include <iDynTree/BerdySparseMAPSolver.h>
+
+#include <BiomechanicalAnalysis/ID/MAPInformationForm.h>
+
+namespace BiomechanicalAnalysis
+{
+namespace ID
+{
+
+/**
+ * @brief Solver of the BERDY MAP problem equivalent to iDynTree::BerdySparseMAPSolver, specialized
+ * for diagonal priors.
+ * The priors are folded in the information form as row scalings of the BERDY matrices, and the
+ * a posteriori expected value is computed with a single double precision sparse factorization,
+ * whose symbolic analysis is reused as long as the sparsity pattern does not change. The
+ * fill-reducing permutation is applied in place to the values of the information matrix, so that
+ * the factorization does not build a permuted copy of the matrix at each estimation.
+ */
+class DiagonalPriorsMAPSolver
+{
+public:
+    /**
+     * @brief Constructor
+     * @param berdyHelper BerdyHelper object of the problem, it must outlive the solver
+     */
+    explicit DiagonalPriorsMAPSolver(iDynTree::BerdyHelper& berdyHelper);
+
+    /**
+     * @brief Function to initialize the solver with the priors of a BerdySparseMAPSolver built on
+     * the same BerdyHelper, so that the two solvers estimate the same distribution
+     * @param reference solver whose priors are copied, they must be set before calling this function
+     * @return true if the initialization is successful, false otherwise, e.g. if one of the priors
+     * is not diagonal
+     */
+    bool initialize(const iDynTree::BerdySparseMAPSolver& reference);
+
+    /**
+     * @brief Function to copy again the measurements prior of the reference solver, e.g. after
+     * changing the active wrench sources, the other priors are unchanged
+     * @param reference solver passed to initialize
+     * @return true if the update is successful, false otherwise, e.g. if the prior is not
+     * diagonal
+     */
+    bool updateMeasurementsPrior(const iDynTree::BerdySparseMAPSolver& reference);
+
+    /**
+     * @brief Function to update the kinematics of the BerdyHelper and the measurements
+     * @param jointsConfiguration joints position
+     * @param jointsVelocity joints velocity
+     * @param floatingFrame index of the floating base frame
+     * @param bodyAngularVelocityOfSpecifiedFrame angular velocity of the floating base frame
+     * @param measurements measurements vector
+     */
+    void updateEstimateInformationFloatingBase(const iDynTree::JointPosDoubleArray& jointsConfiguration,
+                                               const iDynTree::JointDOFsDoubleArray& jointsVelocity,
+                                               const iDynTree::FrameIndex floatingFrame,
+                                               const iDynTree::Vector3& bodyAngularVelocityOfSpecifiedFrame,
+                                               const iDynTree::VectorDynSize& measurements);
+
+    /**
+     * @brief Function to compute the expected value of the a posteriori distribution
+     * @return true if the estimation is successful, false otherwise
+     */
+    bool doEstimate();
+
+    /**
+     * @brief Function to get the last estimate of the dynamic variables
+     * @param lastEstimate vector filled with the expected value of the dynamic variables
+     */
+    void getLastEstimate(iDynTree::VectorDynSize& lastEstimate) const;
+
+private:
+    using SparseMatrix = MAPInformationForm::SparseMatrix;
+    using Permutation = Eigen::PermutationMatrix<Eigen::Dynamic, Eigen::Dynamic, SparseMatrix::StorageIndex>;
+
+    /**
+     * @brief Function to compute the fill-reducing permutation of the information matrix and the
+     * symbolic analysis of the factorization of the permuted matrix
+     */
+    void analyzePattern();
+
+    iDynTree::BerdyHelper& m_berdyHelper; /** BerdyHelper object of the problem */
+    MAPInformationForm m_informationForm; /** information form of the problem */
+    iDynTree::VectorDynSize m_measurements; /** measurements of the last update */
+    Eigen::SimplicialLDLT<SparseMatrix, Eigen::Upper, Eigen::NaturalOrdering<SparseMatrix::StorageIndex>>
+        m_factorization; /** factorization of the permuted information matrix */
+    bool m_analyzed{false}; /** true if the pattern of the factorization has been analyzed */
+    Permutation m_permutation; /** fill-reducing permutation P of the information matrix */
+    Permutation m_inversePermutation; /** inverse of P */
+    SparseMatrix m_permutedInformation; /** upper triangle of P I P^T, where I is the information matrix */
+    std::vector<int> m_permutedIndices; /** index in the values of I of each value of m_permutedInformation */
+    Eigen::VectorXd m_permutedInformationVector; /** information vector permuted by P */
+    Eigen::VectorXd m_permutedEstimate; /** estimate permuted by P */
+    Eigen::VectorXd m_estimate; /** expected value of the dynamic variables */
+};
+
+} // namespace ID
+} // namespace BiomechanicalAnalysis
+
+#endif // BIOMECHANICAL_ANALYSIS_DIAGONAL_PRIORS_MAP_SOLVER_H
@@ -7,6 +7,10 @@
 #define BIOMECHANICAL_ANALYSIS_INVERSE_DYNAMICS_H
 
 #include <memory>
+#include <optional>
+
+#include <BiomechanicalAnalysis/ID/DiagonalPriorsMAPSolver.h>
+#include <BiomechanicalAnalysis/ID/MixedPrecisionMAPSolver.h>
 
 // iDynTree headers
 #include <iDynTree/BerdyHelper.h>
@@ -23,12 +27,23 @@ namespace BiomechanicalAnalysis
 namespace ID
 {
 
+/**
+ * @brief Kinematic state of the model, read once per frame and shared by all the consumers
+ */
 struct KinematicState
 {
     iDynTree::FrameIndex floatingBaseFrameIndex;
     iDynTree::Vector3 baseAngularVelocity;
     iDynTree::JointPosDoubleArray jointsPosition;
     iDynTree::JointDOFsDoubleArray jointsVelocity;
+    iDynTree::Transform worldBaseTransform; /** transform between the world and the base frames */
+    iDynTree::Twist baseVelocity; /** base velocity */
+    iDynTree::Vector3 worldGravity; /** gravity expressed in the world frame */
+    iDynTree::Position centerOfMassPosition; /** position of the center of mass in the world frame */
+    iDynTree::VectorDynSize inputJointsPosition; /** joints position of the kinDyn object passed in
+                                                    the initialize function */
+    iDynTree::VectorDynSize inputJointsVelocity; /** joints velocity of the kinDyn object passed in
+                                                    the initialize function */
 };
 
 struct MAPEstParams
@@ -45,6 +60,12 @@ struct MAPHelper
     iDynTree::BerdyHelper berdyHelper; /** BerdyHelper object */
     std::unique_ptr<iDynTree::BerdySparseMAPSolver> berdySolver = nullptr; /** BerdySparseMAPSolver
                                                                               object */
+    std::unique_ptr<MixedPrecisionMAPSolver> mixedPrecisionSolver = nullptr; /** MixedPrecisionMAPSolver
+                                                                                object, used in place of
+                                                                                berdySolver if not null */
+    std::unique_ptr<DiagonalPriorsMAPSolver> diagonalPriorsSolver = nullptr; /** DiagonalPriorsMAPSolver
+                                                                                object, used in place of
+                                                                                berdySolver if not null */
     iDynTree::VectorDynSize estimatedDynamicVariables;
     iDynTree::VectorDynSize estimatedJointTorques;
     iDynTree::VectorDynSize measurement;
@@ -63,6 +84,8 @@ struct WrenchSourceData
     std::string outputFrame;
     iDynTree::Transform outputFrameTransform;
     iDynTree::Wrench wrench;
+    std::optional<double> contactForceThreshold; /** vertical force above which the source is
+                                                    considered in contact, if set */
 };
 
 /**
@@ -81,14 +104,67 @@ private:
     bool m_useFullModel; /** flag to use the full model for the inverse dynamics */
     MAPHelper m_extWrenchesEstimator; /** MAPHelper object for the estimation of the external
                                          wrenches */
+    std::unordered_map<std::size_t, iDynTree::SparseMatrix<iDynTree::ColumnMajor>> m_measurementsPriors; /** measurements prior
+                                                                                                             covariance of the external
+                                                                                                             wrenches estimation, one
+                                                                                                             for each combination of
+                                                                                                             active wrench sources */
+    std::size_t m_measurementsPrior{0}; /** combination of active wrench sources of the measurements
+                                           prior set in the solver */
+    MAPEstParams m_extWrenchesParams; /** parameters of the external wrenches estimation */
+    std::size_t m_activeWrenchSources{0}; /** bitmask of the active wrench sources, the i-th bit
+                                             refers to the i-th element of m_wrenchSources */
+    static constexpr std::size_t maxPrecomputedContactSources = 8; /** maximum number of wrench sources
+                                                                       with a specific covariance whose
+                                                                       combinations can be precomputed */
+    std::size_t m_specificCovarianceWrenchSources{0}; /** bitmask of the wrench sources with a specific
+                                                         measurement covariance, the only ones whose
+                                                         activation changes the measurements prior */
     MAPHelper m_jointTorquesHelper; /** MAPHelper object for the estimation of the joint torques */
     std::vector<WrenchSourceData> m_wrenchSources; /** vector of WrenchSourceData objects */
     KinematicState m_kinState; /** KinematicState object */
+    bool m_kinStateUpdated{false}; /** true if updateExtWrenchesMeasurements() has read the kinematic
+                                      state of a frame that has not been solved yet */
+    std::vector<int> m_fullModelJointsMap; /** index in the kinDyn object passed in the initialize
+                                              function of each joint of the full model, -1 if the
+                                              joint is missing */
     std::vector<iDynTree::Wrench> m_estimatedExtWrenches; /** vector of estimated external wrenches
                                                            */
+    iDynTree::LinkNetExternalWrenches m_linkExtWrenches; /** net external wrenches of the links of the
+                                                            full model, extracted from the external
+                                                            wrenches estimation */
     double m_humanMass; /** mass of the human */
+    bool m_useMixedPrecision{false}; /** flag to solve the MAP problems with MixedPrecisionMAPSolver */
+    bool m_useDiagonalPriors{false}; /** flag to solve the MAP problems with DiagonalPriorsMAPSolver */
+    std::size_t m_mixedPrecisionRefinementSteps{5}; /** maximum number of refinement steps of the
+                                                       mixed precision solvers */
+    double m_mixedPrecisionTolerance{1e-8}; /** relative correction at which the refinement of the
+                                               mixed precision solvers is stopped */
     std::string m_modelPath; /** path to the urdf model file */
 
+    /**
+     * @brief Function to initialize the HumanID object, using the given full model if not null
+     * @param handler pointer to the ParametersHandler object
+     * @param kinDyn pointer to the KinDynComputations object
+     * @param fullModel pointer to the model used for the inverse dynamics, if null the model is
+     * loaded from the `urdfModel` parameter or taken from kinDyn
+     * @return true if the initialization is successful, false otherwise
+     */
+    bool initializeFromModel(std::weak_ptr<const BipedalLocomotion::ParametersHandler::IParametersHandler> handler,
+                             std::shared_ptr<iDynTree::KinDynComputations> kinDyn,
+                             const iDynTree::Model* fullModel);
+
+    /**
+     * @brief Function to lump the negligible links of the model used for the inverse dynamics,
+     * reducing the size of the MAP problems
+     * @param groupHandler pointer to the `MODEL_SIMPLIFICATION` group
+     * @param extWrenchesHandler pointer to the `EXTERNAL_WRENCHES` group, used to preserve the links
+     * where the external wrenches are applied
+     * @return true if the simplification is successful, false otherwise
+     */
+    bool simplifyFullModel(const std::shared_ptr<BipedalLocomotion::ParametersHandler::IParametersHandler> groupHandler,
+                           const std::shared_ptr<BipedalLocomotion::ParametersHandler::IParametersHandler> extWrenchesHandler);
+
     /**
      * @brief Function to initialize the MAPHelper m_jointTorquesHelper object
      * @param groupHandler pointer to the ParametersHandler object
@@ -103,6 +179,56 @@ private:
      */
     bool initializeExtWrenchesHelper(const std::shared_ptr<BipedalLocomotion::ParametersHandler::IParametersHandler> groupHandler);
 
+    /**
+     * @brief Function to compute the measurements prior covariance of the external wrenches
+     * estimation associated to a combination of active wrench sources
+     * @param activeWrenchSources bitmask of the active wrench sources
+     * @param covariance measurements prior covariance
+     * @note the function does not modify the object, so it can be called in parallel
+     */
+    void computeMeasurementsPriorCovariance(const std::size_t activeWrenchSources,
+                                            iDynTree::SparseMatrix<iDynTree::ColumnMajor>& covariance) const;
+
+    /**
+     * @brief Function to set in the external wrenches solvers the measurements prior associated to
+     * the current combination of active wrench sources, computing it if it is not yet in the cache
+     * @return true if the selection is successful, false otherwise
+     */
+    bool selectMeasurementsPrior();
+
+    /**
+     * @brief Function to create the specialized solver of a MAPHelper whose BerdySparseMAPSolver
+     * has already been initialized with the priors, if the mixed precision or the diagonal priors
+     * solver is enabled
+     * @param helper MAPHelper object
+     * @return true if the creation is successful or no specialized solver is enabled, false
+     * otherwise
+     */
+    bool createSpecializedSolver(MAPHelper& helper) const;
+
+    /**
+     * @brief Function to estimate the dynamic variables of a MAPHelper with the current kinematic
+     * state and its measurement vector
+     * @param helper MAPHelper object
+     * @return true if the estimation is successful, false otherwise
+     */
+    bool estimateDynamicVariables(MAPHelper& helper);
+
+    /**
+     * @brief Function to check if a wrench source is active
+     * @param index index of the wrench source in m_wrenchSources
+     * @return true if the wrench source is active, false otherwise
+     */
+    bool isWrenchSourceActive(const std::size_t index) const;
+
+    /**
+     * @brief Function to read the kinematic state from the kinDyn object passed in the initialize
+     * function and, if the full model is used, to propagate it to the full model
+     * @note this is the only place where the kinematic state is read, the other functions use the
+     * values stored in m_kinState
+     */
+    void updateKinematicState();
+
     /**
      * @brief Function to compute the rate of change of the momentum calculated in the base frame
      * @return true if the initialization is successful, false otherwise
@@ -141,19 +267,90 @@ public:
      * @return true if the initialization is successful, false otherwise
      * @note an example of the required parameters can be found in
      * https://github.com/ami-iit/biomechanical-analysis-framework/tree/main/src/examples/ID
+     * @note if the optional `MODEL_SIMPLIFICATION` group is present, the links of the model whose
+     * subtree has mass and largest principal inertia below `massThreshold` and `inertiaThreshold`,
+     * and, unless `lumpFixedJoints` is false, the links attached with fixed joints are lumped in
+     * their parent before building the estimators. The joint torques are then estimated only for
+     * the joints of the simplified model.
+     * @note if the optional `mixedPrecision` parameter is true, the MAP problems are solved by
+     * MixedPrecisionMAPSolver, with at most `mixedPrecisionRefinementSteps` refinement steps (default
+     * 5) stopped at the relative correction `mixedPrecisionTolerance` (default 1e-8).
+     * @note if the optional `diagonalPriors` parameter is true, the MAP problems are solved in double
+     * precision by DiagonalPriorsMAPSolver, which exploits the diagonal priors configured by
+     * HumanID. The mixed precision solver, if enabled, takes precedence and exploits them as well.
      */
     bool initialize(std::weak_ptr<const BipedalLocomotion::ParametersHandler::IParametersHandler> handler,
                     std::shared_ptr<iDynTree::KinDynComputations> kinDyn);
 
     /**
-     * @brief Function to update the measurements of the external wrenches
+     * @brief Function to initialize the HumanID object with a model already in memory, e.g. a
+     * model scaled with BiomechanicalAnalysis::Model::ModelScaling
+     * @param handler pointer to the ParametersHandler object
+     * @param kinDyn pointer to the KinDynComputations object
+     * @param fullModel model used for the inverse dynamics, it replaces the `urdfModel` and
+     * `jointsList` parameters
+     * @return true if the initialization is successful, false otherwise
+     */
+    bool initialize(std::weak_ptr<const BipedalLocomotion::ParametersHandler::IParametersHandler> handler,
+                    std::shared_ptr<iDynTree::KinDynComputations> kinDyn,
+                    const iDynTree::Model& fullModel);
+
+    /**
+     * @brief Function to update the measurements of the external wrenches and to read the kinematic
+     * state of the frame from the KinDynComputations object passed to initialize()
      * @param wrenches unordered map mapping the name of the wrench source to the wrench
+     * @return true if the measurements are updated correctly, false otherwise
+     * @note it must be called on each frame after the state of the KinDynComputations object has
+     * been set and before solve()
      */
     bool updateExtWrenchesMeasurements(const std::unordered_map<std::string, iDynTree::Wrench>& wrenches);
 
+    /**
+     * @brief Function to set the wrench sources in contact for the current frame
+     * @param activeSources vector containing the output frames of the active wrench sources
+     * @return true if all the output frames refer to a configured wrench source, false otherwise
+     * @note the wrench sources not listed are treated as links without external wrench, i.e. their
+     * wrench measurement is zero with the default measurement covariance. All the combinations
+     * share the same MAP problem and differ only in the measurements prior, which is computed the
+     * first time the combination is used and then cached, or at initialization if
+     * `precomputeContactCombinations` is set to true in the `EXTERNAL_WRENCHES` group, which is
+     * allowed for at most 8 sources with a specific covariance. The sources without a specific
+     * covariance share the prior of the active ones.
+     * @note the wrench variables of the inactive sources are not removed from the MAP problem, whose
+     * size is the same for all the combinations: the deactivation constrains them to zero through
+     * the measurements prior, it does not reduce the cost of the estimation.
+     * @note the sources with the `contactForceThreshold` parameter are activated and deactivated
+     * in updateExtWrenchesMeasurements() depending on their measured vertical force, overriding
+     * the value set here.
+     */
+    bool setActiveWrenchSources(const std::vector<std::string>& activeSources);
+
+    /**
+     * @brief Function to get the wrench sources in contact for the current frame
+     * @return vector containing the output frames of the active wrench sources
+     */
+    std::vector<std::string> getActiveWrenchSources() const;
+
+    /**
+     * @brief Function to get the number of estimations solved again in double precision by the
+     * mixed precision solvers because their refinement did not converge
+     * @return number of estimations since the initialization, 0 if the mixed precision is disabled
+     */
+    std::size_t getNrOfDoublePrecisionFallbacks() const;
+
+    /**
+     * @brief Function to get the number of refinement steps done by the mixed precision solvers in
+     * the last call to solve(), i.e. after the single precision factorization
+     * @return sum of the refinement steps of the MAP problems, 0 if the mixed precision is disabled
+     */
+    std::size_t getLastRefinementSteps() const;
+
     /**
      * @brief Function to solve the inverse dynamics problem
-     * @return true if the solution is successful, false otherwise
+     * @return true if the solution is successful, false otherwise, e.g. if
+     * updateExtWrenchesMeasurements() has not been called since the last call to solve()
+     * @note the problem is solved with the kinematic state read by updateExtWrenchesMeasurements(),
+     * hence the two functions must be called in this order on each frame
      */
     bool solve();
 
@@ -163,7 +360,27 @@ public:
      */
     iDynTree::VectorDynSize getJointTorques();
 
-    void getJointTorques(Eigen::Ref<Eigen::VectorXd> jointTorques);
+    /**
+     * @brief Function to get the estimated joint torques without allocating
+     * @param jointTorques vector of joint torques, of size getNrOfDOFs()
+     * @return true if the size of jointTorques is correct, false otherwise
+     */
+    bool getJointTorques(Eigen::Ref<Eigen::VectorXd> jointTorques);
+
+    /**
+     * @brief Function to get the number of degrees of freedom of the model used for the inverse
+     * dynamics, i.e. the number of estimated joint torques
+     * @return number of degrees of freedom, which differs from the number of joints of
+     * getJointsList() if the model has fixed joints
+     */
+    std::size_t getNrOfDOFs() const;
+
+    /**
+     * @brief Function to get the model used for the inverse dynamics
+     * @return model whose degrees of freedom give the order of the joint torques, i.e. the torque of
+     * a joint is at the offset returned by getDOFsOffset()
+     */
+    const iDynTree::Model& getModel() const;
 
     /**
      * @brief Function to get the list of the joints
@@ -0,0 +1,167 @@
+/**
+ * @file MAPInformationForm.h
+ * @authors Davide Gorbani <davide.gorbani@iit.it>
+ */
+
+#ifndef BIOMECHANICAL_ANALYSIS_MAP_INFORMATION_FORM_H
+#define BIOMECHANICAL_ANALYSIS_MAP_INFORMATION_FORM_H
+
+#include <vector>
+
+// Eigen headers
+#include <Eigen/Dense>
+#include <Eigen/SparseCore>
+
+// iDynTree headers
+#include <iDynTree/BerdyHelper.h>
+#include <iDynTree/BerdySparseMAPSolver.h>
+#include <iDynTree/Core/SparseMatrix.h>
+
+namespace BiomechanicalAnalysis
+{
+namespace ID
+{
+
+/**
+ * @brief Information form of the a posteriori distribution of the BERDY MAP problem, i.e. the
+ * linear system
+ * (D^T Sigma_D^-1 D + Sigma_d^-1 + Y^T Sigma_y^-1 Y) d = Sigma_d^-1 mu_d - D^T Sigma_D^-1 bD + Y^T Sigma_y^-1 (y - bY)
+ * whose solution is the expected value of the dynamic variables.
+ * The diagonal priors, which are the ones configured by HumanID, are stored as vectors and folded in
+ * as row scalings of D and Y. With diagonal priors the pattern of the information matrix is computed
+ * only when the pattern of D or Y changes, i.e. at the initialization, and each frame updates its
+ * values in place without allocating memory.
+ */
+class MAPInformationForm
+{
+public:
+    using SparseMatrix = Eigen::SparseMatrix<double, Eigen::ColMajor>;
+
+    /**
+     * @brief Function to initialize the information form with the priors of a BerdySparseMAPSolver
+     * @param berdyHelper BerdyHelper object of the problem
+     * @param reference solver whose priors are copied, they must be set before calling this function
+     * @return true if the initialization is successful, false otherwise
+     */
+    bool initialize(iDynTree::BerdyHelper& berdyHelper, const iDynTree::BerdySparseMAPSolver& reference);
+
+    /**
+     * @brief Function to copy again the measurements prior of a BerdySparseMAPSolver, the other
+     * priors are unchanged
+     * @param reference solver whose measurements prior is copied
+     */
+    void setMeasurementsPrior(const iDynTree::BerdySparseMAPSolver& reference);
+
+    /**
+     * @brief Function to compute the information matrix and vector with the current kinematics of the
+     * BerdyHelper
+     * @param berdyHelper BerdyHelper object of the problem
+     * @param measurements measurements vector
+     * @return true if the computation is successful, false otherwise
+     */
+    bool update(iDynTree::BerdyHelper& berdyHelper, const iDynTree::VectorDynSize& measurements);
+
+    /**
+     * @brief Function to know if all the priors are diagonal
+     * @return true if all the priors are diagonal
+     */
+    bool hasDiagonalPriors() const;
+
+    /**
+     * @brief Function to know if the sparsity pattern of the information matrix changed in the last
+     * update, e.g. to decide if the symbolic analysis of a factorization must be done again
+     * @return true if the pattern changed, or if it is the first update
+     */
+    bool hasPatternChanged() const;
+
+    /**
+     * @brief Function to get the information matrix computed by the last update
+     * @return information matrix
+     */
+    const SparseMatrix& getInformationMatrix() const;
+
+    /**
+     * @brief Function to get the information vector computed by the last update
+     * @return information vector
+     */
+    const Eigen::VectorXd& getInformationVector() const;
+
+private:
+    /**
+     * Inverse covariance of a prior, whose diagonal is also stored as a vector if the prior is diagonal
+     */
+    struct Prior
+    {
+        bool isDiagonal{false}; /** true if the prior is diagonal */
+        Eigen::VectorXd diagonal; /** diagonal of the inverse covariance, if diagonal */
+        SparseMatrix matrix; /** inverse covariance */
+
+        /**
+         * @brief Function to set the prior from an inverse covariance matrix
+         * @param inverseCovariance inverse covariance matrix
+         */
+        void set(const iDynTree::SparseMatrix<iDynTree::ColumnMajor>& inverseCovariance);
+    };
+
+    /**
+     * Transpose of a matrix of the problem, whose values are copied in place from the matrix as long
+     * as its pattern does not change
+     */
+    struct Transpose
+    {
+        std::vector<int> pattern; /** outer and inner indices of the matrix */
+        SparseMatrix matrix; /** transpose of the matrix, its columns are the rows of the matrix */
+        std::vector<int> indices; /** index in the values of the matrix of each value of the transpose */
+
+        /**
+         * @brief Function to update the transpose with the values of a matrix
+         * @param A matrix
+         * @return true if the pattern of the matrix changed and the transpose has been built again
+         */
+        bool update(const Eigen::Ref<const SparseMatrix>& A);
+    };
+
+    /**
+     * @brief Function to compute the pattern of the information matrix with diagonal priors, i.e. the
+     * union of the patterns of D^T D, Y^T Y and of the diagonal
+     */
+    void computeInformationPattern();
+
+    /**
+     * @brief Function to compute the values of the information matrix with diagonal priors in place,
+     * as the sum of the columns of D^T and Y^T scaled by the weighted values of D and Y
+     * @param D dynamics constraints matrix
+     * @param Y measurements matrix
+     */
+    void computeInformationValues(const Eigen::Ref<const SparseMatrix>& D, const Eigen::Ref<const SparseMatrix>& Y);
+
+    Prior m_dynamicsConstraintsPrior; /** Sigma_D^-1 */
+    Prior m_dynamicsRegularizationPrior; /** Sigma_d^-1 */
+    Prior m_measurementsPrior; /** Sigma_y^-1 */
+    Eigen::VectorXd m_dynamicsRegularizationPriorInformationVector; /** Sigma_d^-1 mu_d */
+
+    // buffers of the problem
+    iDynTree::SparseMatrix<iDynTree::ColumnMajor> m_D; /** dynamics constraints matrix */
+    iDynTree::VectorDynSize m_bD; /** dynamics constraints bias */
+    iDynTree::SparseMatrix<iDynTree::ColumnMajor> m_Y; /** measurements matrix */
+    iDynTree::VectorDynSize m_bY; /** measurements bias */
+    SparseMatrix m_weightedD; /** Sigma_D^-1 D, used only with non diagonal priors */
+    SparseMatrix m_weightedY; /** Sigma_y^-1 Y, used only with non diagonal priors */
+    Transpose m_DTranspose; /** D^T, used only with diagonal priors */
+    Transpose m_YTranspose; /** Y^T, used only with diagonal priors */
+    bool m_hasInformationPattern{false}; /** true if the pattern of m_information is the one of the
+                                            diagonal priors for the current D and Y */
+    Eigen::VectorXi m_positions; /** position in the values of m_information of each row of the
+                                    column being computed */
+    Eigen::VectorXd m_weightedBD; /** Sigma_D^-1 bD */
+    Eigen::VectorXd m_weightedMeasurements; /** Sigma_y^-1 (y - bY) */
+    SparseMatrix m_information; /** information matrix */
+    Eigen::VectorXd m_informationVector; /** information vector */
+    std::vector<int> m_pattern; /** outer and inner indices of the information matrix */
+    bool m_patternChanged{true}; /** true if the pattern changed in the last update */
+};
+
+} // namespace ID
+} // namespace BiomechanicalAnalysis
+
+#endif // BIOMECHANICAL_ANALYSIS_MAP_INFORMATION_FORM_H
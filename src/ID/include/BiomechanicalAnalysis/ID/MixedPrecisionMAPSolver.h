@@ -0,0 +1,147 @@
+/**
+ * @file MixedPrecisionMAPSolver.h
+ * @authors Davide Gorbani <davide.gorbani@iit.it>
+ */
+
+#ifndef BIOMECHANICAL_ANALYSIS_MIXED_PRECISION_MAP_SOLVER_H
+#define BIOMECHANICAL_ANALYSIS_MIXED_PRECISION_MAP_SOLVER_H
+
+#include <cstddef>
+
+// Eigen headers
+#include <Eigen/Dense>
+#include <Eigen/SparseCholesky>
+
+// iDynTree headers
+#include <iDynTree/BerdyHelper.h>
+#include <iDynTree/BerdySparseMAPSolver.h>
+
+#include <BiomechanicalAnalysis/ID/MAPInformationForm.h>
+
+namespace BiomechanicalAnalysis
+{
+namespace ID
+{
+
+/**
+ * @brief Solver of the BERDY MAP problem equivalent to iDynTree::BerdySparseMAPSolver, which
+ * factorizes the information matrix of the a posteriori distribution in single precision and
+ * recovers the double precision accuracy with iterative refinement.
+ * The information matrix and the residuals are computed in double precision, the matrix is scaled
+ * by the inverse square root of its diagonal before being cast to float, so that the priors with
+ * very different covariances do not exceed the range of the single precision factorization. If the
+ * refinement does not reach the requested tolerance, the problem is solved again with a double
+ * precision factorization.
+ */
+class MixedPrecisionMAPSolver
+{
+public:
+    /**
+     * @brief Constructor
+     * @param berdyHelper BerdyHelper object of the problem, it must outlive the solver
+     */
+    explicit MixedPrecisionMAPSolver(iDynTree::BerdyHelper& berdyHelper);
+
+    /**
+     * @brief Function to initialize the solver with the priors of a BerdySparseMAPSolver built on
+     * the same BerdyHelper, so that the two solvers estimate the same distribution
+     * @param reference solver whose priors are copied, they must be set before calling this function
+     * @param refinementSteps maximum number of double precision refinement steps, at least one
+     * @param tolerance norm of the last correction, relative to the norm of the estimate, below which
+     * the refinement is stopped
+     * @return true if the initialization is successful, false otherwise
+     */
+    bool initialize(const iDynTree::BerdySparseMAPSolver& reference, const std::size_t refinementSteps, const double tolerance);
+
+    /**
+     * @brief Function to copy again the measurements prior of the reference solver, e.g. after
+     * changing the active wrench sources, the other priors are unchanged
+     * @param reference solver passed to initialize
+     * @return true if the update is successful, false otherwise
+     */
+    bool updateMeasurementsPrior(const iDynTree::BerdySparseMAPSolver& reference);
+
+    /**
+     * @brief Function to update the kinematics of the BerdyHelper and the measurements
+     * @param jointsConfiguration joints position
+     * @param jointsVelocity joints velocity
+     * @param floatingFrame index of the floating base frame
+     * @param bodyAngularVelocityOfSpecifiedFrame angular velocity of the floating base frame
+     * @param measurements measurements vector
+     */
+    void updateEstimateInformationFloatingBase(const iDynTree::JointPosDoubleArray& jointsConfiguration,
+                                               const iDynTree::JointDOFsDoubleArray& jointsVelocity,
+                                               const iDynTree::FrameIndex floatingFrame,
+                                               const iDynTree::Vector3& bodyAngularVelocityOfSpecifiedFrame,
+                                               const iDynTree::VectorDynSize& measurements);
+
+    /**
+     * @brief Function to compute the expected value of the a posteriori distribution
+     * @return true if the estimation is successful, false otherwise
+     */
+    bool doEstimate();
+
+    /**
+     * @brief Function to get the last estimate of the dynamic variables
+     * @param lastEstimate vector filled with the expected value of the dynamic variables
+     */
+    void getLastEstimate(iDynTree::VectorDynSize& lastEstimate) const;
+
+    /**
+     * @brief Function to get the number of refinement steps done by the last estimation
+     * @return number of refinement steps
+     */
+    std::size_t getLastRefinementSteps() const;
+
+    /**
+     * @brief Function to get the number of estimations solved again in double precision because the
+     * refinement did not converge
+     * @return number of estimations
+     */
+    std::size_t getNrOfDoublePrecisionFallbacks() const;
+
+private:
+    using SparseMatrix = MAPInformationForm::SparseMatrix;
+    using SparseMatrixFloat = Eigen::SparseMatrix<float, Eigen::ColMajor>;
+
+    /**
+     * @brief Function to factorize the scaled information matrix in single precision, analyzing its
+     * pattern only if it changed since the last factorization
+     * @return true if the factorization is successful, false otherwise
+     */
+    bool factorize();
+
+    /**
+     * @brief Function to compute the scaled information matrix in single precision, its values are
+     * overwritten in place unless the pattern of the information matrix changed
+     * @param information information matrix in double precision
+     */
+    void updateScaledInformation(const SparseMatrix& information);
+
+    iDynTree::BerdyHelper& m_berdyHelper; /** BerdyHelper object of the problem */
+    std::size_t m_refinementSteps{5}; /** maximum number of refinement steps */
+    double m_tolerance{1e-8}; /** relative correction below which the refinement is stopped */
+    MAPInformationForm m_informationForm; /** information form of the problem */
+    iDynTree::VectorDynSize m_measurements; /** measurements of the last update */
+    Eigen::VectorXd m_scaling; /** inverse square root of the diagonal of the information matrix */
+    SparseMatrixFloat m_scaledInformation; /** scaled information matrix in single precision */
+    Eigen::SimplicialLDLT<SparseMatrixFloat> m_factorization; /** single precision factorization */
+    bool m_analyzed{false}; /** true if the pattern of the factorization has been analyzed */
+    Eigen::SimplicialLDLT<SparseMatrix> m_fallbackFactorization; /** double precision factorization
+                                                                   used when the refinement does not
+                                                                   converge */
+    bool m_fallbackAnalyzed{false}; /** true if the pattern of the double precision factorization has
+                                       been analyzed */
+    Eigen::VectorXf m_scaledVector; /** scaled right hand side in single precision */
+    Eigen::VectorXf m_scaledSolution; /** solution of the single precision factorization */
+    Eigen::VectorXd m_residual; /** residual of the refinement */
+    Eigen::VectorXd m_correction; /** correction of the refinement */
+    Eigen::VectorXd m_estimate; /** expected value of the dynamic variables */
+    std::size_t m_lastRefinementSteps{0}; /** refinement steps done by the last estimation */
+    std::size_t m_nrOfFallbacks{0}; /** estimations solved again in double precision */
+};
+
+} // namespace ID
+} // namespace BiomechanicalAnalysis
+
+#endif // BIOMECHANICAL_ANALYSIS_MIXED_PRECISION_MAP_SOLVER_H
@@ -0,0 +1,127 @@
+#include <BiomechanicalAnalysis/ID/DiagonalPriorsMAPSolver.h>
+#include <BiomechanicalAnalysis/Logging/Logger.h>
+#include <iDynTree/EigenHelpers.h>
+
+using namespace BiomechanicalAnalysis::ID;
+
+DiagonalPriorsMAPSolver::DiagonalPriorsMAPSolver(iDynTree::BerdyHelper& berdyHelper)
+    : m_berdyHelper(berdyHelper)
+{
+}
+
+bool DiagonalPriorsMAPSolver::initialize(const iDynTree::BerdySparseMAPSolver& reference)
+{
+    constexpr auto logPrefix = "[DiagonalPriorsMAPSolver::initialize]";
+
+    if (!m_informationForm.initialize(m_berdyHelper, reference))
+    {
+        BiomechanicalAnalysis::log()->error("{} Error initializing the information form.", logPrefix);
+        return false;
+    }
+    if (!m_informationForm.hasDiagonalPriors())
+    {
+        BiomechanicalAnalysis::log()->error("{} The priors of the reference solver are not diagonal.", logPrefix);
+        return false;
+    }
+
+    m_measurements.resize(m_berdyHelper.getNrOfSensorsMeasurements());
+    m_measurements.zero();
+    m_estimate = Eigen::VectorXd::Zero(m_berdyHelper.getNrOfDynamicVariables());
+    m_analyzed = false;
+
+    return true;
+}
+
+bool DiagonalPriorsMAPSolver::updateMeasurementsPrior(const iDynTree::BerdySparseMAPSolver& reference)
+{
+    m_informationForm.setMeasurementsPrior(reference);
+    if (!m_informationForm.hasDiagonalPriors())
+    {
+        BiomechanicalAnalysis::log()->error("[DiagonalPriorsMAPSolver::updateMeasurementsPrior] The measurements prior is not "
+                                            "diagonal.");
+        return false;
+    }
+    return true;
+}
+
+void DiagonalPriorsMAPSolver::updateEstimateInformationFloatingBase(const iDynTree::JointPosDoubleArray& jointsConfiguration,
+                                                                    const iDynTree::JointDOFsDoubleArray& jointsVelocity,
+                                                                    const iDynTree::FrameIndex floatingFrame,
+                                                                    const iDynTree::Vector3& bodyAngularVelocityOfSpecifiedFrame,
+                                                                    const iDynTree::VectorDynSize& measurements)
+{
+    m_berdyHelper.updateKinematicsFromFloatingBase(jointsConfiguration, jointsVelocity, floatingFrame, bodyAngularVelocityOfSpecifiedFrame);
+    m_measurements = measurements;
+}
+
+bool DiagonalPriorsMAPSolver::doEstimate()
+{
+    constexpr auto logPrefix = "[DiagonalPriorsMAPSolver::doEstimate]";
+
+    if (!m_informationForm.update(m_berdyHelper, m_measurements))
+    {
+        BiomechanicalAnalysis::log()->error("{} Error computing the information form.", logPrefix);
+        return false;
+    }
+
+    // The symbolic analysis depends only on the pattern, which changes only at the first update
+    if (!m_analyzed || m_informationForm.hasPatternChanged())
+    {
+        analyzePattern();
+    }
+
+    // P I P^T is factorized without copying it in the factorization, and the estimate is P^T times
+    // the solution of the permuted system
+    const double* values = m_informationForm.getInformationMatrix().valuePtr();
+    for (std::size_t i = 0; i < m_permutedIndices.size(); i++)
+    {
+        m_permutedInformation.valuePtr()[i] = values[m_permutedIndices[i]];
+    }
+    m_factorization.factorize(m_permutedInformation);
+    if (m_factorization.info() != Eigen::Success)
+    {
+        BiomechanicalAnalysis::log()->error("{} Error factorizing the information matrix.", logPrefix);
+        return false;
+    }
+    m_permutedInformationVector = m_permutation * m_informationForm.getInformationVector();
+    m_permutedEstimate = m_factorization.solve(m_permutedInformationVector);
+    m_estimate = m_inversePermutation * m_permutedEstimate;
+
+    return true;
+}
+
+void DiagonalPriorsMAPSolver::analyzePattern()
+{
+    const SparseMatrix& information = m_informationForm.getInformationMatrix();
+
+    Eigen::AMDOrdering<SparseMatrix::StorageIndex> ordering;
+    ordering(information, m_inversePermutation);
+    m_permutation = m_inversePermutation.inverse();
+
+    // the permutation of a matrix whose values are their indices maps each value of the permuted
+    // matrix to the one of the information matrix
+    SparseMatrix indexed = information;
+    for (Eigen::Index i = 0; i < indexed.nonZeros(); i++)
+    {
+        indexed.valuePtr()[i] = static_cast<double>(i);
+    }
+    m_permutedInformation.resize(information.rows(), information.cols());
+    m_permutedInformation.selfadjointView<Eigen::Upper>() = indexed.selfadjointView<Eigen::Lower>().twistedBy(m_permutation);
+    m_permutedInformation.makeCompressed();
+    m_permutedIndices.resize(m_permutedInformation.nonZeros());
+    for (Eigen::Index i = 0; i < m_permutedInformation.nonZeros(); i++)
+    {
+        m_permutedIndices[i] = static_cast<int>(m_permutedInformation.valuePtr()[i]);
+    }
+
+    m_factorization.analyzePattern(m_permutedInformation);
+    m_permutedInformationVector.resize(information.rows());
+    m_permutedEstimate.resize(information.rows());
+    m_analyzed = true;
+}
+
+void DiagonalPriorsMAPSolver::getLastEstimate(iDynTree::VectorDynSize& lastEstimate) const
+{
+    lastEstimate.resize(m_estimate.size());
+    iDynTree::toEigen(lastEstimate) = m_estimate;
+}
@@ -1,14 +1,34 @@
 #include <BiomechanicalAnalysis/ID/InverseDynamics.h>
 #include <BiomechanicalAnalysis/Logging/Logger.h>
+#include <BiomechanicalAnalysis/Model/ModelSimplification.h>
+#include <BiomechanicalAnalysis/System/Executor.h>
 #include <ResolveRoboticsURICpp.h>
 #include <iDynTree/EigenHelpers.h>
 #include <iDynTree/ModelLoader.h>
 
+#include <algorithm>
+#include <bitset>
+#include <limits>
+
 using namespace BiomechanicalAnalysis::ID;
 
 bool HumanID::initialize(std::weak_ptr<const BipedalLocomotion::ParametersHandler::IParametersHandler> handler,
                          std::shared_ptr<iDynTree::KinDynComputations> kinDyn)
 {
+    return initializeFromModel(handler, kinDyn, nullptr);
+}
+
+bool HumanID::initialize(std::weak_ptr<const BipedalLocomotion::ParametersHandler::IParametersHandler> handler,
+                         std::shared_ptr<iDynTree::KinDynComputations> kinDyn,
+                         const iDynTree::Model& fullModel)
+{
+    return initializeFromModel(handler, kinDyn, &fullModel);
+}
+
+bool HumanID::initializeFromModel(std::weak_ptr<const BipedalLocomotion::ParametersHandler::IParametersHandler> handler,
+                                  std::shared_ptr<iDynTree::KinDynComputations> kinDyn,
+                                  const iDynTree::Model* fullModel)
+{
 
     // Log prefix for this class
     constexpr auto logPrefix = "[HumanID::initialize]";
@@ -33,10 +53,24 @@ bool HumanID::initialize(std::weak_ptr<const BipedalLocomotion::ParametersHandle
     // Assign the passed kinDyn object
     m_kinDyn = kinDyn;
 
-    // Check if the model path is provided and load the model if present, otherwise use the kinDyn object
+    // Use the model passed by the user if any, otherwise check if the model path is provided and load
+    // the model if present, otherwise use the kinDyn object
     iDynTree::ModelLoader loader;
     std::string urdfModel;
-    if (ptr->getParameter("urdfModel", urdfModel))
+    if (fullModel != nullptr)
+    {
+        // Use the model passed by the user, without parsing any file
+        m_kinDynFullModel = std::make_shared<iDynTree::KinDynComputations>();
+        if (!m_kinDynFullModel->loadRobotModel(*fullModel))
+        {
+            BiomechanicalAnalysis::log()->error("{} Error loading the model passed to the initialize function.", logPrefix);
+            return false;
+        }
+
+        // Set the floating base for m_kinDynFullModel
+        m_kinDynFullModel->setFloatingBase(m_kinDyn->getFloatingBase());
+        m_useFullModel = true;
+    } else if (ptr->getParameter("urdfModel", urdfModel))
     {
         std::optional<std::string> urdfOpt = ResolveRoboticsURICpp::resolveRoboticsURI(urdfModel);
         if (!urdfOpt.has_value())
@@ -93,14 +127,62 @@ bool HumanID::initialize(std::weak_ptr<const BipedalLocomotion::ParametersHandle
         m_kinDynFullModel = m_kinDyn;
     }
 
-    // Resize and initialize the KinematicState object
+    // Get the optional parameters of the specialized MAP solvers
+    m_useMixedPrecision = false;
+    ptr->getParameter("mixedPrecision", m_useMixedPrecision);
+    int refinementSteps;
+    if (ptr->getParameter("mixedPrecisionRefinementSteps", refinementSteps))
+    {
+        if (refinementSteps < 1)
+        {
+            BiomechanicalAnalysis::log()->error("{} The 'mixedPrecisionRefinementSteps' parameter must be positive.", logPrefix);
+            return false;
+        }
+        m_mixedPrecisionRefinementSteps = static_cast<std::size_t>(refinementSteps);
+    }
+    ptr->getParameter("mixedPrecisionTolerance", m_mixedPrecisionTolerance);
+    m_useDiagonalPriors = false;
+    ptr->getParameter("diagonalPriors", m_useDiagonalPriors);
+
+    // Lump the negligible links of the model used for the inverse dynamics, if requested
+    auto simplificationHandler = ptr->getGroup("MODEL_SIMPLIFICATION").lock();
+    if (simplificationHandler != nullptr)
+    {
+        if (!simplifyFullModel(simplificationHandler, ptr->getGroup("EXTERNAL_WRENCHES").lock()))
+        {
+            BiomechanicalAnalysis::log()->error("{} Error simplifying the model.", logPrefix);
+            return false;
+        }
+    }
+
+    // Resize and initialize the KinematicState object, which is read at the first frame
+    m_kinStateUpdated = false;
     m_kinState.floatingBaseFrameIndex = m_kinDyn->getFrameIndex(m_kinDyn->getFloatingBase());
     m_kinState.jointsPosition.resize(m_kinDynFullModel->model().getNrOfDOFs());
     m_kinState.jointsPosition.zero();
     m_kinState.jointsVelocity.resize(m_kinDynFullModel->model().getNrOfDOFs());
     m_kinState.jointsVelocity.zero();
     m_kinState.baseAngularVelocity.zero();
+    m_kinState.inputJointsPosition.resize(m_kinDyn->getNrOfDegreesOfFreedom());
+    m_kinState.inputJointsVelocity.resize(m_kinDyn->getNrOfDegreesOfFreedom());
+
+    // Map the joints of the full model to the ones of the kinDyn object, so that the state can be
+    // copied without looking up the joint names at each frame
+    m_fullModelJointsMap.assign(m_kinDynFullModel->getNrOfDegreesOfFreedom(), -1);
+    for (int i = 0; i < m_kinDynFullModel->getNrOfDegreesOfFreedom(); i++)
+    {
+        for (int j = 0; j < m_kinDyn->getNrOfDegreesOfFreedom(); j++)
+        {
+            if (m_kinDynFullModel->getRobotModel().getJointName(i) == m_kinDyn->getRobotModel().getJointName(j))
+            {
+                m_fullModelJointsMap[i] = j;
+                break;
+            }
+        }
+    }
+
     m_jointTorquesHelper.estimatedJointTorques.resize(m_kinDynFullModel->model().getNrOfDOFs());
+    m_linkExtWrenches.resize(m_kinDynFullModel->model());
 
     // Get the group handler for 'JOINT_TORQUES' to initialize the MAPHelper m_jointTorquesHelper object
     auto jointTorquesHandler = ptr->getGroup("JOINT_TORQUES").lock();
@@ -132,10 +214,7 @@ bool HumanID::initialize(std::weak_ptr<const BipedalLocomotion::ParametersHandle
         return false;
     }
 
-    // Resize the estimated Dynamic Variables and the measurement vectors of the MAPHelper objects
-    m_extWrenchesEstimator.estimatedDynamicVariables.resize(m_extWrenchesEstimator.berdyHelper.getNrOfDynamicVariables());
-    m_extWrenchesEstimator.measurement.resize(m_extWrenchesEstimator.berdyHelper.getNrOfSensorsMeasurements());
-    m_extWrenchesEstimator.measurement.zero();
+    // Resize the estimated Dynamic Variables and the measurement vectors of the MAPHelper object
     m_jointTorquesHelper.estimatedDynamicVariables.resize(m_jointTorquesHelper.berdyHelper.getNrOfDynamicVariables());
     m_jointTorquesHelper.measurement.resize(m_jointTorquesHelper.berdyHelper.getNrOfSensorsMeasurements());
 
@@ -145,32 +224,41 @@ bool HumanID::initialize(std::weak_ptr<const BipedalLocomotion::ParametersHandle
 bool HumanID::updateExtWrenchesMeasurements(const std::unordered_map<std::string, iDynTree::Wrench>& wrenches)
 {
     constexpr auto logPrefix = "[HumanID::updateExtWrenchesMeasurements]";
-    if (m_useFullModel)
-    {
-        // if the full model is used, update the kinematic state of the full model
-        iDynTree::Transform w_H_b;
-        iDynTree::VectorDynSize s;
-        s.resize(m_kinDyn->getNrOfDegreesOfFreedom());
-        iDynTree::Twist base_velocity;
-        iDynTree::VectorDynSize s_dot;
-        s_dot.resize(m_kinDyn->getNrOfDegreesOfFreedom());
-        iDynTree::Vector3 world_gravity;
-        m_kinDyn->getRobotState(w_H_b, s, base_velocity, s_dot, world_gravity);
-        m_kinState.jointsPosition.zero();
-        m_kinState.jointsVelocity.zero();
-        for (int i = 0; i < m_kinDynFullModel->getNrOfDegreesOfFreedom(); i++)
-        {
-            for (int j = 0; j < m_kinDyn->getNrOfDegreesOfFreedom(); j++)
-            {
-                if (m_kinDynFullModel->getRobotModel().getJointName(i) == m_kinDyn->getRobotModel().getJointName(j))
-                {
-                    m_kinState.jointsPosition(i) = s(j);
-                    m_kinState.jointsVelocity(i) = s_dot(j);
-                    break;
-                }
-            }
+
+    // Read the kinematic state of the current frame, solve() can use it only if the measurements
+    // are updated successfully
+    m_kinStateUpdated = false;
+    updateKinematicState();
+
+    // Update the active wrench sources whose contact is detected with a force threshold
+    for (std::size_t i = 0; i < m_wrenchSources.size(); i++)
+    {
+        if (!m_wrenchSources[i].contactForceThreshold.has_value())
+        {
+            continue;
+        }
+        auto wrenchIt = wrenches.find(m_wrenchSources[i].outputFrame);
+        if (wrenchIt == wrenches.end())
+        {
+            BiomechanicalAnalysis::log()->error("{} Wrench {} not found.", logPrefix, m_wrenchSources[i].outputFrame);
+            return false;
+        }
+        // The vertical force is compared in the output frame, where the wrench is measured by BERDY
+        const iDynTree::Wrench wrench = m_wrenchSources[i].outputFrameTransform * wrenchIt->second;
+        if (wrench.getLinearVec3()(2) > m_wrenchSources[i].contactForceThreshold.value())
+        {
+            m_activeWrenchSources |= (std::size_t{1} << i);
+        } else
+        {
+            m_activeWrenchSources &= ~(std::size_t{1} << i);
         }
-        m_kinDynFullModel->setRobotState(w_H_b, m_kinState.jointsPosition, base_velocity, m_kinState.jointsVelocity, world_gravity);
+    }
+
+    // Select the measurements prior associated to the current combination of active wrench sources
+    if (!selectMeasurementsPrior())
+    {
+        BiomechanicalAnalysis::log()->error("{} Error selecting the measurements prior.", logPrefix);
+        return false;
     }
 
     // Update the measurement vector with the measurements of the wrenches
@@ -190,6 +278,13 @@ bool HumanID::updateExtWrenchesMeasurements(const std::unordered_map<std::string
         // If the wrench source type is Fixed, compute the wrench and update the measurement vector
         else if (m_wrenchSources[i].type == WrenchSourceType::Fixed)
         {
+            // The measurement of an inactive source is zero, as for any link not in contact
+            if (!isWrenchSourceActive(i))
+            {
+                m_wrenchSources[i].wrench.zero();
+                continue;
+            }
+
             // Check if the wrench exists in the provided wrenches map
             if (wrenches.find(m_wrenchSources[i].outputFrame) == wrenches.end())
             {
@@ -199,7 +294,6 @@ bool HumanID::updateExtWrenchesMeasurements(const std::unordered_map<std::string
 
             // Compute the wrench in the output frame's transformed coordinate system
             m_wrenchSources[i].wrench = m_wrenchSources[i].outputFrameTransform * wrenches.at(m_wrenchSources[i].outputFrame);
-            iDynTree::Wrench wrenchMeas = m_wrenchSources[i].outputFrameTransform * wrenches.at(m_wrenchSources[i].outputFrame);
             iDynTree::LinkIndex linkIndex = m_extWrenchesEstimator.berdyHelper.model().getLinkIndex(m_wrenchSources[i].outputFrame);
             if (linkIndex == iDynTree::LINK_INVALID_INDEX)
             {
@@ -210,8 +304,8 @@ bool HumanID::updateExtWrenchesMeasurements(const std::unordered_map<std::string
             // Determine the range of indices in the measurement vector for this sensor
             iDynTree::IndexRange sensorRange
                 = m_extWrenchesEstimator.berdyHelper.getRangeLinkSensorVariable(iDynTree::BerdySensorTypes::NET_EXT_WRENCH_SENSOR,
-                                                                                m_kinDynFullModel->getFrameIndex(
-                                                                                    m_wrenchSources[i].outputFrame));
+                                                                                 m_kinDynFullModel->getFrameIndex(
+                                                                                     m_wrenchSources[i].outputFrame));
 
             // Update the measurement vector with the computed wrench components
             for (int j = 0; j < 6; j++)
@@ -234,6 +328,7 @@ bool HumanID::updateExtWrenchesMeasurements(const std::unordered_map<std::string
         m_extWrenchesEstimator.measurement(rcmSensorRange.offset + i) = rcmWrench(i);
     }
 
+    m_kinStateUpdated = true;
     return true; // Return true indicating successful update of the measurement vector
 }
 
@@ -241,29 +336,25 @@ bool HumanID::solve()
 {
     constexpr auto logPrefix = "[HumanID::solve]";
 
-    // Update the kinematic state
-    m_kinDynFullModel->getJointPos(m_kinState.jointsPosition);
-    m_kinDynFullModel->getJointVel(m_kinState.jointsVelocity);
-    m_kinState.baseAngularVelocity = m_kinDyn->getBaseTwist().getAngularVec3();
+    // The kinematic state is read only by updateExtWrenchesMeasurements, solving without it would
+    // use the state of the previous frame
+    if (!m_kinStateUpdated)
+    {
+        BiomechanicalAnalysis::log()->error("{} updateExtWrenchesMeasurements() must be called before solve() on each frame.",
+                                            logPrefix);
+        return false;
+    }
+    m_kinStateUpdated = false;
 
-    // Update the berdySolver object with the current kinematic state
-    m_extWrenchesEstimator.berdySolver->updateEstimateInformationFloatingBase(m_kinState.jointsPosition,
-                                                                              m_kinState.jointsVelocity,
-                                                                              m_kinState.floatingBaseFrameIndex,
-                                                                              m_kinState.baseAngularVelocity,
-                                                                              m_extWrenchesEstimator.measurement);
-    // Estimate the external wrenches
-    if (!m_extWrenchesEstimator.berdySolver->doEstimate())
+    // Estimate the external wrenches with the kinematic state read in updateExtWrenchesMeasurements
+    if (!estimateDynamicVariables(m_extWrenchesEstimator))
     {
         BiomechanicalAnalysis::log()->error("{} Error in the estimation of the dynamics.", logPrefix);
         return false;
     }
 
-    m_extWrenchesEstimator.berdySolver->getLastEstimate(m_extWrenchesEstimator.estimatedDynamicVariables);
-
-    iDynTree::LinkNetExternalWrenches linkExtWrenches(m_kinDynFullModel->getRobotModel());
     m_extWrenchesEstimator.berdyHelper.extractLinkNetExternalWrenchesFromDynamicVariables(m_extWrenchesEstimator.estimatedDynamicVariables,
-                                                                                          linkExtWrenches);
+                                                                                           m_linkExtWrenches);
 
     // Extract the estimated external wrenches
     for (std::size_t i = 0; i < m_wrenchSources.size(); i++)
@@ -271,7 +362,7 @@ bool HumanID::solve()
         iDynTree::LinkIndex linkIndex = m_kinDynFullModel->getRobotModel().getLinkIndex(m_wrenchSources[i].outputFrame);
         for (int j = 0; j < 6; j++)
         {
-            m_estimatedExtWrenches[i](j) = linkExtWrenches(linkIndex)(j);
+            m_estimatedExtWrenches[i](j) = m_linkExtWrenches(linkIndex)(j);
         }
     }
 
@@ -288,34 +379,14 @@ bool HumanID::solve()
         }
     }
 
-    // Update the berdyHelper object with the current kinematic state
-    if (!m_jointTorquesHelper.berdyHelper.updateKinematicsFromFloatingBase(m_kinState.jointsPosition,
-                                                                           m_kinState.jointsVelocity,
-                                                                           m_kinState.floatingBaseFrameIndex,
-                                                                           m_kinState.baseAngularVelocity))
-    {
-        BiomechanicalAnalysis::log()->error("{} Error updating the kinematics from the floating "
-                                            "base.",
-                                            logPrefix);
-        return false;
-    }
-
-    // Update the berdySolver object with the current kinematic state
-    m_jointTorquesHelper.berdySolver->updateEstimateInformationFloatingBase(m_kinState.jointsPosition,
-                                                                            m_kinState.jointsVelocity,
-                                                                            m_kinState.floatingBaseFrameIndex,
-                                                                            m_kinState.baseAngularVelocity,
-                                                                            m_jointTorquesHelper.measurement);
-    // Estimate the joint torques
-    if (!m_jointTorquesHelper.berdySolver->doEstimate())
+    // Estimate the joint torques, the solver takes care of updating the kinematics of its
+    // berdyHelper
+    if (!estimateDynamicVariables(m_jointTorquesHelper))
     {
         BiomechanicalAnalysis::log()->error("{} Error in the estimation of the dynamics.", logPrefix);
         return false;
     }
 
-    // Extract the estimated dynamic variables
-    m_jointTorquesHelper.berdySolver->getLastEstimate(m_jointTorquesHelper.estimatedDynamicVariables);
-
     // Extract the estimated joint torques
     if (!m_jointTorquesHelper.berdyHelper.extractJointTorquesFromDynamicVariables(m_jointTorquesHelper.estimatedDynamicVariables,
                                                                                   m_kinState.jointsPosition,
@@ -335,15 +406,26 @@ iDynTree::VectorDynSize HumanID::getJointTorques()
     return m_jointTorquesHelper.estimatedJointTorques;
 }
 
-void HumanID::getJointTorques(Eigen::Ref<Eigen::VectorXd> jointTorques)
+bool HumanID::getJointTorques(Eigen::Ref<Eigen::VectorXd> jointTorques)
 {
     if (jointTorques.size() != m_kinDynFullModel->model().getNrOfDOFs())
     {
         BiomechanicalAnalysis::log()->error("[HumanID::getJointTorques] The size of the input vector "
                                             "is different from the number of DOFs of the model.");
-        return;
+        return false;
     }
     jointTorques = iDynTree::toEigen(m_jointTorquesHelper.estimatedJointTorques);
+    return true;
+}
+
+std::size_t HumanID::getNrOfDOFs() const
+{
+    return m_kinDynFullModel->model().getNrOfDOFs();
+}
+
+const iDynTree::Model& HumanID::getModel() const
+{
+    return m_kinDynFullModel->model();
 }
 
 std::vector<std::string> HumanID::getJointsList()
@@ -371,6 +453,72 @@ std::vector<std::string> HumanID::getEstimatedExtWrenchesList()
     return wrenchSources;
 }
 
+bool HumanID::simplifyFullModel(const std::shared_ptr<BipedalLocomotion::ParametersHandler::IParametersHandler> groupHandler,
+                                const std::shared_ptr<BipedalLocomotion::ParametersHandler::IParametersHandler> extWrenchesHandler)
+{
+    constexpr auto logPrefix = "[HumanID::simplifyFullModel]";
+
+    BiomechanicalAnalysis::Model::SimplificationParameters parameters;
+    if (!groupHandler->getParameter("massThreshold", parameters.massThreshold))
+    {
+        BiomechanicalAnalysis::log()->error("{} Error getting the 'massThreshold' parameter.", logPrefix);
+        return false;
+    }
+    if (!groupHandler->getParameter("inertiaThreshold", parameters.inertiaThreshold))
+    {
+        BiomechanicalAnalysis::log()->error("{} Error getting the 'inertiaThreshold' parameter.", logPrefix);
+        return false;
+    }
+    if (!groupHandler->getParameter("lumpFixedJoints", parameters.lumpFixedJoints))
+    {
+        parameters.lumpFixedJoints = true;
+    }
+
+    // the floating base and the links where the external wrenches are applied must be preserved
+    const iDynTree::Model& model = m_kinDynFullModel->model();
+    const std::string floatingBase = m_kinDyn->getFloatingBase();
+    if (model.getLinkIndex(floatingBase) == iDynTree::LINK_INVALID_INDEX)
+    {
+        BiomechanicalAnalysis::log()->error("{} The floating base {} is not a link of the model.", logPrefix, floatingBase);
+        return false;
+    }
+    parameters.preservedLinks.push_back(floatingBase);
+    std::vector<std::string> wrenchSources;
+    if (extWrenchesHandler != nullptr && extWrenchesHandler->getParameter("wrenchSources", wrenchSources))
+    {
+        for (const auto& source : wrenchSources)
+        {
+            auto sourceHandler = extWrenchesHandler->getGroup(source).lock();
+            std::string outputFrame;
+            if (sourceHandler != nullptr && sourceHandler->getParameter("outputFrame", outputFrame)
+                && model.getLinkIndex(outputFrame) != iDynTree::LINK_INVALID_INDEX)
+            {
+                parameters.preservedLinks.push_back(outputFrame);
+            }
+        }
+    }
+
+    // the simplified model keeps the base of the original one
+    iDynTree::Model baseModel = model;
+    baseModel.setDefaultBaseLink(model.getLinkIndex(floatingBase));
+    iDynTree::Model simplifiedModel;
+    if (!BiomechanicalAnalysis::Model::ModelSimplification::simplifyModel(baseModel, parameters, simplifiedModel))
+    {
+        return false;
+    }
+
+    m_kinDynFullModel = std::make_shared<iDynTree::KinDynComputations>();
+    if (!m_kinDynFullModel->loadRobotModel(simplifiedModel))
+    {
+        BiomechanicalAnalysis::log()->error("{} Error loading the simplified model.", logPrefix);
+        return false;
+    }
+    m_kinDynFullModel->setFloatingBase(floatingBase);
+    m_useFullModel = true;
+
+    return true;
+}
+
 bool HumanID::initializeJointTorquesHelper(const std::shared_ptr<BipedalLocomotion::ParametersHandler::IParametersHandler> groupHandler)
 {
     constexpr auto logPrefix = "[HumanID::intizialize::initializeJointTorquesHelper]";
@@ -534,6 +682,12 @@ bool HumanID::initializeJointTorquesHelper(const std::shared_ptr<BipedalLocomoti
     m_jointTorquesHelper.berdySolver->setDynamicsConstraintsPriorCovariance(dynamicsConstraintsCovarianceMatrix);
     m_jointTorquesHelper.berdySolver->setMeasurementsPriorCovariance(measurementsCovarianceMatrix);
 
+    if (!createSpecializedSolver(m_jointTorquesHelper))
+    {
+        BiomechanicalAnalysis::log()->error("{} Error initializing the specialized MAP solver.", logPrefix);
+        return false;
+    }
+
     return true;
 }
 
@@ -633,21 +787,44 @@ bool HumanID::initializeExtWrenchesHelper(const std::shared_ptr<BipedalLocomotio
             }
         }
 
+        // Get the optional vertical force threshold used to detect the contact
+        double contactForceThreshold;
+        if (wrenchHandler->getParameter("contactForceThreshold", contactForceThreshold))
+        {
+            if (data.type != WrenchSourceType::Fixed)
+            {
+                BiomechanicalAnalysis::log()->error("{} The 'contactForceThreshold' parameter is allowed only for fixed wrench "
+                                                    "sources.",
+                                                    logPrefix);
+                return false;
+            }
+            data.contactForceThreshold = contactForceThreshold;
+        }
+
         // Add the processed wrench source data to the list
         m_wrenchSources.push_back(data);
     }
 
+    // Each wrench source is associated to a bit of the active wrench sources mask
+    if (m_wrenchSources.size() >= std::numeric_limits<std::size_t>::digits)
+    {
+        BiomechanicalAnalysis::log()->error("{} The number of wrench sources must be lower than {}.",
+                                            logPrefix,
+                                            std::numeric_limits<std::size_t>::digits);
+        return false;
+    }
+
     // Resize estimated external wrenches based on the number of sources
     m_estimatedExtWrenches.resize(m_wrenchSources.size());
 
     // Retrieve parameters related to external wrench estimation
-    if (!groupHandler->getParameter("mu_dyn_variables", m_extWrenchesEstimator.params.priorDynamicsRegularizationExpected))
+    if (!groupHandler->getParameter("mu_dyn_variables", m_extWrenchesParams.priorDynamicsRegularizationExpected))
     {
         BiomechanicalAnalysis::log()->error("{} Error getting the 'mu_dyn_variables' parameter.", logPrefix);
         return false;
     }
 
-    if (!groupHandler->getParameter("cov_dyn_variables", m_extWrenchesEstimator.params.priorDynamicsRegularizationCovarianceValue))
+    if (!groupHandler->getParameter("cov_dyn_variables", m_extWrenchesParams.priorDynamicsRegularizationCovarianceValue))
     {
         BiomechanicalAnalysis::log()->error("{} Error getting the 'cov_dyn_variables' parameter.", logPrefix);
         return false;
@@ -670,13 +847,11 @@ bool HumanID::initializeExtWrenchesHelper(const std::shared_ptr<BipedalLocomotio
             BiomechanicalAnalysis::log()->error("{} Error getting the '{}' parameter.", logPrefix, element);
             return false;
         }
-        m_extWrenchesEstimator.params.specificMeasurementsCovariance[element] = covariance;
+        m_extWrenchesParams.specificMeasurementsCovariance[element] = covariance;
     }
 
     // Retrieve covariance for RCM_SENSOR measurements
-    if (!groupHandler->getParameter("cov_measurements_RCM_SENSOR",
-                                    m_extWrenchesEstimator.params.specificMeasurementsCovariance["RCM_"
-                                                                                                 "SENSOR"]))
+    if (!groupHandler->getParameter("cov_measurements_RCM_SENSOR", m_extWrenchesParams.specificMeasurementsCovariance["RCM_SENSOR"]))
     {
         BiomechanicalAnalysis::log()->error("{} Error getting the 'cov_measurements_RCM_SENSOR' "
                                             "parameter.",
@@ -685,7 +860,7 @@ bool HumanID::initializeExtWrenchesHelper(const std::shared_ptr<BipedalLocomotio
     }
 
     // Retrieve default covariance for measurements
-    if (!groupHandler->getParameter("default_cov_measurements", m_extWrenchesEstimator.params.measurementDefaultCovariance))
+    if (!groupHandler->getParameter("default_cov_measurements", m_extWrenchesParams.measurementDefaultCovariance))
     {
         BiomechanicalAnalysis::log()->error("{} Error getting the 'default_cov_measurements' "
                                             "parameter.",
@@ -693,6 +868,18 @@ bool HumanID::initializeExtWrenchesHelper(const std::shared_ptr<BipedalLocomotio
         return false;
     }
 
+    // All the wrench sources are active by default; only the activation of the sources with a
+    // specific covariance changes the measurements prior, the other ones share the same prior
+    m_activeWrenchSources = (std::size_t{1} << m_wrenchSources.size()) - 1;
+    m_specificCovarianceWrenchSources = 0;
+    for (std::size_t i = 0; i < m_wrenchSources.size(); i++)
+    {
+        if (m_extWrenchesParams.specificMeasurementsCovariance.count(m_wrenchSources[i].outputFrame) > 0)
+        {
+            m_specificCovarianceWrenchSources |= (std::size_t{1} << i);
+        }
+    }
+
     // Initialize BerdyOptions for external wrenches
     iDynTree::BerdyOptions berdyOptionsExtWrenches;
     berdyOptionsExtWrenches.berdyVariant = iDynTree::BerdyVariants::BERDY_FLOATING_BASE_NON_COLLOCATED_EXT_WRENCHES;
@@ -728,6 +915,107 @@ bool HumanID::initializeExtWrenchesHelper(const std::shared_ptr<BipedalLocomotio
         return false;
     }
 
+    // Set the prior covariance matrix for measurements, the one of all the wrench sources active
+    m_measurementsPriors.clear();
+    m_measurementsPrior = m_activeWrenchSources & m_specificCovarianceWrenchSources;
+    computeMeasurementsPriorCovariance(m_measurementsPrior, m_measurementsPriors[m_measurementsPrior]);
+    m_extWrenchesEstimator.berdySolver->setMeasurementsPriorCovariance(m_measurementsPriors[m_measurementsPrior]);
+
+    // Set mu_d (expected value for dynamics regularization)
+    iDynTree::VectorDynSize dynamicsRegularizationExpectedValueVector;
+    dynamicsRegularizationExpectedValueVector.resize(m_extWrenchesEstimator.berdyHelper.getNrOfDynamicVariables());
+    for (std::size_t i = 0; i < dynamicsRegularizationExpectedValueVector.size(); i++)
+        dynamicsRegularizationExpectedValueVector.setVal(i, m_extWrenchesParams.priorDynamicsRegularizationExpected);
+    m_extWrenchesEstimator.berdySolver->setDynamicsRegularizationPriorExpectedValue(dynamicsRegularizationExpectedValueVector);
+
+    // Set Sigma_d (covariance matrix for dynamics regularization)
+    iDynTree::Triplets priorDynamicsRegularizationCovarianceMatrixTriplets;
+    std::size_t sigmaDSize = m_extWrenchesEstimator.berdyHelper.getNrOfDynamicVariables();
+    for (std::size_t i = 0; i < sigmaDSize; i++)
+    {
+        priorDynamicsRegularizationCovarianceMatrixTriplets.setTriplet({i, i, m_extWrenchesParams.priorDynamicsRegularizationCovarianceValue});
+    }
+    iDynTree::SparseMatrix<iDynTree::ColumnMajor> priorDynamicsRegularizationCovarianceMatrix;
+    priorDynamicsRegularizationCovarianceMatrix.resize(sigmaDSize, sigmaDSize);
+    priorDynamicsRegularizationCovarianceMatrix.setFromTriplets(priorDynamicsRegularizationCovarianceMatrixTriplets);
+    m_extWrenchesEstimator.berdySolver->setDynamicsRegularizationPriorCovariance(priorDynamicsRegularizationCovarianceMatrix);
+
+    // Check validity of BerdySolver initialization
+    if (!m_extWrenchesEstimator.berdySolver->isValid())
+    {
+        BiomechanicalAnalysis::log()->error("{} Error in the initialization of the BerdySolver.", logPrefix);
+        return false;
+    }
+
+    if (!createSpecializedSolver(m_extWrenchesEstimator))
+    {
+        BiomechanicalAnalysis::log()->error("{} Error initializing the specialized MAP solver.", logPrefix);
+        return false;
+    }
+
+    // Resize the estimated dynamic variables and the measurement vectors
+    m_extWrenchesEstimator.params = m_extWrenchesParams;
+    m_extWrenchesEstimator.estimatedDynamicVariables.resize(m_extWrenchesEstimator.berdyHelper.getNrOfDynamicVariables());
+    m_extWrenchesEstimator.measurement.resize(m_extWrenchesEstimator.berdyHelper.getNrOfSensorsMeasurements());
+    m_extWrenchesEstimator.measurement.zero();
+
+    // Precompute the measurements priors of all the combinations of active wrench sources if
+    // requested, i.e. of all the subsets of the sources with a specific covariance
+    bool precomputeContactCombinations{false};
+    groupHandler->getParameter("precomputeContactCombinations", precomputeContactCombinations);
+    if (precomputeContactCombinations)
+    {
+        // The number of combinations grows as 2^N, hence only a few sources can be precomputed
+        const std::size_t nrOfSpecificSources = std::bitset<std::numeric_limits<std::size_t>::digits>(m_specificCovarianceWrenchSources).count();
+        if (nrOfSpecificSources > maxPrecomputedContactSources)
+        {
+            BiomechanicalAnalysis::log()->error("{} 'precomputeContactCombinations' supports at most {} wrench sources with a specific "
+                                                "covariance, {} are configured.",
+                                                logPrefix,
+                                                maxPrecomputedContactSources,
+                                                nrOfSpecificSources);
+            return false;
+        }
+
+        std::vector<std::size_t> combinations;
+        for (std::size_t combination = m_specificCovarianceWrenchSources;; combination = (combination - 1) & m_specificCovarianceWrenchSources)
+        {
+            combinations.push_back(combination);
+            if (combination == 0)
+            {
+                break;
+            }
+        }
+
+        // The priors are independent of each other, hence they are computed in parallel on the
+        // executor shared by the framework
+        std::vector<iDynTree::SparseMatrix<iDynTree::ColumnMajor>> covariances(combinations.size());
+        BiomechanicalAnalysis::System::Executor::instance().parallelFor(0, combinations.size(), [this, &combinations, &covariances](std::size_t i) {
+            computeMeasurementsPriorCovariance(combinations[i], covariances[i]);
+        });
+        for (std::size_t i = 0; i < combinations.size(); i++)
+        {
+            m_measurementsPriors[combinations[i]] = std::move(covariances[i]);
+        }
+    }
+
+    return true;
+}
+
+void HumanID::computeMeasurementsPriorCovariance(const std::size_t activeWrenchSources,
+                                                 iDynTree::SparseMatrix<iDynTree::ColumnMajor>& covariance) const
+{
+    // The inactive wrench sources are treated as the links without external wrenches, hence their
+    // specific covariance is replaced by the default one
+    std::unordered_map<std::string, std::vector<double>> specificMeasurementsCovariance = m_extWrenchesParams.specificMeasurementsCovariance;
+    for (std::size_t i = 0; i < m_wrenchSources.size(); i++)
+    {
+        if ((activeWrenchSources & (std::size_t{1} << i)) == 0)
+        {
+            specificMeasurementsCovariance.erase(m_wrenchSources[i].outputFrame);
+        }
+    }
+
     // Set the prior covariance for the external wrench measurements
     iDynTree::Triplets measurementsCovarianceMatrixTriplets;
     for (const iDynTree::BerdySensor& berdySensor : m_extWrenchesEstimator.berdyHelper.getSensorsOrdering())
@@ -739,10 +1027,10 @@ bool HumanID::initializeExtWrenchesHelper(const std::shared_ptr<BipedalLocomotio
             // Initialize with default covariance
             iDynTree::Vector6 wrenchCovariance;
             for (int i = 0; i < 6; i++)
-                wrenchCovariance.setVal(i, m_extWrenchesEstimator.params.measurementDefaultCovariance);
+                wrenchCovariance.setVal(i, m_extWrenchesParams.measurementDefaultCovariance);
             // Set specific covariance if configured
-            auto specificMeasurementsPtr = m_extWrenchesEstimator.params.specificMeasurementsCovariance.find(berdySensor.id);
-            if (specificMeasurementsPtr != m_extWrenchesEstimator.params.specificMeasurementsCovariance.end())
+            auto specificMeasurementsPtr = specificMeasurementsCovariance.find(berdySensor.id);
+            if (specificMeasurementsPtr != specificMeasurementsCovariance.end())
             {
                 for (int i = 0; i < 6; i++)
                     wrenchCovariance.setVal(i, specificMeasurementsPtr->second[i]);
@@ -755,9 +1043,7 @@ bool HumanID::initializeExtWrenchesHelper(const std::shared_ptr<BipedalLocomotio
         }
         break;
         case iDynTree::BerdySensorTypes::RCM_SENSOR: {
-            auto specificMeasurementsPtr = m_extWrenchesEstimator.params.specificMeasurementsCovariance.find("RCM_"
-                                                                                                             "SENS"
-                                                                                                             "OR");
+            auto specificMeasurementsPtr = specificMeasurementsCovariance.find("RCM_SENSOR");
             for (std::size_t i = 0; i < 6; i++)
             {
                 measurementsCovarianceMatrixTriplets.setTriplet(
@@ -770,44 +1056,209 @@ bool HumanID::initializeExtWrenchesHelper(const std::shared_ptr<BipedalLocomotio
         }
     }
 
-    // Set the prior covariance matrix for measurements
-    iDynTree::SparseMatrix<iDynTree::ColumnMajor> measurementsPriorCovarianceMatrix;
     std::size_t sigmaYSize = m_extWrenchesEstimator.berdyHelper.getNrOfSensorsMeasurements();
-    measurementsPriorCovarianceMatrix.resize(sigmaYSize, sigmaYSize);
-    measurementsPriorCovarianceMatrix.zero();
-    measurementsPriorCovarianceMatrix.setFromTriplets(measurementsCovarianceMatrixTriplets);
-    m_extWrenchesEstimator.berdySolver->setMeasurementsPriorCovariance(measurementsPriorCovarianceMatrix);
+    covariance.resize(sigmaYSize, sigmaYSize);
+    covariance.zero();
+    covariance.setFromTriplets(measurementsCovarianceMatrixTriplets);
+}
 
-    // Set mu_d (expected value for dynamics regularization)
-    iDynTree::VectorDynSize dynamicsRegularizationExpectedValueVector;
-    dynamicsRegularizationExpectedValueVector.resize(m_extWrenchesEstimator.berdyHelper.getNrOfDynamicVariables());
-    for (std::size_t i = 0; i < dynamicsRegularizationExpectedValueVector.size(); i++)
-        dynamicsRegularizationExpectedValueVector.setVal(i, m_extWrenchesEstimator.params.priorDynamicsRegularizationExpected);
-    m_extWrenchesEstimator.berdySolver->setDynamicsRegularizationPriorExpectedValue(dynamicsRegularizationExpectedValueVector);
+bool HumanID::selectMeasurementsPrior()
+{
+    constexpr auto logPrefix = "[HumanID::selectMeasurementsPrior]";
 
-    // Set Sigma_d (covariance matrix for dynamics regularization)
-    iDynTree::Triplets priorDynamicsRegularizationCovarianceMatrixTriplets;
-    std::size_t sigmaDSize = m_extWrenchesEstimator.berdyHelper.getNrOfDynamicVariables();
-    for (std::size_t i = 0; i < sigmaDSize; i++)
+    const std::size_t combination = m_activeWrenchSources & m_specificCovarianceWrenchSources;
+    if (combination == m_measurementsPrior)
     {
-        priorDynamicsRegularizationCovarianceMatrixTriplets.setTriplet(
-            {i, i, m_extWrenchesEstimator.params.priorDynamicsRegularizationCovarianceValue});
+        return true;
     }
-    iDynTree::SparseMatrix<iDynTree::ColumnMajor> priorDynamicsRegularizationCovarianceMatrix;
-    priorDynamicsRegularizationCovarianceMatrix.resize(sigmaDSize, sigmaDSize);
-    priorDynamicsRegularizationCovarianceMatrix.setFromTriplets(priorDynamicsRegularizationCovarianceMatrixTriplets);
-    m_extWrenchesEstimator.berdySolver->setDynamicsRegularizationPriorCovariance(priorDynamicsRegularizationCovarianceMatrix);
 
-    // Check validity of BerdySolver initialization
-    if (!m_extWrenchesEstimator.berdySolver->isValid())
+    auto priorIt = m_measurementsPriors.find(combination);
+    if (priorIt == m_measurementsPriors.end())
+    {
+        priorIt = m_measurementsPriors.emplace(combination, iDynTree::SparseMatrix<iDynTree::ColumnMajor>()).first;
+        computeMeasurementsPriorCovariance(combination, priorIt->second);
+    }
+
+    // Only the measurements prior changes, the BERDY problem and the other priors are shared by all
+    // the combinations
+    m_extWrenchesEstimator.berdySolver->setMeasurementsPriorCovariance(priorIt->second);
+    if (m_extWrenchesEstimator.mixedPrecisionSolver != nullptr
+        && !m_extWrenchesEstimator.mixedPrecisionSolver->updateMeasurementsPrior(*m_extWrenchesEstimator.berdySolver))
+    {
+        BiomechanicalAnalysis::log()->error("{} Error updating the prior of the MixedPrecisionMAPSolver object.", logPrefix);
+        return false;
+    }
+    if (m_extWrenchesEstimator.diagonalPriorsSolver != nullptr
+        && !m_extWrenchesEstimator.diagonalPriorsSolver->updateMeasurementsPrior(*m_extWrenchesEstimator.berdySolver))
+    {
+        BiomechanicalAnalysis::log()->error("{} Error updating the prior of the DiagonalPriorsMAPSolver object.", logPrefix);
+        return false;
+    }
+    m_measurementsPrior = combination;
+    return true;
+}
+
+bool HumanID::createSpecializedSolver(MAPHelper& helper) const
+{
+    helper.mixedPrecisionSolver = nullptr;
+    helper.diagonalPriorsSolver = nullptr;
+
+    // The specialized solvers copy the priors of the BerdySparseMAPSolver, so that they estimate
+    // the same distribution
+    if (m_useMixedPrecision)
+    {
+        helper.mixedPrecisionSolver = std::make_unique<MixedPrecisionMAPSolver>(helper.berdyHelper);
+        return helper.mixedPrecisionSolver->initialize(*helper.berdySolver, m_mixedPrecisionRefinementSteps, m_mixedPrecisionTolerance);
+    }
+    if (m_useDiagonalPriors)
+    {
+        helper.diagonalPriorsSolver = std::make_unique<DiagonalPriorsMAPSolver>(helper.berdyHelper);
+        return helper.diagonalPriorsSolver->initialize(*helper.berdySolver);
+    }
+    return true;
+}
+
+bool HumanID::estimateDynamicVariables(MAPHelper& helper)
+{
+    if (helper.mixedPrecisionSolver != nullptr)
+    {
+        helper.mixedPrecisionSolver->updateEstimateInformationFloatingBase(m_kinState.jointsPosition,
+                                                                          m_kinState.jointsVelocity,
+                                                                          m_kinState.floatingBaseFrameIndex,
+                                                                          m_kinState.baseAngularVelocity,
+                                                                          helper.measurement);
+        if (!helper.mixedPrecisionSolver->doEstimate())
+        {
+            return false;
+        }
+        helper.mixedPrecisionSolver->getLastEstimate(helper.estimatedDynamicVariables);
+        return true;
+    }
+
+    if (helper.diagonalPriorsSolver != nullptr)
+    {
+        helper.diagonalPriorsSolver->updateEstimateInformationFloatingBase(m_kinState.jointsPosition,
+                                                                          m_kinState.jointsVelocity,
+                                                                          m_kinState.floatingBaseFrameIndex,
+                                                                          m_kinState.baseAngularVelocity,
+                                                                          helper.measurement);
+        if (!helper.diagonalPriorsSolver->doEstimate())
+        {
+            return false;
+        }
+        helper.diagonalPriorsSolver->getLastEstimate(helper.estimatedDynamicVariables);
+        return true;
+    }
+
+    helper.berdySolver->updateEstimateInformationFloatingBase(m_kinState.jointsPosition,
+                                                              m_kinState.jointsVelocity,
+                                                              m_kinState.floatingBaseFrameIndex,
+                                                              m_kinState.baseAngularVelocity,
+                                                              helper.measurement);
+    if (!helper.berdySolver->doEstimate())
     {
-        BiomechanicalAnalysis::log()->error("{} Error in the initialization of the BerdySolver.", logPrefix);
         return false;
     }
+    helper.berdySolver->getLastEstimate(helper.estimatedDynamicVariables);
+    return true;
+}
 
+bool HumanID::isWrenchSourceActive(const std::size_t index) const
+{
+    return (m_activeWrenchSources & (std::size_t{1} << index)) != 0;
+}
+
+bool HumanID::setActiveWrenchSources(const std::vector<std::string>& activeSources)
+{
+    std::size_t activeWrenchSources = 0;
+    for (const auto& source : activeSources)
+    {
+        auto sourceIt = std::find_if(m_wrenchSources.begin(), m_wrenchSources.end(), [&source](const WrenchSourceData& data) {
+            return data.outputFrame == source;
+        });
+        if (sourceIt == m_wrenchSources.end())
+        {
+            BiomechanicalAnalysis::log()->error("[HumanID::setActiveWrenchSources] Wrench source {} not found.", source);
+            return false;
+        }
+        activeWrenchSources |= (std::size_t{1} << std::distance(m_wrenchSources.begin(), sourceIt));
+    }
+    m_activeWrenchSources = activeWrenchSources;
     return true;
 }
 
+std::vector<std::string> HumanID::getActiveWrenchSources() const
+{
+    std::vector<std::string> activeSources;
+    for (std::size_t i = 0; i < m_wrenchSources.size(); i++)
+    {
+        if (isWrenchSourceActive(i))
+        {
+            activeSources.push_back(m_wrenchSources[i].outputFrame);
+        }
+    }
+    return activeSources;
+}
+
+std::size_t HumanID::getNrOfDoublePrecisionFallbacks() const
+{
+    std::size_t fallbacks{0};
+    for (const MAPHelper* helper : {&m_extWrenchesEstimator, &m_jointTorquesHelper})
+    {
+        if (helper->mixedPrecisionSolver != nullptr)
+        {
+            fallbacks += helper->mixedPrecisionSolver->getNrOfDoublePrecisionFallbacks();
+        }
+    }
+    return fallbacks;
+}
+
+std::size_t HumanID::getLastRefinementSteps() const
+{
+    std::size_t refinementSteps{0};
+    for (const MAPHelper* helper : {&m_extWrenchesEstimator, &m_jointTorquesHelper})
+    {
+        if (helper->mixedPrecisionSolver != nullptr)
+        {
+            refinementSteps += helper->mixedPrecisionSolver->getLastRefinementSteps();
+        }
+    }
+    return refinementSteps;
+}
+
+
+void HumanID::updateKinematicState()
+{
+    m_kinDyn->getRobotState(m_kinState.worldBaseTransform,
+                            m_kinState.inputJointsPosition,
+                            m_kinState.baseVelocity,
+                            m_kinState.inputJointsVelocity,
+                            m_kinState.worldGravity);
+    m_kinState.baseAngularVelocity = m_kinState.baseVelocity.getAngularVec3();
+    m_kinState.centerOfMassPosition = m_kinDyn->getCenterOfMassPosition();
+
+    if (!m_useFullModel)
+    {
+        iDynTree::toEigen(m_kinState.jointsPosition) = iDynTree::toEigen(m_kinState.inputJointsPosition);
+        iDynTree::toEigen(m_kinState.jointsVelocity) = iDynTree::toEigen(m_kinState.inputJointsVelocity);
+        return;
+    }
+
+    // if the full model is used, update the kinematic state of the full model, the joints missing in
+    // the kinDyn object are set to zero
+    for (std::size_t i = 0; i < m_fullModelJointsMap.size(); i++)
+    {
+        const int index = m_fullModelJointsMap[i];
+        m_kinState.jointsPosition(i) = index < 0 ? 0.0 : m_kinState.inputJointsPosition(index);
+        m_kinState.jointsVelocity(i) = index < 0 ? 0.0 : m_kinState.inputJointsVelocity(index);
+    }
+    m_kinDynFullModel->setRobotState(m_kinState.worldBaseTransform,
+                                     m_kinState.jointsPosition,
+                                     m_kinState.baseVelocity,
+                                     m_kinState.jointsVelocity,
+                                     m_kinState.worldGravity);
+}
+
 iDynTree::SpatialForceVector HumanID::computeRCMInBaseFrame()
 {
     // Initialize RCM wrench and world gravity vector
@@ -822,8 +1273,8 @@ iDynTree::SpatialForceVector HumanID::computeRCMInBaseFrame()
 
     // Compute transformation from base frame to centroidal frame
     iDynTree::Transform base_H_centroidal;
-    base_H_centroidal.setPosition(m_kinDyn->getCenterOfMassPosition() - m_kinDyn->getWorldBaseTransform().getPosition());
-    base_H_centroidal.setRotation(m_kinDyn->getWorldBaseTransform().getRotation().inverse());
+    base_H_centroidal.setPosition(m_kinState.centerOfMassPosition - m_kinState.worldBaseTransform.getPosition());
+    base_H_centroidal.setRotation(m_kinState.worldBaseTransform.getRotation().inverse());
 
     // Compute RCM wrench in base frame
     rcmWrench = rcmWrench + base_H_centroidal * subjectWeightInCentroidal;
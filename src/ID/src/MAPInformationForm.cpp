@@ -0,0 +1,287 @@
+#include <BiomechanicalAnalysis/ID/MAPInformationForm.h>
+#include <BiomechanicalAnalysis/Logging/Logger.h>
+#include <iDynTree/EigenHelpers.h>
+#include <iDynTree/EigenSparseHelpers.h>
+
+#include <algorithm>
+
+using namespace BiomechanicalAnalysis::ID;
+
+namespace
+{
+
+// compute Sigma^-1 A, scaling the rows of A in place of a sparse product if the prior is diagonal
+template <typename Prior, typename Matrix>
+void weight(const Prior& prior, const Matrix& A, MAPInformationForm::SparseMatrix& weighted)
+{
+    if (!prior.isDiagonal)
+    {
+        weighted = prior.matrix * A;
+        return;
+    }
+    weighted = A;
+    for (int k = 0; k < weighted.outerSize(); k++)
+    {
+        for (MAPInformationForm::SparseMatrix::InnerIterator it(weighted, k); it; ++it)
+        {
+            it.valueRef() *= prior.diagonal(it.row());
+        }
+    }
+}
+
+// compute Sigma^-1 v in a vector of the same size, with a coefficient-wise product if the prior is
+// diagonal
+template <typename Prior, typename Vector> void weight(const Prior& prior, const Vector& v, Eigen::VectorXd& weighted)
+{
+    if (prior.isDiagonal)
+    {
+        weighted = prior.diagonal.cwiseProduct(v);
+        return;
+    }
+    weighted.noalias() = prior.matrix * v;
+}
+
+// check if the outer and inner indices of a compressed matrix are the ones of the pattern
+template <typename Matrix> bool hasPattern(const Matrix& A, const std::vector<int>& pattern)
+{
+    const std::size_t outerSize = static_cast<std::size_t>(A.outerSize()) + 1;
+    const std::size_t nonZeros = static_cast<std::size_t>(A.nonZeros());
+    const int* outer = A.outerIndexPtr();
+    const int* inner = A.innerIndexPtr();
+    return pattern.size() == outerSize + nonZeros && std::equal(outer, outer + outerSize, pattern.begin())
+           && std::equal(inner, inner + nonZeros, pattern.begin() + outerSize);
+}
+
+// store the outer and inner indices of a compressed matrix in the pattern
+template <typename Matrix> void setPattern(const Matrix& A, std::vector<int>& pattern)
+{
+    const int* outer = A.outerIndexPtr();
+    const int* inner = A.innerIndexPtr();
+    pattern.assign(outer, outer + A.outerSize() + 1);
+    pattern.insert(pattern.end(), inner, inner + A.nonZeros());
+}
+
+} // namespace
+
+bool MAPInformationForm::Transpose::update(const Eigen::Ref<const SparseMatrix>& A)
+{
+    const bool patternChanged = !hasPattern(A, pattern);
+    if (patternChanged)
+    {
+        // the transpose of a matrix whose values are their indices maps each value of the transpose
+        // to the one of the matrix
+        setPattern(A, pattern);
+        SparseMatrix indexed = A;
+        for (Eigen::Index i = 0; i < indexed.nonZeros(); i++)
+        {
+            indexed.valuePtr()[i] = static_cast<double>(i);
+        }
+        matrix = indexed.transpose();
+        indices.resize(matrix.nonZeros());
+        for (Eigen::Index i = 0; i < matrix.nonZeros(); i++)
+        {
+            indices[i] = static_cast<int>(matrix.valuePtr()[i]);
+        }
+    }
+    for (std::size_t i = 0; i < indices.size(); i++)
+    {
+        matrix.valuePtr()[i] = A.valuePtr()[indices[i]];
+    }
+    return patternChanged;
+}
+
+void MAPInformationForm::Prior::set(const iDynTree::SparseMatrix<iDynTree::ColumnMajor>& inverseCovariance)
+{
+    matrix = iDynTree::toEigen(inverseCovariance);
+    isDiagonal = matrix.rows() == matrix.cols();
+    for (int k = 0; k < matrix.outerSize() && isDiagonal; k++)
+    {
+        for (SparseMatrix::InnerIterator it(matrix, k); it; ++it)
+        {
+            if (it.row() != it.col() && it.value() != 0.0)
+            {
+                isDiagonal = false;
+                break;
+            }
+        }
+    }
+    diagonal = isDiagonal ? Eigen::VectorXd(matrix.diagonal()) : Eigen::VectorXd();
+}
+
+bool MAPInformationForm::initialize(iDynTree::BerdyHelper& berdyHelper, const iDynTree::BerdySparseMAPSolver& reference)
+{
+    constexpr auto logPrefix = "[MAPInformationForm::initialize]";
+
+    if (!reference.isValid())
+    {
+        BiomechanicalAnalysis::log()->error("{} The reference solver is not valid.", logPrefix);
+        return false;
+    }
+
+    // The priors are stored as information matrices, as done by the reference solver
+    m_dynamicsConstraintsPrior.set(reference.dynamicsConstraintsPriorCovarianceInverse());
+    m_dynamicsRegularizationPrior.set(reference.dynamicsRegularizationPriorCovarianceInverse());
+    m_measurementsPrior.set(reference.measurementsPriorCovarianceInverse());
+    const auto expectedValue = iDynTree::toEigen(reference.dynamicsRegularizationPriorExpectedValue());
+    m_dynamicsRegularizationPriorInformationVector.resize(expectedValue.size());
+    weight(m_dynamicsRegularizationPrior, expectedValue, m_dynamicsRegularizationPriorInformationVector);
+
+    const std::size_t nrOfDynamicVariables = berdyHelper.getNrOfDynamicVariables();
+    m_D.resize(berdyHelper.getNrOfDynamicEquations(), nrOfDynamicVariables);
+    m_bD.resize(berdyHelper.getNrOfDynamicEquations());
+    m_Y.resize(berdyHelper.getNrOfSensorsMeasurements(), nrOfDynamicVariables);
+    m_bY.resize(berdyHelper.getNrOfSensorsMeasurements());
+    m_weightedBD.resize(berdyHelper.getNrOfDynamicEquations());
+    m_weightedMeasurements.resize(berdyHelper.getNrOfSensorsMeasurements());
+    m_informationVector.resize(nrOfDynamicVariables);
+    m_positions.resize(nrOfDynamicVariables);
+    m_DTranspose = Transpose();
+    m_YTranspose = Transpose();
+    m_hasInformationPattern = false;
+    m_pattern.clear();
+    m_patternChanged = true;
+
+    // The pattern of the BERDY matrices depends only on the model, hence the buffers of the diagonal
+    // priors are allocated here and the updates only change their values
+    if (!berdyHelper.getBerdyMatrices(m_D, m_bD, m_Y, m_bY))
+    {
+        BiomechanicalAnalysis::log()->error("{} Error getting the BERDY matrices.", logPrefix);
+        return false;
+    }
+    if (hasDiagonalPriors())
+    {
+        m_DTranspose.update(iDynTree::toEigen(m_D));
+        m_YTranspose.update(iDynTree::toEigen(m_Y));
+        computeInformationPattern();
+        m_pattern.reserve(m_information.outerSize() + 1 + m_information.nonZeros());
+    }
+
+    return true;
+}
+
+void MAPInformationForm::setMeasurementsPrior(const iDynTree::BerdySparseMAPSolver& reference)
+{
+    m_measurementsPrior.set(reference.measurementsPriorCovarianceInverse());
+}
+
+bool MAPInformationForm::update(iDynTree::BerdyHelper& berdyHelper, const iDynTree::VectorDynSize& measurements)
+{
+    constexpr auto logPrefix = "[MAPInformationForm::update]";
+
+    if (!berdyHelper.getBerdyMatrices(m_D, m_bD, m_Y, m_bY))
+    {
+        BiomechanicalAnalysis::log()->error("{} Error getting the BERDY matrices.", logPrefix);
+        return false;
+    }
+    const auto D = iDynTree::toEigen(m_D);
+    const auto Y = iDynTree::toEigen(m_Y);
+
+    if (hasDiagonalPriors())
+    {
+        // The pattern is computed again only if the one of D or Y changed
+        const bool DPatternChanged = m_DTranspose.update(D);
+        const bool YPatternChanged = m_YTranspose.update(Y);
+        if (!m_hasInformationPattern || DPatternChanged || YPatternChanged)
+        {
+            computeInformationPattern();
+        }
+        computeInformationValues(D, Y);
+    } else
+    {
+        // A^T Sigma^-1 A is computed as A^T (Sigma^-1 A), where the product in parentheses is a
+        // row scaling for the diagonal priors
+        weight(m_dynamicsConstraintsPrior, D, m_weightedD);
+        weight(m_measurementsPrior, Y, m_weightedY);
+        m_information = SparseMatrix(D.transpose() * m_weightedD) + SparseMatrix(Y.transpose() * m_weightedY);
+        m_information += m_dynamicsRegularizationPrior.matrix;
+        m_hasInformationPattern = false;
+    }
+
+    // The pattern depends only on the structure of the model, hence it is expected to change only
+    // at the first update
+    m_patternChanged = !hasPattern(m_information, m_pattern);
+    if (m_patternChanged)
+    {
+        setPattern(m_information, m_pattern);
+    }
+
+    weight(m_dynamicsConstraintsPrior, iDynTree::toEigen(m_bD), m_weightedBD);
+    weight(m_measurementsPrior, iDynTree::toEigen(measurements) - iDynTree::toEigen(m_bY), m_weightedMeasurements);
+    m_informationVector = m_dynamicsRegularizationPriorInformationVector;
+    m_informationVector.noalias() -= D.transpose() * m_weightedBD;
+    m_informationVector.noalias() += Y.transpose() * m_weightedMeasurements;
+
+    return true;
+}
+
+void MAPInformationForm::computeInformationPattern()
+{
+    // The products of the patterns, with unit values so that no coefficient cancels out
+    SparseMatrix DPattern = m_DTranspose.matrix;
+    SparseMatrix YPattern = m_YTranspose.matrix;
+    std::fill(DPattern.valuePtr(), DPattern.valuePtr() + DPattern.nonZeros(), 1.0);
+    std::fill(YPattern.valuePtr(), YPattern.valuePtr() + YPattern.nonZeros(), 1.0);
+    SparseMatrix identity(DPattern.rows(), DPattern.rows());
+    identity.setIdentity();
+    m_information = SparseMatrix(DPattern * SparseMatrix(DPattern.transpose()));
+    m_information += SparseMatrix(YPattern * SparseMatrix(YPattern.transpose()));
+    m_information += identity;
+    m_information.makeCompressed();
+    m_hasInformationPattern = true;
+}
+
+void MAPInformationForm::computeInformationValues(const Eigen::Ref<const SparseMatrix>& D, const Eigen::Ref<const SparseMatrix>& Y)
+{
+    // Column j of A^T W A is the sum of the columns k of A^T scaled by W_kk A_kj, whose rows are
+    // all in the pattern of column j of the information matrix
+    const SparseMatrix& DT = m_DTranspose.matrix;
+    const SparseMatrix& YT = m_YTranspose.matrix;
+    double* values = m_information.valuePtr();
+    const int* outer = m_information.outerIndexPtr();
+    const int* inner = m_information.innerIndexPtr();
+    for (int j = 0; j < m_information.outerSize(); j++)
+    {
+        for (int p = outer[j]; p < outer[j + 1]; p++)
+        {
+            m_positions(inner[p]) = p;
+            values[p] = 0.0;
+        }
+        for (Eigen::Ref<const SparseMatrix>::InnerIterator it(D, j); it; ++it)
+        {
+            const double scale = m_dynamicsConstraintsPrior.diagonal(it.row()) * it.value();
+            for (SparseMatrix::InnerIterator itT(DT, it.row()); itT; ++itT)
+            {
+                values[m_positions(itT.row())] += itT.value() * scale;
+            }
+        }
+        for (Eigen::Ref<const SparseMatrix>::InnerIterator it(Y, j); it; ++it)
+        {
+            const double scale = m_measurementsPrior.diagonal(it.row()) * it.value();
+            for (SparseMatrix::InnerIterator itT(YT, it.row()); itT; ++itT)
+            {
+                values[m_positions(itT.row())] += itT.value() * scale;
+            }
+        }
+        values[m_positions(j)] += m_dynamicsRegularizationPrior.diagonal(j);
+    }
+}
+
+bool MAPInformationForm::hasDiagonalPriors() const
+{
+    return m_dynamicsConstraintsPrior.isDiagonal && m_dynamicsRegularizationPrior.isDiagonal && m_measurementsPrior.isDiagonal;
+}
+
+bool MAPInformationForm::hasPatternChanged() const
+{
+    return m_patternChanged;
+}
+
+const MAPInformationForm::SparseMatrix& MAPInformationForm::getInformationMatrix() const
+{
+    return m_information;
+}
+
+const Eigen::VectorXd& MAPInformationForm::getInformationVector() const
+{
+    return m_informationVector;
+}
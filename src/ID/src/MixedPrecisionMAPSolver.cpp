@@ -0,0 +1,194 @@
+#include <BiomechanicalAnalysis/ID/MixedPrecisionMAPSolver.h>
+#include <BiomechanicalAnalysis/Logging/Logger.h>
+#include <iDynTree/EigenHelpers.h>
+
+#include <algorithm>
+#include <limits>
+
+using namespace BiomechanicalAnalysis::ID;
+
+MixedPrecisionMAPSolver::MixedPrecisionMAPSolver(iDynTree::BerdyHelper& berdyHelper)
+    : m_berdyHelper(berdyHelper)
+{
+}
+
+bool MixedPrecisionMAPSolver::initialize(const iDynTree::BerdySparseMAPSolver& reference,
+                                         const std::size_t refinementSteps,
+                                         const double tolerance)
+{
+    constexpr auto logPrefix = "[MixedPrecisionMAPSolver::initialize]";
+
+    if (refinementSteps == 0 || tolerance <= 0.0)
+    {
+        BiomechanicalAnalysis::log()->error("{} The number of refinement steps and the tolerance must be positive.", logPrefix);
+        return false;
+    }
+    m_refinementSteps = refinementSteps;
+    m_tolerance = tolerance;
+
+    if (!m_informationForm.initialize(m_berdyHelper, reference))
+    {
+        BiomechanicalAnalysis::log()->error("{} Error initializing the information form.", logPrefix);
+        return false;
+    }
+
+    m_measurements.resize(m_berdyHelper.getNrOfSensorsMeasurements());
+    m_measurements.zero();
+    // The buffers of the estimation are allocated here, so that doEstimate does not allocate
+    // memory unless the pattern of the information matrix changes
+    const Eigen::Index nrOfDynamicVariables = m_berdyHelper.getNrOfDynamicVariables();
+    m_estimate = Eigen::VectorXd::Zero(nrOfDynamicVariables);
+    m_scaling.resize(nrOfDynamicVariables);
+    m_scaledVector.resize(nrOfDynamicVariables);
+    m_scaledSolution.resize(nrOfDynamicVariables);
+    m_residual.resize(nrOfDynamicVariables);
+    m_correction.resize(nrOfDynamicVariables);
+    m_scaledInformation.resize(0, 0);
+    m_analyzed = false;
+    m_fallbackAnalyzed = false;
+    m_nrOfFallbacks = 0;
+
+    return true;
+}
+
+bool MixedPrecisionMAPSolver::updateMeasurementsPrior(const iDynTree::BerdySparseMAPSolver& reference)
+{
+    m_informationForm.setMeasurementsPrior(reference);
+    return true;
+}
+
+void MixedPrecisionMAPSolver::updateEstimateInformationFloatingBase(const iDynTree::JointPosDoubleArray& jointsConfiguration,
+                                                                    const iDynTree::JointDOFsDoubleArray& jointsVelocity,
+                                                                    const iDynTree::FrameIndex floatingFrame,
+                                                                    const iDynTree::Vector3& bodyAngularVelocityOfSpecifiedFrame,
+                                                                    const iDynTree::VectorDynSize& measurements)
+{
+    m_berdyHelper.updateKinematicsFromFloatingBase(jointsConfiguration, jointsVelocity, floatingFrame, bodyAngularVelocityOfSpecifiedFrame);
+    m_measurements = measurements;
+}
+
+bool MixedPrecisionMAPSolver::factorize()
+{
+    // The scaled matrix has the same pattern of the information matrix, hence the symbolic
+    // analysis is done again only if the pattern of the information matrix changed
+    if (!m_analyzed || m_informationForm.hasPatternChanged())
+    {
+        m_factorization.analyzePattern(m_scaledInformation);
+        m_analyzed = true;
+    }
+    m_factorization.factorize(m_scaledInformation);
+    return m_factorization.info() == Eigen::Success;
+}
+
+void MixedPrecisionMAPSolver::updateScaledInformation(const SparseMatrix& information)
+{
+    if (m_informationForm.hasPatternChanged() || m_scaledInformation.nonZeros() != information.nonZeros())
+    {
+        m_scaledInformation = information.cast<float>();
+    }
+
+    // The two matrices have the same pattern, hence their entries are visited in the same order
+    for (Eigen::Index k = 0; k < information.outerSize(); k++)
+    {
+        SparseMatrixFloat::InnerIterator scaled(m_scaledInformation, k);
+        for (SparseMatrix::InnerIterator it(information, k); it; ++it, ++scaled)
+        {
+            scaled.valueRef() = static_cast<float>(m_scaling(it.row()) * it.value() * m_scaling(it.col()));
+        }
+    }
+}
+
+bool MixedPrecisionMAPSolver::doEstimate()
+{
+    constexpr auto logPrefix = "[MixedPrecisionMAPSolver::doEstimate]";
+
+    if (!m_informationForm.update(m_berdyHelper, m_measurements))
+    {
+        BiomechanicalAnalysis::log()->error("{} Error computing the information form.", logPrefix);
+        return false;
+    }
+    const SparseMatrix& information = m_informationForm.getInformationMatrix();
+    const Eigen::VectorXd& informationVector = m_informationForm.getInformationVector();
+    if (m_informationForm.hasPatternChanged())
+    {
+        m_fallbackAnalyzed = false;
+    }
+
+    // Symmetric scaling, so that the scaled matrix has a unit diagonal
+    m_scaling = information.diagonal();
+    if (m_scaling.minCoeff() <= 0.0)
+    {
+        BiomechanicalAnalysis::log()->error("{} The information matrix is not positive definite.", logPrefix);
+        return false;
+    }
+    m_scaling = m_scaling.cwiseSqrt().cwiseInverse();
+    updateScaledInformation(information);
+
+    // Each refinement step solves for the error of the estimate with the residual computed in
+    // double precision, the refinement is stopped when the correction is negligible
+    bool converged = false;
+    m_lastRefinementSteps = 0;
+    if (factorize())
+    {
+        m_scaledVector.noalias() = m_scaling.cwiseProduct(informationVector).cast<float>();
+        m_scaledSolution.noalias() = m_factorization.solve(m_scaledVector);
+        m_estimate.noalias() = m_scaling.cwiseProduct(m_scaledSolution.cast<double>());
+        while (m_lastRefinementSteps < m_refinementSteps)
+        {
+            m_residual = informationVector;
+            m_residual.noalias() -= information * m_estimate;
+            m_scaledVector.noalias() = m_scaling.cwiseProduct(m_residual).cast<float>();
+            m_scaledSolution.noalias() = m_factorization.solve(m_scaledVector);
+            m_correction.noalias() = m_scaling.cwiseProduct(m_scaledSolution.cast<double>());
+            m_estimate += m_correction;
+            m_lastRefinementSteps++;
+            if (!m_estimate.allFinite())
+            {
+                break;
+            }
+            if (m_correction.lpNorm<Eigen::Infinity>()
+                <= m_tolerance * std::max(m_estimate.lpNorm<Eigen::Infinity>(), std::numeric_limits<double>::min()))
+            {
+                converged = true;
+                break;
+            }
+        }
+    }
+
+    if (!converged)
+    {
+        // The problem is too ill-conditioned for the single precision factorization, the double
+        // precision one reuses its symbolic analysis until the pattern changes
+        m_nrOfFallbacks++;
+        if (!m_fallbackAnalyzed)
+        {
+            m_fallbackFactorization.analyzePattern(information);
+            m_fallbackAnalyzed = true;
+        }
+        m_fallbackFactorization.factorize(information);
+        if (m_fallbackFactorization.info() != Eigen::Success)
+        {
+            BiomechanicalAnalysis::log()->error("{} Error factorizing the information matrix.", logPrefix);
+            return false;
+        }
+        m_estimate.noalias() = m_fallbackFactorization.solve(informationVector);
+    }
+
+    return true;
+}
+
+void MixedPrecisionMAPSolver::getLastEstimate(iDynTree::VectorDynSize& lastEstimate) const
+{
+    lastEstimate.resize(m_estimate.size());
+    iDynTree::toEigen(lastEstimate) = m_estimate;
+}
+
+std::size_t MixedPrecisionMAPSolver::getLastRefinementSteps() const
+{
+    return m_lastRefinementSteps;
+}
+
+std::size_t MixedPrecisionMAPSolver::getNrOfDoublePrecisionFallbacks() const
+{
+    return m_nrOfFallbacks;
+}
@@ -1,6 +1,7 @@
 #include <catch2/catch_test_macros.hpp>
 
 #include <BiomechanicalAnalysis/ID/InverseDynamics.h>
+#include <iDynTree/EigenHelpers.h>
 #include <iDynTree/ModelLoader.h>
 #include <iDynTree/ModelTestUtils.h>
 #include <yarp/os/ResourceFinder.h>
@@ -10,6 +11,10 @@
 #include <BipedalLocomotion/ParametersHandler/TomlImplementation.h>
 #include <ConfigFolderPath.h>
 
+#include <algorithm>
+#include <cmath>
+#include <functional>
+
 TEST_CASE("Inverse Dynamics test")
 {
     auto kinDyn = std::make_shared<iDynTree::KinDynComputations>();
@@ -37,8 +42,342 @@ TEST_CASE("Inverse Dynamics test")
     std::unordered_map<std::string, iDynTree::Wrench> wrenches;
     wrenches["link0"] = iDynTree::Wrench();
     wrenches["link1"] = iDynTree::Wrench();
+    BiomechanicalAnalysis::ID::HumanID id;
+    REQUIRE(id.initialize(paramHandler, kinDyn));
+    // the kinematic state of each frame is read by updateExtWrenchesMeasurements
+    REQUIRE_FALSE(id.solve());
+    REQUIRE(id.updateExtWrenchesMeasurements(wrenches));
+    REQUIRE(id.solve());
+    REQUIRE_FALSE(id.solve());
+}
+
+namespace
+{
+
+// estimate the external wrenches of the feet with the given active wrench sources, where all the
+// sources have a specific covariance in the configuration, hence their activation changes the
+// measurements prior
+bool estimateFeetWrenches(const iDynTree::Model& model,
+                          bool precomputeContactCombinations,
+                          const std::vector<std::string>& activeSources,
+                          std::vector<iDynTree::Wrench>& extWrenches)
+{
+    auto kinDyn = std::make_shared<iDynTree::KinDynComputations>();
+    kinDyn->loadRobotModel(model);
+
+    auto paramHandler = std::make_shared<BipedalLocomotion::ParametersHandler::TomlImplementation>();
+    if (!paramHandler->setFromFile(getConfigPath() + "/configTestID.toml"))
+    {
+        return false;
+    }
+    paramHandler->getGroup("EXTERNAL_WRENCHES").lock()->setParameter("precomputeContactCombinations", precomputeContactCombinations);
+
+    std::unordered_map<std::string, iDynTree::Wrench> wrenches;
+    wrenches["link0"] = iDynTree::Wrench();
+    wrenches["link0"](2) = 400.0;
+    wrenches["link1"] = iDynTree::Wrench();
+    wrenches["link1"](2) = 300.0;
+
+    BiomechanicalAnalysis::ID::HumanID id;
+    if (!id.initialize(paramHandler, kinDyn))
+    {
+        return false;
+    }
+
+    // a first frame with all the sources active, so that the prior is switched afterwards
+    if (!id.updateExtWrenchesMeasurements(wrenches) || !id.solve())
+    {
+        return false;
+    }
+    if (!id.setActiveWrenchSources(activeSources) || !id.updateExtWrenchesMeasurements(wrenches) || !id.solve())
+    {
+        return false;
+    }
+    extWrenches = id.getEstimatedExtWrenches();
+    return true;
+}
+
+} // namespace
+
+TEST_CASE("Inverse Dynamics active wrench sources test")
+{
+    auto kinDyn = std::make_shared<iDynTree::KinDynComputations>();
+
+    auto paramHandler = std::make_shared<BipedalLocomotion::ParametersHandler::TomlImplementation>();
+    REQUIRE(paramHandler->setFromFile(getConfigPath() + "/configTestID.toml"));
+
+    const iDynTree::Model model = iDynTree::getRandomModel(20);
+    kinDyn->loadRobotModel(model);
+    std::unordered_map<std::string, iDynTree::Wrench> wrenches;
+    wrenches["link0"] = iDynTree::Wrench();
+    wrenches["link1"] = iDynTree::Wrench();
+    BiomechanicalAnalysis::ID::HumanID id;
+    REQUIRE(id.initialize(paramHandler, kinDyn));
+    REQUIRE(id.getActiveWrenchSources().size() == 4);
+
+    // only one foot in contact, the other foot measurement is not required
+    REQUIRE(id.setActiveWrenchSources({"link0"}));
+    REQUIRE(id.getActiveWrenchSources() == std::vector<std::string>{"link0"});
+    wrenches.erase("link1");
+    REQUIRE(id.updateExtWrenchesMeasurements(wrenches));
+    REQUIRE(id.solve());
+
+    // back to the full set of wrench sources, which reuses the cached prior
+    REQUIRE(id.setActiveWrenchSources({"link0", "link1", "link2", "link3"}));
+    wrenches["link1"] = iDynTree::Wrench();
+    REQUIRE(id.updateExtWrenchesMeasurements(wrenches));
+    REQUIRE(id.solve());
+
+    REQUIRE_FALSE(id.setActiveWrenchSources({"notAWrenchSource"}));
+
+    // the wrench of an inactive source is estimated as zero, even if it is measured
+    std::vector<iDynTree::Wrench> allActiveWrenches;
+    std::vector<iDynTree::Wrench> oneFootWrenches;
+    REQUIRE(estimateFeetWrenches(model, false, {"link0", "link1", "link2", "link3"}, allActiveWrenches));
+    REQUIRE(estimateFeetWrenches(model, false, {"link0", "link2", "link3"}, oneFootWrenches));
+    REQUIRE(allActiveWrenches[1](2) > 100.0);
+    REQUIRE(iDynTree::toEigen(oneFootWrenches[1].getLinearVec3()).norm() < 1.0);
+
+    // the precomputed priors give the same estimates of the priors computed on demand
+    for (const auto& activeSources : {std::vector<std::string>{"link0", "link2", "link3"}, std::vector<std::string>{"link1"}})
+    {
+        std::vector<iDynTree::Wrench> onDemandWrenches;
+        std::vector<iDynTree::Wrench> precomputedWrenches;
+        REQUIRE(estimateFeetWrenches(model, false, activeSources, onDemandWrenches));
+        REQUIRE(estimateFeetWrenches(model, true, activeSources, precomputedWrenches));
+        REQUIRE(onDemandWrenches.size() == precomputedWrenches.size());
+        for (std::size_t i = 0; i < onDemandWrenches.size(); i++)
+        {
+            for (int j = 0; j < 6; j++)
+            {
+                REQUIRE(std::abs(onDemandWrenches[i](j) - precomputedWrenches[i](j)) <= 1e-9 * std::max(1.0, std::abs(onDemandWrenches[i](j))));
+            }
+        }
+    }
+}
+
+TEST_CASE("Inverse Dynamics precomputed contact combinations limit test")
+{
+    auto kinDyn = std::make_shared<iDynTree::KinDynComputations>();
+    kinDyn->loadRobotModel(iDynTree::getRandomModel(20));
+
+    // the four sources of the configuration plus five dummy sources, all with a specific covariance
+    auto paramHandler = std::make_shared<BipedalLocomotion::ParametersHandler::TomlImplementation>();
+    REQUIRE(paramHandler->setFromFile(getConfigPath() + "/configTestID.toml"));
+    auto extWrenchesHandler = paramHandler->getGroup("EXTERNAL_WRENCHES").lock();
+    std::vector<std::string> wrenchSources;
+    std::vector<std::string> specificElements;
+    REQUIRE(extWrenchesHandler->getParameter("wrenchSources", wrenchSources));
+    REQUIRE(extWrenchesHandler->getParameter("specificElements", specificElements));
+    for (int i = 4; i < 9; i++)
+    {
+        const std::string link = "link" + std::to_string(i);
+        auto sourceHandler = std::make_shared<BipedalLocomotion::ParametersHandler::TomlImplementation>();
+        sourceHandler->setParameter("outputFrame", link);
+        sourceHandler->setParameter("type", std::string("dummy"));
+        sourceHandler->setParameter("values", std::vector<double>(6, 0.0));
+        REQUIRE(extWrenchesHandler->setGroup("dummy" + std::to_string(i), sourceHandler));
+        wrenchSources.push_back("dummy" + std::to_string(i));
+        specificElements.push_back(link);
+        extWrenchesHandler->setParameter(link, std::vector<double>{1e06, 1e06, 1e06, 1e-06, 1e-06, 1e-06});
+    }
+    extWrenchesHandler->setParameter("wrenchSources", wrenchSources);
+    extWrenchesHandler->setParameter("specificElements", specificElements);
+
+    // the combinations of nine sources are computed on demand, but not precomputed
+    BiomechanicalAnalysis::ID::HumanID id;
+    REQUIRE(id.initialize(paramHandler, kinDyn));
+    extWrenchesHandler->setParameter("precomputeContactCombinations", true);
+    BiomechanicalAnalysis::ID::HumanID precomputedId;
+    REQUIRE_FALSE(precomputedId.initialize(paramHandler, kinDyn));
+}
+
+TEST_CASE("Inverse Dynamics in-memory model test")
+{
+    auto kinDyn = std::make_shared<iDynTree::KinDynComputations>();
+
+    auto paramHandler = std::make_shared<BipedalLocomotion::ParametersHandler::TomlImplementation>();
+    REQUIRE(paramHandler->setFromFile(getConfigPath() + "/configTestID.toml"));
+
+    // the model passed to initialize is used in place of the urdfModel parameter
+    const iDynTree::Model model = iDynTree::getRandomModel(20);
+    kinDyn->loadRobotModel(model);
+    std::unordered_map<std::string, iDynTree::Wrench> wrenches;
+    wrenches["link0"] = iDynTree::Wrench();
+    wrenches["link1"] = iDynTree::Wrench();
+    BiomechanicalAnalysis::ID::HumanID id;
+    REQUIRE(id.initialize(paramHandler, kinDyn, model));
+    REQUIRE(id.getJointsList().size() == model.getNrOfJoints());
+    REQUIRE(id.getModel().getNrOfDOFs() == id.getNrOfDOFs());
+    REQUIRE(id.updateExtWrenchesMeasurements(wrenches));
+    REQUIRE(id.solve());
+}
+
+TEST_CASE("Inverse Dynamics model simplification test")
+{
+    // only revolute joints, so that the i-th joint of the simplified model is its i-th DOF
+    const iDynTree::Model model = iDynTree::getRandomModel(20, 10, true);
+    auto kinDyn = std::make_shared<iDynTree::KinDynComputations>();
+    kinDyn->loadRobotModel(model);
+
+    // the weight of the model is carried by link0, so that the external wrenches of the full and of
+    // the simplified model are the same
+    double mass = 0.0;
+    for (std::size_t i = 0; i < model.getNrOfLinks(); i++)
+    {
+        mass += model.getLink(i)->getInertia().getMass();
+    }
+    auto makeHandler = [mass]() {
+        auto handler = std::make_shared<BipedalLocomotion::ParametersHandler::TomlImplementation>();
+        handler->setFromFile(getConfigPath() + "/configTestID.toml");
+        handler->setParameter("humanMass", mass);
+        auto extWrenchesHandler = handler->getGroup("EXTERNAL_WRENCHES").lock();
+        extWrenchesHandler->setParameter("specificElements", std::vector<std::string>{"link0"});
+        extWrenchesHandler->setParameter("link0", std::vector<double>{1e3, 1e3, 1e3, 1e3, 1e3, 1e3});
+        return handler;
+    };
+    std::unordered_map<std::string, iDynTree::Wrench> wrenches;
+    wrenches["link0"] = iDynTree::Wrench();
+    wrenches["link1"] = iDynTree::Wrench();
+
+    BiomechanicalAnalysis::ID::HumanID fullId;
+    REQUIRE(fullId.initialize(makeHandler(), kinDyn));
+    REQUIRE(fullId.updateExtWrenchesMeasurements(wrenches));
+    REQUIRE(fullId.solve());
+    const Eigen::VectorXd fullTorques = iDynTree::toEigen(fullId.getJointTorques());
+
+    // lump every link except the ones needed by the wrench sources
+    auto paramHandler = makeHandler();
+    auto simplificationHandler = std::make_shared<BipedalLocomotion::ParametersHandler::StdImplementation>();
+    simplificationHandler->setParameter("massThreshold", 1e6);
+    simplificationHandler->setParameter("inertiaThreshold", 1e6);
+    REQUIRE(paramHandler->setGroup("MODEL_SIMPLIFICATION", simplificationHandler));
+
     BiomechanicalAnalysis::ID::HumanID id;
     REQUIRE(id.initialize(paramHandler, kinDyn));
     REQUIRE(id.updateExtWrenchesMeasurements(wrenches));
     REQUIRE(id.solve());
+
+    // link0-link3 are added to the random model right after its base, hence they are connected to the
+    // base by at most four joints and the other links are lumped
+    const std::vector<std::string> joints = id.getJointsList();
+    REQUIRE(joints.size() < model.getNrOfJoints());
+    REQUIRE(joints.size() <= 4);
+
+    // the lumped links are at rest, hence the kept joints have the torques of the full model
+    const Eigen::VectorXd torques = iDynTree::toEigen(id.getJointTorques());
+    REQUIRE(static_cast<std::size_t>(torques.size()) == joints.size());
+    const double tolerance = 1e-2 * std::max(1.0, fullTorques.lpNorm<Eigen::Infinity>());
+    for (std::size_t i = 0; i < joints.size(); i++)
+    {
+        const iDynTree::JointIndex jointIndex = model.getJointIndex(joints[i]);
+        REQUIRE(jointIndex != iDynTree::JOINT_INVALID_INDEX);
+        REQUIRE(std::abs(torques(i) - fullTorques(model.getJoint(jointIndex)->getDOFsOffset())) <= tolerance);
+    }
+}
+
+namespace
+{
+
+// solve a frame with a non trivial state, using the specialized solver enabled by the given
+// parameter if not empty; the solver is passed to check, if not null, after the frame is solved
+bool solveFrame(const iDynTree::Model& model,
+                const std::string& solverParameter,
+                Eigen::VectorXd& torques,
+                std::vector<iDynTree::Wrench>& extWrenches,
+                const std::function<void(const BiomechanicalAnalysis::ID::HumanID&)>& check = nullptr)
+{
+    auto kinDyn = std::make_shared<iDynTree::KinDynComputations>();
+    kinDyn->loadRobotModel(model);
+
+    iDynTree::VectorDynSize jointsPosition(kinDyn->getNrOfDegreesOfFreedom());
+    iDynTree::VectorDynSize jointsVelocity(kinDyn->getNrOfDegreesOfFreedom());
+    for (std::size_t i = 0; i < jointsPosition.size(); i++)
+    {
+        jointsPosition(i) = 0.1 * static_cast<double>(i % 7) - 0.3;
+        jointsVelocity(i) = 0.05 * static_cast<double>(i % 5) - 0.1;
+    }
+    iDynTree::Twist baseVelocity;
+    baseVelocity.zero();
+    baseVelocity(5) = 0.2;
+    iDynTree::Vector3 gravity;
+    gravity.zero();
+    gravity(2) = -9.81;
+    if (!kinDyn->setRobotState(iDynTree::Transform::Identity(), jointsPosition, baseVelocity, jointsVelocity, gravity))
+    {
+        return false;
+    }
+
+    std::unordered_map<std::string, iDynTree::Wrench> wrenches;
+    wrenches["link0"] = iDynTree::Wrench();
+    wrenches["link0"](2) = 400.0;
+    wrenches["link1"] = iDynTree::Wrench();
+    wrenches["link1"](2) = 300.0;
+    wrenches["link1"](3) = 5.0;
+
+    auto paramHandler = std::make_shared<BipedalLocomotion::ParametersHandler::TomlImplementation>();
+    if (!paramHandler->setFromFile(getConfigPath() + "/configTestID.toml"))
+    {
+        return false;
+    }
+    if (!solverParameter.empty())
+    {
+        paramHandler->setParameter(solverParameter, true);
+    }
+    BiomechanicalAnalysis::ID::HumanID id;
+    if (!id.initialize(paramHandler, kinDyn) || !id.updateExtWrenchesMeasurements(wrenches) || !id.solve())
+    {
+        return false;
+    }
+    torques = iDynTree::toEigen(id.getJointTorques());
+    extWrenches = id.getEstimatedExtWrenches();
+    if (check)
+    {
+        check(id);
+    }
+    return true;
+}
+
+// check that the estimates of two solvers differ at most by the given relative tolerance, the
+// specialized solver is passed to check, if not null
+void requireSameEstimates(const std::string& solverParameter,
+                          double tolerance,
+                          const std::function<void(const BiomechanicalAnalysis::ID::HumanID&)>& check = nullptr)
+{
+    Eigen::VectorXd torques;
+    Eigen::VectorXd specializedTorques;
+    std::vector<iDynTree::Wrench> extWrenches;
+    std::vector<iDynTree::Wrench> specializedExtWrenches;
+    const iDynTree::Model model = iDynTree::getRandomModel(20);
+    REQUIRE(solveFrame(model, "", torques, extWrenches));
+    REQUIRE(solveFrame(model, solverParameter, specializedTorques, specializedExtWrenches, check));
+
+    REQUIRE(torques.size() == specializedTorques.size());
+    REQUIRE((torques - specializedTorques).lpNorm<Eigen::Infinity>() <= tolerance * std::max(1.0, torques.lpNorm<Eigen::Infinity>()));
+    REQUIRE(extWrenches.size() == specializedExtWrenches.size());
+    for (std::size_t i = 0; i < extWrenches.size(); i++)
+    {
+        for (int j = 0; j < 6; j++)
+        {
+            REQUIRE(std::abs(extWrenches[i](j) - specializedExtWrenches[i](j)) <= tolerance * std::max(1.0, std::abs(extWrenches[i](j))));
+        }
+    }
+}
+
+} // namespace
+
+TEST_CASE("Inverse Dynamics mixed precision test")
+{
+    // the refinement recovers the accuracy of the double precision solver, and the estimates come
+    // from the single precision factorization, without falling back to double precision
+    requireSameEstimates("mixedPrecision", 1e-6, [](const BiomechanicalAnalysis::ID::HumanID& id) {
+        REQUIRE(id.getLastRefinementSteps() > 0);
+        REQUIRE(id.getNrOfDoublePrecisionFallbacks() == 0);
+    });
+}
+
+TEST_CASE("Inverse Dynamics diagonal priors test")
+{
+    // the specialized solver computes the same estimate, up to the rounding errors
+    requireSameEstimates("diagonalPriors", 1e-8);
 }
@@ -13,6 +13,7 @@
 #include <BipedalLocomotion/ContinuousDynamicalSystem/FloatingBaseSystemKinematics.h>
 #include <BipedalLocomotion/ContinuousDynamicalSystem/ForwardEuler.h>
 #include <BipedalLocomotion/IK/GravityTask.h>
+#include <BipedalLocomotion/IK/IKLinearTask.h>
 #include <BipedalLocomotion/IK/JointLimitsTask.h>
 #include <BipedalLocomotion/IK/JointTrackingTask.h>
 #include <BipedalLocomotion/IK/JointVelocityLimitsTask.h>
@@ -29,6 +30,47 @@ namespace BiomechanicalAnalysis
 namespace IK
 {
 
+/**
+ * @brief Inequality task forwarding the matrices of another inequality task, whose bounds can be
+ * relaxed so that the constraint becomes inactive without removing it from the QP
+ */
+class SwitchableInequalityTask : public BipedalLocomotion::IK::IKLinearTask
+{
+public:
+    /**
+     * Constructor
+     * @param task inequality task whose matrices are forwarded
+     */
+    explicit SwitchableInequalityTask(std::shared_ptr<BipedalLocomotion::IK::IKLinearTask> task);
+
+    /**
+     * enable or disable the constraint
+     * @param enabled true to forward the bounds of the task, false to replace them with bounds that
+     * are never active
+     */
+    void setEnabled(const bool enabled);
+
+    /**
+     * check if the constraint is enabled
+     * @return true if the bounds of the task are forwarded
+     */
+    bool isEnabled() const;
+
+    bool setVariablesHandler(const BipedalLocomotion::System::VariablesHandler& variablesHandler) override;
+
+    bool update() override;
+
+    std::size_t size() const override;
+
+    Type type() const override;
+
+    bool isValid() const override;
+
+private:
+    std::shared_ptr<BipedalLocomotion::IK::IKLinearTask> m_task; /** forwarded task */
+    bool m_enabled{true}; /** true if the bounds of the task are forwarded */
+};
+
 /**
  * @brief Struct containing the orientation and the angular velocity of an IMU
  */
@@ -100,6 +142,44 @@ private:
     bool initializeJointVelocityLimitsTask(const std::string& taskName,
                                            const std::shared_ptr<BipedalLocomotion::ParametersHandler::IParametersHandler> taskHandler);
 
+    /**
+     * add a task to the list of the tasks with a residual
+     * @param taskName name of the task
+     * @param frameName name of the frame of the task
+     * @param frameIndex index of the frame of the task
+     * @param residualIndex index of the residual of the task
+     * @return true if the frame exists in the model
+     */
+    bool addTaskResidual(const std::string& taskName, const std::string& frameName, iDynTree::FrameIndex& frameIndex, std::size_t& residualIndex);
+
+    /**
+     * compute the residuals of the SO3, gravity and floor contact tasks, using the forward
+     * kinematics already computed by the QP for the update of the tasks
+     */
+    void updateTaskResiduals();
+
+    /**
+     * set the weight of a task in the QP solver, the weight of the joint regularization task is
+     * stored and applied only while the task is enabled
+     * @param taskName name of the task
+     * @param weight weight of the task
+     * @return true if the weight is set
+     */
+    bool setTaskWeight(const std::string& taskName, Eigen::Ref<const Eigen::VectorXd> weight);
+
+    /**
+     * check that the velocities computed by the QP are finite and plausible
+     * @return true if the velocities are plausible
+     */
+    bool areVelocitiesPlausible() const;
+
+    /**
+     * set the state of the integrator and of the KinDynComputations object, with zero velocities
+     * @param jointPositions joint positions
+     * @param basePose base pose
+     */
+    void resetState(Eigen::Ref<const Eigen::VectorXd> jointPositions, const Eigen::Matrix4d& basePose);
+
     std::chrono::nanoseconds m_dtIntegration; /** Integration time step in nanoseconds */
 
     /**
@@ -127,6 +207,24 @@ private:
 
     Eigen::VectorXd m_calibrationJointPositions; /** Joint positions for calibration */
 
+    double m_maxJointVelocity{100.0}; /** Largest plausible joint velocity, in rad/s */
+    double m_maxBaseLinearVelocity{20.0}; /** Largest plausible base linear velocity, in m/s */
+    double m_maxBaseAngularVelocity{50.0}; /** Largest plausible base angular velocity, in rad/s */
+    std::size_t m_nrOfDivergences{0}; /** Number of frames in which the solver diverged */
+
+    /**
+     * Struct containing the link orientations estimated by the IMUs of a SO3 task with more than
+     * one node, fused in the set point of the task
+     */
+    struct OrientationFusion
+    {
+        std::vector<double> weights; // Weight of each node in the mean
+        std::vector<manif::SO3d> I_R_link; // Link orientation estimated by each node
+        std::vector<Eigen::Vector3d> I_omega_link; // Link angular velocity estimated by each node
+        std::vector<bool> valid; // True if the node has been updated since the last call to advance()
+        manif::SO3d setPoint = manif::SO3d::Identity(); // Fused orientation
+    };
+
     /**
      * Struct containing the SO3 task from the BipedalLocomotion IK, the node number and the
      * rotation matrix between the IMU and the link
@@ -145,6 +243,13 @@ private:
                                                                  // script
         Eigen::Vector3d weight; // Weight of the task
         std::string frameName; // Name of the frame in which the task is expressed
+        iDynTree::FrameIndex frameIndex{iDynTree::FRAME_INVALID_INDEX}; // Index of the frame
+        manif::SO3d setPoint = manif::SO3d::Identity(); // Orientation set point of the link
+        std::size_t residualIndex{0}; // Index of the residual of the task
+        std::shared_ptr<OrientationFusion> fusion; // Fusion shared by the nodes of the task, nullptr
+                                                   // if the task has a single node
+        std::size_t fusionSlot{0}; // Index of the node in the fusion
+        bool primaryNode{true}; // False for the additional nodes of a task
     };
 
     /**
@@ -162,6 +267,10 @@ private:
         int nodeNumber;
         std::string taskName;
         std::string frameName;
+        iDynTree::FrameIndex frameIndex{iDynTree::FRAME_INVALID_INDEX};
+        Eigen::Vector3d setPoint{Eigen::Vector3d::UnitZ()}; // direction of the world z axis in the
+                                                            // link frame
+        std::size_t residualIndex{0};
     };
 
     /**
@@ -178,20 +287,47 @@ private:
         std::string taskName;
         std::string frameName;
         double verticalForceThreshold;
+        iDynTree::FrameIndex frameIndex{iDynTree::FRAME_INVALID_INDEX};
+        std::size_t residualIndex{0};
     };
 
     std::shared_ptr<BipedalLocomotion::IK::JointTrackingTask> m_jointRegularizationTask; /** Joint
                                                                                            regularization
                                                                                            task */
 
+    bool m_jointRegularizationEnabled{true}; /** true if the joint regularization task is enabled */
+
+    std::string m_jointRegularizationTaskName; /** name of the joint regularization task in the QP */
+
+    Eigen::VectorXd m_jointRegularizationWeight; /** weight of the joint regularization task, set to
+                                                    zero in the QP while the task is disabled */
+
     std::shared_ptr<BipedalLocomotion::IK::JointLimitsTask> m_jointConstraintsTask; /** Joint limits
                                                                                        task */
 
     std::shared_ptr<BipedalLocomotion::IK::JointVelocityLimitsTask> m_jointVelocityLimitsTask; /** Joint velocity limits task */
 
+    std::shared_ptr<SwitchableInequalityTask> m_jointVelocityLimitsSwitch; /** joint velocity limits
+                                                                              task added to the QP,
+                                                                              it can be disabled */
+
     manif::SO3d calib_W_R_link = manif::SO3d::Identity(); /** calibration matrix between the world
                                                            and the link */
 
+    /**
+     * compute the weighted mean on SO3 of the link orientations of the updated nodes of a fusion
+     * @param fusion fusion whose set point is computed
+     * @param initialGuess initial guess of the mean, e.g. the last updated orientation
+     */
+    static void fuseOrientations(OrientationFusion& fusion, const manif::SO3d& initialGuess);
+
+    /**
+     * check if a node is an additional node of a SO3 task, which cannot be used by other tasks
+     * @param node node number
+     * @return true if the node is an additional node of a SO3 task
+     */
+    bool isAdditionalNode(const int node) const;
+
     std::unordered_map<int, OrientationTaskStruct> m_OrientationTasks; /** unordered map of type
                                                                         OrientationTaskStruct, each
                                                                         element referring to a
@@ -209,6 +345,9 @@ private:
     int m_nrDoFs; /** Number of Joint Degrees of Freedom */
     bool m_tPose{false}; /** Flag for resetting the integrator state */
 
+    std::vector<std::string> m_taskResidualNames; /** names of the tasks with a residual */
+    Eigen::VectorXd m_taskResiduals; /** residuals of the tasks, in the order of m_taskResidualNames */
+
     BipedalLocomotion::IK::QPInverseKinematics m_qpIK; /** QP Inverse Kinematics solver */
     BipedalLocomotion::System::VariablesHandler m_variableHandler; /** Variables handler */
 
@@ -235,6 +374,9 @@ public:
      * |           |           `tasks`              | `vector<string>`|         Vector containing the list of the tasks considered in the IK.                          |    Yes    |
      * |   `IK`    | `robot_velocity_variable_name` |     `string`    | Name of the variable contained in `VariablesHandler` describing the generalized robot velocity |    Yes    |
      * |   `IK`    |           `verbosity`          |      `bool`     |                         Verbosity of the solver. Default value `false`                         |     No    |
+     * |           |      `max_joint_velocity`      |     `double`    |      Largest plausible joint velocity in rad/s, used to detect divergence. Default 100.0      |     No    |
+     * |           |   `max_base_linear_velocity`   |     `double`    |    Largest plausible base linear velocity in m/s, used to detect divergence. Default 20.0    |     No    |
+     * |           |  `max_base_angular_velocity`   |     `double`    |   Largest plausible base angular velocity in rad/s, used to detect divergence. Default 50.0  |     No    |
      * Where the generalized robot velocity is a vector containing the base spatialvelocity
      * (expressed in mixed representation) and the joint velocities.
      * For **each** task listed in the parameter `tasks` the user must specify all the parameters
@@ -251,7 +393,13 @@ public:
      * | `SO3Task` |         `frame_name`           |     `string`    |                          Name of the frame in which the task is expressed.              |  Yes |
      * | `SO3Task` |         `kp_angular`           |     `double`    |                        Value of the gain of the angular velocity feedback.              |  Yes |
      * | `SO3Task` |           `weight`             | `vector<double>`|                        Weight of the task. Default value is (1.0, 1.0, 1.0)             |  yes |
+     * | `SO3Task` |   `additional_node_numbers`    |  `vector<int>`  | Node numbers of other IMUs on the same link, fused with the node `node_number`. Default empty. |  No  |
+     * | `SO3Task` |        `node_weights`          | `vector<double>`| Weights of `node_number` followed by `additional_node_numbers` in the fusion. Default all 1.0. |  No  |
      * `SO3Task` is a placeholder for the name of the task contained in the `tasks` list.
+     * The IMUs of a task with additional nodes are calibrated separately, and their link orientations
+     * are fused with a weighted mean on SO3 into the single set point of the task, so that the size
+     * of the QP does not grow with the number of IMUs. The additional nodes cannot be used by any
+     * other task.
      *
      * The "GravityTask" requires the following parameters:
      * |    Group    |         Parameter Name         |    Type    |                                         Description                                          | Mandatory |
@@ -374,6 +522,8 @@ public:
      * @param I_R_IMU orientation of the IMU
      * @param I_omega_IMU angular velocity of the IMU
      * @return true if the orientation setpoint is set correctly
+     * @note if the task has additional nodes, its set point is the weighted mean of the nodes
+     * updated since the last call to advance(), so that a node that stops sending is not fused
      */
     bool
     updateOrientationTask(const int node, const manif::SO3d& I_R_IMU, const manif::SO3Tangentd& I_omega_IMU = manif::SO3d::Tangent::Zero());
@@ -395,6 +545,25 @@ public:
      */
     bool updateFloorContactTask(const int node, const double verticalForce, const double linkHeight = 0.0);
 
+    /**
+     * set the contact state of a given node of a floor contact task, e.g. from a contact schedule
+     * computed offline, instead of comparing its vertical force with the threshold of the task
+     * @param node node number
+     * @param inContact true if the foot is in contact
+     * @param linkHeight height of the link in contact, used as set point when the contact starts
+     * @return true if the position setpoint is set correctly
+     */
+    bool setFloorContact(const int node, const bool inContact, const double linkHeight = 0.0);
+
+    /**
+     * get the contact state of a given node of a floor contact task
+     * @param node node number
+     * @param inContact true if the foot is in contact
+     * @return true if the contact state is retrieved correctly, false if the node is not in a floor
+     * contact task
+     */
+    bool getFloorContact(const int node, bool& inContact) const;
+
     /**
      * set the setpoint for the joint regularization task.
      * This function is to be called before the advance function to set the joint constraints
@@ -404,6 +573,23 @@ public:
      */
     bool updateJointRegularizationTask();
 
+    /**
+     * enable or disable the joint regularization task, e.g. to lower the cost of the solver when the
+     * time budget is exceeded. The task stays in the QP, while it is disabled its weight is zero.
+     * @param enabled true to enable the task, false to disable it
+     * @return true if the weight of the task is updated
+     */
+    bool setJointRegularizationTaskEnabled(const bool enabled);
+
+    /**
+     * enable or disable the joint velocity limits task, e.g. to let the solver catch up with fast
+     * motions when the time budget is exceeded. The constraint stays in the QP, while it is
+     * disabled its bounds are never active.
+     * @param enabled true to enable the task, false to disable it
+     * @return true if the joint velocity limits task is initialized
+     */
+    bool setJointVelocityLimitsTaskEnabled(const bool enabled);
+
     /**
      * update the joint constraint task.
      * This function is to be called before the advance function to set the joint constraints
@@ -411,6 +597,29 @@ public:
      */
     bool updateJointConstraintsTask();
 
+    /**
+     * update the orientation of a node of either a SO3 task or a gravity task, without the need of
+     * knowing which kind of task the node belongs to
+     * @param node node number
+     * @param I_R_IMU orientation of the IMU
+     * @param I_omega_IMU angular velocity of the IMU, used only by the SO3 tasks
+     * @return true if the node belongs to a SO3 or gravity task and the task is updated correctly
+     */
+    bool updateOrientationOrGravityTask(const int node,
+                                        const manif::SO3d& I_R_IMU,
+                                        const manif::SO3Tangentd& I_omega_IMU = manif::SO3d::Tangent::Zero());
+
+    /**
+     * compute the orientation of the link of a node of either a SO3 task or a gravity task with the
+     * current calibration, i.e. W_R_link = W_R_WIMU * WIMU_R_IMU * IMU_R_link, as done when the
+     * task is updated
+     * @param node node number
+     * @param I_R_IMU orientation of the IMU
+     * @param I_R_link orientation of the link
+     * @return true if the node belongs to a SO3 or gravity task
+     */
+    bool getCalibratedNodeOrientation(const int node, const manif::SO3d& I_R_IMU, manif::SO3d& I_R_link) const;
+
     /**
      * update the orientation for all the nodes of the SO3 and gravity tasks
      * @param nodeStruct unordered map containing the struct node data (see
@@ -453,14 +662,74 @@ public:
      */
     bool calibrateAllWithWorld(std::unordered_map<int, nodeData> nodeStruct, std::string frameRef = "");
 
+    /**
+     * carry over the calibration and the state of another HumanIK object, e.g. when the model of a
+     * subject is replaced by a refined one. The calibration matrices and the contact state are
+     * copied for the nodes with a task of the same kind in both the objects, the joint positions and
+     * velocities for the joints with the same name in both the models, and the base pose and
+     * velocity as they are. The state of the KinDynComputations object is updated accordingly.
+     * @param previous initialized HumanIK object whose state is carried over
+     * @return true if the state has been carried over, false if one of the objects is not
+     * initialized
+     * @note the elements without a counterpart in previous keep their value
+     */
+    bool transferStateFrom(const HumanIK& previous);
+
+    /**
+     * set the joint positions and the base orientation of the integrator, e.g. to warm start the
+     * inverse kinematics with an approximate solution. The base position is kept, the joint and
+     * base velocities are set to zero. The state of the KinDynComputations object is updated
+     * accordingly.
+     * @param jointPositions joint positions
+     * @param baseOrientation base orientation
+     * @return true if the state has been set, false if the object is not initialized or the size
+     * of the joint positions is wrong
+     */
+    bool setState(Eigen::Ref<const Eigen::VectorXd> jointPositions, Eigen::Ref<const Eigen::Matrix3d> baseOrientation);
+
     /**
      * this function solves the inverse kinematics problem and integrate the joint velocity to
      * compute the joint positions and the base pose; it also updates the state of the
      * KinDynComputations object passed to the class
      * @return true if the inverse kinematics solver is advanced correctly
+     * @note if the QP fails, or its velocities are not finite or exceed the plausible limits set in
+     * the configuration, or the integration fails or its state is not finite, the solver is
+     * considered diverged: the state is not updated and it is reset in place to the last good
+     * state, as in resetToLastGoodState(), and the function returns false
      */
     bool advance();
 
+    /**
+     * reset the integrator and the KinDynComputations object to the last state computed by a
+     * successful call to advance(), with zero velocities. The tasks, the calibration and the
+     * workspace of the solver are kept.
+     * @return true if the state has been reset, false if the object is not initialized
+     */
+    bool resetToLastGoodState();
+
+    /**
+     * reset the integrator and the KinDynComputations object to the calibration pose, i.e. the
+     * base at the origin and the joints at `calibration_joint_positions`, with zero velocities. The
+     * tasks, the calibration and the workspace of the solver are kept.
+     * @return true if the state has been reset, false if the object is not initialized
+     */
+    bool resetToCalibrationPose();
+
+    /**
+     * get the orientation set point of a SO3 task, i.e. the fused orientation of its nodes if the
+     * task has additional nodes
+     * @param node node number of the task, or one of its additional nodes
+     * @param setPoint orientation set point of the link
+     * @return true if the set point is retrieved correctly, false if the node is not in a SO3 task
+     */
+    bool getOrientationTaskSetPoint(const int node, manif::SO3d& setPoint) const;
+
+    /**
+     * get the number of calls to advance() in which the solver diverged
+     * @return number of divergences since the initialization
+     */
+    std::size_t getNrOfDivergences() const;
+
     /**
      * get the joint positions
      * @param jointPositions joint positions
@@ -502,6 +771,24 @@ public:
      * @return true if the base angular velocity is retrieved correctly
      */
     bool getBaseAngularVelocity(Eigen::Ref<Eigen::Vector3d> baseAngularVelocity) const;
+
+    /**
+     * get the tracking residuals of the SO3, gravity and floor contact tasks, computed by the last
+     * call to advance() on the state used by the QP, without additional kinematics computations.
+     * The residuals are:
+     * - SO3 task: geodesic distance, in rad, between the orientation of the link and its set point
+     * - gravity task: angle, in rad, between the vertical direction of the link and its set point
+     * - floor contact task: distance, in m, between the position of the link and its set point, zero
+     *   when the foot is not in contact
+     * @return contiguous vector of residuals, ordered as getTaskResidualNames()
+     */
+    const Eigen::VectorXd& getTaskResiduals() const;
+
+    /**
+     * get the names of the tasks whose residual is returned by getTaskResiduals()
+     * @return names of the tasks, in the order of the configuration file
+     */
+    const std::vector<std::string>& getTaskResidualNames() const;
 };
 
 } // namespace IK
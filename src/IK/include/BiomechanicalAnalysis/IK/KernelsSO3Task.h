@@ -0,0 +1,148 @@
+/**
+ * @file KernelsSO3Task.h
+ * @authors Davide Gorbani <davide.gorbani@iit.it>
+ */
+
+#ifndef BIOMECHANICAL_ANALYSIS_KERNELS_SO3_TASK_H
+#define BIOMECHANICAL_ANALYSIS_KERNELS_SO3_TASK_H
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Eigen
+#include <Eigen/Dense>
+
+// iDynTree
+#include <iDynTree/KinDynComputations.h>
+
+// BipedalLocomotion
+#include <BipedalLocomotion/IK/IKLinearTask.h>
+#include <BipedalLocomotion/ParametersHandler/IParametersHandler.h>
+#include <BipedalLocomotion/System/VariablesHandler.h>
+
+// manif
+#include <manif/SO3.h>
+
+namespace BiomechanicalAnalysis
+{
+
+namespace IK
+{
+
+/**
+ * @brief Pose and jacobian of the links of a model computed by the kernels emitted by the
+ * Model::ModelKernelsGenerator, with the type of the kernels erased
+ */
+struct LinkKinematicsKernels
+{
+    std::size_t nrOfDOFs{0}; /** number of degrees of freedom of the model */
+    std::vector<std::string> linkNames; /** names of the links, in the order of the kernels */
+    std::function<void(const Eigen::Isometry3d& world_H_base,
+                       Eigen::Ref<const Eigen::VectorXd> jointPositions,
+                       std::size_t link,
+                       Eigen::Isometry3d& world_H_link,
+                       Eigen::Ref<Eigen::MatrixXd> jacobian)>
+        computeLinkKinematics; /** compute the pose and the mixed jacobian of a link */
+};
+
+/**
+ * build the LinkKinematicsKernels from the kernels generated for a model
+ * @tparam ModelKernels the `ModelKernels` type emitted by the Model::ModelKernelsGenerator
+ * @return the kernels
+ */
+template <typename ModelKernels> LinkKinematicsKernels makeLinkKinematicsKernels()
+{
+    LinkKinematicsKernels kernels;
+    kernels.nrOfDOFs = ModelKernels::NrOfDOFs;
+    for (const char* name : ModelKernels::linkNames())
+    {
+        kernels.linkNames.emplace_back(name);
+    }
+    // the poses are stored in the closure, hence the kernels do not allocate memory
+    kernels.computeLinkKinematics = [world_H_links = typename ModelKernels::LinkPoses()](const Eigen::Isometry3d& world_H_base,
+                                                                                         Eigen::Ref<const Eigen::VectorXd> jointPositions,
+                                                                                         std::size_t link,
+                                                                                         Eigen::Isometry3d& world_H_link,
+                                                                                         Eigen::Ref<Eigen::MatrixXd> jacobian) mutable {
+        ModelKernels::computeLinkPoses(world_H_base, jointPositions, world_H_links);
+        ModelKernels::computeLinkJacobian(link, world_H_links, jacobian);
+        world_H_link = world_H_links[link];
+    };
+    return kernels;
+}
+
+/**
+ * @brief Orientation task equivalent to the BipedalLocomotion::IK::SO3Task, i.e.
+ * \f$ J_\omega \nu = \omega^* + k_p \log(R^* R^\top)^\vee \f$, whose pose and jacobian are
+ * computed by the generated kernels of the model instead of the KinDynComputations object.
+ * The kinDyn object is used only to read the base pose and the joint positions, hence it must be
+ * updated as for the SO3Task and its velocity representation must be MIXED.
+ */
+class KernelsSO3Task : public BipedalLocomotion::IK::IKLinearTask
+{
+public:
+    /**
+     * set the kinDyn object and the kernels of its model
+     * @param kinDyn pointer to the KinDynComputations object
+     * @param kernels kernels built with makeLinkKinematicsKernels for the model of kinDyn
+     * @return true if the kernels are consistent with the model
+     */
+    bool setKinDynAndKernels(std::shared_ptr<iDynTree::KinDynComputations> kinDyn, LinkKinematicsKernels kernels);
+
+    // clang-format off
+    /**
+     * initialize the task
+     * @param paramHandler pointer to the parameters handler
+     * @return true if the task is initialized correctly
+     * @note the following parameters are used by the class
+     * |         Parameter Name         |   Type   |                          Description                          | Mandatory |
+     * |:------------------------------:|:--------:|:-------------------------------------------------------------:|:---------:|
+     * | `robot_velocity_variable_name` | `string` |        Name of the variable containing the robot velocity     |    Yes    |
+     * |          `frame_name`          | `string` |        Name of the controlled link, it must be in the kernels  |    Yes    |
+     * |          `kp_angular`          | `double` |                  Gain of the orientation error                 |    Yes    |
+     */
+    // clang-format on
+    bool initialize(std::weak_ptr<const BipedalLocomotion::ParametersHandler::IParametersHandler> paramHandler) override;
+
+    bool setVariablesHandler(const BipedalLocomotion::System::VariablesHandler& variablesHandler) override;
+
+    bool update() override;
+
+    /**
+     * set the desired orientation and angular velocity of the link
+     * @param I_R_F desired orientation of the link
+     * @param angularVelocity desired angular velocity of the link, in mixed representation
+     * @return true
+     */
+    bool setSetPoint(const manif::SO3d& I_R_F, const manif::SO3d::Tangent& angularVelocity = manif::SO3d::Tangent::Zero());
+
+    std::size_t size() const override;
+
+    Type type() const override;
+
+    bool isValid() const override;
+
+private:
+    std::shared_ptr<iDynTree::KinDynComputations> m_kinDyn; /** used to read the base pose and the joint positions */
+    LinkKinematicsKernels m_kernels; /** kernels of the model of m_kinDyn */
+    std::string m_robotVelocityVariableName; /** name of the robot velocity variable */
+    BipedalLocomotion::System::VariablesHandler::VariableDescription m_robotVelocityVariable; /** robot velocity variable */
+    std::size_t m_linkIndex{0}; /** index of the controlled link in the kernels */
+    double m_kp{0.0}; /** gain of the orientation error */
+    manif::SO3d m_setPoint{manif::SO3d::Identity()}; /** desired orientation */
+    manif::SO3d::Tangent m_angularVelocity{manif::SO3d::Tangent::Zero()}; /** desired angular velocity */
+    Eigen::VectorXd m_jointPositions; /** joint positions read from m_kinDyn */
+    Eigen::Isometry3d m_world_H_base{Eigen::Isometry3d::Identity()}; /** base pose read from m_kinDyn */
+    Eigen::Isometry3d m_world_H_link{Eigen::Isometry3d::Identity()}; /** pose of the link */
+    Eigen::MatrixXd m_jacobian; /** mixed jacobian of the link */
+    bool m_isInitialized{false}; /** true if the task has been initialized */
+    bool m_isValid{false}; /** true if the task has been updated */
+};
+
+} // namespace IK
+} // namespace BiomechanicalAnalysis
+
+#endif // BIOMECHANICAL_ANALYSIS_KERNELS_SO3_TASK_H
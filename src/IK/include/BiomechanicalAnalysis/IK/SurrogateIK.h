@@ -0,0 +1,214 @@
+/**
+ * @file SurrogateIK.h
+ * @authors Davide Gorbani <davide.gorbani@iit.it>
+ */
+
+#ifndef BIOMECHANICAL_ANALYSIS_SURROGATE_IK_H
+#define BIOMECHANICAL_ANALYSIS_SURROGATE_IK_H
+
+#include <cstddef>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+// Eigen
+#include <Eigen/Dense>
+
+// BipedalLocomotion
+#include <BipedalLocomotion/ParametersHandler/IParametersHandler.h>
+
+#include <BiomechanicalAnalysis/IK/InverseKinematics.h>
+
+namespace BiomechanicalAnalysis
+{
+
+namespace IK
+{
+
+/**
+ * @brief Errors of the predictions of SurrogateIK with respect to the solutions of HumanIK
+ */
+struct SurrogateIKError
+{
+    std::size_t count{0}; /** number of compared frames */
+    double lastJointError{0.0}; /** largest joint error of the last frame, in rad */
+    double lastBaseOrientationError{0.0}; /** base orientation error of the last frame, in rad */
+    double rmsJointError{0.0}; /** root mean square of the joint errors of all the frames */
+    double maxJointError{0.0}; /** largest joint error of all the frames */
+    double maxBaseOrientationError{0.0}; /** largest base orientation error of all the frames */
+};
+
+/**
+ * @brief Regressor from the orientations of the nodes to the joint positions and the base
+ * orientation computed by HumanIK, to be used as an approximate inverse kinematics with a latency
+ * of a few microseconds or to warm start HumanIK with HumanIK::setState.
+ * When the HumanIK object is passed to addSample() and predict(), the input is the orientation of
+ * the links of the nodes with the current calibration of HumanIK, see
+ * HumanIK::getCalibratedNodeOrientation, hence the regressor stays valid after the subject is
+ * calibrated again. Otherwise the input is the orientation of the nodes as given, and the
+ * regressor is valid only for the calibration of the training samples.
+ * The mapping is smooth for a given model, hence the regressor is a ridge
+ * regression on the entries of the rotation matrices of the nodes and on a set of random Fourier
+ * features of them. Training accumulates the normal equations one sample at a time, so that
+ * recordings of any length are used with a memory that depends only on the number of features, and
+ * then solves them with a Cholesky factorization; both training and inference run on the CPU.
+ */
+class SurrogateIK
+{
+public:
+    // clang-format off
+    /**
+     * initialize the regressor
+     * @param handler pointer to the parameters handler
+     * @return true if the regressor is initialized correctly
+     * @note the following parameters are used by the class
+     * |     Parameter Name     |      Type      |                                   Description                                   | Mandatory |
+     * |:----------------------:|:--------------:|:-------------------------------------------------------------------------------:|:---------:|
+     * |     `node_numbers`     |  `vector<int>` |                Nodes whose orientation is the input of the regressor            |    Yes    |
+     * |    `random_features`   |      `int`     |  Number of random Fourier features, 0 for a linear regressor. Default 256       |    No     |
+     * |   `kernel_bandwidth`   |    `double`    | Bandwidth of the Gaussian kernel approximated by the features. Default 1.0      |    No     |
+     * |    `regularization`    |    `double`    |        Weight of the ridge regularization, it must be positive. Default 1e-6   |    No     |
+     * |         `seed`         |      `int`     |            Seed of the generator of the random features. Default 0             |    No     |
+     */
+    // clang-format on
+    bool initialize(std::weak_ptr<const BipedalLocomotion::ParametersHandler::IParametersHandler> handler);
+
+    /**
+     * add a training sample
+     * @param nodeStruct orientations of the nodes, it must contain all the nodes of the regressor
+     * @param jointPositions joint positions computed by HumanIK
+     * @param baseOrientation base orientation computed by HumanIK
+     * @return true if the sample has been added
+     * @note the number of joints is set by the first sample
+     * @note the orientations are used as given, hence the samples cannot be mixed with the ones
+     * added with a HumanIK object
+     */
+    bool addSample(const std::unordered_map<int, nodeData>& nodeStruct,
+                   Eigen::Ref<const Eigen::VectorXd> jointPositions,
+                   Eigen::Ref<const Eigen::Matrix3d> baseOrientation);
+
+    /**
+     * add a training sample with the current solution of a HumanIK object, i.e. after calling
+     * HumanIK::advance with the same node orientations. The input is the orientation of the links
+     * of the nodes with the current calibration of the HumanIK object
+     * @param nodeStruct orientations of the nodes, it must contain all the nodes of the regressor
+     * @param ik HumanIK object
+     * @return true if the sample has been added
+     */
+    bool addSample(const std::unordered_map<int, nodeData>& nodeStruct, const HumanIK& ik);
+
+    /**
+     * compute the weights of the regressor from the samples added so far
+     * @return true if the regressor has been trained
+     * @note the samples are kept, hence more samples can be added and the regressor trained again
+     */
+    bool train();
+
+    /**
+     * get the number of samples added so far
+     * @return number of samples
+     */
+    std::size_t getNrOfSamples() const;
+
+    /**
+     * check if the regressor has been trained
+     * @return true if train() has been called successfully
+     */
+    bool isTrained() const;
+
+    /**
+     * predict the joint positions and the base orientation, without memory allocations
+     * @param nodeStruct orientations of the nodes, it must contain all the nodes of the regressor
+     * @param jointPositions predicted joint positions
+     * @param baseOrientation predicted base orientation, projected on SO3
+     * @return true if the prediction has been computed
+     * @note the regressor must have been trained with samples added without a HumanIK object
+     */
+    bool predict(const std::unordered_map<int, nodeData>& nodeStruct,
+                 Eigen::Ref<Eigen::VectorXd> jointPositions,
+                 Eigen::Ref<Eigen::Matrix3d> baseOrientation);
+
+    /**
+     * predict the joint positions and the base orientation from the orientations of the nodes
+     * calibrated by a HumanIK object, without memory allocations
+     * @param nodeStruct orientations of the nodes, it must contain all the nodes of the regressor
+     * @param ik HumanIK object whose calibration is applied to the nodes
+     * @param jointPositions predicted joint positions
+     * @param baseOrientation predicted base orientation, projected on SO3
+     * @return true if the prediction has been computed
+     * @note the regressor must have been trained with samples added with a HumanIK object
+     */
+    bool predict(const std::unordered_map<int, nodeData>& nodeStruct,
+                 const HumanIK& ik,
+                 Eigen::Ref<Eigen::VectorXd> jointPositions,
+                 Eigen::Ref<Eigen::Matrix3d> baseOrientation);
+
+    /**
+     * compare the prediction with the current solution of a HumanIK object, i.e. after calling
+     * HumanIK::advance with the same node orientations, and update the errors returned by
+     * getError(). The regressor must have been trained with samples added with a HumanIK object
+     * @param nodeStruct orientations of the nodes, it must contain all the nodes of the regressor
+     * @param ik HumanIK object
+     * @return true if the errors have been updated
+     */
+    bool monitor(const std::unordered_map<int, nodeData>& nodeStruct, const HumanIK& ik);
+
+    /**
+     * get the errors of the predictions with respect to HumanIK
+     * @return errors computed by monitor()
+     */
+    const SurrogateIKError& getError() const;
+
+    /**
+     * reset the errors returned by getError()
+     */
+    void resetError();
+
+private:
+    /**
+     * compute the features of the node orientations in m_features
+     * @param nodeStruct orientations of the nodes
+     * @param ik HumanIK object whose calibration is applied to the nodes, nullptr to use the
+     * orientations as given
+     * @return true if all the nodes are available
+     */
+    bool computeFeatures(const std::unordered_map<int, nodeData>& nodeStruct, const HumanIK* ik);
+
+    bool addSample(const std::unordered_map<int, nodeData>& nodeStruct,
+                   const HumanIK* ik,
+                   Eigen::Ref<const Eigen::VectorXd> jointPositions,
+                   Eigen::Ref<const Eigen::Matrix3d> baseOrientation);
+
+    bool predict(const std::unordered_map<int, nodeData>& nodeStruct,
+                 const HumanIK* ik,
+                 Eigen::Ref<Eigen::VectorXd> jointPositions,
+                 Eigen::Ref<Eigen::Matrix3d> baseOrientation);
+
+    std::vector<int> m_nodeNumbers; /** nodes of the input */
+    Eigen::MatrixXd m_projection; /** frequencies of the random features */
+    Eigen::VectorXd m_phases; /** phases of the random features */
+    double m_regularization{1e-6}; /** weight of the ridge regularization */
+    manif::SO3d m_nodeOrientation; /** orientation of a node, calibrated if a HumanIK object is given */
+    Eigen::VectorXd m_input; /** entries of the rotation matrices of the nodes */
+    Eigen::VectorXd m_features; /** constant, linear and random features */
+    Eigen::VectorXd m_target; /** joint positions followed by the base orientation */
+    Eigen::MatrixXd m_normalMatrix; /** sum of features * features^T of the samples */
+    Eigen::MatrixXd m_normalTarget; /** sum of features * target^T of the samples */
+    Eigen::MatrixXd m_weights; /** weights of the regressor, one column for each output */
+    Eigen::VectorXd m_output; /** output of the regressor */
+    Eigen::VectorXd m_jointPositions; /** joint positions of HumanIK */
+    Eigen::Matrix3d m_baseOrientation; /** base orientation of HumanIK */
+    Eigen::VectorXd m_predictedJointPositions; /** predicted joint positions */
+    Eigen::Matrix3d m_predictedBaseOrientation; /** predicted base orientation */
+    std::size_t m_nrOfJoints{0}; /** number of joints, set by the first sample */
+    std::size_t m_nrOfSamples{0}; /** number of samples */
+    bool m_calibratedInput{false}; /** true if the samples have been added with a HumanIK object */
+    bool m_trained{false}; /** true if the regressor has been trained */
+    double m_sumSquaredJointError{0.0}; /** sum of the squared joint errors */
+    SurrogateIKError m_error; /** errors with respect to HumanIK */
+};
+
+} // namespace IK
+} // namespace BiomechanicalAnalysis
+
+#endif // BIOMECHANICAL_ANALYSIS_SURROGATE_IK_H
@@ -4,6 +4,9 @@
 #include <iDynTree/EigenHelpers.h>
 #include <iDynTree/Model.h>
 
+#include <algorithm>
+#include <cmath>
+
 using namespace BiomechanicalAnalysis::IK;
 using namespace BipedalLocomotion::ContinuousDynamicalSystem;
 using namespace BipedalLocomotion::Conversions;
@@ -16,6 +19,71 @@ constexpr size_t WRENCH_TORQUE_X = 3;
 constexpr size_t WRENCH_TORQUE_Y = 4;
 constexpr size_t WRENCH_TORQUE_Z = 5;
 
+// bound of a disabled inequality, OSQP, the solver of QPInverseKinematics, treats it as infinite
+constexpr double INACTIVE_INEQUALITY_BOUND = 1e30;
+
+SwitchableInequalityTask::SwitchableInequalityTask(std::shared_ptr<BipedalLocomotion::IK::IKLinearTask> task)
+    : m_task(std::move(task))
+{
+}
+
+void SwitchableInequalityTask::setEnabled(const bool enabled)
+{
+    m_enabled = enabled;
+}
+
+bool SwitchableInequalityTask::isEnabled() const
+{
+    return m_enabled;
+}
+
+bool SwitchableInequalityTask::setVariablesHandler(const BipedalLocomotion::System::VariablesHandler& variablesHandler)
+{
+    if (m_task == nullptr || !m_task->setVariablesHandler(variablesHandler))
+    {
+        BiomechanicalAnalysis::log()->error("[SwitchableInequalityTask::setVariablesHandler] Unable to set the variables handler "
+                                            "of the task.");
+        return false;
+    }
+    m_description = m_task->getDescription();
+    m_A = m_task->getA();
+    m_b = m_task->getB();
+    return true;
+}
+
+bool SwitchableInequalityTask::update()
+{
+    if (!m_task->update())
+    {
+        return false;
+    }
+    // the matrices keep their size, hence the copies do not allocate memory
+    m_A = m_task->getA();
+    if (m_enabled)
+    {
+        m_b = m_task->getB();
+    } else
+    {
+        m_b.setConstant(INACTIVE_INEQUALITY_BOUND);
+    }
+    return true;
+}
+
+std::size_t SwitchableInequalityTask::size() const
+{
+    return m_task->size();
+}
+
+SwitchableInequalityTask::Type SwitchableInequalityTask::type() const
+{
+    return m_task->type();
+}
+
+bool SwitchableInequalityTask::isValid() const
+{
+    return m_task != nullptr && m_task->isValid();
+}
+
 bool HumanIK::initialize(std::weak_ptr<const BipedalLocomotion::ParametersHandler::IParametersHandler> handler,
                          std::shared_ptr<iDynTree::KinDynComputations> kinDyn)
 {
@@ -96,6 +164,19 @@ bool HumanIK::initialize(std::weak_ptr<const BipedalLocomotion::ParametersHandle
         m_calibrationJointPositions.setZero();
     }
 
+    // Retrieve the plausible velocities used to detect the divergence of the solver
+    ptr->getParameter("max_joint_velocity", m_maxJointVelocity);
+    ptr->getParameter("max_base_linear_velocity", m_maxBaseLinearVelocity);
+    ptr->getParameter("max_base_angular_velocity", m_maxBaseAngularVelocity);
+    if (m_maxJointVelocity <= 0.0 || m_maxBaseLinearVelocity <= 0.0 || m_maxBaseAngularVelocity <= 0.0)
+    {
+        BiomechanicalAnalysis::log()->error("{} The plausible velocities must be positive.", logPrefix);
+        return false;
+    }
+    m_nrOfDivergences = 0;
+
+    m_taskResidualNames.clear();
+
     // Cycle on the tasks to be initialized
     for (const auto& task : tasks)
     {
@@ -172,6 +253,8 @@ bool HumanIK::initialize(std::weak_ptr<const BipedalLocomotion::ParametersHandle
 
     m_qpIK.finalize(m_variableHandler);
 
+    m_taskResiduals = Eigen::VectorXd::Zero(m_taskResidualNames.size());
+
     return ok;
 }
 
@@ -205,13 +288,87 @@ bool HumanIK::updateOrientationTask(const int node, const manif::SO3d& I_R_IMU,
         return false;
     }
 
+    OrientationTaskStruct& data = m_OrientationTasks[node];
+
     // Compute the rotation matrix from the world to the link frame as:
     // W_R_link = W_R_WIMU * WIMU_R_IMU * IMU_R_link
-    I_R_link = m_OrientationTasks[node].calibrationMatrix * I_R_IMU * m_OrientationTasks[node].IMU_R_link;
+    I_R_link = data.calibrationMatrix * I_R_IMU * data.IMU_R_link;
+
+    if (data.fusion == nullptr)
+    {
+        data.setPoint = I_R_link;
+
+        // Set the setpoint for the orientation task of the node
+        return data.task->setSetPoint(I_R_link, data.calibrationMatrix.rotation() * I_omega_IMU.coeffs());
+    }
+
+    // the estimate of the node replaces its previous one, and the set point of the task is the
+    // weighted mean of the estimates of the nodes updated in this frame
+    OrientationFusion& fusion = *data.fusion;
+    fusion.I_R_link[data.fusionSlot] = I_R_link;
+    fusion.I_omega_link[data.fusionSlot] = data.calibrationMatrix.rotation() * I_omega_IMU.coeffs();
+    fusion.valid[data.fusionSlot] = true;
+    fuseOrientations(fusion, I_R_link);
+
+    Eigen::Vector3d omega = Eigen::Vector3d::Zero();
+    double totalWeight{0.0};
+    for (std::size_t i = 0; i < fusion.weights.size(); i++)
+    {
+        if (fusion.valid[i])
+        {
+            omega += fusion.weights[i] * fusion.I_omega_link[i];
+            totalWeight += fusion.weights[i];
+        }
+    }
+    return data.task->setSetPoint(fusion.setPoint, omega / totalWeight);
+}
+
+void HumanIK::fuseOrientations(OrientationFusion& fusion, const manif::SO3d& initialGuess)
+{
+    // weighted Karcher mean, the tangent space of the mean is updated until the weighted mean of
+    // the residuals vanishes. The estimates of a link are close to each other, so few iterations are
+    // enough.
+    constexpr std::size_t maxIterations = 10;
+    constexpr double tolerance = 1e-10;
+
+    fusion.setPoint = initialGuess;
+    for (std::size_t iteration = 0; iteration < maxIterations; iteration++)
+    {
+        Eigen::Vector3d delta = Eigen::Vector3d::Zero();
+        double totalWeight{0.0};
+        for (std::size_t i = 0; i < fusion.weights.size(); i++)
+        {
+            if (fusion.valid[i])
+            {
+                delta += fusion.weights[i] * (fusion.I_R_link[i] - fusion.setPoint).coeffs();
+                totalWeight += fusion.weights[i];
+            }
+        }
+        delta /= totalWeight;
+        fusion.setPoint = fusion.setPoint + manif::SO3Tangentd(delta);
+        if (delta.squaredNorm() < tolerance * tolerance)
+        {
+            break;
+        }
+    }
+}
 
-    // Set the setpoint for the orientation task of the node
-    return m_OrientationTasks[node].task->setSetPoint(I_R_link,
-                                                      m_OrientationTasks[node].calibrationMatrix.rotation() * I_omega_IMU.coeffs());
+bool HumanIK::isAdditionalNode(const int node) const
+{
+    const auto it = m_OrientationTasks.find(node);
+    return it != m_OrientationTasks.end() && !it->second.primaryNode;
+}
+
+bool HumanIK::getOrientationTaskSetPoint(const int node, manif::SO3d& setPoint) const
+{
+    const auto it = m_OrientationTasks.find(node);
+    if (it == m_OrientationTasks.end())
+    {
+        BiomechanicalAnalysis::log()->error("[HumanIK::getOrientationTaskSetPoint] Invalid node number {}.", node);
+        return false;
+    }
+    setPoint = it->second.fusion == nullptr ? it->second.setPoint : it->second.fusion->setPoint;
+    return true;
 }
 
 bool HumanIK::updateGravityTask(const int node, const manif::SO3d& I_R_IMU)
@@ -229,16 +386,43 @@ bool HumanIK::updateGravityTask(const int node, const manif::SO3d& I_R_IMU)
 
     // set the set point of the gravity task choosing the z direction of the link_R_W rotation
     // matrix
-    return m_GravityTasks[node].task->setSetPoint((I_R_link.rotation().transpose().rightCols(1)));
+    m_GravityTasks[node].setPoint = I_R_link.rotation().transpose().rightCols(1);
+    return m_GravityTasks[node].task->setSetPoint(m_GravityTasks[node].setPoint);
 }
 
 bool HumanIK::updateFloorContactTask(const int node, const double verticalForce, const double linkHeight)
+{
+    // check if the node number is valid
+    const auto it = m_FloorContactTasks.find(node);
+    if (it == m_FloorContactTasks.end())
+    {
+        BiomechanicalAnalysis::log()->error("[HumanIK::updateFloorContactTask] Invalid node number.");
+        return false;
+    }
+
+    // the foot gets in contact if the vertical force is greater than the threshold and it leaves
+    // the contact if the vertical force is lower than the threshold; after a calibration the foot
+    // is not in contact
+    const bool footInContact = it->second.footInContact && !m_tPose;
+    bool inContact = footInContact;
+    if (verticalForce > it->second.verticalForceThreshold && !footInContact)
+    {
+        inContact = true;
+    } else if (verticalForce < it->second.verticalForceThreshold && footInContact)
+    {
+        inContact = false;
+    }
+
+    return setFloorContact(node, inContact, linkHeight);
+}
+
+bool HumanIK::setFloorContact(const int node, const bool inContact, const double linkHeight)
 {
     bool ok{true};
     // check if the node number is valid
     if (m_FloorContactTasks.find(node) == m_FloorContactTasks.end())
     {
-        BiomechanicalAnalysis::log()->error("[HumanIK::updateFloorContactTask] Invalid node number.");
+        BiomechanicalAnalysis::log()->error("[HumanIK::setFloorContact] Invalid node number.");
         return false;
     }
     if (m_tPose == true)
@@ -255,20 +439,20 @@ bool HumanIK::updateFloorContactTask(const int node, const double verticalForce,
         m_kinDyn->setRobotState(basePose, jointPositions, baseVelocity, m_jointVelocities, m_gravity);
     }
 
-    // if the vertical force is greater than the threshold and if the foot is not yet in contact,
-    // set the weight of the associated task to the weight of the task and set the set point of the
-    // task to the position of the frame computed with the legged odometry
-    if (verticalForce > m_FloorContactTasks[node].verticalForceThreshold && !m_FloorContactTasks[node].footInContact)
+    // if the foot gets in contact, set the weight of the associated task to the weight of the task
+    // and set the set point of the task to the position of the frame computed with the legged
+    // odometry
+    if (inContact && !m_FloorContactTasks[node].footInContact)
     {
-        m_qpIK.setTaskWeight(m_FloorContactTasks[node].taskName, m_FloorContactTasks[node].weight);
+        setTaskWeight(m_FloorContactTasks[node].taskName, m_FloorContactTasks[node].weight);
         m_FloorContactTasks[node].footInContact = true;
         m_FloorContactTasks[node].setPointPosition
             = iDynTree::toEigen(m_kinDyn->getWorldTransform(m_FloorContactTasks[node].frameName).getPosition());
         m_FloorContactTasks[node].setPointPosition(2) = linkHeight;
-    } else if (verticalForce < m_FloorContactTasks[node].verticalForceThreshold && m_FloorContactTasks[node].footInContact)
+    } else if (!inContact && m_FloorContactTasks[node].footInContact)
     {
         // if the foot is not more in contact, set the weight of the associated task to zero
-        m_qpIK.setTaskWeight(m_FloorContactTasks[node].taskName, Eigen::Vector3d::Zero());
+        setTaskWeight(m_FloorContactTasks[node].taskName, Eigen::Vector3d::Zero());
         m_FloorContactTasks[node].footInContact = false;
     }
 
@@ -281,6 +465,18 @@ bool HumanIK::updateFloorContactTask(const int node, const double verticalForce,
     return ok;
 }
 
+bool HumanIK::getFloorContact(const int node, bool& inContact) const
+{
+    const auto it = m_FloorContactTasks.find(node);
+    if (it == m_FloorContactTasks.end())
+    {
+        BiomechanicalAnalysis::log()->error("[HumanIK::getFloorContact] Invalid node number {}.", node);
+        return false;
+    }
+    inContact = it->second.footInContact;
+    return true;
+}
+
 bool HumanIK::updateJointRegularizationTask()
 {
     // check if the joint regularization task is initialized
@@ -293,6 +489,62 @@ bool HumanIK::updateJointRegularizationTask()
     return m_jointRegularizationTask->setSetPoint(Eigen::VectorXd::Zero(m_nrDoFs));
 }
 
+bool HumanIK::setJointRegularizationTaskEnabled(const bool enabled)
+{
+    // check if the joint regularization task is initialized
+    if (m_jointRegularizationTask == nullptr)
+    {
+        BiomechanicalAnalysis::log()->error("[HumanIK::setJointRegularizationTaskEnabled] Joint regularization task not initialized.");
+        return false;
+    }
+
+    // the task is kept in the QP, so that its structure does not change, and it has no effect
+    // while its weight is zero
+    const bool ok = enabled ? m_qpIK.setTaskWeight(m_jointRegularizationTaskName, m_jointRegularizationWeight)
+                            : m_qpIK.setTaskWeight(m_jointRegularizationTaskName, Eigen::VectorXd::Zero(m_jointRegularizationWeight.size()));
+    if (!ok)
+    {
+        return false;
+    }
+    m_jointRegularizationEnabled = enabled;
+    return true;
+}
+
+bool HumanIK::setJointVelocityLimitsTaskEnabled(const bool enabled)
+{
+    // check if the joint velocity limits task is initialized
+    if (m_jointVelocityLimitsSwitch == nullptr)
+    {
+        BiomechanicalAnalysis::log()->error("[HumanIK::setJointVelocityLimitsTaskEnabled] Joint velocity limits task not "
+                                            "initialized.");
+        return false;
+    }
+
+    m_jointVelocityLimitsSwitch->setEnabled(enabled);
+    return true;
+}
+
+bool HumanIK::setTaskWeight(const std::string& taskName, Eigen::Ref<const Eigen::VectorXd> weight)
+{
+    if (m_jointRegularizationTask == nullptr || taskName != m_jointRegularizationTaskName)
+    {
+        return m_qpIK.setTaskWeight(taskName, weight);
+    }
+
+    if (weight.size() != m_jointRegularizationWeight.size())
+    {
+        BiomechanicalAnalysis::log()->error("[HumanIK::setTaskWeight] Invalid size of the weight of the {} task.", taskName);
+        return false;
+    }
+    // while the joint regularization is disabled the new weight is applied when it is enabled again
+    if (m_jointRegularizationEnabled && !m_qpIK.setTaskWeight(taskName, weight))
+    {
+        return false;
+    }
+    m_jointRegularizationWeight = weight;
+    return true;
+}
+
 bool HumanIK::updateJointConstraintsTask()
 {
     // check if the joint constraints task is initialized
@@ -305,35 +557,61 @@ bool HumanIK::updateJointConstraintsTask()
     return m_jointConstraintsTask->update();
 }
 
+bool HumanIK::updateOrientationOrGravityTask(const int node, const manif::SO3d& I_R_IMU, const manif::SO3Tangentd& I_omega_IMU)
+{
+    if (m_OrientationTasks.find(node) != m_OrientationTasks.end())
+    {
+        if (!updateOrientationTask(node, I_R_IMU, I_omega_IMU))
+        {
+            BiomechanicalAnalysis::log()->error("[HumanIK::updateOrientationOrGravityTask] "
+                                                "Error in updating the orientation task of "
+                                                "node {}",
+                                                node);
+            return false;
+        }
+    } else if (m_GravityTasks.find(node) != m_GravityTasks.end())
+    {
+        if (!updateGravityTask(node, I_R_IMU))
+        {
+            BiomechanicalAnalysis::log()->error("[HumanIK::updateOrientationOrGravityTask] "
+                                                "Error in updating the gravity task of node {}",
+                                                node);
+            return false;
+        }
+    } else
+    {
+        BiomechanicalAnalysis::log()->error("[HumanIK::updateOrientationOrGravityTask] "
+                                            "Invalid node number {}.",
+                                            node);
+        return false;
+    }
+    return true;
+}
+
+bool HumanIK::getCalibratedNodeOrientation(const int node, const manif::SO3d& I_R_IMU, manif::SO3d& I_R_link) const
+{
+    if (const auto it = m_OrientationTasks.find(node); it != m_OrientationTasks.end())
+    {
+        I_R_link = it->second.calibrationMatrix * I_R_IMU * it->second.IMU_R_link;
+        return true;
+    }
+    if (const auto it = m_GravityTasks.find(node); it != m_GravityTasks.end())
+    {
+        I_R_link = it->second.calibrationMatrix * I_R_IMU * it->second.IMU_R_link;
+        return true;
+    }
+    BiomechanicalAnalysis::log()->error("[HumanIK::getCalibratedNodeOrientation] Node {} does not belong to a SO3 or gravity task.",
+                                        node);
+    return false;
+}
+
 bool HumanIK::updateOrientationAndGravityTasks(const std::unordered_map<int, nodeData>& nodeStruct)
 {
     // Update the orientation and gravity tasks
     for (const auto& [node, data] : nodeStruct)
     {
-        if (m_OrientationTasks.find(node) != m_OrientationTasks.end())
-        {
-            if (!updateOrientationTask(node, data.I_R_IMU, data.I_omega_IMU))
-            {
-                BiomechanicalAnalysis::log()->error("[HumanIK::updateOrientationGravityTasks] "
-                                                    "Error in updating the orientation task of "
-                                                    "node {}",
-                                                    node);
-                return false;
-            }
-        } else if (m_GravityTasks.find(node) != m_GravityTasks.end())
-        {
-            if (!updateGravityTask(node, data.I_R_IMU))
-            {
-                BiomechanicalAnalysis::log()->error("[HumanIK::updateOrientationGravityTasks] "
-                                                    "Error in updating the gravity task of node {}",
-                                                    node);
-                return false;
-            }
-        } else
+        if (!updateOrientationOrGravityTask(node, data.I_R_IMU, data.I_omega_IMU))
         {
-            BiomechanicalAnalysis::log()->error("[HumanIK::updateOrientationGravityTasks] "
-                                                "Invalid node number {}.",
-                                                node);
             return false;
         }
     }
@@ -468,36 +746,216 @@ bool HumanIK::calibrateAllWithWorld(std::unordered_map<int, nodeData> nodeStruct
     return true;
 }
 
+bool HumanIK::transferStateFrom(const HumanIK& previous)
+{
+    constexpr auto logPrefix = "[HumanIK::transferStateFrom]";
+
+    if (m_kinDyn == nullptr || previous.m_kinDyn == nullptr)
+    {
+        BiomechanicalAnalysis::log()->error("{} Both the HumanIK objects must be initialized.", logPrefix);
+        return false;
+    }
+
+    // calibration of the nodes
+    for (auto& [node, data] : m_OrientationTasks)
+    {
+        const auto it = previous.m_OrientationTasks.find(node);
+        if (it != previous.m_OrientationTasks.end())
+        {
+            data.calibrationMatrix = it->second.calibrationMatrix;
+            data.IMU_R_link = it->second.IMU_R_link;
+        }
+    }
+    for (auto& [node, data] : m_GravityTasks)
+    {
+        const auto it = previous.m_GravityTasks.find(node);
+        if (it != previous.m_GravityTasks.end())
+        {
+            data.calibrationMatrix = it->second.calibrationMatrix;
+            data.IMU_R_link = it->second.IMU_R_link;
+        }
+    }
+
+    // joint state, matched by name since the models may have different joints
+    const iDynTree::Model& model = m_kinDyn->model();
+    const iDynTree::Model& previousModel = previous.m_kinDyn->model();
+    for (iDynTree::JointIndex joint = 0; joint < static_cast<iDynTree::JointIndex>(model.getNrOfJoints()); joint++)
+    {
+        const iDynTree::JointIndex previousJoint = previousModel.getJointIndex(model.getJointName(joint));
+        if (previousJoint == iDynTree::JOINT_INVALID_INDEX || model.getJoint(joint)->getNrOfDOFs() != 1
+            || previousModel.getJoint(previousJoint)->getNrOfDOFs() != 1)
+        {
+            continue;
+        }
+        const std::size_t dof = model.getJoint(joint)->getDOFsOffset();
+        const std::size_t previousDof = previousModel.getJoint(previousJoint)->getDOFsOffset();
+        m_jointPositions(dof) = previous.m_jointPositions(previousDof);
+        m_jointVelocities(dof) = previous.m_jointVelocities(previousDof);
+    }
+    m_basePose = previous.m_basePose;
+    m_baseVelocity = previous.m_baseVelocity;
+    m_tPose = previous.m_tPose;
+
+    m_system.dynamics->setState({m_basePose.topRightCorner<3, 1>(), toManifRot(m_basePose.topLeftCorner<3, 3>()), m_jointPositions});
+    m_kinDyn->setRobotState(m_basePose, m_jointPositions, m_baseVelocity, m_jointVelocities, m_gravity);
+
+    // contact state of the feet, the weight of the tasks follows it as in updateFloorContactTask
+    for (auto& [node, data] : m_FloorContactTasks)
+    {
+        const auto it = previous.m_FloorContactTasks.find(node);
+        if (it == previous.m_FloorContactTasks.end())
+        {
+            continue;
+        }
+        data.footInContact = it->second.footInContact;
+        data.setPointPosition = it->second.setPointPosition;
+        const Eigen::Vector3d weight = data.footInContact ? data.weight : Eigen::Vector3d::Zero().eval();
+        setTaskWeight(data.taskName, weight);
+        if (data.footInContact)
+        {
+            data.task->setSetPoint(data.setPointPosition);
+        }
+    }
+
+    return true;
+}
+
+bool HumanIK::setState(Eigen::Ref<const Eigen::VectorXd> jointPositions, Eigen::Ref<const Eigen::Matrix3d> baseOrientation)
+{
+    constexpr auto logPrefix = "[HumanIK::setState]";
+
+    if (m_kinDyn == nullptr)
+    {
+        BiomechanicalAnalysis::log()->error("{} The HumanIK object is not initialized.", logPrefix);
+        return false;
+    }
+    if (jointPositions.size() != m_jointPositions.size())
+    {
+        BiomechanicalAnalysis::log()->error("{} Invalid size of the joint positions, expected {}, got {}.",
+                                            logPrefix,
+                                            m_jointPositions.size(),
+                                            jointPositions.size());
+        return false;
+    }
+
+    Eigen::Matrix4d basePose = m_basePose;
+    basePose.topLeftCorner<3, 3>() = baseOrientation;
+    resetState(jointPositions, basePose);
+
+    return true;
+}
+
+void HumanIK::resetState(Eigen::Ref<const Eigen::VectorXd> jointPositions, const Eigen::Matrix4d& basePose)
+{
+    m_jointPositions = jointPositions;
+    m_jointVelocities.setZero();
+    m_basePose = basePose;
+    m_baseVelocity.setZero();
+
+    m_system.dynamics->setState({m_basePose.topRightCorner<3, 1>(), toManifRot(m_basePose.topLeftCorner<3, 3>()), m_jointPositions});
+    m_kinDyn->setRobotState(m_basePose, m_jointPositions, m_baseVelocity, m_jointVelocities, m_gravity);
+}
+
+bool HumanIK::resetToLastGoodState()
+{
+    if (m_kinDyn == nullptr)
+    {
+        BiomechanicalAnalysis::log()->error("[HumanIK::resetToLastGoodState] The HumanIK object is not initialized.");
+        return false;
+    }
+
+    // advance() updates the state only if the solver did not diverge, hence the current state is
+    // the last good one
+    resetState(m_jointPositions, m_basePose);
+
+    return true;
+}
+
+bool HumanIK::resetToCalibrationPose()
+{
+    if (m_kinDyn == nullptr)
+    {
+        BiomechanicalAnalysis::log()->error("[HumanIK::resetToCalibrationPose] The HumanIK object is not initialized.");
+        return false;
+    }
+
+    resetState(m_calibrationJointPositions, Eigen::Matrix4d::Identity());
+
+    return true;
+}
+
+std::size_t HumanIK::getNrOfDivergences() const
+{
+    return m_nrOfDivergences;
+}
+
+bool HumanIK::areVelocitiesPlausible() const
+{
+    // the comparisons are false for NaN
+    return (m_jointVelocities.array().abs() <= m_maxJointVelocity).all()
+           && m_baseVelocity.head<3>().norm() <= m_maxBaseLinearVelocity
+           && m_baseVelocity.tail<3>().norm() <= m_maxBaseAngularVelocity;
+}
+
 bool HumanIK::advance()
 {
     // Initialize ok flag to true
     bool ok{true};
 
+    // The set points of the tasks have been computed, the nodes of the next frame are fused from
+    // scratch, so that a node that stops sending does not weight the mean anymore
+    for (auto& [node, data] : m_OrientationTasks)
+    {
+        if (data.primaryNode && data.fusion != nullptr)
+        {
+            std::fill(data.fusion->valid.begin(), data.fusion->valid.end(), false);
+        }
+    }
+
     // Advance the QP solver
     ok = ok && m_qpIK.advance();
     // Check if the output of the QP solver is valid
     ok = ok && m_qpIK.isOutputValid();
 
-    // If there's an error in the QP solver, log an error and return false
+    // If there's an error in the QP solver, log an error, restart from the last good state and
+    // return false
     if (!ok)
     {
-        BiomechanicalAnalysis::log()->error("[HumanIK::advance] Error in the QP solver.");
+        BiomechanicalAnalysis::log()->error("[HumanIK::advance] Error in the QP solver, resetting to the last good state.");
+        m_nrOfDivergences++;
+        resetToLastGoodState();
         return false;
     }
 
+    // The kinDyn object still contains the state used by the QP
+    updateTaskResiduals();
+
     // Get joint velocities and base velocities from the QP solver output
     m_jointVelocities = m_qpIK.getOutput().jointVelocity;
     m_baseVelocity = m_qpIK.getOutput().baseVelocity.coeffs();
 
+    // An IMU glitch can drive the QP to NaN or implausible velocities, in that case the state is
+    // not integrated
+    if (!areVelocitiesPlausible())
+    {
+        BiomechanicalAnalysis::log()->error("[HumanIK::advance] Implausible velocities, resetting to the last good state.");
+        m_nrOfDivergences++;
+        resetToLastGoodState();
+        return false;
+    }
+
     // Set control input to the system dynamics
     ok = ok && m_system.dynamics->setControlInput({m_baseVelocity, m_jointVelocities});
     // Integrate the system dynamics
     ok = ok && m_system.integrator->integrate(0s, m_dtIntegration);
 
-    // If there's an error in the integration, log an error and return false
+    // If there's an error in the integration, log an error, restart from the last good state and
+    // return false
     if (!ok)
     {
-        BiomechanicalAnalysis::log()->error("[HumanIK::advance] Error in the integration.");
+        BiomechanicalAnalysis::log()->error("[HumanIK::advance] Error in the integration, resetting to the last good state.");
+        m_nrOfDivergences++;
+        resetToLastGoodState();
         return false;
     }
 
@@ -512,6 +970,13 @@ bool HumanIK::advance()
 
     // Get the solution (base position, base rotation, joint positions) from the integrator
     const auto& [basePosition, baseRotation, jointPosition] = m_system.integrator->getSolution();
+    if (!basePosition.allFinite() || !baseRotation.coeffs().allFinite() || !jointPosition.allFinite())
+    {
+        BiomechanicalAnalysis::log()->error("[HumanIK::advance] The integrated state is not finite, resetting to the last good state.");
+        m_nrOfDivergences++;
+        resetToLastGoodState();
+        return false;
+    }
     // Update the base pose and joint positions
     m_basePose.topRightCorner<3, 1>() = basePosition;
     m_basePose.topLeftCorner<3, 3>() = baseRotation.rotation();
@@ -587,6 +1052,62 @@ bool HumanIK::getBaseAngularVelocity(Eigen::Ref<Eigen::Vector3d> baseAngularVelo
     return true;
 }
 
+const Eigen::VectorXd& HumanIK::getTaskResiduals() const
+{
+    return m_taskResiduals;
+}
+
+const std::vector<std::string>& HumanIK::getTaskResidualNames() const
+{
+    return m_taskResidualNames;
+}
+
+bool HumanIK::addTaskResidual(const std::string& taskName,
+                              const std::string& frameName,
+                              iDynTree::FrameIndex& frameIndex,
+                              std::size_t& residualIndex)
+{
+    // the index avoids the lookup of the frame name at each iteration
+    frameIndex = m_kinDyn->model().getFrameIndex(frameName);
+    if (frameIndex == iDynTree::FRAME_INVALID_INDEX)
+    {
+        BiomechanicalAnalysis::log()->error("[HumanIK::addTaskResidual] Frame {} of the {} task not found in the model", frameName, taskName);
+        return false;
+    }
+    residualIndex = m_taskResidualNames.size();
+    m_taskResidualNames.push_back(taskName);
+    return true;
+}
+
+void HumanIK::updateTaskResiduals()
+{
+    // the world transforms are cached by kinDyn, since the forward kinematics has been computed
+    // by the tasks during the QP update
+    for (const auto& [node, data] : m_OrientationTasks)
+    {
+        if (!data.primaryNode)
+        {
+            continue;
+        }
+        const manif::SO3d& setPoint = data.fusion == nullptr ? data.setPoint : data.fusion->setPoint;
+        const manif::SO3d I_R_frame = toManifRot(iDynTree::toEigen(m_kinDyn->getWorldTransform(data.frameIndex).getRotation()));
+        m_taskResiduals(data.residualIndex) = (I_R_frame - setPoint).coeffs().norm();
+    }
+    for (const auto& [node, data] : m_GravityTasks)
+    {
+        // direction of the world z axis in the frame of the task
+        const Eigen::Vector3d frame_z = iDynTree::toEigen(m_kinDyn->getWorldTransform(data.frameIndex).getRotation()).bottomRows<1>().transpose();
+        m_taskResiduals(data.residualIndex) = std::atan2(frame_z.cross(data.setPoint).norm(), frame_z.dot(data.setPoint));
+    }
+    for (const auto& [node, data] : m_FloorContactTasks)
+    {
+        m_taskResiduals(data.residualIndex)
+            = data.footInContact
+                  ? (iDynTree::toEigen(m_kinDyn->getWorldTransform(data.frameIndex).getPosition()) - data.setPointPosition).norm()
+                  : 0.0;
+    }
+}
+
 bool HumanIK::initializeOrientationTask(const std::string& taskName,
                                         const std::shared_ptr<BipedalLocomotion::ParametersHandler::IParametersHandler> taskHandler)
 {
@@ -604,6 +1125,14 @@ bool HumanIK::initializeOrientationTask(const std::string& taskName,
         BiomechanicalAnalysis::log()->error("{} Parameter node_number of the {} task is missing", logPrefix, taskName);
         return false;
     }
+    if (isAdditionalNode(nodeNumber))
+    {
+        BiomechanicalAnalysis::log()->error("{} The node {} of the {} task is an additional node of a SO3 task",
+                                            logPrefix,
+                                            nodeNumber,
+                                            taskName);
+        return false;
+    }
 
     // Retrieve frame name parameter from config file, using the task handler
     if (!taskHandler->getParameter("frame_name", m_OrientationTasks[nodeNumber].frameName))
@@ -672,6 +1201,11 @@ bool HumanIK::initializeOrientationTask(const std::string& taskName,
 
     // Add the orientation task to the QP solver
     ok = ok && m_qpIK.addTask(m_OrientationTasks[nodeNumber].task, taskName, 1, m_OrientationTasks[nodeNumber].weight);
+    ok = ok
+         && addTaskResidual(taskName,
+                            m_OrientationTasks[nodeNumber].frameName,
+                            m_OrientationTasks[nodeNumber].frameIndex,
+                            m_OrientationTasks[nodeNumber].residualIndex);
 
     // Check if initialization was successful
     if (!ok)
@@ -680,7 +1214,54 @@ bool HumanIK::initializeOrientationTask(const std::string& taskName,
         return false;
     }
 
-    return ok;
+    // Retrieve the other IMUs of the link, fused in the set point of the same task
+    std::vector<int> additionalNodes;
+    if (!taskHandler->getParameter("additional_node_numbers", additionalNodes) || additionalNodes.empty())
+    {
+        return true;
+    }
+
+    std::vector<double> nodeWeights(additionalNodes.size() + 1, 1.0);
+    if (taskHandler->getParameter("node_weights", nodeWeights) && nodeWeights.size() != additionalNodes.size() + 1)
+    {
+        BiomechanicalAnalysis::log()->error("{} The size of the parameter node_weights of the {} task is {}, it should be {}",
+                                            logPrefix,
+                                            taskName,
+                                            nodeWeights.size(),
+                                            additionalNodes.size() + 1);
+        return false;
+    }
+    if (std::any_of(nodeWeights.begin(), nodeWeights.end(), [](double w) { return w <= 0.0; }))
+    {
+        BiomechanicalAnalysis::log()->error("{} The node_weights of the {} task must be positive", logPrefix, taskName);
+        return false;
+    }
+
+    auto fusion = std::make_shared<OrientationFusion>();
+    fusion->weights = nodeWeights;
+    fusion->I_R_link.assign(nodeWeights.size(), manif::SO3d::Identity());
+    fusion->I_omega_link.assign(nodeWeights.size(), Eigen::Vector3d::Zero());
+    fusion->valid.assign(nodeWeights.size(), false);
+    m_OrientationTasks[nodeNumber].fusion = fusion;
+
+    for (std::size_t i = 0; i < additionalNodes.size(); i++)
+    {
+        if (m_OrientationTasks.find(additionalNodes[i]) != m_OrientationTasks.end()
+            || m_GravityTasks.find(additionalNodes[i]) != m_GravityTasks.end()
+            || m_FloorContactTasks.find(additionalNodes[i]) != m_FloorContactTasks.end())
+        {
+            BiomechanicalAnalysis::log()->error("{} The node {} of the {} task belongs to another task", logPrefix, additionalNodes[i], taskName);
+            return false;
+        }
+        // the additional nodes share the task and have their own calibration
+        OrientationTaskStruct node = m_OrientationTasks[nodeNumber];
+        node.nodeNumber = additionalNodes[i];
+        node.fusionSlot = i + 1;
+        node.primaryNode = false;
+        m_OrientationTasks[additionalNodes[i]] = node;
+    }
+
+    return true;
 }
 
 bool HumanIK::initializeGravityTask(const std::string& taskName,
@@ -704,6 +1285,14 @@ bool HumanIK::initializeGravityTask(const std::string& taskName,
         BiomechanicalAnalysis::log()->error("{} Parameter node_number of the {} task is missing", logPrefix, taskName);
         return false;
     }
+    if (isAdditionalNode(nodeNumber))
+    {
+        BiomechanicalAnalysis::log()->error("{} The node {} of the {} task is an additional node of a SO3 task",
+                                            logPrefix,
+                                            nodeNumber,
+                                            taskName);
+        return false;
+    }
 
     // Retrieve frame name parameter from the config file, using the task handler
     if (!taskHandler->getParameter("target_frame_name", m_GravityTasks[nodeNumber].frameName))
@@ -774,6 +1363,11 @@ bool HumanIK::initializeGravityTask(const std::string& taskName,
 
     // Add the gravity task to the QP solver
     ok = ok && m_qpIK.addTask(m_GravityTasks[nodeNumber].task, taskName, 1, m_GravityTasks[nodeNumber].weight);
+    ok = ok
+         && addTaskResidual(taskName,
+                            m_GravityTasks[nodeNumber].frameName,
+                            m_GravityTasks[nodeNumber].frameIndex,
+                            m_GravityTasks[nodeNumber].residualIndex);
 
     // Check if initialization was successful
     return ok;
@@ -796,6 +1390,14 @@ bool HumanIK::initializeFloorContactTask(const std::string& taskName,
         BiomechanicalAnalysis::log()->error("{} Parameter node_number of the {} task is missing", logPrefix, taskName);
         return false;
     }
+    if (isAdditionalNode(nodeNumber))
+    {
+        BiomechanicalAnalysis::log()->error("{} The node {} of the {} task is an additional node of a SO3 task",
+                                            logPrefix,
+                                            nodeNumber,
+                                            taskName);
+        return false;
+    }
 
     // Retrieve frame name parameter from the task handler and assign it to the corresponding
     // FloorContactTask
@@ -851,6 +1453,11 @@ bool HumanIK::initializeFloorContactTask(const std::string& taskName,
 
     // Add the floor contact task to the QP solver
     ok = ok && m_qpIK.addTask(m_FloorContactTasks[nodeNumber].task, taskName, 1, m_FloorContactTasks[nodeNumber].weight);
+    ok = ok
+         && addTaskResidual(taskName,
+                            m_FloorContactTasks[nodeNumber].frameName,
+                            m_FloorContactTasks[nodeNumber].frameIndex,
+                            m_FloorContactTasks[nodeNumber].residualIndex);
 
     // Check if initialization was successful
     return ok;
@@ -886,12 +1493,15 @@ bool HumanIK::initializeJointRegularizationTask(const std::string& taskName,
     ok = ok && m_jointRegularizationTask->setKinDyn(m_kinDyn);
     ok = ok && m_jointRegularizationTask->initialize(taskHandler);
 
-    // Create a weight vector with constant values based on the weight parameter
-    Eigen::VectorXd weightVector(m_kinDyn->getNrOfDegreesOfFreedom());
-    weightVector.setConstant(weight);
+    // Create a weight vector with constant values based on the weight parameter, it is stored to
+    // enable the task again after it has been disabled
+    m_jointRegularizationWeight.resize(m_kinDyn->getNrOfDegreesOfFreedom());
+    m_jointRegularizationWeight.setConstant(weight);
+    m_jointRegularizationTaskName = taskName;
 
     // Add the joint regularization task to the QP solver with the specified weight vector
-    ok = ok && m_qpIK.addTask(m_jointRegularizationTask, taskName, 1, weightVector);
+    ok = ok && m_qpIK.addTask(m_jointRegularizationTask, taskName, 1, m_jointRegularizationWeight);
+    m_jointRegularizationEnabled = true;
 
     // Return true if initialization was successful, otherwise return false
     return ok;
@@ -1070,8 +1680,10 @@ bool HumanIK::initializeJointVelocityLimitsTask(const std::string& taskName,
     // Initialize the JointVelocityLimitsTask object
     ok = ok && m_jointVelocityLimitsTask->initialize(taskHandler);
 
-    // Add the joint velocity limits task to the QP solver
-    ok = ok && m_qpIK.addTask(m_jointVelocityLimitsTask, taskName, 0);
+    // Add the joint velocity limits task to the QP solver through a switch, so that it can be
+    // disabled without changing the structure of the QP
+    m_jointVelocityLimitsSwitch = std::make_shared<SwitchableInequalityTask>(m_jointVelocityLimitsTask);
+    ok = ok && m_qpIK.addTask(m_jointVelocityLimitsSwitch, taskName, 0);
 
     // Return true if initialization was successful, otherwise return false
     return ok;
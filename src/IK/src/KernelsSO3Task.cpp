@@ -0,0 +1,155 @@
+#include <BiomechanicalAnalysis/IK/KernelsSO3Task.h>
+#include <BiomechanicalAnalysis/Logging/Logger.h>
+
+#include <iDynTree/EigenHelpers.h>
+
+#include <algorithm>
+
+using namespace BiomechanicalAnalysis::IK;
+
+bool KernelsSO3Task::setKinDynAndKernels(std::shared_ptr<iDynTree::KinDynComputations> kinDyn, LinkKinematicsKernels kernels)
+{
+    constexpr auto logPrefix = "[KernelsSO3Task::setKinDynAndKernels]";
+
+    if ((kinDyn == nullptr) || (!kinDyn->isValid()))
+    {
+        BiomechanicalAnalysis::log()->error("{} Invalid kinDyn object.", logPrefix);
+        return false;
+    }
+    if (kinDyn->getFrameVelocityRepresentation() != iDynTree::FrameVelocityRepresentation::MIXED_REPRESENTATION)
+    {
+        BiomechanicalAnalysis::log()->error("{} The velocity representation of the kinDyn object must be MIXED.", logPrefix);
+        return false;
+    }
+    if (!kernels.computeLinkKinematics || (kernels.nrOfDOFs != kinDyn->getNrOfDegreesOfFreedom()))
+    {
+        BiomechanicalAnalysis::log()->error("{} The kernels have {} degrees of freedom, while the model of the kinDyn object has {}.",
+                                            logPrefix,
+                                            kernels.nrOfDOFs,
+                                            kinDyn->getNrOfDegreesOfFreedom());
+        return false;
+    }
+
+    m_kinDyn = std::move(kinDyn);
+    m_kernels = std::move(kernels);
+    m_jointPositions.resize(m_kernels.nrOfDOFs);
+    m_jacobian.resize(6, 6 + m_kernels.nrOfDOFs);
+    return true;
+}
+
+bool KernelsSO3Task::initialize(std::weak_ptr<const BipedalLocomotion::ParametersHandler::IParametersHandler> paramHandler)
+{
+    constexpr auto logPrefix = "[KernelsSO3Task::initialize]";
+
+    m_isInitialized = false;
+    if (m_kinDyn == nullptr)
+    {
+        BiomechanicalAnalysis::log()->error("{} Call setKinDynAndKernels before initializing the task.", logPrefix);
+        return false;
+    }
+
+    auto ptr = paramHandler.lock();
+    if (ptr == nullptr)
+    {
+        BiomechanicalAnalysis::log()->error("{} Invalid parameters handler.", logPrefix);
+        return false;
+    }
+
+    std::string frameName;
+    if (!ptr->getParameter("robot_velocity_variable_name", m_robotVelocityVariableName) || !ptr->getParameter("frame_name", frameName)
+        || !ptr->getParameter("kp_angular", m_kp))
+    {
+        BiomechanicalAnalysis::log()->error("{} Unable to get the parameters robot_velocity_variable_name, frame_name and kp_angular.",
+                                            logPrefix);
+        return false;
+    }
+
+    const auto link = std::find(m_kernels.linkNames.begin(), m_kernels.linkNames.end(), frameName);
+    if (link == m_kernels.linkNames.end())
+    {
+        BiomechanicalAnalysis::log()->error("{} The frame {} is not a link of the kernels.", logPrefix, frameName);
+        return false;
+    }
+    m_linkIndex = static_cast<std::size_t>(std::distance(m_kernels.linkNames.begin(), link));
+
+    m_description = "KernelsSO3Task Optimal Control Element - Frame name: " + frameName;
+    m_isInitialized = true;
+    return true;
+}
+
+bool KernelsSO3Task::setVariablesHandler(const BipedalLocomotion::System::VariablesHandler& variablesHandler)
+{
+    constexpr auto logPrefix = "[KernelsSO3Task::setVariablesHandler]";
+
+    if (!m_isInitialized)
+    {
+        BiomechanicalAnalysis::log()->error("{} The task is not initialized.", logPrefix);
+        return false;
+    }
+    if (!variablesHandler.getVariable(m_robotVelocityVariableName, m_robotVelocityVariable))
+    {
+        BiomechanicalAnalysis::log()->error("{} Unable to get the variable {}.", logPrefix, m_robotVelocityVariableName);
+        return false;
+    }
+    if (m_robotVelocityVariable.size != m_jacobian.cols())
+    {
+        BiomechanicalAnalysis::log()->error("{} The size of the variable {} is {}, while the model has {} degrees of freedom.",
+                                            logPrefix,
+                                            m_robotVelocityVariableName,
+                                            m_robotVelocityVariable.size,
+                                            m_kernels.nrOfDOFs);
+        return false;
+    }
+
+    m_A.setZero(3, variablesHandler.getNumberOfVariables());
+    m_b.setZero(3);
+    return true;
+}
+
+bool KernelsSO3Task::update()
+{
+    m_isValid = false;
+    if (!m_isInitialized)
+    {
+        BiomechanicalAnalysis::log()->error("[KernelsSO3Task::update] The task is not initialized.");
+        return false;
+    }
+
+    m_world_H_base.matrix() = iDynTree::toEigen(m_kinDyn->getWorldBaseTransform().asHomogeneousTransform());
+    if (!m_kinDyn->getJointPos(iDynTree::make_span(m_jointPositions)))
+    {
+        BiomechanicalAnalysis::log()->error("[KernelsSO3Task::update] Unable to get the joint positions.");
+        return false;
+    }
+
+    m_kernels.computeLinkKinematics(m_world_H_base, m_jointPositions, m_linkIndex, m_world_H_link, m_jacobian);
+
+    m_A.middleCols(m_robotVelocityVariable.offset, m_robotVelocityVariable.size) = m_jacobian.bottomRows<3>();
+    const manif::SO3d I_R_F(Eigen::Quaterniond(m_world_H_link.linear()));
+    m_b = m_angularVelocity.coeffs() + m_kp * (m_setPoint * I_R_F.inverse()).log().coeffs();
+
+    m_isValid = true;
+    return true;
+}
+
+bool KernelsSO3Task::setSetPoint(const manif::SO3d& I_R_F, const manif::SO3d::Tangent& angularVelocity)
+{
+    m_setPoint = I_R_F;
+    m_angularVelocity = angularVelocity;
+    return true;
+}
+
+std::size_t KernelsSO3Task::size() const
+{
+    return 3;
+}
+
+KernelsSO3Task::Type KernelsSO3Task::type() const
+{
+    return Type::equality;
+}
+
+bool KernelsSO3Task::isValid() const
+{
+    return m_isValid;
+}
@@ -0,0 +1,328 @@
+#include <BiomechanicalAnalysis/IK/SurrogateIK.h>
+#include <BiomechanicalAnalysis/Logging/Logger.h>
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+using namespace BiomechanicalAnalysis::IK;
+
+namespace
+{
+
+constexpr std::size_t rotationSize = 9;
+
+// closest rotation matrix in the Frobenius norm
+Eigen::Matrix3d projectOnSO3(const Eigen::Matrix3d& matrix)
+{
+    const Eigen::JacobiSVD<Eigen::Matrix3d> svd(matrix, Eigen::ComputeFullU | Eigen::ComputeFullV);
+    Eigen::Vector3d signs(1.0, 1.0, (svd.matrixU() * svd.matrixV().transpose()).determinant() < 0.0 ? -1.0 : 1.0);
+    return svd.matrixU() * signs.asDiagonal() * svd.matrixV().transpose();
+}
+
+double rotationDistance(const Eigen::Matrix3d& first, const Eigen::Matrix3d& second)
+{
+    const double cosine = 0.5 * ((first.transpose() * second).trace() - 1.0);
+    return std::acos(std::clamp(cosine, -1.0, 1.0));
+}
+
+} // namespace
+
+bool SurrogateIK::initialize(std::weak_ptr<const BipedalLocomotion::ParametersHandler::IParametersHandler> handler)
+{
+    constexpr auto logPrefix = "[SurrogateIK::initialize]";
+
+    auto ptr = handler.lock();
+    if (ptr == nullptr)
+    {
+        BiomechanicalAnalysis::log()->error("{} Invalid parameters handler.", logPrefix);
+        return false;
+    }
+
+    if (!ptr->getParameter("node_numbers", m_nodeNumbers) || m_nodeNumbers.empty())
+    {
+        BiomechanicalAnalysis::log()->error("{} Parameter node_numbers is missing or empty.", logPrefix);
+        return false;
+    }
+
+    int randomFeatures{256};
+    double kernelBandwidth{1.0};
+    int seed{0};
+    m_regularization = 1e-6;
+    ptr->getParameter("random_features", randomFeatures);
+    ptr->getParameter("kernel_bandwidth", kernelBandwidth);
+    ptr->getParameter("regularization", m_regularization);
+    ptr->getParameter("seed", seed);
+    if (randomFeatures < 0)
+    {
+        BiomechanicalAnalysis::log()->error("{} random_features must be non-negative.", logPrefix);
+        return false;
+    }
+    if (kernelBandwidth <= 0.0 || m_regularization <= 0.0)
+    {
+        BiomechanicalAnalysis::log()->error("{} kernel_bandwidth and regularization must be positive.", logPrefix);
+        return false;
+    }
+
+    // Random Fourier features of a Gaussian kernel, sqrt(2 / F) cos(w^T x + b) with w ~ N(0, I /
+    // bandwidth^2) and b ~ U(0, 2 pi)
+    const std::size_t inputSize = rotationSize * m_nodeNumbers.size();
+    std::mt19937 generator(static_cast<std::mt19937::result_type>(seed));
+    std::normal_distribution<double> frequency(0.0, 1.0 / kernelBandwidth);
+    std::uniform_real_distribution<double> phase(0.0, 2.0 * M_PI);
+    m_projection.resize(randomFeatures, inputSize);
+    m_phases.resize(randomFeatures);
+    for (int i = 0; i < randomFeatures; i++)
+    {
+        for (std::size_t j = 0; j < inputSize; j++)
+        {
+            m_projection(i, j) = frequency(generator);
+        }
+        m_phases(i) = phase(generator);
+    }
+
+    m_input.resize(inputSize);
+    m_features.resize(1 + inputSize + randomFeatures);
+    m_normalMatrix = Eigen::MatrixXd::Zero(m_features.size(), m_features.size());
+    m_normalTarget.resize(m_features.size(), 0);
+    m_weights.resize(m_features.size(), 0);
+    m_nrOfJoints = 0;
+    m_nrOfSamples = 0;
+    m_calibratedInput = false;
+    m_trained = false;
+    resetError();
+
+    return true;
+}
+
+bool SurrogateIK::computeFeatures(const std::unordered_map<int, nodeData>& nodeStruct, const HumanIK* ik)
+{
+    for (std::size_t i = 0; i < m_nodeNumbers.size(); i++)
+    {
+        const auto it = nodeStruct.find(m_nodeNumbers[i]);
+        if (it == nodeStruct.end())
+        {
+            BiomechanicalAnalysis::log()->error("[SurrogateIK::computeFeatures] Node {} is missing.", m_nodeNumbers[i]);
+            return false;
+        }
+        if (ik == nullptr)
+        {
+            m_nodeOrientation = it->second.I_R_IMU;
+        } else if (!ik->getCalibratedNodeOrientation(m_nodeNumbers[i], it->second.I_R_IMU, m_nodeOrientation))
+        {
+            BiomechanicalAnalysis::log()->error("[SurrogateIK::computeFeatures] Unable to calibrate the orientation of node {}.",
+                                                m_nodeNumbers[i]);
+            return false;
+        }
+        const Eigen::Matrix3d I_R_node = m_nodeOrientation.rotation();
+        m_input.segment<rotationSize>(rotationSize * i) = Eigen::Map<const Eigen::Matrix<double, rotationSize, 1>>(I_R_node.data());
+    }
+
+    const Eigen::Index randomFeatures = m_phases.size();
+    m_features(0) = 1.0;
+    m_features.segment(1, m_input.size()) = m_input;
+    if (randomFeatures > 0)
+    {
+        auto random = m_features.tail(randomFeatures);
+        random.noalias() = m_projection * m_input;
+        random = std::sqrt(2.0 / static_cast<double>(randomFeatures)) * (random + m_phases).array().cos().matrix();
+    }
+    return true;
+}
+
+bool SurrogateIK::addSample(const std::unordered_map<int, nodeData>& nodeStruct,
+                            Eigen::Ref<const Eigen::VectorXd> jointPositions,
+                            Eigen::Ref<const Eigen::Matrix3d> baseOrientation)
+{
+    return addSample(nodeStruct, nullptr, jointPositions, baseOrientation);
+}
+
+bool SurrogateIK::addSample(const std::unordered_map<int, nodeData>& nodeStruct,
+                            const HumanIK* ik,
+                            Eigen::Ref<const Eigen::VectorXd> jointPositions,
+                            Eigen::Ref<const Eigen::Matrix3d> baseOrientation)
+{
+    constexpr auto logPrefix = "[SurrogateIK::addSample]";
+
+    if (m_nodeNumbers.empty())
+    {
+        BiomechanicalAnalysis::log()->error("{} The regressor is not initialized.", logPrefix);
+        return false;
+    }
+    if (m_nrOfSamples > 0 && m_calibratedInput != (ik != nullptr))
+    {
+        BiomechanicalAnalysis::log()->error("{} The samples must be all added either with or without the HumanIK object.", logPrefix);
+        return false;
+    }
+    if (m_nrOfSamples == 0)
+    {
+        m_calibratedInput = ik != nullptr;
+        m_nrOfJoints = jointPositions.size();
+        m_target.resize(m_nrOfJoints + rotationSize);
+        m_normalTarget = Eigen::MatrixXd::Zero(m_features.size(), m_target.size());
+        m_output.resize(m_target.size());
+        m_jointPositions.resize(m_nrOfJoints);
+        m_predictedJointPositions.resize(m_nrOfJoints);
+    } else if (static_cast<std::size_t>(jointPositions.size()) != m_nrOfJoints)
+    {
+        BiomechanicalAnalysis::log()->error("{} Invalid size of the joint positions, expected {}, got {}.",
+                                            logPrefix,
+                                            m_nrOfJoints,
+                                            jointPositions.size());
+        return false;
+    }
+    if (!computeFeatures(nodeStruct, ik))
+    {
+        BiomechanicalAnalysis::log()->error("{} Error computing the features.", logPrefix);
+        return false;
+    }
+
+    m_target.head(m_nrOfJoints) = jointPositions;
+    m_baseOrientation = baseOrientation;
+    m_target.tail<rotationSize>() = Eigen::Map<const Eigen::Matrix<double, rotationSize, 1>>(m_baseOrientation.data());
+    m_normalMatrix.selfadjointView<Eigen::Lower>().rankUpdate(m_features);
+    m_normalTarget.noalias() += m_features * m_target.transpose();
+    m_nrOfSamples++;
+
+    return true;
+}
+
+bool SurrogateIK::addSample(const std::unordered_map<int, nodeData>& nodeStruct, const HumanIK& ik)
+{
+    m_jointPositions.resize(ik.getDoFsNumber());
+    return ik.getJointPositions(m_jointPositions) && ik.getBaseOrientation(m_baseOrientation)
+           && addSample(nodeStruct, &ik, m_jointPositions, m_baseOrientation);
+}
+
+bool SurrogateIK::train()
+{
+    constexpr auto logPrefix = "[SurrogateIK::train]";
+
+    if (m_nrOfSamples == 0)
+    {
+        BiomechanicalAnalysis::log()->error("{} No samples have been added.", logPrefix);
+        return false;
+    }
+
+    // The regularization is relative to the number of samples, so that it does not depend on the
+    // length of the recording
+    Eigen::MatrixXd normalMatrix = m_normalMatrix.selfadjointView<Eigen::Lower>();
+    normalMatrix.diagonal().array() += m_regularization * static_cast<double>(m_nrOfSamples);
+    const Eigen::LLT<Eigen::MatrixXd> factorization(normalMatrix);
+    if (factorization.info() != Eigen::Success)
+    {
+        BiomechanicalAnalysis::log()->error("{} Error factorizing the normal equations.", logPrefix);
+        return false;
+    }
+    m_weights = factorization.solve(m_normalTarget);
+    m_trained = true;
+
+    return true;
+}
+
+std::size_t SurrogateIK::getNrOfSamples() const
+{
+    return m_nrOfSamples;
+}
+
+bool SurrogateIK::isTrained() const
+{
+    return m_trained;
+}
+
+bool SurrogateIK::predict(const std::unordered_map<int, nodeData>& nodeStruct,
+                          Eigen::Ref<Eigen::VectorXd> jointPositions,
+                          Eigen::Ref<Eigen::Matrix3d> baseOrientation)
+{
+    return predict(nodeStruct, nullptr, jointPositions, baseOrientation);
+}
+
+bool SurrogateIK::predict(const std::unordered_map<int, nodeData>& nodeStruct,
+                          const HumanIK& ik,
+                          Eigen::Ref<Eigen::VectorXd> jointPositions,
+                          Eigen::Ref<Eigen::Matrix3d> baseOrientation)
+{
+    return predict(nodeStruct, &ik, jointPositions, baseOrientation);
+}
+
+bool SurrogateIK::predict(const std::unordered_map<int, nodeData>& nodeStruct,
+                          const HumanIK* ik,
+                          Eigen::Ref<Eigen::VectorXd> jointPositions,
+                          Eigen::Ref<Eigen::Matrix3d> baseOrientation)
+{
+    constexpr auto logPrefix = "[SurrogateIK::predict]";
+
+    if (!m_trained)
+    {
+        BiomechanicalAnalysis::log()->error("{} The regressor is not trained.", logPrefix);
+        return false;
+    }
+    if (m_calibratedInput != (ik != nullptr))
+    {
+        BiomechanicalAnalysis::log()->error("{} The regressor has been trained {} the HumanIK object, it must predict {} it as well.",
+                                            logPrefix,
+                                            m_calibratedInput ? "with" : "without",
+                                            m_calibratedInput ? "with" : "without");
+        return false;
+    }
+    if (static_cast<std::size_t>(jointPositions.size()) != m_nrOfJoints)
+    {
+        BiomechanicalAnalysis::log()->error("{} Invalid size of the joint positions, expected {}, got {}.",
+                                            logPrefix,
+                                            m_nrOfJoints,
+                                            jointPositions.size());
+        return false;
+    }
+    if (!computeFeatures(nodeStruct, ik))
+    {
+        BiomechanicalAnalysis::log()->error("{} Error computing the features.", logPrefix);
+        return false;
+    }
+
+    m_output.noalias() = m_weights.transpose() * m_features;
+    jointPositions = m_output.head(m_nrOfJoints);
+    baseOrientation = projectOnSO3(Eigen::Map<const Eigen::Matrix3d>(m_output.data() + m_nrOfJoints));
+
+    return true;
+}
+
+bool SurrogateIK::monitor(const std::unordered_map<int, nodeData>& nodeStruct, const HumanIK& ik)
+{
+    constexpr auto logPrefix = "[SurrogateIK::monitor]";
+
+    if (!predict(nodeStruct, &ik, m_predictedJointPositions, m_predictedBaseOrientation))
+    {
+        BiomechanicalAnalysis::log()->error("{} Error computing the prediction.", logPrefix);
+        return false;
+    }
+    if (static_cast<std::size_t>(ik.getDoFsNumber()) != m_nrOfJoints || !ik.getJointPositions(m_jointPositions)
+        || !ik.getBaseOrientation(m_baseOrientation))
+    {
+        BiomechanicalAnalysis::log()->error("{} Error getting the solution of HumanIK.", logPrefix);
+        return false;
+    }
+
+    m_error.count++;
+    m_error.lastJointError = m_nrOfJoints == 0 ? 0.0 : (m_predictedJointPositions - m_jointPositions).lpNorm<Eigen::Infinity>();
+    m_error.lastBaseOrientationError = rotationDistance(m_predictedBaseOrientation, m_baseOrientation);
+    if (m_nrOfJoints > 0)
+    {
+        m_sumSquaredJointError += (m_predictedJointPositions - m_jointPositions).squaredNorm() / static_cast<double>(m_nrOfJoints);
+    }
+    m_error.rmsJointError = std::sqrt(m_sumSquaredJointError / static_cast<double>(m_error.count));
+    m_error.maxJointError = std::max(m_error.maxJointError, m_error.lastJointError);
+    m_error.maxBaseOrientationError = std::max(m_error.maxBaseOrientationError, m_error.lastBaseOrientationError);
+
+    return true;
+}
+
+const SurrogateIKError& SurrogateIK::getError() const
+{
+    return m_error;
+}
+
+void SurrogateIK::resetError()
+{
+    m_error = SurrogateIKError();
+    m_sumSquaredJointError = 0.0;
+}
@@ -10,6 +10,8 @@
 #include <BipedalLocomotion/ParametersHandler/TomlImplementation.h>
 #include <ConfigFolderPath.h>
 
+#include <algorithm>
+
 TEST_CASE("InverseKinematics test")
 {
     auto kinDyn = std::make_shared<iDynTree::KinDynComputations>();
@@ -55,14 +57,208 @@ TEST_CASE("InverseKinematics test")
     REQUIRE(ik.updateFloorContactTask(10, 11.0));
     REQUIRE(ik.updateGravityTask(10, I_R_IMU));
     REQUIRE(ik.updateOrientationAndGravityTasks(mapNodeData));
+    REQUIRE(ik.updateOrientationOrGravityTask(3, I_R_IMU, I_omega_IMU));
+    REQUIRE(ik.updateOrientationOrGravityTask(10, I_R_IMU));
+    REQUIRE_FALSE(ik.updateOrientationOrGravityTask(100, I_R_IMU));
     REQUIRE(ik.updateJointConstraintsTask());
     REQUIRE(ik.updateJointRegularizationTask());
     REQUIRE(ik.calibrateWorldYaw(mapNodeData));
     REQUIRE(ik.calibrateAllWithWorld(mapNodeData, "link1"));
+
+    // the calibrated orientation of a node does not depend on the world of the IMUs
+    manif::SO3d I_R_link;
+    manif::SO3d I_R_linkRecalibrated;
+    REQUIRE(ik.getCalibratedNodeOrientation(6, mapNodeData[6].I_R_IMU, I_R_link));
+    REQUIRE_FALSE(ik.getCalibratedNodeOrientation(100, I_R_IMU, I_R_linkRecalibrated));
+    const manif::SO3d I_R_WIMU = manif::SO3d::Random();
+    std::unordered_map<int, BiomechanicalAnalysis::IK::nodeData> rotatedNodeData = mapNodeData;
+    for (auto& [node, data] : rotatedNodeData)
+    {
+        data.I_R_IMU = I_R_WIMU * data.I_R_IMU;
+    }
+    REQUIRE(ik.calibrateAllWithWorld(rotatedNodeData, "link1"));
+    REQUIRE(ik.getCalibratedNodeOrientation(6, rotatedNodeData[6].I_R_IMU, I_R_linkRecalibrated));
+    REQUIRE(I_R_linkRecalibrated.rotation().isApprox(I_R_link.rotation(), 1e-9));
+    REQUIRE(ik.calibrateAllWithWorld(mapNodeData, "link1"));
+
     REQUIRE(ik.advance());
     REQUIRE(ik.getJointPositions(JointPositions));
     REQUIRE(ik.getJointVelocities(JointVelocities));
 
+    // the solver can be advanced without the joint regularization and the velocity limits
+    REQUIRE(ik.setJointRegularizationTaskEnabled(false));
+    REQUIRE(ik.setJointVelocityLimitsTaskEnabled(false));
+    REQUIRE(ik.advance());
+    REQUIRE(ik.setJointRegularizationTaskEnabled(true));
+    REQUIRE(ik.setJointVelocityLimitsTaskEnabled(true));
+    REQUIRE(ik.advance());
+
+    // a disabled task has no effect, the solution is the same of a solver without the task, and a
+    // disabled joint regularization gives a solution different from the one with the task enabled
+    {
+        std::vector<std::string> allTasks;
+        REQUIRE(paramHandler->getParameter("tasks", allTasks));
+        auto withoutTask = [&allTasks](const std::string& taskName) {
+            std::vector<std::string> tasks = allTasks;
+            tasks.erase(std::find(tasks.begin(), tasks.end(), taskName));
+            return tasks;
+        };
+
+        // the solvers start from the same state and have the same set points
+        auto solve = [&](const std::vector<std::string>& tasks,
+                         bool disableRegularization,
+                         bool disableVelocityLimits,
+                         Eigen::VectorXd& velocities) {
+            paramHandler->setParameter("tasks", tasks);
+            auto solverKinDyn = std::make_shared<iDynTree::KinDynComputations>();
+            solverKinDyn->loadRobotModel(model);
+            BiomechanicalAnalysis::IK::HumanIK solver;
+            REQUIRE(solver.initialize(paramHandler, solverKinDyn));
+            REQUIRE(solver.setDt(0.1));
+            if (disableRegularization)
+            {
+                REQUIRE(solver.setJointRegularizationTaskEnabled(false));
+            }
+            if (disableVelocityLimits)
+            {
+                REQUIRE(solver.setJointVelocityLimitsTaskEnabled(false));
+            }
+            REQUIRE(solver.updateOrientationAndGravityTasks(mapNodeData));
+            REQUIRE(solver.updateJointConstraintsTask());
+            REQUIRE(solver.advance());
+            velocities.resize(solverKinDyn->getNrOfDegreesOfFreedom());
+            REQUIRE(solver.getJointVelocities(velocities));
+        };
+
+        Eigen::VectorXd enabledVelocities;
+        Eigen::VectorXd disabledVelocities;
+        Eigen::VectorXd withoutTaskVelocities;
+        solve(allTasks, false, false, enabledVelocities);
+        solve(allTasks, true, false, disabledVelocities);
+        solve(withoutTask("JOINT_REG_TASK"), false, false, withoutTaskVelocities);
+        REQUIRE(disabledVelocities.isApprox(withoutTaskVelocities, 1e-3));
+        REQUIRE((disabledVelocities - enabledVelocities).norm() > 1e-6);
+
+        // the velocity limits of the configuration are [-1, 1] rad/s
+        REQUIRE(enabledVelocities.cwiseAbs().maxCoeff() <= 1.0 + 1e-3);
+        solve(allTasks, false, true, disabledVelocities);
+        solve(withoutTask("JOINT_VEL_LIMITS_TASK"), false, false, withoutTaskVelocities);
+        REQUIRE(disabledVelocities.isApprox(withoutTaskVelocities, 1e-3));
+        paramHandler->setParameter("tasks", allTasks);
+    }
+
+    // one residual for each SO3, gravity and floor contact task
+    REQUIRE(ik.getTaskResidualNames().size() == 12);
+    REQUIRE(ik.getTaskResiduals().size() == 12);
+    REQUIRE(ik.getTaskResiduals().allFinite());
+    REQUIRE((ik.getTaskResiduals().array() >= 0.0).all());
+
+    // the state is carried over to a solver of a new model of the subject
+    auto newKinDyn = std::make_shared<iDynTree::KinDynComputations>();
+    newKinDyn->loadRobotModel(model);
+    BiomechanicalAnalysis::IK::HumanIK newIk;
+    REQUIRE(newIk.initialize(paramHandler, newKinDyn));
+    REQUIRE(newIk.setDt(0.1));
+    REQUIRE(newIk.transferStateFrom(ik));
+    Eigen::VectorXd newJointPositions(kinDyn->getNrOfDegreesOfFreedom());
+    REQUIRE(ik.getJointPositions(JointPositions));
+    REQUIRE(newIk.getJointPositions(newJointPositions));
+    REQUIRE(newJointPositions.isApprox(JointPositions));
+    REQUIRE(newIk.updateOrientationAndGravityTasks(mapNodeData));
+    REQUIRE(newIk.advance());
+
+    // the state is warm started with an approximate solution
+    Eigen::VectorXd warmStartJointPositions = Eigen::VectorXd::Constant(nrDoFs, 0.1);
+    Eigen::Matrix3d baseOrientation;
+    REQUIRE(newIk.setState(warmStartJointPositions, Eigen::Matrix3d::Identity()));
+    REQUIRE(newIk.getJointPositions(newJointPositions));
+    REQUIRE(newJointPositions.isApprox(warmStartJointPositions));
+    REQUIRE(newIk.getBaseOrientation(baseOrientation));
+    REQUIRE(baseOrientation.isIdentity());
+    REQUIRE_FALSE(newIk.setState(Eigen::VectorXd::Zero(nrDoFs + 1), Eigen::Matrix3d::Identity()));
+    REQUIRE(newIk.advance());
+
+    // an IMU glitch makes the solver diverge, it is reset in place to the last good state
+    REQUIRE(newIk.getNrOfDivergences() == 0);
+    REQUIRE(newIk.getJointPositions(warmStartJointPositions));
+    REQUIRE(newIk.updateOrientationTask(3, I_R_IMU, manif::SO3Tangentd(Eigen::Vector3d::Constant(1e6))));
+    REQUIRE_FALSE(newIk.advance());
+    REQUIRE(newIk.getNrOfDivergences() == 1);
+    REQUIRE(newIk.getJointPositions(newJointPositions));
+    REQUIRE(newJointPositions == warmStartJointPositions);
+    REQUIRE(newIk.getJointVelocities(JointVelocities));
+    REQUIRE(JointVelocities.isZero());
+    REQUIRE(newIk.updateOrientationTask(3, I_R_IMU, I_omega_IMU));
+    REQUIRE(newIk.advance());
+    REQUIRE(newIk.resetToCalibrationPose());
+    REQUIRE(newIk.getJointPositions(newJointPositions));
+    REQUIRE(newJointPositions.isZero());
+    REQUIRE(newIk.advance());
+
     std::cout << "JointPositions = " << JointPositions.transpose() << std::endl;
     std::cout << "JointVelocities = " << JointVelocities.transpose() << std::endl;
 }
+
+TEST_CASE("InverseKinematics fusion of the IMUs of a link test")
+{
+    const iDynTree::Model model = iDynTree::getRandomModel(20);
+    auto paramHandler = std::make_shared<BipedalLocomotion::ParametersHandler::TomlImplementation>();
+    REQUIRE(paramHandler->setFromFile(getConfigPath() + "/configTestIKFusion.toml"));
+
+    auto initialize = [&](BiomechanicalAnalysis::IK::HumanIK& ik) {
+        auto kinDyn = std::make_shared<iDynTree::KinDynComputations>();
+        kinDyn->loadRobotModel(model);
+        return ik.initialize(paramHandler, kinDyn);
+    };
+
+    BiomechanicalAnalysis::IK::HumanIK ik;
+    REQUIRE(initialize(ik));
+    REQUIRE(ik.setDt(0.1));
+
+    // the estimates of the nodes lie on a geodesic, so their weighted mean is known: the node 20
+    // is rotated by 0.1 rad around z with respect to the nodes 3 and 21
+    manif::SO3d I_R_IMU;
+    I_R_IMU.setRandom();
+    const Eigen::Vector3d rotation(0.0, 0.0, 0.1);
+    const manif::SO3d I_R_IMU_rotated = I_R_IMU * manif::SO3Tangentd(rotation).exp();
+    manif::SO3d setPoint;
+
+    REQUIRE(ik.updateOrientationTask(3, I_R_IMU));
+    REQUIRE(ik.getOrientationTaskSetPoint(3, setPoint));
+    REQUIRE((setPoint - I_R_IMU).coeffs().norm() < 1e-9);
+
+    // weights 1 and 2
+    REQUIRE(ik.updateOrientationTask(20, I_R_IMU_rotated));
+    REQUIRE(ik.getOrientationTaskSetPoint(3, setPoint));
+    REQUIRE((setPoint - I_R_IMU * manif::SO3Tangentd(rotation * 2.0 / 3.0).exp()).coeffs().norm() < 1e-9);
+
+    // weights 1, 2 and 1
+    REQUIRE(ik.updateOrientationOrGravityTask(21, I_R_IMU));
+    REQUIRE(ik.getOrientationTaskSetPoint(20, setPoint));
+    REQUIRE((setPoint - I_R_IMU * manif::SO3Tangentd(rotation * 0.5).exp()).coeffs().norm() < 1e-9);
+
+    REQUIRE(ik.updateOrientationTask(6, I_R_IMU));
+    REQUIRE(ik.updateGravityTask(10, I_R_IMU));
+    REQUIRE(ik.advance());
+
+    // in the next frame only the node 20 is sending, the estimates of the other nodes are not fused
+    REQUIRE(ik.updateOrientationTask(20, I_R_IMU_rotated));
+    REQUIRE(ik.getOrientationTaskSetPoint(3, setPoint));
+    REQUIRE((setPoint - I_R_IMU_rotated).coeffs().norm() < 1e-9);
+    REQUIRE(ik.advance());
+    REQUIRE_FALSE(ik.getOrientationTaskSetPoint(100, setPoint));
+
+    // the additional nodes cannot be used by the tasks initialized before or after the SO3 task
+    auto gravityHandler = paramHandler->getGroup("GRAVITY_TASK_1").lock();
+    REQUIRE(gravityHandler != nullptr);
+    gravityHandler->setParameter("node_number", 20);
+    BiomechanicalAnalysis::IK::HumanIK gravityCollision;
+    REQUIRE_FALSE(initialize(gravityCollision));
+    gravityHandler->setParameter("node_number", 10);
+
+    auto floorContactHandler = paramHandler->getGroup("FLOOR_CONTACT_TASK_1").lock();
+    REQUIRE(floorContactHandler != nullptr);
+    floorContactHandler->setParameter("node_number", 21);
+    BiomechanicalAnalysis::IK::HumanIK floorContactCollision;
+    REQUIRE_FALSE(initialize(floorContactCollision));
+}
@@ -0,0 +1,88 @@
+// Catch2
+#include <catch2/catch_test_macros.hpp>
+
+#include <BiomechanicalAnalysis/IK/KernelsSO3Task.h>
+#include <iDynTree/EigenHelpers.h>
+#include <iDynTree/ModelLoader.h>
+#include <iDynTree/ModelTestUtils.h>
+#include <manif/SO3.h>
+
+#include <BipedalLocomotion/IK/SO3Task.h>
+#include <BipedalLocomotion/ParametersHandler/StdImplementation.h>
+#include <BipedalLocomotion/System/VariablesHandler.h>
+#include <ConfigFolderPath.h>
+#include <IKTestModelKernels.h>
+
+TEST_CASE("KernelsSO3Task test")
+{
+    iDynTree::ModelLoader loader;
+    REQUIRE(loader.loadModelFromFile(getConfigPath() + "/../../Model/tests/testModel.urdf"));
+
+    auto kinDyn = std::make_shared<iDynTree::KinDynComputations>();
+    REQUIRE(kinDyn->loadRobotModel(loader.model()));
+    REQUIRE(kinDyn->setFloatingBase("base"));
+    REQUIRE(kinDyn->setFrameVelocityRepresentation(iDynTree::MIXED_REPRESENTATION));
+
+    const std::size_t nrDoFs = IKTestModelKernels::NrOfDOFs;
+    const std::string frameName = IKTestModelKernels::LinkNames[IKTestModelKernels::NrOfLinks - 1];
+
+    auto paramHandler = std::make_shared<BipedalLocomotion::ParametersHandler::StdImplementation>();
+    paramHandler->setParameter("robot_velocity_variable_name", std::string("robot_velocity"));
+    paramHandler->setParameter("frame_name", frameName);
+    paramHandler->setParameter("kp_angular", 3.0);
+
+    BipedalLocomotion::System::VariablesHandler variablesHandler;
+    REQUIRE(variablesHandler.addVariable("other_variable", 4));
+    REQUIRE(variablesHandler.addVariable("robot_velocity", 6 + nrDoFs));
+
+    const auto kernels = BiomechanicalAnalysis::IK::makeLinkKinematicsKernels<IKTestModelKernels::ModelKernels>();
+
+    BiomechanicalAnalysis::IK::KernelsSO3Task kernelsTask;
+    REQUIRE(kernelsTask.setKinDynAndKernels(kinDyn, kernels));
+    REQUIRE(kernelsTask.initialize(paramHandler));
+    REQUIRE(kernelsTask.setVariablesHandler(variablesHandler));
+
+    BipedalLocomotion::IK::SO3Task task;
+    REQUIRE(task.setKinDyn(kinDyn));
+    REQUIRE(task.initialize(paramHandler));
+    REQUIRE(task.setVariablesHandler(variablesHandler));
+
+    const manif::SO3d setPoint = manif::SO3d::Random();
+    const manif::SO3d::Tangent angularVelocity = manif::SO3d::Tangent::Random();
+    REQUIRE(kernelsTask.setSetPoint(setPoint, angularVelocity));
+    REQUIRE(task.setSetPoint(setPoint, angularVelocity));
+
+    // the task computed by the kernels matches the one computed by the KinDynComputations object
+    constexpr double tolerance = 1e-9;
+    for (int i = 0; i < 5; i++)
+    {
+        const Eigen::Matrix4d world_T_base = iDynTree::toEigen(iDynTree::getRandomTransform().asHomogeneousTransform());
+        const Eigen::VectorXd s = Eigen::VectorXd::Random(nrDoFs);
+        const Eigen::Matrix<double, 6, 1> baseVelocity = Eigen::Matrix<double, 6, 1>::Random();
+        const Eigen::VectorXd sDot = Eigen::VectorXd::Random(nrDoFs);
+        const Eigen::Vector3d gravity(0.0, 0.0, -9.81);
+        REQUIRE(kinDyn->setRobotState(iDynTree::make_matrix_view(world_T_base),
+                                      iDynTree::make_span(s),
+                                      iDynTree::make_span(baseVelocity),
+                                      iDynTree::make_span(sDot),
+                                      iDynTree::make_span(gravity)));
+
+        REQUIRE(kernelsTask.update());
+        REQUIRE(task.update());
+        REQUIRE(kernelsTask.isValid());
+        REQUIRE(kernelsTask.size() == task.size());
+        REQUIRE(kernelsTask.getA().isApprox(task.getA(), tolerance));
+        REQUIRE((kernelsTask.getB() - task.getB()).norm() < tolerance);
+    }
+
+    // inconsistent inputs
+    BiomechanicalAnalysis::IK::KernelsSO3Task wrongTask;
+    REQUIRE_FALSE(wrongTask.initialize(paramHandler));
+    auto otherKinDyn = std::make_shared<iDynTree::KinDynComputations>();
+    REQUIRE(otherKinDyn->loadRobotModel(iDynTree::getRandomModel(nrDoFs + 1)));
+    REQUIRE(otherKinDyn->setFrameVelocityRepresentation(iDynTree::MIXED_REPRESENTATION));
+    REQUIRE_FALSE(wrongTask.setKinDynAndKernels(otherKinDyn, kernels));
+    REQUIRE(wrongTask.setKinDynAndKernels(kinDyn, kernels));
+    paramHandler->setParameter("frame_name", std::string("notALink"));
+    REQUIRE_FALSE(wrongTask.initialize(paramHandler));
+}
@@ -0,0 +1,103 @@
+// Catch2
+#include <catch2/catch_test_macros.hpp>
+
+#include <BiomechanicalAnalysis/IK/SurrogateIK.h>
+#include <manif/SO3.h>
+
+#include <BipedalLocomotion/ParametersHandler/StdImplementation.h>
+
+#include <random>
+
+namespace
+{
+
+Eigen::Matrix3d toRotation(const Eigen::Vector3d& angles)
+{
+    return (Eigen::AngleAxisd(angles(0), Eigen::Vector3d::UnitZ()) * Eigen::AngleAxisd(angles(1), Eigen::Vector3d::UnitY())
+            * Eigen::AngleAxisd(angles(2), Eigen::Vector3d::UnitX()))
+        .toRotationMatrix();
+}
+
+// Synthetic smooth mapping: the joints of each node are the Euler angles of its orientation and the
+// base is oriented as the first node
+void makeSample(std::mt19937& generator,
+                std::unordered_map<int, BiomechanicalAnalysis::IK::nodeData>& nodes,
+                Eigen::VectorXd& jointPositions,
+                Eigen::Matrix3d& baseOrientation)
+{
+    std::uniform_real_distribution<double> angle(-0.5, 0.5);
+    const std::vector<int> nodeNumbers = {3, 4};
+    jointPositions.resize(3 * nodeNumbers.size());
+    for (std::size_t i = 0; i < nodeNumbers.size(); i++)
+    {
+        const Eigen::Vector3d angles(angle(generator), angle(generator), angle(generator));
+        jointPositions.segment<3>(3 * i) = angles;
+        nodes[nodeNumbers[i]].I_R_IMU = manif::SO3d(Eigen::Quaterniond(toRotation(angles)));
+    }
+    baseOrientation = nodes[3].I_R_IMU.rotation();
+}
+
+} // namespace
+
+TEST_CASE("SurrogateIK test")
+{
+    auto paramHandler = std::make_shared<BipedalLocomotion::ParametersHandler::StdImplementation>();
+    paramHandler->setParameter("node_numbers", std::vector<int>{3, 4});
+    paramHandler->setParameter("random_features", 256);
+    paramHandler->setParameter("kernel_bandwidth", 2.0);
+    paramHandler->setParameter("regularization", 1e-8);
+
+    BiomechanicalAnalysis::IK::SurrogateIK surrogate;
+    REQUIRE(surrogate.initialize(paramHandler));
+
+    std::unordered_map<int, BiomechanicalAnalysis::IK::nodeData> nodes;
+    Eigen::VectorXd jointPositions;
+    Eigen::Matrix3d baseOrientation;
+    Eigen::VectorXd predictedJointPositions(6);
+    Eigen::Matrix3d predictedBaseOrientation;
+
+    // the regressor must be trained before predicting
+    std::mt19937 generator(42);
+    makeSample(generator, nodes, jointPositions, baseOrientation);
+    REQUIRE_FALSE(surrogate.predict(nodes, predictedJointPositions, predictedBaseOrientation));
+
+    for (int i = 0; i < 4000; i++)
+    {
+        makeSample(generator, nodes, jointPositions, baseOrientation);
+        REQUIRE(surrogate.addSample(nodes, jointPositions, baseOrientation));
+    }
+    REQUIRE(surrogate.getNrOfSamples() == 4000);
+    REQUIRE(surrogate.train());
+    REQUIRE(surrogate.isTrained());
+
+    double maxJointError = 0.0;
+    double maxBaseOrientationError = 0.0;
+    for (int i = 0; i < 200; i++)
+    {
+        makeSample(generator, nodes, jointPositions, baseOrientation);
+        REQUIRE(surrogate.predict(nodes, predictedJointPositions, predictedBaseOrientation));
+        maxJointError = std::max(maxJointError, (predictedJointPositions - jointPositions).lpNorm<Eigen::Infinity>());
+        maxBaseOrientationError = std::max(maxBaseOrientationError, (predictedBaseOrientation - baseOrientation).norm());
+        REQUIRE(predictedBaseOrientation.isUnitary(1e-9));
+        REQUIRE(predictedBaseOrientation.determinant() > 0.0);
+    }
+    REQUIRE(maxJointError < 0.02);
+    REQUIRE(maxBaseOrientationError < 0.01);
+
+    // wrong inputs
+    nodes.erase(4);
+    REQUIRE_FALSE(surrogate.predict(nodes, predictedJointPositions, predictedBaseOrientation));
+    Eigen::VectorXd wrongSize(5);
+    REQUIRE_FALSE(surrogate.addSample(nodes, wrongSize, baseOrientation));
+
+    // the regressor has been trained on the orientations as given, hence it cannot predict from the
+    // orientations calibrated by HumanIK
+    makeSample(generator, nodes, jointPositions, baseOrientation);
+    BiomechanicalAnalysis::IK::HumanIK ik;
+    REQUIRE_FALSE(surrogate.predict(nodes, ik, predictedJointPositions, predictedBaseOrientation));
+    REQUIRE_FALSE(surrogate.monitor(nodes, ik));
+
+    // the regularization must be positive
+    paramHandler->setParameter("regularization", 0.0);
+    REQUIRE_FALSE(surrogate.initialize(paramHandler));
+}
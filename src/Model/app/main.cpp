@@ -0,0 +1,110 @@
+/**
+ * @file main.cpp
+ * @authors Davide Gorbani <davide.gorbani@iit.it>
+ */
+
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <iDynTree/ModelLoader.h>
+
+#include <BiomechanicalAnalysis/Logging/Logger.h>
+#include <BiomechanicalAnalysis/Model/ModelKernelsGenerator.h>
+
+namespace
+{
+
+void printUsage()
+{
+    std::cout << "Usage: baf-model-kernels-generator --model <urdf> --base <link> --namespace <namespace> --output <header>"
+              << " [--joints <joint1,joint2,...>]" << std::endl;
+}
+
+std::vector<std::string> split(const std::string& list)
+{
+    std::vector<std::string> tokens;
+    std::stringstream stream(list);
+    std::string token;
+    while (std::getline(stream, token, ','))
+    {
+        if (!token.empty())
+        {
+            tokens.push_back(token);
+        }
+    }
+    return tokens;
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    constexpr auto logPrefix = "[baf-model-kernels-generator]";
+
+    std::string modelPath, baseLink, kernelsNamespace, outputPath;
+    std::vector<std::string> joints;
+    for (int i = 1; i < argc; i++)
+    {
+        const std::string arg = argv[i];
+        if (i + 1 >= argc)
+        {
+            printUsage();
+            return EXIT_FAILURE;
+        }
+        const std::string value = argv[++i];
+        if (arg == "--model")
+        {
+            modelPath = value;
+        } else if (arg == "--base")
+        {
+            baseLink = value;
+        } else if (arg == "--namespace")
+        {
+            kernelsNamespace = value;
+        } else if (arg == "--output")
+        {
+            outputPath = value;
+        } else if (arg == "--joints")
+        {
+            joints = split(value);
+        } else
+        {
+            printUsage();
+            return EXIT_FAILURE;
+        }
+    }
+
+    if (modelPath.empty() || baseLink.empty() || kernelsNamespace.empty() || outputPath.empty())
+    {
+        printUsage();
+        return EXIT_FAILURE;
+    }
+
+    iDynTree::ModelLoader loader;
+    const bool loaded = joints.empty() ? loader.loadModelFromFile(modelPath) : loader.loadReducedModelFromFile(modelPath, joints);
+    if (!loaded)
+    {
+        BiomechanicalAnalysis::log()->error("{} Unable to load the model '{}'.", logPrefix, modelPath);
+        return EXIT_FAILURE;
+    }
+
+    std::ofstream output(outputPath);
+    if (!output.is_open())
+    {
+        BiomechanicalAnalysis::log()->error("{} Unable to open the file '{}'.", logPrefix, outputPath);
+        return EXIT_FAILURE;
+    }
+
+    if (!BiomechanicalAnalysis::Model::ModelKernelsGenerator::generate(loader.model(), baseLink, kernelsNamespace, output))
+    {
+        BiomechanicalAnalysis::log()->error("{} Unable to generate the kernels.", logPrefix);
+        return EXIT_FAILURE;
+    }
+
+    BiomechanicalAnalysis::log()->info("{} Kernels of '{}' written in '{}'.", logPrefix, modelPath, outputPath);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,249 @@
+/**
+ * @file KernelsHelpers.h
+ * @authors Davide Gorbani <davide.gorbani@iit.it>
+ */
+
+#ifndef BIOMECHANICAL_ANALYSIS_MODEL_KERNELS_HELPERS_H
+#define BIOMECHANICAL_ANALYSIS_MODEL_KERNELS_HELPERS_H
+
+#include <cmath>
+
+#include <Eigen/Dense>
+
+namespace BiomechanicalAnalysis
+{
+namespace Model
+{
+namespace Kernels
+{
+
+// clang-format off
+/**
+ * Helper functions used by the kernels emitted by the ModelKernelsGenerator.
+ * All the spatial vectors follow the iDynTree convention, i.e. the linear part is stored in the
+ * first three elements and the angular part in the last three. The numerical constants of the
+ * model are passed as literals by the generated code, so that the compiler can fold them.
+ */
+// clang-format on
+
+using Vector6d = Eigen::Matrix<double, 6, 1>;
+
+/**
+ * build a transform from the row-major elements of the rotation matrix and the position
+ * @return the transform
+ */
+inline Eigen::Isometry3d transform(double r00,
+                                   double r01,
+                                   double r02,
+                                   double r10,
+                                   double r11,
+                                   double r12,
+                                   double r20,
+                                   double r21,
+                                   double r22,
+                                   double px,
+                                   double py,
+                                   double pz)
+{
+    Eigen::Isometry3d H = Eigen::Isometry3d::Identity();
+    H.linear() << r00, r01, r02, r10, r11, r12, r20, r21, r22;
+    H.translation() << px, py, pz;
+    return H;
+}
+
+/**
+ * compute the rotation of an angle around a unit axis with the Rodrigues formula
+ * @param axis unit axis
+ * @param angle rotation angle in radians
+ * @return the rotation matrix
+ */
+inline Eigen::Matrix3d axisRotation(const Eigen::Vector3d& axis, const double angle)
+{
+    const double c = std::cos(angle);
+    const double s = std::sin(angle);
+    Eigen::Matrix3d skew;
+    skew << 0.0, -axis(2), axis(1), axis(2), 0.0, -axis(0), -axis(1), axis(0), 0.0;
+    return c * Eigen::Matrix3d::Identity() + s * skew + (1.0 - c) * axis * axis.transpose();
+}
+
+/**
+ * compute the transform between the parent and the child link of a revolute joint
+ * @param parent_H_child_rest transform between the parent and the child link at rest
+ * @param axis unit axis of the joint expressed in the child link frame
+ * @param origin point of the axis expressed in the child link frame
+ * @param position joint position
+ * @return the transform parent_H_child
+ */
+inline Eigen::Isometry3d revoluteTransform(const Eigen::Isometry3d& parent_H_child_rest,
+                                           const Eigen::Vector3d& axis,
+                                           const Eigen::Vector3d& origin,
+                                           const double position)
+{
+    Eigen::Isometry3d rotation = Eigen::Isometry3d::Identity();
+    rotation.linear() = axisRotation(axis, position);
+    rotation.translation() = origin - rotation.linear() * origin;
+    return parent_H_child_rest * rotation;
+}
+
+/**
+ * compute the transform between the parent and the child link of a prismatic joint
+ * @param parent_H_child_rest transform between the parent and the child link at rest
+ * @param axis unit axis of the joint expressed in the child link frame
+ * @param position joint position
+ * @return the transform parent_H_child
+ */
+inline Eigen::Isometry3d prismaticTransform(const Eigen::Isometry3d& parent_H_child_rest, const Eigen::Vector3d& axis, const double position)
+{
+    Eigen::Isometry3d translation = Eigen::Isometry3d::Identity();
+    translation.translation() = position * axis;
+    return parent_H_child_rest * translation;
+}
+
+/**
+ * motion subspace of a revolute joint expressed in the child link frame
+ * @param axis unit axis of the joint expressed in the child link frame
+ * @param origin point of the axis expressed in the child link frame
+ * @return the motion subspace vector
+ */
+inline Vector6d revoluteMotionSubspace(const Eigen::Vector3d& axis, const Eigen::Vector3d& origin)
+{
+    Vector6d S;
+    S << origin.cross(axis), axis;
+    return S;
+}
+
+/**
+ * motion subspace of a prismatic joint expressed in the child link frame
+ * @param axis unit axis of the joint expressed in the child link frame
+ * @return the motion subspace vector
+ */
+inline Vector6d prismaticMotionSubspace(const Eigen::Vector3d& axis)
+{
+    Vector6d S;
+    S << axis, Eigen::Vector3d::Zero();
+    return S;
+}
+
+/**
+ * change the frame of a motion vector
+ * @param child_H_parent transform between the frame of the output and of the input vector
+ * @param motion motion vector expressed in the parent frame
+ * @return the motion vector expressed in the child frame
+ */
+inline Vector6d transformMotion(const Eigen::Isometry3d& child_H_parent, const Vector6d& motion)
+{
+    Vector6d out;
+    out.tail<3>() = child_H_parent.linear() * motion.tail<3>();
+    out.head<3>() = child_H_parent.linear() * motion.head<3>() + child_H_parent.translation().cross(out.tail<3>());
+    return out;
+}
+
+/**
+ * change the frame of a force vector
+ * @param parent_H_child transform between the frame of the output and of the input vector
+ * @param force force vector expressed in the child frame
+ * @return the force vector expressed in the parent frame
+ */
+inline Vector6d transformForce(const Eigen::Isometry3d& parent_H_child, const Vector6d& force)
+{
+    Vector6d out;
+    out.head<3>() = parent_H_child.linear() * force.head<3>();
+    out.tail<3>() = parent_H_child.linear() * force.tail<3>() + parent_H_child.translation().cross(out.head<3>());
+    return out;
+}
+
+/**
+ * cross product between a twist and a motion vector
+ */
+inline Vector6d crossMotion(const Vector6d& twist, const Vector6d& motion)
+{
+    Vector6d out;
+    out.head<3>() = twist.tail<3>().cross(motion.head<3>()) + twist.head<3>().cross(motion.tail<3>());
+    out.tail<3>() = twist.tail<3>().cross(motion.tail<3>());
+    return out;
+}
+
+/**
+ * cross product between a twist and a force vector
+ */
+inline Vector6d crossForce(const Vector6d& twist, const Vector6d& force)
+{
+    Vector6d out;
+    out.head<3>() = twist.tail<3>().cross(force.head<3>());
+    out.tail<3>() = twist.tail<3>().cross(force.tail<3>()) + twist.head<3>().cross(force.head<3>());
+    return out;
+}
+
+/**
+ * product between a spatial inertia and a motion vector
+ * @param mass mass of the link
+ * @param com center of mass expressed in the link frame
+ * @param inertia rotational inertia with respect to the link frame origin
+ * @param motion motion vector expressed in the link frame
+ * @return the force vector expressed in the link frame
+ */
+inline Vector6d
+inertiaProduct(const double mass, const Eigen::Vector3d& com, const Eigen::Matrix3d& inertia, const Vector6d& motion)
+{
+    Vector6d out;
+    out.head<3>() = mass * (motion.head<3>() - com.cross(motion.tail<3>()));
+    out.tail<3>() = mass * com.cross(motion.head<3>()) + inertia * motion.tail<3>();
+    return out;
+}
+
+/**
+ * set the columns of a mixed representation jacobian associated to the floating base
+ * @param basePosition position of the base in the world frame
+ * @param framePosition position of the frame in the world frame
+ * @param jacobian jacobian of the frame
+ */
+template <typename Derived>
+void setBaseColumns(const Eigen::Vector3d& basePosition, const Eigen::Vector3d& framePosition, Eigen::MatrixBase<Derived> const& jacobian)
+{
+    auto& J = const_cast<Eigen::MatrixBase<Derived>&>(jacobian);
+    const Eigen::Vector3d r = framePosition - basePosition;
+    J.template block<3, 3>(0, 0).setIdentity();
+    J.template block<3, 3>(0, 3) << 0.0, r(2), -r(1), -r(2), 0.0, r(0), r(1), -r(0), 0.0;
+    J.template block<3, 3>(3, 3).setIdentity();
+}
+
+/**
+ * set the column of a mixed representation jacobian associated to a revolute joint
+ * @param world_H_child transform between the world and the child link of the joint
+ * @param axis unit axis of the joint expressed in the child link frame
+ * @param origin point of the axis expressed in the child link frame
+ * @param framePosition position of the frame in the world frame
+ * @param column column of the jacobian
+ */
+template <typename Derived>
+void setRevoluteColumn(const Eigen::Isometry3d& world_H_child,
+                       const Eigen::Vector3d& axis,
+                       const Eigen::Vector3d& origin,
+                       const Eigen::Vector3d& framePosition,
+                       Eigen::MatrixBase<Derived> const& column)
+{
+    auto& c = const_cast<Eigen::MatrixBase<Derived>&>(column);
+    const Eigen::Vector3d worldAxis = world_H_child.linear() * axis;
+    c.template head<3>() = worldAxis.cross(framePosition - world_H_child * origin);
+    c.template tail<3>() = worldAxis;
+}
+
+/**
+ * set the column of a mixed representation jacobian associated to a prismatic joint
+ * @param world_H_child transform between the world and the child link of the joint
+ * @param axis unit axis of the joint expressed in the child link frame
+ * @param column column of the jacobian
+ */
+template <typename Derived>
+void setPrismaticColumn(const Eigen::Isometry3d& world_H_child, const Eigen::Vector3d& axis, Eigen::MatrixBase<Derived> const& column)
+{
+    auto& c = const_cast<Eigen::MatrixBase<Derived>&>(column);
+    c.template head<3>() = world_H_child.linear() * axis;
+    c.template tail<3>().setZero();
+}
+
+} // namespace Kernels
+} // namespace Model
+} // namespace BiomechanicalAnalysis
+
+#endif // BIOMECHANICAL_ANALYSIS_MODEL_KERNELS_HELPERS_H
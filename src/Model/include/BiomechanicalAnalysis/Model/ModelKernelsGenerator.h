@@ -0,0 +1,60 @@
+/**
+ * @file ModelKernelsGenerator.h
+ * @authors Davide Gorbani <davide.gorbani@iit.it>
+ */
+
+#ifndef BIOMECHANICAL_ANALYSIS_MODEL_KERNELS_GENERATOR_H
+#define BIOMECHANICAL_ANALYSIS_MODEL_KERNELS_GENERATOR_H
+
+#include <ostream>
+#include <string>
+
+// iDynTree headers
+#include <iDynTree/Model.h>
+
+namespace BiomechanicalAnalysis
+{
+namespace Model
+{
+
+/**
+ * @brief Class to generate the C++ kinematics and dynamics kernels specialized for a given model.
+ * The generated header contains, in the namespace chosen by the user:
+ * - the constants `NrOfLinks`, `NrOfDOFs` and the arrays `LinkNames` and `JointNames`, the links
+ *   being ordered as in the traversal of the model starting from the base link and the joints as
+ *   in the iDynTree model;
+ * - `computeLinkPoses()`, which computes the transform between the world and each link;
+ * - `computeLinkJacobian()`, which computes the jacobian of a link in mixed representation;
+ * - `inverseDynamics()`, which computes the generalized forces with the recursive Newton-Euler
+ *   algorithm, with the base quantities expressed in body-fixed representation;
+ * - the `ModelKernels` type, which gathers the constants and the functions above so that it can be
+ *   passed as template argument.
+ * The joint axes, the rest transforms and the inertial parameters are written as literals and the
+ * traversal of the tree is unrolled, so that the compiler can specialize the computations.
+ * @note only fixed, revolute and prismatic joints are supported.
+ * @note the kernels are used by IK::KernelsSO3Task, an orientation task that can replace the SO3
+ * task of BipedalLocomotion in a QPInverseKinematics. The tasks configured in HumanIK and the
+ * estimators of HumanID still compute the kinematics and the dynamics with their own
+ * KinDynComputations and BerdyHelper objects.
+ */
+class ModelKernelsGenerator
+{
+public:
+    /**
+     * @brief Function to generate the kernels of a model
+     * @param model model for which the kernels are generated
+     * @param baseLink name of the floating base link
+     * @param kernelsNamespace namespace of the generated kernels, e.g. `HumanKernels` or `my::kernels`
+     * @param stream stream where the generated header is written
+     * @return true if the generation is successful, false otherwise
+     */
+    static bool generate(const iDynTree::Model& model,
+                         const std::string& baseLink,
+                         const std::string& kernelsNamespace,
+                         std::ostream& stream);
+};
+
+} // namespace Model
+} // namespace BiomechanicalAnalysis
+
+#endif // BIOMECHANICAL_ANALYSIS_MODEL_KERNELS_GENERATOR_H
@@ -0,0 +1,65 @@
+/**
+ * @file ModelScaling.h
+ * @authors Davide Gorbani <davide.gorbani@iit.it>
+ */
+
+#ifndef BIOMECHANICAL_ANALYSIS_MODEL_SCALING_H
+#define BIOMECHANICAL_ANALYSIS_MODEL_SCALING_H
+
+#include <string>
+#include <unordered_map>
+
+// iDynTree headers
+#include <iDynTree/Model.h>
+#include <iDynTree/VectorFixSize.h>
+
+namespace BiomechanicalAnalysis
+{
+namespace Model
+{
+
+/**
+ * @brief Parameters of the anthropometric scaling of a model
+ */
+struct ScalingParameters
+{
+    double templateHeight{0.0}; /** height of the subject described by the template model */
+    double subjectHeight{0.0}; /** height of the subject */
+    double subjectMass{0.0}; /** total mass of the subject */
+    std::unordered_map<std::string, iDynTree::Vector3> linkScaleFactors; /** scale factors along the
+                                                                             axes of the link frame,
+                                                                             overriding the height
+                                                                             ratio for the listed
+                                                                             links */
+};
+
+/**
+ * @brief Class to scale a template model to the anthropometry of a subject without writing and
+ * parsing a new URDF.
+ * Each link has a scale factor along the axes of its frame, equal to the ratio between the subject
+ * and the template height unless specified in ScalingParameters::linkScaleFactors. The scaling
+ * affects:
+ * - the rest transforms of the joints, whose position is scaled with the factors of the parent link;
+ * - the center of mass of the links and the position of the additional frames and of the link
+ *   sensors, scaled with the factors of the link they belong to;
+ * - the masses, proportional to the scaled volume of the links and normalized to the subject mass;
+ * - the rotational inertias, obtained by scaling the mass distribution of each link.
+ * The visual and collision shapes are not copied in the scaled model.
+ */
+class ModelScaling
+{
+public:
+    /**
+     * @brief Function to scale a template model
+     * @param templateModel model to be scaled
+     * @param parameters scaling parameters
+     * @param scaledModel scaled model
+     * @return true if the scaling is successful, false otherwise
+     */
+    static bool scaleModel(const iDynTree::Model& templateModel, const ScalingParameters& parameters, iDynTree::Model& scaledModel);
+};
+
+} // namespace Model
+} // namespace BiomechanicalAnalysis
+
+#endif // BIOMECHANICAL_ANALYSIS_MODEL_SCALING_H
@@ -0,0 +1,60 @@
+/**
+ * @file ModelSimplification.h
+ * @authors Davide Gorbani <davide.gorbani@iit.it>
+ */
+
+#ifndef BIOMECHANICAL_ANALYSIS_MODEL_SIMPLIFICATION_H
+#define BIOMECHANICAL_ANALYSIS_MODEL_SIMPLIFICATION_H
+
+#include <string>
+#include <vector>
+
+// iDynTree headers
+#include <iDynTree/Model.h>
+
+namespace BiomechanicalAnalysis
+{
+namespace Model
+{
+
+/**
+ * @brief Parameters of the simplification of a model
+ */
+struct SimplificationParameters
+{
+    double massThreshold{0.0}; /** subtrees lighter than this mass are lumped in their parent */
+    double inertiaThreshold{0.0}; /** subtrees whose largest principal inertia, with respect to
+                                     their center of mass, is smaller than this value are lumped in
+                                     their parent */
+    bool lumpFixedJoints{true}; /** if true the links attached with a fixed joint are lumped in
+                                   their parent */
+    std::vector<std::string> preservedLinks; /** links that must not be lumped, e.g. the ones
+                                                where the external wrenches are applied */
+};
+
+/**
+ * @brief Class to reduce the number of links and joints of a model.
+ * A subtree is lumped in the parent of its root link, with its joints at rest, if both its mass and
+ * its largest principal inertia are below the thresholds. If SimplificationParameters::lumpFixedJoints
+ * is true also the links attached to their parent with a fixed joint are lumped. The default base
+ * link and the preserved links, together with the links connecting them to the base, are never
+ * lumped. The lumped links are kept as additional frames of the link they are lumped in, so the
+ * frame names of the original model are still valid.
+ */
+class ModelSimplification
+{
+public:
+    /**
+     * @brief Function to simplify a model
+     * @param model model to be simplified
+     * @param parameters simplification parameters
+     * @param simplifiedModel simplified model
+     * @return true if the simplification is successful, false otherwise
+     */
+    static bool simplifyModel(const iDynTree::Model& model, const SimplificationParameters& parameters, iDynTree::Model& simplifiedModel);
+};
+
+} // namespace Model
+} // namespace BiomechanicalAnalysis
+
+#endif // BIOMECHANICAL_ANALYSIS_MODEL_SIMPLIFICATION_H
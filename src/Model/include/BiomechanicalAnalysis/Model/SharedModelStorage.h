@@ -0,0 +1,92 @@
+/**
+ * @file SharedModelStorage.h
+ * @authors Davide Gorbani <davide.gorbani@iit.it>
+ */
+
+#ifndef BIOMECHANICAL_ANALYSIS_MODEL_SHARED_MODEL_STORAGE_H
+#define BIOMECHANICAL_ANALYSIS_MODEL_SHARED_MODEL_STORAGE_H
+
+#include <cstddef>
+#include <string>
+
+// iDynTree headers
+#include <iDynTree/Model.h>
+
+namespace BiomechanicalAnalysis
+{
+namespace Model
+{
+
+/**
+ * @brief Fast loader of a preprocessed model, published once per host in a POSIX shared-memory
+ * segment.
+ * A loader process parses, reduces and simplifies the model once and stores it with create(). The
+ * segment contains a flat, position independent description of the links, joints, additional
+ * frames and sensors, with the same ordering of the original model, so that the joint, DoF and
+ * sensor indices are preserved. The worker processes map the segment read-only with open() and
+ * build their model with getModel() from the mapped memory, without reading or parsing the URDF.
+ * @note The segment is not a view used by the solvers: getModel() copies the description in an
+ * iDynTree::Model owned by the caller, and HumanIK and HumanID build their own structures from it.
+ * Hence every process still holds its own model and solvers, the segment only saves the time
+ * needed to load and preprocess the model.
+ * @note Only fixed, revolute and prismatic joints, and six-axis force-torque sensors,
+ * accelerometers, gyroscopes and angular accelerometers are supported.
+ */
+class SharedModelStorage
+{
+public:
+    /**
+     * Destructor, it unmaps the segment and, if it has been created by this object, removes it
+     */
+    ~SharedModelStorage();
+
+    /**
+     * @brief Function to store a model in a new shared-memory segment
+     * @param name name of the segment, it must start with '/', e.g. "/humanModel"
+     * @param model model to be stored
+     * @return true if the segment has been created, false otherwise, e.g. if a segment with the same
+     * name already exists
+     * @note the segment is removed when this object is destroyed or close() is called
+     */
+    bool create(const std::string& name, const iDynTree::Model& model);
+
+    /**
+     * @brief Function to map read-only a segment created by another process
+     * @param name name of the segment
+     * @return true if the segment has been mapped and contains a valid model, false otherwise
+     */
+    bool open(const std::string& name);
+
+    /**
+     * @brief Function to build a model from the mapped segment
+     * @param model model built from the stored description, it is a copy independent of the
+     * segment
+     * @return true if the model has been built, false otherwise
+     */
+    bool getModel(iDynTree::Model& model) const;
+
+    /**
+     * @brief Function to get the size of the mapped segment
+     * @return size of the segment in bytes, 0 if no segment is mapped
+     */
+    std::size_t getSize() const;
+
+    /**
+     * @brief Function to unmap the segment, the segment is also removed if it has been created by
+     * this object
+     */
+    void close();
+
+private:
+    bool map(int fileDescriptor, std::size_t size, bool writable);
+
+    std::string m_name; /** name of the mapped segment */
+    const unsigned char* m_data{nullptr}; /** mapped segment */
+    std::size_t m_size{0}; /** size of the mapped segment */
+    bool m_owner{false}; /** true if the segment has been created by this object */
+};
+
+} // namespace Model
+} // namespace BiomechanicalAnalysis
+
+#endif // BIOMECHANICAL_ANALYSIS_MODEL_SHARED_MODEL_STORAGE_H
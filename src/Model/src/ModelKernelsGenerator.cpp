@@ -0,0 +1,419 @@
+#include <BiomechanicalAnalysis/Logging/Logger.h>
+#include <BiomechanicalAnalysis/Model/ModelKernelsGenerator.h>
+
+#include <cctype>
+#include <iomanip>
+#include <limits>
+#include <sstream>
+#include <vector>
+
+// iDynTree headers
+#include <iDynTree/PrismaticJoint.h>
+#include <iDynTree/RevoluteJoint.h>
+#include <iDynTree/Traversal.h>
+
+using namespace BiomechanicalAnalysis::Model;
+
+namespace
+{
+
+/**
+ * Data of a link needed to emit the kernels, ordered as in the traversal of the model
+ */
+struct LinkData
+{
+    std::string name;
+    int parent{-1}; /** traversal index of the parent link, -1 for the base */
+    enum class JointType
+    {
+        None,
+        Fixed,
+        Revolute,
+        Prismatic,
+    } jointType{JointType::None};
+    std::string jointName;
+    std::size_t dofOffset{0};
+    iDynTree::Transform parent_H_link_rest;
+    iDynTree::Direction axis; /** joint axis expressed in the link frame */
+    iDynTree::Position axisOrigin; /** point of the joint axis expressed in the link frame */
+    double mass{0.0};
+    iDynTree::Position com;
+    iDynTree::RotationalInertia inertiaWrtOrigin;
+};
+
+std::string literal(const double value)
+{
+    std::ostringstream stream;
+    stream << std::setprecision(std::numeric_limits<double>::max_digits10) << value;
+    std::string str = stream.str();
+    if (str.find_first_of(".en") == std::string::npos)
+    {
+        str += ".0";
+    }
+    return str;
+}
+
+std::string vector3(const double x, const double y, const double z)
+{
+    return "Eigen::Vector3d(" + literal(x) + ", " + literal(y) + ", " + literal(z) + ")";
+}
+
+std::string transform(const iDynTree::Transform& H)
+{
+    const iDynTree::Rotation& R = H.getRotation();
+    const iDynTree::Position& p = H.getPosition();
+    std::string str = "K::transform(";
+    for (int i = 0; i < 3; i++)
+    {
+        for (int j = 0; j < 3; j++)
+        {
+            str += literal(R(i, j)) + ", ";
+        }
+    }
+    return str + literal(p(0)) + ", " + literal(p(1)) + ", " + literal(p(2)) + ")";
+}
+
+std::string jointTransform(const LinkData& link, const std::string& positions)
+{
+    const std::string q = positions + "[" + std::to_string(link.dofOffset) + "]";
+    switch (link.jointType)
+    {
+    case LinkData::JointType::Revolute:
+        return "K::revoluteTransform(" + transform(link.parent_H_link_rest) + ", " + vector3(link.axis(0), link.axis(1), link.axis(2)) + ", "
+               + vector3(link.axisOrigin(0), link.axisOrigin(1), link.axisOrigin(2)) + ", " + q + ")";
+    case LinkData::JointType::Prismatic:
+        return "K::prismaticTransform(" + transform(link.parent_H_link_rest) + ", " + vector3(link.axis(0), link.axis(1), link.axis(2))
+               + ", " + q + ")";
+    default:
+        return transform(link.parent_H_link_rest);
+    }
+}
+
+std::string motionSubspace(const LinkData& link)
+{
+    if (link.jointType == LinkData::JointType::Revolute)
+    {
+        return "K::revoluteMotionSubspace(" + vector3(link.axis(0), link.axis(1), link.axis(2)) + ", "
+               + vector3(link.axisOrigin(0), link.axisOrigin(1), link.axisOrigin(2)) + ")";
+    }
+    return "K::prismaticMotionSubspace(" + vector3(link.axis(0), link.axis(1), link.axis(2)) + ")";
+}
+
+std::string inertiaProduct(const LinkData& link, const std::string& motion)
+{
+    std::string inertia = "(Eigen::Matrix3d() << ";
+    for (int i = 0; i < 3; i++)
+    {
+        for (int j = 0; j < 3; j++)
+        {
+            inertia += literal(link.inertiaWrtOrigin(i, j)) + ((i == 2 && j == 2) ? "" : ", ");
+        }
+    }
+    inertia += ").finished()";
+    return "K::inertiaProduct(" + literal(link.mass) + ", " + vector3(link.com(0), link.com(1), link.com(2)) + ", " + inertia + ", "
+           + motion + ")";
+}
+
+bool hasDOF(const LinkData& link)
+{
+    return link.jointType == LinkData::JointType::Revolute || link.jointType == LinkData::JointType::Prismatic;
+}
+
+bool isValidNamespace(const std::string& kernelsNamespace)
+{
+    std::size_t start = 0;
+    while (true)
+    {
+        const std::size_t end = kernelsNamespace.find("::", start);
+        const std::string token = kernelsNamespace.substr(start, end == std::string::npos ? std::string::npos : end - start);
+        if (token.empty() || std::isdigit(static_cast<unsigned char>(token.front())))
+        {
+            return false;
+        }
+        for (const char c : token)
+        {
+            if (!std::isalnum(static_cast<unsigned char>(c)) && c != '_')
+            {
+                return false;
+            }
+        }
+        if (end == std::string::npos)
+        {
+            return true;
+        }
+        start = end + 2;
+    }
+}
+
+} // namespace
+
+bool ModelKernelsGenerator::generate(const iDynTree::Model& model,
+                                     const std::string& baseLink,
+                                     const std::string& kernelsNamespace,
+                                     std::ostream& stream)
+{
+    constexpr auto logPrefix = "[ModelKernelsGenerator::generate]";
+
+    if (!isValidNamespace(kernelsNamespace))
+    {
+        BiomechanicalAnalysis::log()->error("{} '{}' is not a valid namespace.", logPrefix, kernelsNamespace);
+        return false;
+    }
+
+    const iDynTree::LinkIndex baseIndex = model.getLinkIndex(baseLink);
+    if (baseIndex == iDynTree::LINK_INVALID_INDEX)
+    {
+        BiomechanicalAnalysis::log()->error("{} The link '{}' is not in the model.", logPrefix, baseLink);
+        return false;
+    }
+
+    iDynTree::Traversal traversal;
+    if (!model.computeFullTreeTraversal(traversal, baseIndex))
+    {
+        BiomechanicalAnalysis::log()->error("{} Unable to compute the traversal of the model.", logPrefix);
+        return false;
+    }
+
+    // collect the data of the links in traversal order
+    std::vector<LinkData> links(traversal.getNrOfVisitedLinks());
+    for (unsigned int i = 0; i < traversal.getNrOfVisitedLinks(); i++)
+    {
+        LinkData& link = links[i];
+        const iDynTree::LinkIndex linkIndex = traversal.getLink(i)->getIndex();
+        link.name = model.getLinkName(linkIndex);
+
+        const iDynTree::SpatialInertia& inertia = traversal.getLink(i)->getInertia();
+        link.mass = inertia.getMass();
+        link.com = inertia.getCenterOfMass();
+        // move the rotational inertia from the center of mass to the link frame origin
+        link.inertiaWrtOrigin = inertia.getRotationalInertiaWrtCenterOfMass();
+        const double comSquaredNorm = link.com(0) * link.com(0) + link.com(1) * link.com(1) + link.com(2) * link.com(2);
+        for (int r = 0; r < 3; r++)
+        {
+            for (int c = 0; c < 3; c++)
+            {
+                link.inertiaWrtOrigin(r, c) += link.mass * ((r == c ? comSquaredNorm : 0.0) - link.com(r) * link.com(c));
+            }
+        }
+
+        if (i == 0)
+        {
+            continue;
+        }
+
+        const iDynTree::LinkIndex parentIndex = traversal.getParentLink(i)->getIndex();
+        link.parent = traversal.getTraversalIndexFromLinkIndex(parentIndex);
+        const iDynTree::IJoint* joint = traversal.getParentJoint(i);
+        link.jointName = model.getJointName(joint->getIndex());
+        link.dofOffset = joint->getDOFsOffset();
+        link.parent_H_link_rest = joint->getRestTransform(parentIndex, linkIndex);
+
+        if (joint->getNrOfDOFs() == 0)
+        {
+            link.jointType = LinkData::JointType::Fixed;
+        } else if (const auto revolute = dynamic_cast<const iDynTree::RevoluteJoint*>(joint))
+        {
+            const iDynTree::Axis axis = revolute->getAxis(linkIndex, parentIndex);
+            link.jointType = LinkData::JointType::Revolute;
+            link.axis = axis.getDirection();
+            link.axisOrigin = axis.getOrigin();
+        } else if (const auto prismatic = dynamic_cast<const iDynTree::PrismaticJoint*>(joint))
+        {
+            const iDynTree::Axis axis = prismatic->getAxis(linkIndex, parentIndex);
+            link.jointType = LinkData::JointType::Prismatic;
+            link.axis = axis.getDirection();
+        } else
+        {
+            BiomechanicalAnalysis::log()->error("{} The joint '{}' is not fixed, revolute or prismatic.", logPrefix, link.jointName);
+            return false;
+        }
+    }
+
+    std::string guard = "GENERATED_" + kernelsNamespace + "_MODEL_KERNELS_H";
+    for (std::size_t pos = guard.find("::"); pos != std::string::npos; pos = guard.find("::"))
+    {
+        guard.replace(pos, 2, "_");
+    }
+    for (char& c : guard)
+    {
+        c = static_cast<char>(std::toupper(static_cast<unsigned char>(c)));
+    }
+
+    stream << "// This file has been generated by the BiomechanicalAnalysis ModelKernelsGenerator, do not edit it.\n"
+           << "// Base link: " << baseLink << ", links: " << links.size() << ", DOFs: " << model.getNrOfDOFs() << "\n\n"
+           << "#ifndef " << guard << "\n#define " << guard << "\n\n"
+           << "#include <array>\n#include <cstddef>\n\n"
+           << "#include <Eigen/Dense>\n\n"
+           << "#include <BiomechanicalAnalysis/Model/KernelsHelpers.h>\n\n"
+           << "namespace " << kernelsNamespace << "\n{\n\n";
+
+    // constants
+    stream << "constexpr std::size_t NrOfLinks = " << links.size() << ";\n"
+           << "constexpr std::size_t NrOfDOFs = " << model.getNrOfDOFs() << ";\n\n"
+           << "constexpr std::array<const char*, NrOfLinks> LinkNames = {";
+    for (std::size_t i = 0; i < links.size(); i++)
+    {
+        stream << (i == 0 ? "" : ", ") << "\"" << links[i].name << "\"";
+    }
+    stream << "};\n\n";
+    std::vector<std::string> jointNames(model.getNrOfDOFs());
+    for (const auto& link : links)
+    {
+        if (hasDOF(link))
+        {
+            jointNames[link.dofOffset] = link.jointName;
+        }
+    }
+    stream << "constexpr std::array<const char*, NrOfDOFs> JointNames = {";
+    for (std::size_t i = 0; i < jointNames.size(); i++)
+    {
+        stream << (i == 0 ? "" : ", ") << "\"" << jointNames[i] << "\"";
+    }
+    stream << "};\n\n"
+           << "using LinkPoses = std::array<Eigen::Isometry3d, NrOfLinks>;\n\n";
+
+    // forward kinematics
+    stream << "/**\n * compute the transform between the world and each link, indexed as in LinkNames\n */\n"
+           << "inline void computeLinkPoses(const Eigen::Isometry3d& world_H_base,\n"
+           << "                             const Eigen::Ref<const Eigen::VectorXd>& jointPositions,\n"
+           << "                             LinkPoses& world_H_links)\n{\n"
+           << "    namespace K = BiomechanicalAnalysis::Model::Kernels;\n"
+           << "    world_H_links[0] = world_H_base;\n";
+    for (std::size_t i = 1; i < links.size(); i++)
+    {
+        stream << "    // " << links[i].name << "\n"
+               << "    world_H_links[" << i << "] = world_H_links[" << links[i].parent << "] * " << jointTransform(links[i], "jointPositions")
+               << ";\n";
+    }
+    stream << "}\n\n";
+
+    // jacobians
+    stream << "/**\n * compute the jacobian in mixed representation of a link, indexed as in LinkNames, given the\n"
+           << " * link poses computed by computeLinkPoses(). The jacobian must have 6 rows and 6 + NrOfDOFs columns.\n */\n"
+           << "template <typename Derived>\n"
+           << "inline void computeLinkJacobian(const std::size_t link, const LinkPoses& world_H_links, Eigen::MatrixBase<Derived> const& "
+              "jacobian)\n{\n"
+           << "    namespace K = BiomechanicalAnalysis::Model::Kernels;\n"
+           << "    auto& J = const_cast<Eigen::MatrixBase<Derived>&>(jacobian);\n"
+           << "    J.setZero();\n"
+           << "    const Eigen::Vector3d p = world_H_links[link].translation();\n"
+           << "    K::setBaseColumns(world_H_links[0].translation(), p, J);\n"
+           << "    switch (link)\n    {\n";
+    for (std::size_t i = 1; i < links.size(); i++)
+    {
+        stream << "    case " << i << ": // " << links[i].name << "\n";
+        for (int j = static_cast<int>(i); j > 0; j = links[j].parent)
+        {
+            const LinkData& link = links[j];
+            const std::string column = "J.col(" + std::to_string(6 + link.dofOffset) + ")";
+            if (link.jointType == LinkData::JointType::Revolute)
+            {
+                stream << "        K::setRevoluteColumn(world_H_links[" << j << "], " << vector3(link.axis(0), link.axis(1), link.axis(2)) << ", "
+                       << vector3(link.axisOrigin(0), link.axisOrigin(1), link.axisOrigin(2)) << ", p, " << column << ");\n";
+            } else if (link.jointType == LinkData::JointType::Prismatic)
+            {
+                stream << "        K::setPrismaticColumn(world_H_links[" << j << "], " << vector3(link.axis(0), link.axis(1), link.axis(2))
+                       << ", " << column << ");\n";
+            }
+        }
+        stream << "        break;\n";
+    }
+    stream << "    default:\n        break;\n    }\n}\n\n";
+
+    // inverse dynamics
+    stream << "/**\n * compute the generalized forces with the recursive Newton-Euler algorithm. The base velocity, the base\n"
+           << " * acceleration and the base wrench in the first 6 elements of generalizedForces are expressed in\n"
+           << " * body-fixed representation.\n */\n"
+           << "inline void inverseDynamics(const Eigen::Isometry3d& world_H_base,\n"
+           << "                            const Eigen::Ref<const Eigen::VectorXd>& jointPositions,\n"
+           << "                            const BiomechanicalAnalysis::Model::Kernels::Vector6d& baseVelocity,\n"
+           << "                            const Eigen::Ref<const Eigen::VectorXd>& jointVelocities,\n"
+           << "                            const BiomechanicalAnalysis::Model::Kernels::Vector6d& baseAcceleration,\n"
+           << "                            const Eigen::Ref<const Eigen::VectorXd>& jointAccelerations,\n"
+           << "                            const Eigen::Vector3d& worldGravity,\n"
+           << "                            Eigen::Ref<Eigen::VectorXd> generalizedForces)\n{\n"
+           << "    namespace K = BiomechanicalAnalysis::Model::Kernels;\n"
+           << "    std::array<Eigen::Isometry3d, NrOfLinks> parent_H_links;\n"
+           << "    std::array<K::Vector6d, NrOfLinks> v, a, f;\n\n"
+           << "    // " << links[0].name << "\n"
+           << "    v[0] = baseVelocity;\n"
+           << "    a[0] = baseAcceleration;\n"
+           << "    a[0].head<3>() -= world_H_base.linear().transpose() * worldGravity;\n"
+           << "    f[0] = " << inertiaProduct(links[0], "a[0]") << " + K::crossForce(v[0], " << inertiaProduct(links[0], "v[0]") << ");\n";
+    for (std::size_t i = 1; i < links.size(); i++)
+    {
+        const LinkData& link = links[i];
+        stream << "    // " << link.name << "\n    {\n"
+               << "        parent_H_links[" << i << "] = " << jointTransform(link, "jointPositions") << ";\n"
+               << "        const Eigen::Isometry3d link_H_parent = parent_H_links[" << i << "].inverse();\n";
+        if (hasDOF(link))
+        {
+            const std::string dof = std::to_string(link.dofOffset);
+            stream << "        const K::Vector6d S = " << motionSubspace(link) << ";\n"
+                   << "        const K::Vector6d vJ = S * jointVelocities[" << dof << "];\n"
+                   << "        v[" << i << "] = K::transformMotion(link_H_parent, v[" << link.parent << "]) + vJ;\n"
+                   << "        a[" << i << "] = K::transformMotion(link_H_parent, a[" << link.parent << "]) + S * jointAccelerations[" << dof
+                   << "] + K::crossMotion(v[" << i << "], vJ);\n";
+        } else
+        {
+            stream << "        v[" << i << "] = K::transformMotion(link_H_parent, v[" << link.parent << "]);\n"
+                   << "        a[" << i << "] = K::transformMotion(link_H_parent, a[" << link.parent << "]);\n";
+        }
+        if (link.mass == 0.0)
+        {
+            stream << "        f[" << i << "].setZero();\n";
+        } else
+        {
+            stream << "        f[" << i << "] = " << inertiaProduct(link, "a[" + std::to_string(i) + "]") << " + K::crossForce(v[" << i
+                   << "], " << inertiaProduct(link, "v[" + std::to_string(i) + "]") << ");\n";
+        }
+        stream << "    }\n";
+    }
+    stream << "\n";
+    for (std::size_t i = links.size() - 1; i > 0; i--)
+    {
+        const LinkData& link = links[i];
+        if (hasDOF(link))
+        {
+            stream << "    generalizedForces[" << 6 + link.dofOffset << "] = " << motionSubspace(link) << ".dot(f[" << i << "]);\n";
+        }
+        stream << "    f[" << link.parent << "] += K::transformForce(parent_H_links[" << i << "], f[" << i << "]);\n";
+    }
+    stream << "    generalizedForces.head<6>() = f[0];\n}\n\n";
+
+    // type gathering the kernels, the members are qualified since they have the names of the
+    // functions they forward to
+    const std::string ns = "::" + kernelsNamespace + "::";
+    stream << "/**\n * kernels of the model gathered in a type, to be passed as template argument to their consumers, e.g.\n"
+           << " * BiomechanicalAnalysis::IK::makeLinkKinematicsKernels()\n */\n"
+           << "struct ModelKernels\n{\n"
+           << "    static constexpr std::size_t NrOfLinks = " << ns << "NrOfLinks;\n"
+           << "    static constexpr std::size_t NrOfDOFs = " << ns << "NrOfDOFs;\n"
+           << "    using LinkPoses = " << ns << "LinkPoses;\n\n"
+           << "    static const std::array<const char*, NrOfLinks>& linkNames()\n    {\n"
+           << "        return " << ns << "LinkNames;\n    }\n\n"
+           << "    static void computeLinkPoses(const Eigen::Isometry3d& world_H_base,\n"
+           << "                                 const Eigen::Ref<const Eigen::VectorXd>& jointPositions,\n"
+           << "                                 LinkPoses& world_H_links)\n    {\n"
+           << "        " << ns << "computeLinkPoses(world_H_base, jointPositions, world_H_links);\n    }\n\n"
+           << "    template <typename Derived>\n"
+           << "    static void computeLinkJacobian(const std::size_t link, const LinkPoses& world_H_links, Eigen::MatrixBase<Derived> const& "
+              "jacobian)\n    {\n"
+           << "        " << ns << "computeLinkJacobian(link, world_H_links, jacobian);\n    }\n\n"
+           << "    static void inverseDynamics(const Eigen::Isometry3d& world_H_base,\n"
+           << "                                const Eigen::Ref<const Eigen::VectorXd>& jointPositions,\n"
+           << "                                const BiomechanicalAnalysis::Model::Kernels::Vector6d& baseVelocity,\n"
+           << "                                const Eigen::Ref<const Eigen::VectorXd>& jointVelocities,\n"
+           << "                                const BiomechanicalAnalysis::Model::Kernels::Vector6d& baseAcceleration,\n"
+           << "                                const Eigen::Ref<const Eigen::VectorXd>& jointAccelerations,\n"
+           << "                                const Eigen::Vector3d& worldGravity,\n"
+           << "                                Eigen::Ref<Eigen::VectorXd> generalizedForces)\n    {\n"
+           << "        " << ns
+           << "inverseDynamics(world_H_base, jointPositions, baseVelocity, jointVelocities, baseAcceleration, jointAccelerations, "
+              "worldGravity, generalizedForces);\n    }\n"
+           << "};\n\n"
+           << "} // namespace " << kernelsNamespace << "\n\n"
+           << "#endif // " << guard << "\n";
+
+    return stream.good();
+}
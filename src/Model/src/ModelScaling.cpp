@@ -0,0 +1,174 @@
+#include <BiomechanicalAnalysis/Logging/Logger.h>
+#include <BiomechanicalAnalysis/Model/ModelScaling.h>
+
+#include <memory>
+#include <vector>
+
+// iDynTree headers
+#include <iDynTree/EigenHelpers.h>
+#include <iDynTree/PrismaticJoint.h>
+#include <iDynTree/RevoluteJoint.h>
+#include <iDynTree/Sensors.h>
+
+using namespace BiomechanicalAnalysis::Model;
+
+namespace
+{
+
+iDynTree::Position scalePosition(const iDynTree::Position& position, const Eigen::Vector3d& scale)
+{
+    iDynTree::Position scaled;
+    iDynTree::toEigen(scaled) = iDynTree::toEigen(position).cwiseProduct(scale);
+    return scaled;
+}
+
+iDynTree::Transform scaleTransform(const iDynTree::Transform& transform, const Eigen::Vector3d& scale)
+{
+    return iDynTree::Transform(transform.getRotation(), scalePosition(transform.getPosition(), scale));
+}
+
+} // namespace
+
+bool ModelScaling::scaleModel(const iDynTree::Model& templateModel, const ScalingParameters& parameters, iDynTree::Model& scaledModel)
+{
+    constexpr auto logPrefix = "[ModelScaling::scaleModel]";
+
+    if (parameters.templateHeight <= 0.0 || parameters.subjectHeight <= 0.0 || parameters.subjectMass <= 0.0)
+    {
+        BiomechanicalAnalysis::log()->error("{} The heights and the mass of the subject must be positive.", logPrefix);
+        return false;
+    }
+
+    const std::size_t nrOfLinks = templateModel.getNrOfLinks();
+
+    // scale factors of each link
+    std::vector<Eigen::Vector3d> scaleFactors(nrOfLinks,
+                                              Eigen::Vector3d::Constant(parameters.subjectHeight / parameters.templateHeight));
+    for (const auto& [linkName, factors] : parameters.linkScaleFactors)
+    {
+        const iDynTree::LinkIndex linkIndex = templateModel.getLinkIndex(linkName);
+        if (linkIndex == iDynTree::LINK_INVALID_INDEX)
+        {
+            BiomechanicalAnalysis::log()->error("{} The link '{}' is not in the model.", logPrefix, linkName);
+            return false;
+        }
+        if ((iDynTree::toEigen(factors).array() <= 0.0).any())
+        {
+            BiomechanicalAnalysis::log()->error("{} The scale factors of the link '{}' must be positive.", logPrefix, linkName);
+            return false;
+        }
+        scaleFactors[linkIndex] = iDynTree::toEigen(factors);
+    }
+
+    // the masses are proportional to the scaled volumes and then normalized to the subject mass
+    std::vector<double> masses(nrOfLinks);
+    double totalMass = 0.0;
+    for (std::size_t i = 0; i < nrOfLinks; i++)
+    {
+        masses[i] = templateModel.getLink(i)->getInertia().getMass() * scaleFactors[i].prod();
+        totalMass += masses[i];
+    }
+    if (totalMass <= 0.0)
+    {
+        BiomechanicalAnalysis::log()->error("{} The total mass of the template model must be positive.", logPrefix);
+        return false;
+    }
+
+    scaledModel = iDynTree::Model();
+
+    for (std::size_t i = 0; i < nrOfLinks; i++)
+    {
+        const iDynTree::SpatialInertia& inertia = templateModel.getLink(i)->getInertia();
+        const double mass = masses[i] * parameters.subjectMass / totalMass;
+
+        // scale the second moment of the mass distribution with respect to the center of mass,
+        // Sigma = 0.5 * tr(I) * 1 - I, and compute back the rotational inertia
+        Eigen::Matrix3d scaledInertia = Eigen::Matrix3d::Zero();
+        if (inertia.getMass() > 0.0)
+        {
+            const Eigen::Matrix3d I = iDynTree::toEigen(inertia.getRotationalInertiaWrtCenterOfMass());
+            const Eigen::Matrix3d sigma = 0.5 * I.trace() * Eigen::Matrix3d::Identity() - I;
+            const Eigen::Matrix3d scaledSigma
+                = mass / inertia.getMass() * scaleFactors[i].asDiagonal() * sigma * scaleFactors[i].asDiagonal();
+            scaledInertia = scaledSigma.trace() * Eigen::Matrix3d::Identity() - scaledSigma;
+        }
+        iDynTree::RotationalInertia rotationalInertia;
+        iDynTree::toEigen(rotationalInertia) = scaledInertia;
+
+        iDynTree::Link link;
+        link.setInertia(iDynTree::SpatialInertia::fromRotationalInertiaWrtCenterOfMass(mass,
+                                                                                       scalePosition(inertia.getCenterOfMass(),
+                                                                                                     scaleFactors[i]),
+                                                                                       rotationalInertia));
+        scaledModel.addLink(templateModel.getLinkName(i), link);
+    }
+
+    for (std::size_t i = 0; i < templateModel.getNrOfJoints(); i++)
+    {
+        std::unique_ptr<iDynTree::IJoint> joint(templateModel.getJoint(i)->clone());
+        const iDynTree::LinkIndex parent = joint->getFirstAttachedLink();
+        const iDynTree::LinkIndex child = joint->getSecondAttachedLink();
+        const iDynTree::Transform parent_H_child = joint->getRestTransform(parent, child);
+
+        // the axes are read before changing the rest transform and set back afterwards, since
+        // they are stored with respect to the parent link
+        if (auto revolute = dynamic_cast<iDynTree::RevoluteJoint*>(joint.get()))
+        {
+            iDynTree::Axis axis = revolute->getAxis(child, parent);
+            axis.setOrigin(scalePosition(axis.getOrigin(), scaleFactors[child]));
+            revolute->setRestTransform(scaleTransform(parent_H_child, scaleFactors[parent]));
+            revolute->setAxis(axis, child, parent);
+        } else if (auto prismatic = dynamic_cast<iDynTree::PrismaticJoint*>(joint.get()))
+        {
+            iDynTree::Axis axis = prismatic->getAxis(child, parent);
+            axis.setOrigin(scalePosition(axis.getOrigin(), scaleFactors[child]));
+            prismatic->setRestTransform(scaleTransform(parent_H_child, scaleFactors[parent]));
+            prismatic->setAxis(axis, child, parent);
+        } else
+        {
+            joint->setRestTransform(scaleTransform(parent_H_child, scaleFactors[parent]));
+        }
+
+        if (scaledModel.addJoint(templateModel.getJointName(i), joint.get()) == iDynTree::JOINT_INVALID_INDEX)
+        {
+            BiomechanicalAnalysis::log()->error("{} Unable to add the joint '{}'.", logPrefix, templateModel.getJointName(i));
+            return false;
+        }
+    }
+
+    for (std::size_t i = nrOfLinks; i < templateModel.getNrOfFrames(); i++)
+    {
+        const iDynTree::LinkIndex linkIndex = templateModel.getFrameLink(i);
+        if (!scaledModel.addAdditionalFrameToLink(templateModel.getLinkName(linkIndex),
+                                                  templateModel.getFrameName(i),
+                                                  scaleTransform(templateModel.getFrameTransform(i), scaleFactors[linkIndex])))
+        {
+            BiomechanicalAnalysis::log()->error("{} Unable to add the frame '{}'.", logPrefix, templateModel.getFrameName(i));
+            return false;
+        }
+    }
+
+    scaledModel.setDefaultBaseLink(templateModel.getDefaultBaseLink());
+
+    // copy the sensors, moving the ones attached to a single link with the link scale factors
+    scaledModel.sensors() = templateModel.sensors();
+    for (int type = 0; type < iDynTree::NR_OF_SENSOR_TYPES; type++)
+    {
+        const auto sensorType = static_cast<iDynTree::SensorType>(type);
+        if (!iDynTree::isLinkSensor(sensorType))
+        {
+            continue;
+        }
+        for (std::size_t i = 0; i < scaledModel.sensors().getNrOfSensors(sensorType); i++)
+        {
+            auto sensor = dynamic_cast<iDynTree::LinkSensor*>(scaledModel.sensors().getSensor(sensorType, i));
+            if (sensor != nullptr)
+            {
+                sensor->setLinkSensorTransform(
+                    scaleTransform(sensor->getLinkSensorTransform(), scaleFactors[sensor->getParentLinkIndex()]));
+            }
+        }
+    }
+
+    return true;
+}
@@ -0,0 +1,113 @@
+#include <BiomechanicalAnalysis/Logging/Logger.h>
+#include <BiomechanicalAnalysis/Model/ModelSimplification.h>
+
+#include <vector>
+
+// iDynTree headers
+#include <iDynTree/EigenHelpers.h>
+#include <iDynTree/ModelTransformers.h>
+#include <iDynTree/Traversal.h>
+
+using namespace BiomechanicalAnalysis::Model;
+
+bool ModelSimplification::simplifyModel(const iDynTree::Model& model,
+                                        const SimplificationParameters& parameters,
+                                        iDynTree::Model& simplifiedModel)
+{
+    constexpr auto logPrefix = "[ModelSimplification::simplifyModel]";
+
+    if (parameters.massThreshold < 0.0 || parameters.inertiaThreshold < 0.0)
+    {
+        BiomechanicalAnalysis::log()->error("{} The mass and inertia thresholds must be non negative.", logPrefix);
+        return false;
+    }
+
+    iDynTree::Traversal traversal;
+    if (!model.computeFullTreeTraversal(traversal, model.getDefaultBaseLink()))
+    {
+        BiomechanicalAnalysis::log()->error("{} Unable to compute the traversal of the model.", logPrefix);
+        return false;
+    }
+    const std::size_t nrOfLinks = traversal.getNrOfVisitedLinks();
+
+    // the base link is always preserved
+    std::vector<bool> preserved(nrOfLinks, false);
+    preserved[0] = true;
+    for (const auto& linkName : parameters.preservedLinks)
+    {
+        const iDynTree::LinkIndex linkIndex = model.getLinkIndex(linkName);
+        if (linkIndex == iDynTree::LINK_INVALID_INDEX)
+        {
+            BiomechanicalAnalysis::log()->error("{} The link '{}' is not in the model.", logPrefix, linkName);
+            return false;
+        }
+        preserved[traversal.getTraversalIndexFromLinkIndex(linkIndex)] = true;
+    }
+
+    // compute, visiting the links from the leaves, the inertia of each subtree at rest expressed in
+    // the frame of its root link and whether the subtree contains a preserved link
+    std::vector<iDynTree::SpatialInertia> subtreeInertia(nrOfLinks);
+    std::vector<bool> containsPreserved = preserved;
+    std::vector<std::size_t> parents(nrOfLinks, 0);
+    for (std::size_t i = 0; i < nrOfLinks; i++)
+    {
+        subtreeInertia[i] = traversal.getLink(i)->getInertia();
+        if (i > 0)
+        {
+            parents[i] = traversal.getTraversalIndexFromLinkIndex(traversal.getParentLink(i)->getIndex());
+        }
+    }
+    for (std::size_t i = nrOfLinks - 1; i > 0; i--)
+    {
+        const iDynTree::Transform parent_H_link
+            = traversal.getParentJoint(i)->getRestTransform(traversal.getParentLink(i)->getIndex(), traversal.getLink(i)->getIndex());
+        subtreeInertia[parents[i]] = subtreeInertia[parents[i]] + parent_H_link * subtreeInertia[i];
+        containsPreserved[parents[i]] = containsPreserved[parents[i]] || containsPreserved[i];
+    }
+
+    // select the joints to be kept, visiting the links from the base
+    std::vector<bool> negligible(nrOfLinks, false);
+    std::vector<bool> keepJoint(model.getNrOfJoints(), false);
+    for (std::size_t i = 1; i < nrOfLinks; i++)
+    {
+        if (!containsPreserved[i])
+        {
+            double largestInertia = 0.0;
+            if (subtreeInertia[i].getMass() > 0.0)
+            {
+                const Eigen::Matrix3d inertia = iDynTree::toEigen(subtreeInertia[i].getRotationalInertiaWrtCenterOfMass());
+                largestInertia = Eigen::SelfAdjointEigenSolver<Eigen::Matrix3d>(inertia).eigenvalues().maxCoeff();
+            }
+            negligible[i] = negligible[parents[i]]
+                            || (subtreeInertia[i].getMass() < parameters.massThreshold && largestInertia < parameters.inertiaThreshold);
+        }
+
+        const iDynTree::IJoint* joint = traversal.getParentJoint(i);
+        const bool lumpFixedJoint = parameters.lumpFixedJoints && joint->getNrOfDOFs() == 0 && !preserved[i];
+        keepJoint[joint->getIndex()] = !negligible[i] && !lumpFixedJoint;
+    }
+
+    std::vector<std::string> jointsInSimplifiedModel;
+    for (std::size_t i = 0; i < model.getNrOfJoints(); i++)
+    {
+        if (keepJoint[i])
+        {
+            jointsInSimplifiedModel.push_back(model.getJointName(i));
+        }
+    }
+
+    if (!iDynTree::createReducedModel(model, jointsInSimplifiedModel, simplifiedModel))
+    {
+        BiomechanicalAnalysis::log()->error("{} Unable to create the simplified model.", logPrefix);
+        return false;
+    }
+
+    BiomechanicalAnalysis::log()->info("{} Links reduced from {} to {}, joints reduced from {} to {}.",
+                                       logPrefix,
+                                       model.getNrOfLinks(),
+                                       simplifiedModel.getNrOfLinks(),
+                                       model.getNrOfJoints(),
+                                       simplifiedModel.getNrOfJoints());
+
+    return true;
+}
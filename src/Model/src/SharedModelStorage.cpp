@@ -0,0 +1,586 @@
+#include <BiomechanicalAnalysis/Logging/Logger.h>
+#include <BiomechanicalAnalysis/Model/SharedModelStorage.h>
+
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+// POSIX headers
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// iDynTree headers
+#include <iDynTree/AccelerometerSensor.h>
+#include <iDynTree/EigenHelpers.h>
+#include <iDynTree/FixedJoint.h>
+#include <iDynTree/GyroscopeSensor.h>
+#include <iDynTree/PrismaticJoint.h>
+#include <iDynTree/RevoluteJoint.h>
+#include <iDynTree/Sensors.h>
+#include <iDynTree/SixAxisForceTorqueSensor.h>
+#include <iDynTree/ThreeAxisAngularAccelerometerSensor.h>
+
+using namespace BiomechanicalAnalysis::Model;
+
+namespace
+{
+
+constexpr std::uint64_t storageMagic = 0x4241464d4f44454cULL; // "BAFMODEL"
+constexpr std::uint32_t storageVersion = 2;
+
+enum class JointType : std::uint32_t
+{
+    Fixed = 0,
+    Revolute = 1,
+    Prismatic = 2,
+};
+
+// the records contain only fixed size fields and offsets, so that the segment can be mapped at any
+// address
+struct Header
+{
+    std::uint64_t magic;
+    std::uint32_t version;
+    std::uint32_t nrOfLinks;
+    std::uint32_t nrOfJoints;
+    std::uint32_t nrOfFrames;
+    std::uint32_t nrOfSensors;
+    std::int64_t defaultBaseLink;
+    std::uint64_t linksOffset;
+    std::uint64_t jointsOffset;
+    std::uint64_t framesOffset;
+    std::uint64_t sensorsOffset;
+    std::uint64_t namesOffset;
+    std::uint64_t size;
+};
+
+struct LinkRecord
+{
+    std::uint64_t name;
+    double mass;
+    double centerOfMass[3];
+    double rotationalInertia[9]; // with respect to the center of mass, row major
+};
+
+struct JointRecord
+{
+    std::uint64_t name;
+    JointType type;
+    std::uint32_t hasPosLimits;
+    std::int64_t parent;
+    std::int64_t child;
+    double rotation[9]; // parent_H_child at rest, row major
+    double position[3];
+    double axisDirection[3]; // expressed in the child link
+    double axisOrigin[3];
+    double minPos;
+    double maxPos;
+};
+
+struct FrameRecord
+{
+    std::uint64_t name;
+    std::int64_t link;
+    double rotation[9]; // link_H_frame, row major
+    double position[3];
+};
+
+struct SensorRecord
+{
+    std::uint64_t name;
+    std::int64_t type; // iDynTree::SensorType
+    std::int64_t parent; // parent link, or parent joint for the force-torque sensors
+    std::int64_t firstLink; // force-torque sensors only
+    std::int64_t secondLink; // force-torque sensors only
+    std::int64_t appliedWrenchLink; // force-torque sensors only
+    double rotation[9]; // link_H_sensor, or firstLink_H_sensor for the force-torque sensors
+    double position[3];
+    double secondRotation[9]; // secondLink_H_sensor, force-torque sensors only
+    double secondPosition[3];
+};
+
+bool isSupportedSensorType(std::int64_t type)
+{
+    return type == iDynTree::SIX_AXIS_FORCE_TORQUE || type == iDynTree::ACCELEROMETER || type == iDynTree::GYROSCOPE
+           || type == iDynTree::THREE_AXIS_ANGULAR_ACCELEROMETER;
+}
+
+std::uint64_t align(std::uint64_t offset)
+{
+    return (offset + alignof(std::max_align_t) - 1) / alignof(std::max_align_t) * alignof(std::max_align_t);
+}
+
+void storeTransform(const iDynTree::Transform& transform, double* rotation, double* position)
+{
+    Eigen::Map<Eigen::Matrix<double, 3, 3, Eigen::RowMajor>>(rotation) = iDynTree::toEigen(transform.getRotation());
+    Eigen::Map<Eigen::Vector3d>(position) = iDynTree::toEigen(transform.getPosition());
+}
+
+iDynTree::Transform loadTransform(const double* rotation, const double* position)
+{
+    iDynTree::Rotation R;
+    iDynTree::toEigen(R) = Eigen::Map<const Eigen::Matrix<double, 3, 3, Eigen::RowMajor>>(rotation);
+    return iDynTree::Transform(R, iDynTree::Position(position[0], position[1], position[2]));
+}
+
+// check that the records of the given type fit, aligned, between offset and end
+template <typename Record> bool isValidTable(std::uint64_t offset, std::uint64_t nrOfRecords, std::uint64_t end)
+{
+    return offset % alignof(Record) == 0 && offset <= end && nrOfRecords <= (end - offset) / sizeof(Record);
+}
+
+// check the whole content of a segment, so that getModel() never reads outside of it: the tables
+// are inside the segment, each name is inside the names area, which ends with '\0', and the
+// indices refer to existing links
+bool isValidSegment(const unsigned char* data, std::size_t size)
+{
+    const Header* header = reinterpret_cast<const Header*>(data);
+    if (header->magic != storageMagic || header->version != storageVersion || header->size != size
+        || !isValidTable<LinkRecord>(header->linksOffset, header->nrOfLinks, header->namesOffset)
+        || !isValidTable<JointRecord>(header->jointsOffset, header->nrOfJoints, header->namesOffset)
+        || !isValidTable<FrameRecord>(header->framesOffset, header->nrOfFrames, header->namesOffset)
+        || !isValidTable<SensorRecord>(header->sensorsOffset, header->nrOfSensors, header->namesOffset)
+        || header->linksOffset < sizeof(Header) || header->jointsOffset < header->linksOffset + header->nrOfLinks * sizeof(LinkRecord)
+        || header->framesOffset < header->jointsOffset + header->nrOfJoints * sizeof(JointRecord)
+        || header->sensorsOffset < header->framesOffset + header->nrOfFrames * sizeof(FrameRecord) || header->namesOffset > size)
+    {
+        return false;
+    }
+
+    const std::uint64_t namesSize = size - header->namesOffset;
+    if (namesSize > 0 && data[size - 1] != '\0')
+    {
+        return false;
+    }
+    const std::int64_t nrOfLinks = header->nrOfLinks;
+    auto isValidLink = [nrOfLinks](std::int64_t link) { return link >= 0 && link < nrOfLinks; };
+
+    const auto* links = reinterpret_cast<const LinkRecord*>(data + header->linksOffset);
+    for (std::size_t i = 0; i < header->nrOfLinks; i++)
+    {
+        if (links[i].name >= namesSize)
+        {
+            return false;
+        }
+    }
+    const auto* joints = reinterpret_cast<const JointRecord*>(data + header->jointsOffset);
+    for (std::size_t i = 0; i < header->nrOfJoints; i++)
+    {
+        if (joints[i].name >= namesSize || !isValidLink(joints[i].parent) || !isValidLink(joints[i].child)
+            || (joints[i].type != JointType::Fixed && joints[i].type != JointType::Revolute && joints[i].type != JointType::Prismatic))
+        {
+            return false;
+        }
+    }
+    const auto* frames = reinterpret_cast<const FrameRecord*>(data + header->framesOffset);
+    for (std::size_t i = 0; i < header->nrOfFrames; i++)
+    {
+        if (frames[i].name >= namesSize || !isValidLink(frames[i].link))
+        {
+            return false;
+        }
+    }
+    const auto* sensors = reinterpret_cast<const SensorRecord*>(data + header->sensorsOffset);
+    for (std::size_t i = 0; i < header->nrOfSensors; i++)
+    {
+        if (sensors[i].name >= namesSize || !isSupportedSensorType(sensors[i].type))
+        {
+            return false;
+        }
+        if (sensors[i].type == iDynTree::SIX_AXIS_FORCE_TORQUE
+                ? sensors[i].parent < 0 || sensors[i].parent >= header->nrOfJoints || !isValidLink(sensors[i].firstLink)
+                      || !isValidLink(sensors[i].secondLink) || !isValidLink(sensors[i].appliedWrenchLink)
+                : !isValidLink(sensors[i].parent))
+        {
+            return false;
+        }
+    }
+    return header->defaultBaseLink == iDynTree::LINK_INVALID_INDEX || isValidLink(header->defaultBaseLink);
+}
+
+} // namespace
+
+SharedModelStorage::~SharedModelStorage()
+{
+    close();
+}
+
+bool SharedModelStorage::create(const std::string& name, const iDynTree::Model& model)
+{
+    constexpr auto logPrefix = "[SharedModelStorage::create]";
+
+    close();
+
+    const std::size_t nrOfLinks = model.getNrOfLinks();
+    const std::size_t nrOfJoints = model.getNrOfJoints();
+    const std::size_t nrOfFrames = model.getNrOfFrames() - nrOfLinks;
+    const iDynTree::SensorsList& sensorsList = model.sensors();
+
+    // the names are stored one after the other, terminated by '\0'
+    std::vector<char> names;
+    auto addName = [&names](const std::string& name) {
+        const std::uint64_t offset = names.size();
+        names.insert(names.end(), name.c_str(), name.c_str() + name.size() + 1);
+        return offset;
+    };
+
+    std::vector<LinkRecord> links(nrOfLinks);
+    for (std::size_t i = 0; i < nrOfLinks; i++)
+    {
+        const iDynTree::SpatialInertia& inertia = model.getLink(i)->getInertia();
+        links[i].name = addName(model.getLinkName(i));
+        links[i].mass = inertia.getMass();
+        Eigen::Map<Eigen::Vector3d>(links[i].centerOfMass) = iDynTree::toEigen(inertia.getCenterOfMass());
+        Eigen::Map<Eigen::Matrix<double, 3, 3, Eigen::RowMajor>>(links[i].rotationalInertia)
+            = iDynTree::toEigen(inertia.getRotationalInertiaWrtCenterOfMass());
+    }
+
+    std::vector<JointRecord> joints(nrOfJoints);
+    for (std::size_t i = 0; i < nrOfJoints; i++)
+    {
+        const iDynTree::IJoint* joint = model.getJoint(i);
+        JointRecord& record = joints[i];
+        std::memset(&record, 0, sizeof(JointRecord));
+        record.name = addName(model.getJointName(i));
+        record.parent = joint->getFirstAttachedLink();
+        record.child = joint->getSecondAttachedLink();
+        storeTransform(joint->getRestTransform(record.parent, record.child), record.rotation, record.position);
+
+        iDynTree::Axis axis;
+        if (joint->getNrOfDOFs() == 0)
+        {
+            record.type = JointType::Fixed;
+        } else if (const auto revolute = dynamic_cast<const iDynTree::RevoluteJoint*>(joint))
+        {
+            record.type = JointType::Revolute;
+            axis = revolute->getAxis(record.child, record.parent);
+        } else if (const auto prismatic = dynamic_cast<const iDynTree::PrismaticJoint*>(joint))
+        {
+            record.type = JointType::Prismatic;
+            axis = prismatic->getAxis(record.child, record.parent);
+        } else
+        {
+            BiomechanicalAnalysis::log()->error("{} The joint '{}' is not fixed, revolute or prismatic.", logPrefix, model.getJointName(i));
+            return false;
+        }
+        if (record.type != JointType::Fixed)
+        {
+            Eigen::Map<Eigen::Vector3d>(record.axisDirection) = iDynTree::toEigen(axis.getDirection());
+            Eigen::Map<Eigen::Vector3d>(record.axisOrigin) = iDynTree::toEigen(axis.getOrigin());
+            record.hasPosLimits = joint->hasPosLimits() ? 1 : 0;
+            if (record.hasPosLimits)
+            {
+                joint->getPosLimits(0, record.minPos, record.maxPos);
+            }
+        }
+    }
+
+    std::vector<FrameRecord> frames(nrOfFrames);
+    for (std::size_t i = 0; i < nrOfFrames; i++)
+    {
+        frames[i].name = addName(model.getFrameName(nrOfLinks + i));
+        frames[i].link = model.getFrameLink(nrOfLinks + i);
+        storeTransform(model.getFrameTransform(nrOfLinks + i), frames[i].rotation, frames[i].position);
+    }
+
+    // the sensors are stored type by type, so that their indices are preserved
+    std::vector<SensorRecord> sensors;
+    for (int type = 0; type < iDynTree::NR_OF_SENSOR_TYPES; type++)
+    {
+        const auto sensorType = static_cast<iDynTree::SensorType>(type);
+        for (std::size_t i = 0; i < sensorsList.getNrOfSensors(sensorType); i++)
+        {
+            const iDynTree::Sensor* sensor = sensorsList.getSensor(sensorType, i);
+            SensorRecord record;
+            std::memset(&record, 0, sizeof(SensorRecord));
+            record.name = addName(sensor->getName());
+            record.type = type;
+            if (const auto forceTorque = dynamic_cast<const iDynTree::SixAxisForceTorqueSensor*>(sensor))
+            {
+                iDynTree::Transform firstLink_H_sensor, secondLink_H_sensor;
+                record.parent = model.getJointIndex(forceTorque->getParentJoint());
+                record.firstLink = model.getLinkIndex(forceTorque->getFirstLinkName());
+                record.secondLink = model.getLinkIndex(forceTorque->getSecondLinkName());
+                record.appliedWrenchLink = forceTorque->getAppliedWrenchLink();
+                if (record.parent == iDynTree::JOINT_INVALID_INDEX || !forceTorque->getLinkSensorTransform(record.firstLink, firstLink_H_sensor)
+                    || !forceTorque->getLinkSensorTransform(record.secondLink, secondLink_H_sensor))
+                {
+                    BiomechanicalAnalysis::log()->error("{} The sensor '{}' is not attached to the model.", logPrefix, sensor->getName());
+                    return false;
+                }
+                storeTransform(firstLink_H_sensor, record.rotation, record.position);
+                storeTransform(secondLink_H_sensor, record.secondRotation, record.secondPosition);
+            } else if (const auto linkSensor = dynamic_cast<const iDynTree::LinkSensor*>(sensor);
+                       linkSensor != nullptr && isSupportedSensorType(type))
+            {
+                record.parent = model.getLinkIndex(linkSensor->getParentLink());
+                if (record.parent == iDynTree::LINK_INVALID_INDEX)
+                {
+                    BiomechanicalAnalysis::log()->error("{} The sensor '{}' is not attached to the model.", logPrefix, sensor->getName());
+                    return false;
+                }
+                storeTransform(linkSensor->getLinkSensorTransform(), record.rotation, record.position);
+            } else
+            {
+                BiomechanicalAnalysis::log()->error("{} The sensor '{}' is not a force-torque sensor, an accelerometer, a gyroscope or an "
+                                                    "angular accelerometer.",
+                                                    logPrefix,
+                                                    sensor->getName());
+                return false;
+            }
+            sensors.push_back(record);
+        }
+    }
+
+    Header header{};
+    header.magic = storageMagic;
+    header.version = storageVersion;
+    header.nrOfLinks = static_cast<std::uint32_t>(nrOfLinks);
+    header.nrOfJoints = static_cast<std::uint32_t>(nrOfJoints);
+    header.nrOfFrames = static_cast<std::uint32_t>(nrOfFrames);
+    header.nrOfSensors = static_cast<std::uint32_t>(sensors.size());
+    header.defaultBaseLink = model.getDefaultBaseLink();
+    header.linksOffset = align(sizeof(Header));
+    header.jointsOffset = align(header.linksOffset + nrOfLinks * sizeof(LinkRecord));
+    header.framesOffset = align(header.jointsOffset + nrOfJoints * sizeof(JointRecord));
+    header.sensorsOffset = align(header.framesOffset + nrOfFrames * sizeof(FrameRecord));
+    header.namesOffset = align(header.sensorsOffset + sensors.size() * sizeof(SensorRecord));
+    header.size = header.namesOffset + names.size();
+
+    const int fileDescriptor = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH);
+    if (fileDescriptor < 0)
+    {
+        BiomechanicalAnalysis::log()->error("{} Unable to create the segment '{}': {}.", logPrefix, name, std::strerror(errno));
+        return false;
+    }
+    m_name = name;
+    m_owner = true;
+    if (ftruncate(fileDescriptor, static_cast<off_t>(header.size)) != 0 || !map(fileDescriptor, header.size, true))
+    {
+        BiomechanicalAnalysis::log()->error("{} Unable to allocate the segment '{}': {}.", logPrefix, name, std::strerror(errno));
+        ::close(fileDescriptor);
+        close();
+        return false;
+    }
+    ::close(fileDescriptor);
+
+    unsigned char* data = const_cast<unsigned char*>(m_data);
+    std::memcpy(data + header.linksOffset, links.data(), nrOfLinks * sizeof(LinkRecord));
+    std::memcpy(data + header.jointsOffset, joints.data(), nrOfJoints * sizeof(JointRecord));
+    std::memcpy(data + header.framesOffset, frames.data(), nrOfFrames * sizeof(FrameRecord));
+    std::memcpy(data + header.sensorsOffset, sensors.data(), sensors.size() * sizeof(SensorRecord));
+    std::memcpy(data + header.namesOffset, names.data(), names.size());
+    std::memcpy(data, &header, sizeof(Header));
+
+    // from now on the segment is immutable also for the process that created it
+    if (mprotect(data, m_size, PROT_READ) != 0)
+    {
+        BiomechanicalAnalysis::log()->warn("{} Unable to make the segment '{}' read-only.", logPrefix, name);
+    }
+
+    BiomechanicalAnalysis::log()->info("{} Model stored in the segment '{}' ({} bytes).", logPrefix, name, m_size);
+    return true;
+}
+
+bool SharedModelStorage::open(const std::string& name)
+{
+    constexpr auto logPrefix = "[SharedModelStorage::open]";
+
+    close();
+
+    const int fileDescriptor = shm_open(name.c_str(), O_RDONLY, 0);
+    if (fileDescriptor < 0)
+    {
+        BiomechanicalAnalysis::log()->error("{} Unable to open the segment '{}': {}.", logPrefix, name, std::strerror(errno));
+        return false;
+    }
+    struct stat status;
+    const bool ok = fstat(fileDescriptor, &status) == 0 && status.st_size >= static_cast<off_t>(sizeof(Header))
+                    && map(fileDescriptor, status.st_size, false);
+    ::close(fileDescriptor);
+    if (!ok)
+    {
+        BiomechanicalAnalysis::log()->error("{} Unable to map the segment '{}'.", logPrefix, name);
+        return false;
+    }
+    m_name = name;
+
+    // the segment is checked once, then getModel() reads it without checks
+    if (!isValidSegment(m_data, m_size))
+    {
+        BiomechanicalAnalysis::log()->error("{} The segment '{}' does not contain a valid model.", logPrefix, name);
+        close();
+        return false;
+    }
+
+    return true;
+}
+
+bool SharedModelStorage::getModel(iDynTree::Model& model) const
+{
+    constexpr auto logPrefix = "[SharedModelStorage::getModel]";
+
+    if (m_data == nullptr)
+    {
+        BiomechanicalAnalysis::log()->error("{} No segment is mapped.", logPrefix);
+        return false;
+    }
+
+    // the records are read in place from the mapped segment
+    const Header* header = reinterpret_cast<const Header*>(m_data);
+    const auto* links = reinterpret_cast<const LinkRecord*>(m_data + header->linksOffset);
+    const auto* joints = reinterpret_cast<const JointRecord*>(m_data + header->jointsOffset);
+    const auto* frames = reinterpret_cast<const FrameRecord*>(m_data + header->framesOffset);
+    const auto* sensors = reinterpret_cast<const SensorRecord*>(m_data + header->sensorsOffset);
+    const char* names = reinterpret_cast<const char*>(m_data + header->namesOffset);
+
+    model = iDynTree::Model();
+    for (std::size_t i = 0; i < header->nrOfLinks; i++)
+    {
+        iDynTree::RotationalInertia rotationalInertia;
+        iDynTree::toEigen(rotationalInertia) = Eigen::Map<const Eigen::Matrix<double, 3, 3, Eigen::RowMajor>>(links[i].rotationalInertia);
+        const iDynTree::Position centerOfMass(links[i].centerOfMass[0], links[i].centerOfMass[1], links[i].centerOfMass[2]);
+
+        iDynTree::Link link;
+        link.setInertia(iDynTree::SpatialInertia::fromRotationalInertiaWrtCenterOfMass(links[i].mass, centerOfMass, rotationalInertia));
+        if (model.addLink(names + links[i].name, link) == iDynTree::LINK_INVALID_INDEX)
+        {
+            BiomechanicalAnalysis::log()->error("{} Unable to add the link '{}'.", logPrefix, names + links[i].name);
+            return false;
+        }
+    }
+
+    for (std::size_t i = 0; i < header->nrOfJoints; i++)
+    {
+        const JointRecord& record = joints[i];
+        const iDynTree::Transform parent_H_child = loadTransform(record.rotation, record.position);
+        const iDynTree::Axis axis(iDynTree::Direction(record.axisDirection[0], record.axisDirection[1], record.axisDirection[2]),
+                                  iDynTree::Position(record.axisOrigin[0], record.axisOrigin[1], record.axisOrigin[2]));
+
+        std::unique_ptr<iDynTree::IJoint> joint;
+        if (record.type == JointType::Revolute)
+        {
+            auto revolute = std::make_unique<iDynTree::RevoluteJoint>();
+            revolute->setAttachedLinks(record.parent, record.child);
+            revolute->setRestTransform(parent_H_child);
+            revolute->setAxis(axis, record.child, record.parent);
+            joint = std::move(revolute);
+        } else if (record.type == JointType::Prismatic)
+        {
+            auto prismatic = std::make_unique<iDynTree::PrismaticJoint>();
+            prismatic->setAttachedLinks(record.parent, record.child);
+            prismatic->setRestTransform(parent_H_child);
+            prismatic->setAxis(axis, record.child, record.parent);
+            joint = std::move(prismatic);
+        } else
+        {
+            joint = std::make_unique<iDynTree::FixedJoint>(record.parent, record.child, parent_H_child);
+        }
+        if (record.hasPosLimits)
+        {
+            double minPos = record.minPos;
+            double maxPos = record.maxPos;
+            joint->enablePosLimits(true);
+            joint->setPosLimits(0, minPos, maxPos);
+        }
+
+        if (model.addJoint(names + record.name, joint.get()) == iDynTree::JOINT_INVALID_INDEX)
+        {
+            BiomechanicalAnalysis::log()->error("{} Unable to add the joint '{}'.", logPrefix, names + record.name);
+            return false;
+        }
+    }
+
+    for (std::size_t i = 0; i < header->nrOfFrames; i++)
+    {
+        if (!model.addAdditionalFrameToLink(model.getLinkName(frames[i].link),
+                                            names + frames[i].name,
+                                            loadTransform(frames[i].rotation, frames[i].position)))
+        {
+            BiomechanicalAnalysis::log()->error("{} Unable to add the frame '{}'.", logPrefix, names + frames[i].name);
+            return false;
+        }
+    }
+
+    model.setDefaultBaseLink(header->defaultBaseLink);
+
+    for (std::size_t i = 0; i < header->nrOfSensors; i++)
+    {
+        const SensorRecord& record = sensors[i];
+        std::unique_ptr<iDynTree::Sensor> sensor;
+        if (record.type == iDynTree::SIX_AXIS_FORCE_TORQUE)
+        {
+            auto forceTorque = std::make_unique<iDynTree::SixAxisForceTorqueSensor>();
+            forceTorque->setParentJoint(model.getJointName(record.parent));
+            forceTorque->setFirstLinkName(model.getLinkName(record.firstLink));
+            forceTorque->setSecondLinkName(model.getLinkName(record.secondLink));
+            forceTorque->setFirstLinkSensorTransform(record.firstLink, loadTransform(record.rotation, record.position));
+            forceTorque->setSecondLinkSensorTransform(record.secondLink, loadTransform(record.secondRotation, record.secondPosition));
+            forceTorque->setAppliedWrenchLink(record.appliedWrenchLink);
+            sensor = std::move(forceTorque);
+        } else
+        {
+            std::unique_ptr<iDynTree::LinkSensor> linkSensor;
+            if (record.type == iDynTree::ACCELEROMETER)
+            {
+                linkSensor = std::make_unique<iDynTree::AccelerometerSensor>();
+            } else if (record.type == iDynTree::GYROSCOPE)
+            {
+                linkSensor = std::make_unique<iDynTree::GyroscopeSensor>();
+            } else
+            {
+                linkSensor = std::make_unique<iDynTree::ThreeAxisAngularAccelerometerSensor>();
+            }
+            linkSensor->setParentLink(model.getLinkName(record.parent));
+            linkSensor->setLinkSensorTransform(loadTransform(record.rotation, record.position));
+            sensor = std::move(linkSensor);
+        }
+        sensor->setName(names + record.name);
+
+        // the indices are set from the names of the links and joints
+        if (!sensor->updateIndices(model) || model.sensors().addSensor(*sensor) < 0)
+        {
+            BiomechanicalAnalysis::log()->error("{} Unable to add the sensor '{}'.", logPrefix, names + record.name);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+std::size_t SharedModelStorage::getSize() const
+{
+    return m_size;
+}
+
+void SharedModelStorage::close()
+{
+    if (m_data != nullptr)
+    {
+        munmap(const_cast<unsigned char*>(m_data), m_size);
+    }
+    if (m_owner)
+    {
+        shm_unlink(m_name.c_str());
+    }
+    m_data = nullptr;
+    m_size = 0;
+    m_owner = false;
+    m_name.clear();
+}
+
+bool SharedModelStorage::map(int fileDescriptor, std::size_t size, bool writable)
+{
+    void* data = mmap(nullptr, size, writable ? PROT_READ | PROT_WRITE : PROT_READ, MAP_SHARED, fileDescriptor, 0);
+    if (data == MAP_FAILED)
+    {
+        return false;
+    }
+    m_data = static_cast<const unsigned char*>(data);
+    m_size = size;
+    return true;
+}
@@ -0,0 +1,98 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <BiomechanicalAnalysis/Model/ModelKernelsGenerator.h>
+#include <iDynTree/EigenHelpers.h>
+#include <iDynTree/KinDynComputations.h>
+#include <iDynTree/ModelLoader.h>
+#include <iDynTree/ModelTestUtils.h>
+
+#include <ConfigFolderPath.h>
+#include <TestModelKernels.h>
+
+#include <sstream>
+#include <string>
+
+TEST_CASE("Model kernels generator test")
+{
+    iDynTree::ModelLoader loader;
+    REQUIRE(loader.loadModelFromFile(getConfigPath() + "/testModel.urdf"));
+
+    std::stringstream stream;
+    REQUIRE(BiomechanicalAnalysis::Model::ModelKernelsGenerator::generate(loader.model(), "base", "my::kernels", stream));
+    REQUIRE(stream.str().find("namespace my::kernels") != std::string::npos);
+    REQUIRE(stream.str().find("struct ModelKernels") != std::string::npos);
+
+    // wrong base link and namespace
+    REQUIRE_FALSE(BiomechanicalAnalysis::Model::ModelKernelsGenerator::generate(loader.model(), "notALink", "kernels", stream));
+    REQUIRE_FALSE(BiomechanicalAnalysis::Model::ModelKernelsGenerator::generate(loader.model(), "base", "my kernels", stream));
+}
+
+TEST_CASE("Model kernels consistency test")
+{
+    iDynTree::ModelLoader loader;
+    REQUIRE(loader.loadModelFromFile(getConfigPath() + "/testModel.urdf"));
+    const iDynTree::Model& model = loader.model();
+    REQUIRE(model.getNrOfDOFs() == TestModelKernels::NrOfDOFs);
+    REQUIRE(model.getNrOfLinks() == TestModelKernels::NrOfLinks);
+
+    iDynTree::KinDynComputations kinDyn;
+    REQUIRE(kinDyn.loadRobotModel(model));
+    REQUIRE(kinDyn.setFloatingBase("base"));
+
+    constexpr double tolerance = 1e-9;
+    const Eigen::Vector3d gravity(0.0, 0.0, -9.81);
+    const Eigen::Isometry3d world_H_base(Eigen::Matrix4d(iDynTree::toEigen(iDynTree::getRandomTransform().asHomogeneousTransform())));
+    const Eigen::VectorXd s = Eigen::VectorXd::Random(TestModelKernels::NrOfDOFs);
+    const Eigen::VectorXd sDot = Eigen::VectorXd::Random(TestModelKernels::NrOfDOFs);
+    const Eigen::VectorXd sDDot = Eigen::VectorXd::Random(TestModelKernels::NrOfDOFs);
+    const BiomechanicalAnalysis::Model::Kernels::Vector6d baseVelocity = BiomechanicalAnalysis::Model::Kernels::Vector6d::Random();
+    const BiomechanicalAnalysis::Model::Kernels::Vector6d baseAcceleration = BiomechanicalAnalysis::Model::Kernels::Vector6d::Random();
+    const Eigen::Matrix4d world_T_base = world_H_base.matrix();
+
+    TestModelKernels::LinkPoses world_H_links;
+    TestModelKernels::computeLinkPoses(world_H_base, s, world_H_links);
+
+    SECTION("Forward kinematics and jacobians")
+    {
+        REQUIRE(kinDyn.setFrameVelocityRepresentation(iDynTree::MIXED_REPRESENTATION));
+        REQUIRE(kinDyn.setRobotState(iDynTree::make_matrix_view(world_T_base),
+                                     iDynTree::make_span(s),
+                                     iDynTree::make_span(baseVelocity),
+                                     iDynTree::make_span(sDot),
+                                     iDynTree::make_span(gravity)));
+
+        Eigen::MatrixXd jacobian(6, 6 + TestModelKernels::NrOfDOFs);
+        Eigen::MatrixXd expectedJacobian(6, 6 + TestModelKernels::NrOfDOFs);
+        for (std::size_t i = 0; i < TestModelKernels::NrOfLinks; i++)
+        {
+            const std::string name = TestModelKernels::LinkNames[i];
+            const Eigen::Matrix4d expectedPose = iDynTree::toEigen(kinDyn.getWorldTransform(name).asHomogeneousTransform());
+            REQUIRE(world_H_links[i].matrix().isApprox(expectedPose, tolerance));
+
+            TestModelKernels::computeLinkJacobian(i, world_H_links, jacobian);
+            REQUIRE(kinDyn.getFrameFreeFloatingJacobian(name, iDynTree::make_matrix_view(expectedJacobian)));
+            REQUIRE((jacobian - expectedJacobian).norm() < tolerance);
+        }
+    }
+
+    SECTION("Inverse dynamics")
+    {
+        REQUIRE(kinDyn.setFrameVelocityRepresentation(iDynTree::BODY_FIXED_REPRESENTATION));
+        REQUIRE(kinDyn.setRobotState(iDynTree::make_matrix_view(world_T_base),
+                                     iDynTree::make_span(s),
+                                     iDynTree::make_span(baseVelocity),
+                                     iDynTree::make_span(sDot),
+                                     iDynTree::make_span(gravity)));
+
+        iDynTree::LinkNetExternalWrenches extWrenches(model);
+        extWrenches.zero();
+        iDynTree::FreeFloatingGeneralizedTorques expectedTorques(model);
+        REQUIRE(kinDyn.inverseDynamics(iDynTree::make_span(baseAcceleration), iDynTree::make_span(sDDot), extWrenches, expectedTorques));
+
+        Eigen::VectorXd generalizedForces(6 + TestModelKernels::NrOfDOFs);
+        TestModelKernels::inverseDynamics(world_H_base, s, baseVelocity, sDot, baseAcceleration, sDDot, gravity, generalizedForces);
+        REQUIRE((generalizedForces.head<6>() - iDynTree::toEigen(expectedTorques.baseWrench())).norm() < tolerance);
+        REQUIRE((generalizedForces.tail(TestModelKernels::NrOfDOFs) - iDynTree::toEigen(expectedTorques.jointTorques())).norm()
+                < tolerance);
+    }
+}
@@ -0,0 +1,104 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <BiomechanicalAnalysis/Model/ModelScaling.h>
+#include <iDynTree/EigenHelpers.h>
+#include <iDynTree/KinDynComputations.h>
+#include <iDynTree/ModelTestUtils.h>
+
+namespace
+{
+
+double totalMass(const iDynTree::Model& model)
+{
+    double mass = 0.0;
+    for (std::size_t i = 0; i < model.getNrOfLinks(); i++)
+    {
+        mass += model.getLink(i)->getInertia().getMass();
+    }
+    return mass;
+}
+
+} // namespace
+
+TEST_CASE("Model scaling test")
+{
+    constexpr double tolerance = 1e-9;
+    const iDynTree::Model model = iDynTree::getRandomModel(15);
+
+    iDynTree::VectorDynSize jointPositions(model.getNrOfDOFs());
+    iDynTree::getRandomVector(jointPositions);
+
+    iDynTree::KinDynComputations templateKinDyn;
+    REQUIRE(templateKinDyn.loadRobotModel(model));
+    REQUIRE(templateKinDyn.setJointPos(jointPositions));
+
+    BiomechanicalAnalysis::Model::ScalingParameters parameters;
+    parameters.templateHeight = 1.75;
+
+    SECTION("Uniform scaling")
+    {
+        const double lengthScale = 1.1;
+        parameters.subjectHeight = lengthScale * parameters.templateHeight;
+        parameters.subjectMass = 1.3 * totalMass(model);
+        const double massScale = parameters.subjectMass / totalMass(model);
+
+        iDynTree::Model scaledModel;
+        REQUIRE(BiomechanicalAnalysis::Model::ModelScaling::scaleModel(model, parameters, scaledModel));
+        REQUIRE(scaledModel.getNrOfLinks() == model.getNrOfLinks());
+        REQUIRE(scaledModel.getNrOfJoints() == model.getNrOfJoints());
+        REQUIRE(scaledModel.getNrOfFrames() == model.getNrOfFrames());
+        REQUIRE(std::abs(totalMass(scaledModel) - parameters.subjectMass) < tolerance);
+
+        for (std::size_t i = 0; i < model.getNrOfLinks(); i++)
+        {
+            const iDynTree::SpatialInertia& inertia = model.getLink(i)->getInertia();
+            const iDynTree::SpatialInertia& scaledInertia = scaledModel.getLink(i)->getInertia();
+            REQUIRE(std::abs(scaledInertia.getMass() - massScale * inertia.getMass()) < tolerance);
+            REQUIRE(iDynTree::toEigen(scaledInertia.getCenterOfMass())
+                        .isApprox(lengthScale * iDynTree::toEigen(inertia.getCenterOfMass()), tolerance));
+            REQUIRE(iDynTree::toEigen(scaledInertia.getRotationalInertiaWrtCenterOfMass())
+                        .isApprox(massScale * lengthScale * lengthScale
+                                      * iDynTree::toEigen(inertia.getRotationalInertiaWrtCenterOfMass()),
+                                  tolerance));
+        }
+
+        // with a uniform scaling the frames keep their orientation and their position with respect
+        // to the base is scaled by the length scale
+        iDynTree::KinDynComputations scaledKinDyn;
+        REQUIRE(scaledKinDyn.loadRobotModel(scaledModel));
+        REQUIRE(scaledKinDyn.setJointPos(jointPositions));
+        for (std::size_t i = 0; i < model.getNrOfFrames(); i++)
+        {
+            const iDynTree::Transform expected = templateKinDyn.getWorldTransform(model.getFrameName(i));
+            const iDynTree::Transform scaled = scaledKinDyn.getWorldTransform(model.getFrameName(i));
+            REQUIRE(iDynTree::toEigen(scaled.getRotation()).isApprox(iDynTree::toEigen(expected.getRotation()), tolerance));
+            REQUIRE((iDynTree::toEigen(scaled.getPosition()) - lengthScale * iDynTree::toEigen(expected.getPosition())).norm()
+                    < tolerance);
+        }
+    }
+
+    SECTION("Link scale factors")
+    {
+        parameters.subjectHeight = parameters.templateHeight;
+        parameters.subjectMass = 70.0;
+        parameters.linkScaleFactors[model.getLinkName(1)] = iDynTree::Vector3();
+        iDynTree::Model scaledModel;
+
+        // the scale factors must be positive
+        REQUIRE_FALSE(BiomechanicalAnalysis::Model::ModelScaling::scaleModel(model, parameters, scaledModel));
+
+        iDynTree::toEigen(parameters.linkScaleFactors[model.getLinkName(1)]) = Eigen::Vector3d(1.0, 1.2, 0.9);
+        REQUIRE(BiomechanicalAnalysis::Model::ModelScaling::scaleModel(model, parameters, scaledModel));
+        REQUIRE(std::abs(totalMass(scaledModel) - parameters.subjectMass) < tolerance);
+
+        parameters.linkScaleFactors["notALink"] = parameters.linkScaleFactors[model.getLinkName(1)];
+        REQUIRE_FALSE(BiomechanicalAnalysis::Model::ModelScaling::scaleModel(model, parameters, scaledModel));
+    }
+
+    SECTION("Invalid parameters")
+    {
+        parameters.subjectHeight = 1.8;
+        iDynTree::Model scaledModel;
+        REQUIRE_FALSE(BiomechanicalAnalysis::Model::ModelScaling::scaleModel(model, parameters, scaledModel));
+    }
+}
@@ -0,0 +1,93 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <BiomechanicalAnalysis/Model/ModelSimplification.h>
+#include <iDynTree/EigenHelpers.h>
+#include <iDynTree/KinDynComputations.h>
+#include <iDynTree/ModelTestUtils.h>
+
+namespace
+{
+
+double totalMass(const iDynTree::Model& model)
+{
+    double mass = 0.0;
+    for (std::size_t i = 0; i < model.getNrOfLinks(); i++)
+    {
+        mass += model.getLink(i)->getInertia().getMass();
+    }
+    return mass;
+}
+
+} // namespace
+
+TEST_CASE("Model simplification test")
+{
+    constexpr double tolerance = 1e-9;
+    const iDynTree::Model model = iDynTree::getRandomModel(20, 5);
+
+    BiomechanicalAnalysis::Model::SimplificationParameters parameters;
+    iDynTree::Model simplifiedModel;
+
+    SECTION("Fixed joints")
+    {
+        std::size_t nrOfFixedJoints = 0;
+        for (std::size_t i = 0; i < model.getNrOfJoints(); i++)
+        {
+            nrOfFixedJoints += model.getJoint(i)->getNrOfDOFs() == 0 ? 1 : 0;
+        }
+
+        REQUIRE(BiomechanicalAnalysis::Model::ModelSimplification::simplifyModel(model, parameters, simplifiedModel));
+        REQUIRE(simplifiedModel.getNrOfJoints() == model.getNrOfJoints() - nrOfFixedJoints);
+        REQUIRE(simplifiedModel.getNrOfDOFs() == model.getNrOfDOFs());
+        REQUIRE(std::abs(totalMass(simplifiedModel) - totalMass(model)) < tolerance);
+
+        // the lumped links are still available as frames, with the same kinematics
+        iDynTree::VectorDynSize jointPositions(model.getNrOfDOFs());
+        iDynTree::getRandomVector(jointPositions);
+        iDynTree::KinDynComputations kinDyn, simplifiedKinDyn;
+        REQUIRE(kinDyn.loadRobotModel(model));
+        REQUIRE(simplifiedKinDyn.loadRobotModel(simplifiedModel));
+        REQUIRE(kinDyn.setJointPos(jointPositions));
+        iDynTree::VectorDynSize simplifiedJointPositions(simplifiedModel.getNrOfDOFs());
+        for (std::size_t i = 0; i < simplifiedModel.getNrOfJoints(); i++)
+        {
+            const iDynTree::IJointConstPtr joint = simplifiedModel.getJoint(i);
+            if (joint->getNrOfDOFs() > 0)
+            {
+                const iDynTree::JointIndex index = model.getJointIndex(simplifiedModel.getJointName(i));
+                simplifiedJointPositions(joint->getDOFsOffset()) = jointPositions(model.getJoint(index)->getDOFsOffset());
+            }
+        }
+        REQUIRE(simplifiedKinDyn.setJointPos(simplifiedJointPositions));
+        for (std::size_t i = 0; i < model.getNrOfFrames(); i++)
+        {
+            const std::string name = model.getFrameName(i);
+            REQUIRE(simplifiedModel.isFrameNameUsed(name));
+            REQUIRE(iDynTree::toEigen(simplifiedKinDyn.getWorldTransform(name).asHomogeneousTransform())
+                        .isApprox(iDynTree::toEigen(kinDyn.getWorldTransform(name).asHomogeneousTransform()), tolerance));
+        }
+    }
+
+    SECTION("Negligible subtrees")
+    {
+        parameters.massThreshold = 2.0 * totalMass(model);
+        parameters.inertiaThreshold = 1e6;
+        parameters.lumpFixedJoints = false;
+
+        // without preserved links the whole model is lumped in the base
+        REQUIRE(BiomechanicalAnalysis::Model::ModelSimplification::simplifyModel(model, parameters, simplifiedModel));
+        REQUIRE(simplifiedModel.getNrOfLinks() == 1);
+        REQUIRE(std::abs(totalMass(simplifiedModel) - totalMass(model)) < tolerance);
+
+        // the preserved link is kept, together with the links connecting it to the base
+        const std::string preservedLink = model.getLinkName(model.getNrOfLinks() - 1);
+        parameters.preservedLinks.push_back(preservedLink);
+        REQUIRE(BiomechanicalAnalysis::Model::ModelSimplification::simplifyModel(model, parameters, simplifiedModel));
+        REQUIRE(simplifiedModel.getLinkIndex(preservedLink) != iDynTree::LINK_INVALID_INDEX);
+        REQUIRE(simplifiedModel.getNrOfLinks() < model.getNrOfLinks());
+        REQUIRE(std::abs(totalMass(simplifiedModel) - totalMass(model)) < tolerance);
+
+        parameters.preservedLinks.push_back("notALink");
+        REQUIRE_FALSE(BiomechanicalAnalysis::Model::ModelSimplification::simplifyModel(model, parameters, simplifiedModel));
+    }
+}
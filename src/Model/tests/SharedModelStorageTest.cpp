@@ -0,0 +1,200 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <BiomechanicalAnalysis/Model/SharedModelStorage.h>
+#include <iDynTree/AccelerometerSensor.h>
+#include <iDynTree/EigenHelpers.h>
+#include <iDynTree/GyroscopeSensor.h>
+#include <iDynTree/KinDynComputations.h>
+#include <iDynTree/ModelTestUtils.h>
+#include <iDynTree/SixAxisForceTorqueSensor.h>
+
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace
+{
+
+// create a segment with the content of another segment, modified by corrupt
+bool createCorruptedCopy(const std::string& source,
+                         const std::string& name,
+                         const std::function<void(std::vector<unsigned char>&)>& corrupt)
+{
+    const int sourceDescriptor = shm_open(source.c_str(), O_RDONLY, 0);
+    struct stat status;
+    if (sourceDescriptor < 0 || fstat(sourceDescriptor, &status) != 0)
+    {
+        return false;
+    }
+    std::vector<unsigned char> data(status.st_size);
+    const bool read = pread(sourceDescriptor, data.data(), data.size(), 0) == static_cast<ssize_t>(data.size());
+    close(sourceDescriptor);
+    if (!read)
+    {
+        return false;
+    }
+
+    corrupt(data);
+    const int descriptor = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, S_IRUSR | S_IWUSR);
+    if (descriptor < 0)
+    {
+        return false;
+    }
+    const bool written = write(descriptor, data.data(), data.size()) == static_cast<ssize_t>(data.size());
+    close(descriptor);
+    return written;
+}
+
+} // namespace
+
+TEST_CASE("Shared model storage test")
+{
+    constexpr double tolerance = 1e-12;
+    iDynTree::Model model = iDynTree::getRandomModel(20, 5);
+
+    // the sensors used by BERDY: an IMU and a force-torque sensor on the first joint
+    iDynTree::AccelerometerSensor accelerometer;
+    accelerometer.setName("accelerometer");
+    accelerometer.setParentLink(model.getLinkName(1));
+    accelerometer.setLinkSensorTransform(iDynTree::getRandomTransform());
+    iDynTree::GyroscopeSensor gyroscope;
+    gyroscope.setName("gyroscope");
+    gyroscope.setParentLink(model.getLinkName(2));
+    gyroscope.setLinkSensorTransform(iDynTree::getRandomTransform());
+    const iDynTree::IJoint* ftJoint = model.getJoint(0);
+    iDynTree::SixAxisForceTorqueSensor forceTorque;
+    forceTorque.setName("forceTorque");
+    forceTorque.setParentJoint(model.getJointName(0));
+    forceTorque.setFirstLinkName(model.getLinkName(ftJoint->getFirstAttachedLink()));
+    forceTorque.setSecondLinkName(model.getLinkName(ftJoint->getSecondAttachedLink()));
+    forceTorque.setFirstLinkSensorTransform(ftJoint->getFirstAttachedLink(), iDynTree::getRandomTransform());
+    forceTorque.setSecondLinkSensorTransform(ftJoint->getSecondAttachedLink(), iDynTree::getRandomTransform());
+    forceTorque.setAppliedWrenchLink(ftJoint->getSecondAttachedLink());
+    for (iDynTree::Sensor* sensor : std::vector<iDynTree::Sensor*>{&accelerometer, &gyroscope, &forceTorque})
+    {
+        REQUIRE(sensor->updateIndices(model));
+        REQUIRE(model.sensors().addSensor(*sensor) >= 0);
+    }
+    const std::string name = "/bafSharedModelStorageTest" + std::to_string(getpid());
+
+    BiomechanicalAnalysis::Model::SharedModelStorage loader, worker;
+    iDynTree::Model sharedModel;
+
+    // nothing to map or to read yet
+    REQUIRE_FALSE(worker.open(name));
+    REQUIRE_FALSE(worker.getModel(sharedModel));
+
+    REQUIRE(loader.create(name, model));
+    REQUIRE(loader.getSize() > 0);
+
+    // a segment with the same name cannot be created twice
+    BiomechanicalAnalysis::Model::SharedModelStorage otherLoader;
+    REQUIRE_FALSE(otherLoader.create(name, model));
+
+    REQUIRE(worker.open(name));
+    REQUIRE(worker.getSize() == loader.getSize());
+    REQUIRE(worker.getModel(sharedModel));
+
+    REQUIRE(sharedModel.getNrOfLinks() == model.getNrOfLinks());
+    REQUIRE(sharedModel.getNrOfJoints() == model.getNrOfJoints());
+    REQUIRE(sharedModel.getNrOfDOFs() == model.getNrOfDOFs());
+    REQUIRE(sharedModel.getNrOfFrames() == model.getNrOfFrames());
+    REQUIRE(sharedModel.getDefaultBaseLink() == model.getDefaultBaseLink());
+    for (std::size_t i = 0; i < model.getNrOfJoints(); i++)
+    {
+        REQUIRE(sharedModel.getJointName(i) == model.getJointName(i));
+        REQUIRE(sharedModel.getJoint(i)->getDOFsOffset() == model.getJoint(i)->getDOFsOffset());
+    }
+
+    // the sensors are attached to the same links with the same transforms
+    REQUIRE(sharedModel.sensors().getNrOfSensors(iDynTree::ACCELEROMETER) == 1);
+    REQUIRE(sharedModel.sensors().getNrOfSensors(iDynTree::GYROSCOPE) == 1);
+    REQUIRE(sharedModel.sensors().getNrOfSensors(iDynTree::SIX_AXIS_FORCE_TORQUE) == 1);
+    for (const iDynTree::SensorType type : {iDynTree::ACCELEROMETER, iDynTree::GYROSCOPE})
+    {
+        const auto sensor = dynamic_cast<const iDynTree::LinkSensor*>(model.sensors().getSensor(type, 0));
+        const auto sharedSensor = dynamic_cast<const iDynTree::LinkSensor*>(sharedModel.sensors().getSensor(type, 0));
+        REQUIRE(sharedSensor != nullptr);
+        REQUIRE(sharedSensor->getName() == sensor->getName());
+        REQUIRE(sharedSensor->getParentLinkIndex() == sensor->getParentLinkIndex());
+        REQUIRE(iDynTree::toEigen(sharedSensor->getLinkSensorTransform().asHomogeneousTransform())
+                    .isApprox(iDynTree::toEigen(sensor->getLinkSensorTransform().asHomogeneousTransform()), tolerance));
+    }
+    const auto sharedForceTorque
+        = dynamic_cast<const iDynTree::SixAxisForceTorqueSensor*>(sharedModel.sensors().getSensor(iDynTree::SIX_AXIS_FORCE_TORQUE, 0));
+    REQUIRE(sharedForceTorque != nullptr);
+    REQUIRE(sharedForceTorque->getName() == "forceTorque");
+    REQUIRE(sharedForceTorque->getParentJointIndex() == 0);
+    REQUIRE(sharedForceTorque->getAppliedWrenchLink() == forceTorque.getAppliedWrenchLink());
+    for (const iDynTree::LinkIndex link : {forceTorque.getFirstLinkIndex(), forceTorque.getSecondLinkIndex()})
+    {
+        iDynTree::Transform link_H_sensor, sharedLink_H_sensor;
+        REQUIRE(forceTorque.getLinkSensorTransform(link, link_H_sensor));
+        REQUIRE(sharedForceTorque->getLinkSensorTransform(link, sharedLink_H_sensor));
+        REQUIRE(iDynTree::toEigen(sharedLink_H_sensor.asHomogeneousTransform())
+                    .isApprox(iDynTree::toEigen(link_H_sensor.asHomogeneousTransform()), tolerance));
+    }
+
+    // same kinematics and dynamics for the same joint positions
+    iDynTree::VectorDynSize jointPositions(model.getNrOfDOFs());
+    iDynTree::getRandomVector(jointPositions);
+    iDynTree::KinDynComputations kinDyn, sharedKinDyn;
+    REQUIRE(kinDyn.loadRobotModel(model));
+    REQUIRE(sharedKinDyn.loadRobotModel(sharedModel));
+    REQUIRE(kinDyn.setJointPos(jointPositions));
+    REQUIRE(sharedKinDyn.setJointPos(jointPositions));
+    for (std::size_t i = 0; i < model.getNrOfFrames(); i++)
+    {
+        const std::string frame = model.getFrameName(i);
+        REQUIRE(iDynTree::toEigen(sharedKinDyn.getWorldTransform(frame).asHomogeneousTransform())
+                    .isApprox(iDynTree::toEigen(kinDyn.getWorldTransform(frame).asHomogeneousTransform()), tolerance));
+    }
+    iDynTree::FreeFloatingMassMatrix massMatrix(model), sharedMassMatrix(sharedModel);
+    REQUIRE(kinDyn.getFreeFloatingMassMatrix(massMatrix));
+    REQUIRE(sharedKinDyn.getFreeFloatingMassMatrix(sharedMassMatrix));
+    REQUIRE(iDynTree::toEigen(sharedMassMatrix).isApprox(iDynTree::toEigen(massMatrix), tolerance));
+
+    // a corrupted segment is rejected by open(), so that getModel() never reads outside of it; the
+    // offsets follow the layout of the segment: the offsets of the links and of the joints are at
+    // bytes 40 and 48 of the header and the one of the sensors at byte 64, the name is the first
+    // field of a record, the parent of a joint is at byte 16 of its record and the type of a sensor
+    // at byte 8
+    const std::string corruptedName = name + "Corrupted";
+    auto requireRejected = [&](const std::function<void(std::vector<unsigned char>&)>& corrupt) {
+        BiomechanicalAnalysis::Model::SharedModelStorage corruptedWorker;
+        REQUIRE(createCorruptedCopy(name, corruptedName, corrupt));
+        REQUIRE_FALSE(corruptedWorker.open(corruptedName));
+        shm_unlink(corruptedName.c_str());
+    };
+    auto readOffset = [](const std::vector<unsigned char>& data, std::size_t position) {
+        std::uint64_t offset;
+        std::memcpy(&offset, data.data() + position, sizeof(offset));
+        return offset;
+    };
+    requireRejected([](std::vector<unsigned char>& data) { data.resize(data.size() / 2); });
+    requireRejected([](std::vector<unsigned char>& data) { data.back() = 'x'; });
+    requireRejected([&](std::vector<unsigned char>& data) {
+        const std::uint64_t linkName = data.size();
+        std::memcpy(data.data() + readOffset(data, 40), &linkName, sizeof(linkName));
+    });
+    requireRejected([&](std::vector<unsigned char>& data) {
+        const std::int64_t parent = model.getNrOfLinks();
+        std::memcpy(data.data() + readOffset(data, 48) + 16, &parent, sizeof(parent));
+    });
+    requireRejected([&](std::vector<unsigned char>& data) {
+        const std::int64_t type = iDynTree::THREE_AXIS_FORCE_TORQUE_CONTACT;
+        std::memcpy(data.data() + readOffset(data, 64) + 8, &type, sizeof(type));
+    });
+
+    // the segment is removed when the loader is closed, the workers keep their mapping
+    loader.close();
+    REQUIRE(worker.getModel(sharedModel));
+    BiomechanicalAnalysis::Model::SharedModelStorage lateWorker;
+    REQUIRE_FALSE(lateWorker.open(name));
+}
@@ -0,0 +1,178 @@
+/**
+ * @file ContactSegmentation.h
+ * @authors Davide Gorbani <davide.gorbani@iit.it>
+ */
+
+#ifndef BIOMECHANICAL_ANALYSIS_OFFLINE_CONTACT_SEGMENTATION_H
+#define BIOMECHANICAL_ANALYSIS_OFFLINE_CONTACT_SEGMENTATION_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Eigen
+#include <Eigen/Dense>
+
+// BipedalLocomotion
+#include <BipedalLocomotion/ParametersHandler/IParametersHandler.h>
+
+#include <BiomechanicalAnalysis/ID/InverseDynamics.h>
+#include <BiomechanicalAnalysis/IK/InverseKinematics.h>
+
+namespace BiomechanicalAnalysis
+{
+namespace Offline
+{
+
+/**
+ * @brief Contact phase of a shoe
+ */
+struct ContactPhase
+{
+    std::size_t firstFrame{0}; /** first frame in contact */
+    std::size_t lastFrame{0}; /** last frame in contact, included */
+};
+
+/**
+ * @brief Contact state of the shoes for each frame of a recording, computed by
+ * ContactSegmentation, to be fed to the floor contact tasks of HumanIK and to the wrench sources
+ * of HumanID
+ */
+class ContactSchedule
+{
+public:
+    /**
+     * get the number of frames of the schedule
+     * @return number of frames
+     */
+    std::size_t getNrOfFrames() const;
+
+    /**
+     * get the nodes of the shoes of the schedule
+     * @return node numbers
+     */
+    const std::vector<int>& getNodeNumbers() const;
+
+    /**
+     * get the contact phases of a shoe
+     * @param node node number of the shoe
+     * @return contact phases, ordered by time, empty if the node is not in the schedule
+     */
+    const std::vector<ContactPhase>& getPhases(const int node) const;
+
+    /**
+     * check if a shoe is in contact
+     * @param node node number of the shoe
+     * @param frame frame of the recording
+     * @return true if the shoe is in contact, false if it is not or the node or the frame are not
+     * in the schedule
+     */
+    bool isInContact(const int node, const std::size_t frame) const;
+
+    /**
+     * set the contact state of the floor contact tasks of HumanIK
+     * @param frame frame of the recording
+     * @param ik HumanIK object, with a floor contact task for each node of the schedule
+     * @param linkHeight height of the link in contact, used as set point when the contact starts
+     * @return true if all the contact states have been set
+     */
+    bool applyToHumanIK(const std::size_t frame, IK::HumanIK& ik, const double linkHeight = 0.0) const;
+
+    /**
+     * set the active wrench sources of HumanID, i.e. the sources of the shoes in contact
+     * @param frame frame of the recording
+     * @param id HumanID object, with a wrench source for each node of the schedule
+     * @return true if the active sources have been set, false if the frame is not in the schedule
+     * or the schedule has no wrench sources
+     * @note the sources with the `contactForceThreshold` parameter are overridden by HumanID, see
+     * HumanID::setActiveWrenchSources
+     */
+    bool applyToHumanID(const std::size_t frame, ID::HumanID& id) const;
+
+private:
+    friend class ContactSegmentation;
+
+    std::size_t m_nrOfFrames{0}; /** number of frames */
+    std::vector<int> m_nodeNumbers; /** nodes of the shoes */
+    std::vector<std::string> m_wrenchSources; /** wrench source of each shoe, empty if not set */
+    std::vector<std::vector<ContactPhase>> m_phases; /** contact phases of each shoe */
+    Eigen::Matrix<std::uint8_t, Eigen::Dynamic, Eigen::Dynamic> m_contacts; /** contact state, one
+                                                                               column for each frame
+                                                                               and one row for each
+                                                                               shoe */
+    std::vector<std::string> m_activeSources; /** buffer of the active wrench sources */
+};
+
+/**
+ * @brief Offline segmentation of the vertical forces of the shoes of a whole recording into contact
+ * phases.
+ * A shoe gets in contact when its vertical force exceeds the contact threshold and it leaves the
+ * contact when the force falls below the release threshold, which is not larger than the contact
+ * one. Afterwards, the swing phases shorter than the minimum swing duration are merged with the
+ * contact phases around them, and the contact phases shorter than the minimum contact duration are
+ * removed. Since the whole recording is available, the thresholds are compared with all the
+ * samples at once, and the rules act on the phases instead of the single frames.
+ */
+class ContactSegmentation
+{
+public:
+    // clang-format off
+    /**
+     * initialize the segmentation
+     * @param handler pointer to the parameters handler
+     * @return true if the segmentation is initialized correctly
+     * @note the following parameters are used by the class
+     * |      Parameter Name      |       Type       |                                        Description                                        | Mandatory |
+     * |:------------------------:|:----------------:|:-----------------------------------------------------------------------------------------:|:---------:|
+     * |      `node_numbers`      |   `vector<int>`  |                                  Nodes of the shoes                                       |    Yes    |
+     * |     `wrench_sources`     | `vector<string>` |  Output frames of the HumanID wrench source of each shoe, in the order of `node_numbers`  |    No     |
+     * |     `sampling_time`      |     `double`     |                            Sampling time of the recording, in s                           |    Yes    |
+     * |   `contact_threshold`    |     `double`     |                 Vertical force above which the shoe gets in contact, in N                 |    Yes    |
+     * |   `release_threshold`    |     `double`     |       Vertical force below which the shoe leaves the contact, in N. Default `contact_threshold` |    No     |
+     * |  `min_contact_duration`  |     `double`     |                         Shortest contact phase, in s. Default 0.0                          |    No     |
+     * |   `min_swing_duration`   |     `double`     |                  Shortest swing phase between two contacts, in s. Default 0.0                |    No     |
+     */
+    // clang-format on
+    bool initialize(std::weak_ptr<const BipedalLocomotion::ParametersHandler::IParametersHandler> handler);
+
+    /**
+     * segment the vertical forces of the shoes of a recording
+     * @param verticalForces vertical force of each frame of the recording, for each node of the
+     * segmentation; all the vectors must have the same size
+     * @param schedule contact schedule of the recording
+     * @return true if the segmentation is successful
+     */
+    bool segment(const std::unordered_map<int, Eigen::VectorXd>& verticalForces, ContactSchedule& schedule) const;
+
+    /**
+     * segment the vertical forces of the shoes of a recording, given as the wrenches of the frames
+     * @param wrenches wrench of each shoe for each frame of the recording, as passed to
+     * HumanIK::updateFloorContactTasks
+     * @param schedule contact schedule of the recording
+     * @return true if the segmentation is successful
+     */
+    bool segment(const std::vector<std::unordered_map<int, Eigen::Matrix<double, 6, 1>>>& wrenches, ContactSchedule& schedule) const;
+
+private:
+    /**
+     * compute the contact phases of a shoe
+     * @param verticalForce vertical force of each frame
+     * @param phases contact phases
+     */
+    void segmentShoe(const Eigen::Ref<const Eigen::VectorXd>& verticalForce, std::vector<ContactPhase>& phases) const;
+
+    std::vector<int> m_nodeNumbers; /** nodes of the shoes */
+    std::vector<std::string> m_wrenchSources; /** wrench source of each shoe */
+    double m_contactThreshold{0.0}; /** vertical force above which the shoe gets in contact */
+    double m_releaseThreshold{0.0}; /** vertical force below which the shoe leaves the contact */
+    std::size_t m_minContactFrames{0}; /** number of frames of the shortest contact phase */
+    std::size_t m_minSwingFrames{0}; /** number of frames of the shortest swing phase */
+};
+
+} // namespace Offline
+} // namespace BiomechanicalAnalysis
+
+#endif // BIOMECHANICAL_ANALYSIS_OFFLINE_CONTACT_SEGMENTATION_H
@@ -0,0 +1,112 @@
+/**
+ * @file TPoseDetector.h
+ * @authors Davide Gorbani <davide.gorbani@iit.it>
+ */
+
+#ifndef BIOMECHANICAL_ANALYSIS_OFFLINE_TPOSE_DETECTOR_H
+#define BIOMECHANICAL_ANALYSIS_OFFLINE_TPOSE_DETECTOR_H
+
+#include <cstddef>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+// BipedalLocomotion
+#include <BipedalLocomotion/ParametersHandler/IParametersHandler.h>
+
+#include <BiomechanicalAnalysis/IK/InverseKinematics.h>
+
+namespace BiomechanicalAnalysis
+{
+namespace Offline
+{
+
+/**
+ * @brief Candidate window of a recording for the T-pose calibration
+ */
+struct CalibrationWindow
+{
+    std::size_t firstFrame{0}; /** first frame of the window */
+    std::size_t lastFrame{0}; /** last frame of the window, included */
+    std::size_t calibrationFrame{0}; /** frame to be passed to the calibration functions of HumanIK */
+    double angularSpeed{0.0}; /** root mean square angular speed of the least still node, in rad/s */
+    double postureDistance{0.0}; /** mean distance from the reference posture of the farthest node,
+                                    in rad, zero without a reference posture */
+    double score{0.0}; /** cost of the window, the lower the better */
+};
+
+/**
+ * @brief Offline detector of the T-pose segments of a recording, whose frames can be used by
+ * HumanIK::calibrateWorldYaw and HumanIK::calibrateAllWithWorld without human interaction.
+ * A window is a candidate if all the nodes are still, i.e. the root mean square of their angular
+ * speed, computed from the differences of consecutive orientations, is below a threshold. If a
+ * reference posture is set, e.g. from a T-pose of a previous recording with the same suit, the
+ * orientations of the nodes relative to the first node must also be close to the reference ones,
+ * so that still segments in other postures, e.g. sitting, are discarded. The candidates are ranked
+ * by the sum of the two statistics normalized by their thresholds, and the overlapping ones are
+ * suppressed in favour of the best one.
+ * The statistics of each frame and of each window are computed in parallel chunks on the
+ * System::Executor, with prefix sums so that the cost of a window does not depend on its length.
+ */
+class TPoseDetector
+{
+public:
+    // clang-format off
+    /**
+     * initialize the detector
+     * @param handler pointer to the parameters handler
+     * @return true if the detector is initialized correctly
+     * @note the following parameters are used by the class
+     * |     Parameter Name     |      Type      |                                       Description                                       | Mandatory |
+     * |:----------------------:|:--------------:|:---------------------------------------------------------------------------------------:|:---------:|
+     * |     `node_numbers`     |  `vector<int>` |   Nodes used by the detector, the posture is expressed relative to the first one        |    Yes    |
+     * |    `sampling_time`     |    `double`    |                          Sampling time of the recording, in s                           |    Yes    |
+     * |   `window_duration`    |    `double`    |                   Duration of the candidate windows, in s. Default 1.0                  |    No     |
+     * |    `window_stride`     |    `double`    |           Time between the starts of two candidate windows, in s. Default 0.1          |    No     |
+     * |  `max_angular_speed`   |    `double`    |          Largest angular speed of a still node, in rad/s. Default 0.15                  |    No     |
+     * | `max_posture_distance` |    `double`    |   Largest distance of a node from the reference posture, in rad. Default 0.35           |    No     |
+     * |    `max_candidates`    |      `int`     |                      Largest number of returned candidates. Default 5                    |    No     |
+     * |      `chunk_size`      |      `int`     |                 Number of frames of each parallel chunk. Default 4096                   |    No     |
+     */
+    // clang-format on
+    bool initialize(std::weak_ptr<const BipedalLocomotion::ParametersHandler::IParametersHandler> handler);
+
+    /**
+     * set the reference posture from a frame in T-pose
+     * @param frame orientations of the nodes in T-pose, it must contain all the nodes of the detector
+     * @return true if the reference posture has been set
+     */
+    bool setReferencePosture(const std::unordered_map<int, IK::nodeData>& frame);
+
+    /**
+     * remove the reference posture, so that the candidates are selected only by their stillness
+     */
+    void clearReferencePosture();
+
+    /**
+     * scan a recording and return the candidate calibration windows
+     * @param frames orientations of the nodes for each frame of the recording; the frames where a
+     * node is missing cannot be part of a candidate window
+     * @param candidates candidate windows, ordered from the best one, not overlapping with each other
+     * @return true if the recording has been scanned, also if no candidates are found
+     */
+    bool detect(const std::vector<std::unordered_map<int, IK::nodeData>>& frames, std::vector<CalibrationWindow>& candidates) const;
+
+private:
+    std::vector<int> m_nodeNumbers; /** nodes used by the detector */
+    double m_samplingTime{0.01}; /** sampling time of the recording */
+    std::size_t m_windowFrames{100}; /** number of frames of a window */
+    std::size_t m_strideFrames{10}; /** number of frames between the starts of two windows */
+    double m_maxAngularSpeed{0.15}; /** largest angular speed of a still node */
+    double m_maxPostureDistance{0.35}; /** largest distance from the reference posture */
+    std::size_t m_maxCandidates{5}; /** largest number of candidates */
+    std::size_t m_chunkSize{4096}; /** number of frames of each parallel chunk */
+    std::vector<Eigen::Matrix3d> m_referencePosture; /** orientations of the nodes relative to the
+                                                        first one in the reference posture, empty
+                                                        if not set */
+};
+
+} // namespace Offline
+} // namespace BiomechanicalAnalysis
+
+#endif // BIOMECHANICAL_ANALYSIS_OFFLINE_TPOSE_DETECTOR_H
@@ -0,0 +1,262 @@
+#include <BiomechanicalAnalysis/Logging/Logger.h>
+#include <BiomechanicalAnalysis/Offline/ContactSegmentation.h>
+
+#include <algorithm>
+#include <cmath>
+
+using namespace BiomechanicalAnalysis::Offline;
+
+namespace
+{
+
+constexpr std::size_t WRENCH_FORCE_Z = 2;
+
+} // namespace
+
+std::size_t ContactSchedule::getNrOfFrames() const
+{
+    return m_nrOfFrames;
+}
+
+const std::vector<int>& ContactSchedule::getNodeNumbers() const
+{
+    return m_nodeNumbers;
+}
+
+const std::vector<ContactPhase>& ContactSchedule::getPhases(const int node) const
+{
+    static const std::vector<ContactPhase> noPhases;
+    const auto it = std::find(m_nodeNumbers.begin(), m_nodeNumbers.end(), node);
+    return it == m_nodeNumbers.end() ? noPhases : m_phases[it - m_nodeNumbers.begin()];
+}
+
+bool ContactSchedule::isInContact(const int node, const std::size_t frame) const
+{
+    const auto it = std::find(m_nodeNumbers.begin(), m_nodeNumbers.end(), node);
+    return it != m_nodeNumbers.end() && frame < m_nrOfFrames && m_contacts(it - m_nodeNumbers.begin(), frame) != 0;
+}
+
+bool ContactSchedule::applyToHumanIK(const std::size_t frame, IK::HumanIK& ik, const double linkHeight) const
+{
+    constexpr auto logPrefix = "[ContactSchedule::applyToHumanIK]";
+
+    if (frame >= m_nrOfFrames)
+    {
+        BiomechanicalAnalysis::log()->error("{} Frame {} is not in the schedule of {} frames.", logPrefix, frame, m_nrOfFrames);
+        return false;
+    }
+    for (std::size_t k = 0; k < m_nodeNumbers.size(); k++)
+    {
+        if (!ik.setFloorContact(m_nodeNumbers[k], m_contacts(k, frame) != 0, linkHeight))
+        {
+            BiomechanicalAnalysis::log()->error("{} Error setting the contact of node {}.", logPrefix, m_nodeNumbers[k]);
+            return false;
+        }
+    }
+    return true;
+}
+
+bool ContactSchedule::applyToHumanID(const std::size_t frame, ID::HumanID& id) const
+{
+    constexpr auto logPrefix = "[ContactSchedule::applyToHumanID]";
+
+    if (frame >= m_nrOfFrames)
+    {
+        BiomechanicalAnalysis::log()->error("{} Frame {} is not in the schedule of {} frames.", logPrefix, frame, m_nrOfFrames);
+        return false;
+    }
+    if (m_wrenchSources.empty())
+    {
+        BiomechanicalAnalysis::log()->error("{} The schedule has no wrench sources, set the parameter wrench_sources.", logPrefix);
+        return false;
+    }
+
+    std::vector<std::string> activeSources;
+    activeSources.reserve(m_wrenchSources.size());
+    for (std::size_t k = 0; k < m_wrenchSources.size(); k++)
+    {
+        if (m_contacts(k, frame) != 0)
+        {
+            activeSources.push_back(m_wrenchSources[k]);
+        }
+    }
+    return id.setActiveWrenchSources(activeSources);
+}
+
+bool ContactSegmentation::initialize(std::weak_ptr<const BipedalLocomotion::ParametersHandler::IParametersHandler> handler)
+{
+    constexpr auto logPrefix = "[ContactSegmentation::initialize]";
+
+    auto ptr = handler.lock();
+    if (ptr == nullptr)
+    {
+        BiomechanicalAnalysis::log()->error("{} Invalid parameters handler.", logPrefix);
+        return false;
+    }
+
+    if (!ptr->getParameter("node_numbers", m_nodeNumbers) || m_nodeNumbers.empty())
+    {
+        BiomechanicalAnalysis::log()->error("{} Parameter node_numbers is missing or empty.", logPrefix);
+        return false;
+    }
+    m_wrenchSources.clear();
+    if (ptr->getParameter("wrench_sources", m_wrenchSources) && m_wrenchSources.size() != m_nodeNumbers.size())
+    {
+        BiomechanicalAnalysis::log()->error("{} Parameter wrench_sources must have the same size of node_numbers.", logPrefix);
+        return false;
+    }
+
+    double samplingTime{0.0};
+    if (!ptr->getParameter("sampling_time", samplingTime) || samplingTime <= 0.0)
+    {
+        BiomechanicalAnalysis::log()->error("{} Parameter sampling_time is missing or not positive.", logPrefix);
+        return false;
+    }
+    if (!ptr->getParameter("contact_threshold", m_contactThreshold))
+    {
+        BiomechanicalAnalysis::log()->error("{} Parameter contact_threshold is missing.", logPrefix);
+        return false;
+    }
+    m_releaseThreshold = m_contactThreshold;
+    ptr->getParameter("release_threshold", m_releaseThreshold);
+    if (m_releaseThreshold > m_contactThreshold)
+    {
+        BiomechanicalAnalysis::log()->error("{} Parameter release_threshold must not be larger than contact_threshold.", logPrefix);
+        return false;
+    }
+
+    double minContactDuration{0.0};
+    double minSwingDuration{0.0};
+    ptr->getParameter("min_contact_duration", minContactDuration);
+    ptr->getParameter("min_swing_duration", minSwingDuration);
+    if (minContactDuration < 0.0 || minSwingDuration < 0.0)
+    {
+        BiomechanicalAnalysis::log()->error("{} The minimum durations must not be negative.", logPrefix);
+        return false;
+    }
+    m_minContactFrames = static_cast<std::size_t>(std::lround(minContactDuration / samplingTime));
+    m_minSwingFrames = static_cast<std::size_t>(std::lround(minSwingDuration / samplingTime));
+
+    return true;
+}
+
+void ContactSegmentation::segmentShoe(const Eigen::Ref<const Eigen::VectorXd>& verticalForce, std::vector<ContactPhase>& phases) const
+{
+    phases.clear();
+
+    // +1 where the shoe gets in contact, -1 where it leaves the contact, 0 in the hysteresis band
+    const Eigen::ArrayXi events = (verticalForce.array() > m_contactThreshold).cast<int>() - (verticalForce.array() < m_releaseThreshold).cast<int>();
+
+    bool inContact = false;
+    std::size_t begin = 0;
+    for (Eigen::Index i = 0; i < events.size(); i++)
+    {
+        if (events(i) != 0 && (events(i) > 0) != inContact)
+        {
+            inContact = !inContact;
+            if (inContact)
+            {
+                begin = i;
+            } else
+            {
+                phases.push_back({begin, static_cast<std::size_t>(i) - 1});
+            }
+        }
+    }
+    if (inContact)
+    {
+        phases.push_back({begin, static_cast<std::size_t>(events.size()) - 1});
+    }
+
+    // the short swing phases are merged with the contact phases around them
+    std::size_t merged = 0;
+    for (std::size_t i = 1; i < phases.size(); i++)
+    {
+        if (phases[i].firstFrame - phases[merged].lastFrame - 1 < m_minSwingFrames)
+        {
+            phases[merged].lastFrame = phases[i].lastFrame;
+        } else
+        {
+            phases[++merged] = phases[i];
+        }
+    }
+    if (!phases.empty())
+    {
+        phases.resize(merged + 1);
+    }
+
+    // the short contact phases are removed
+    phases.erase(std::remove_if(phases.begin(),
+                                phases.end(),
+                                [this](const ContactPhase& phase) { return phase.lastFrame - phase.firstFrame + 1 < m_minContactFrames; }),
+                 phases.end());
+}
+
+bool ContactSegmentation::segment(const std::unordered_map<int, Eigen::VectorXd>& verticalForces, ContactSchedule& schedule) const
+{
+    constexpr auto logPrefix = "[ContactSegmentation::segment]";
+
+    if (m_nodeNumbers.empty())
+    {
+        BiomechanicalAnalysis::log()->error("{} The segmentation is not initialized.", logPrefix);
+        return false;
+    }
+
+    Eigen::Index nrOfFrames = -1;
+    for (const int node : m_nodeNumbers)
+    {
+        const auto it = verticalForces.find(node);
+        if (it == verticalForces.end())
+        {
+            BiomechanicalAnalysis::log()->error("{} The vertical force of node {} is missing.", logPrefix, node);
+            return false;
+        }
+        if (nrOfFrames >= 0 && it->second.size() != nrOfFrames)
+        {
+            BiomechanicalAnalysis::log()->error("{} The vertical forces must have the same number of frames.", logPrefix);
+            return false;
+        }
+        nrOfFrames = it->second.size();
+    }
+
+    schedule.m_nrOfFrames = static_cast<std::size_t>(nrOfFrames);
+    schedule.m_nodeNumbers = m_nodeNumbers;
+    schedule.m_wrenchSources = m_wrenchSources;
+    schedule.m_phases.resize(m_nodeNumbers.size());
+    schedule.m_contacts.setZero(m_nodeNumbers.size(), nrOfFrames);
+    for (std::size_t k = 0; k < m_nodeNumbers.size(); k++)
+    {
+        segmentShoe(verticalForces.at(m_nodeNumbers[k]), schedule.m_phases[k]);
+        for (const auto& phase : schedule.m_phases[k])
+        {
+            schedule.m_contacts.row(k).segment(phase.firstFrame, phase.lastFrame - phase.firstFrame + 1).setOnes();
+        }
+    }
+
+    return true;
+}
+
+bool ContactSegmentation::segment(const std::vector<std::unordered_map<int, Eigen::Matrix<double, 6, 1>>>& wrenches,
+                                  ContactSchedule& schedule) const
+{
+    constexpr auto logPrefix = "[ContactSegmentation::segment]";
+
+    std::unordered_map<int, Eigen::VectorXd> verticalForces;
+    for (const int node : m_nodeNumbers)
+    {
+        Eigen::VectorXd& verticalForce = verticalForces[node];
+        verticalForce.resize(wrenches.size());
+        for (std::size_t i = 0; i < wrenches.size(); i++)
+        {
+            const auto it = wrenches[i].find(node);
+            if (it == wrenches[i].end())
+            {
+                BiomechanicalAnalysis::log()->error("{} The wrench of node {} is missing in frame {}.", logPrefix, node, i);
+                return false;
+            }
+            verticalForce(i) = it->second(WRENCH_FORCE_Z);
+        }
+    }
+
+    return segment(verticalForces, schedule);
+}
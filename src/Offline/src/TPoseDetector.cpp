@@ -0,0 +1,295 @@
+#include <BiomechanicalAnalysis/Logging/Logger.h>
+#include <BiomechanicalAnalysis/Offline/TPoseDetector.h>
+#include <BiomechanicalAnalysis/System/Executor.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+using namespace BiomechanicalAnalysis::Offline;
+
+namespace
+{
+
+// angle of a rotation matrix, accurate also for small angles
+double rotationAngle(const Eigen::Matrix3d& rotation)
+{
+    const Eigen::Vector3d axis(rotation(2, 1) - rotation(1, 2), rotation(0, 2) - rotation(2, 0), rotation(1, 0) - rotation(0, 1));
+    return std::atan2(0.5 * axis.norm(), 0.5 * (rotation.trace() - 1.0));
+}
+
+} // namespace
+
+bool TPoseDetector::initialize(std::weak_ptr<const BipedalLocomotion::ParametersHandler::IParametersHandler> handler)
+{
+    constexpr auto logPrefix = "[TPoseDetector::initialize]";
+
+    auto ptr = handler.lock();
+    if (ptr == nullptr)
+    {
+        BiomechanicalAnalysis::log()->error("{} Invalid parameters handler.", logPrefix);
+        return false;
+    }
+
+    if (!ptr->getParameter("node_numbers", m_nodeNumbers) || m_nodeNumbers.empty())
+    {
+        BiomechanicalAnalysis::log()->error("{} Parameter node_numbers is missing or empty.", logPrefix);
+        return false;
+    }
+    if (!ptr->getParameter("sampling_time", m_samplingTime) || m_samplingTime <= 0.0)
+    {
+        BiomechanicalAnalysis::log()->error("{} Parameter sampling_time is missing or not positive.", logPrefix);
+        return false;
+    }
+
+    double windowDuration{1.0};
+    double windowStride{0.1};
+    int maxCandidates{5};
+    int chunkSize{4096};
+    m_maxAngularSpeed = 0.15;
+    m_maxPostureDistance = 0.35;
+    ptr->getParameter("window_duration", windowDuration);
+    ptr->getParameter("window_stride", windowStride);
+    ptr->getParameter("max_angular_speed", m_maxAngularSpeed);
+    ptr->getParameter("max_posture_distance", m_maxPostureDistance);
+    ptr->getParameter("max_candidates", maxCandidates);
+    ptr->getParameter("chunk_size", chunkSize);
+    if (windowDuration <= 0.0 || windowStride <= 0.0 || m_maxAngularSpeed <= 0.0 || m_maxPostureDistance <= 0.0 || maxCandidates <= 0
+        || chunkSize <= 0)
+    {
+        BiomechanicalAnalysis::log()->error("{} The durations, the thresholds, max_candidates and chunk_size must be positive.", logPrefix);
+        return false;
+    }
+
+    // at least two frames, so that the angular speed is defined
+    m_windowFrames = std::max<std::size_t>(2, static_cast<std::size_t>(std::lround(windowDuration / m_samplingTime)));
+    m_strideFrames = std::max<std::size_t>(1, static_cast<std::size_t>(std::lround(windowStride / m_samplingTime)));
+    m_maxCandidates = static_cast<std::size_t>(maxCandidates);
+    m_chunkSize = static_cast<std::size_t>(chunkSize);
+    m_referencePosture.clear();
+
+    return true;
+}
+
+bool TPoseDetector::setReferencePosture(const std::unordered_map<int, IK::nodeData>& frame)
+{
+    constexpr auto logPrefix = "[TPoseDetector::setReferencePosture]";
+
+    if (m_nodeNumbers.empty())
+    {
+        BiomechanicalAnalysis::log()->error("{} The detector is not initialized.", logPrefix);
+        return false;
+    }
+
+    std::vector<Eigen::Matrix3d> posture(m_nodeNumbers.size());
+    for (std::size_t k = 0; k < m_nodeNumbers.size(); k++)
+    {
+        const auto it = frame.find(m_nodeNumbers[k]);
+        if (it == frame.end())
+        {
+            BiomechanicalAnalysis::log()->error("{} Node {} is missing.", logPrefix, m_nodeNumbers[k]);
+            return false;
+        }
+        posture[k] = it->second.I_R_IMU.rotation();
+    }
+    for (std::size_t k = posture.size(); k-- > 0;)
+    {
+        posture[k] = posture[0].transpose() * posture[k];
+    }
+    m_referencePosture = std::move(posture);
+
+    return true;
+}
+
+void TPoseDetector::clearReferencePosture()
+{
+    m_referencePosture.clear();
+}
+
+bool TPoseDetector::detect(const std::vector<std::unordered_map<int, IK::nodeData>>& frames, std::vector<CalibrationWindow>& candidates) const
+{
+    constexpr auto logPrefix = "[TPoseDetector::detect]";
+
+    candidates.clear();
+    if (m_nodeNumbers.empty())
+    {
+        BiomechanicalAnalysis::log()->error("{} The detector is not initialized.", logPrefix);
+        return false;
+    }
+
+    const std::size_t nrOfFrames = frames.size();
+    const std::size_t nrOfNodes = m_nodeNumbers.size();
+    if (nrOfFrames < m_windowFrames)
+    {
+        return true;
+    }
+    const bool hasReference = !m_referencePosture.empty();
+    auto& executor = BiomechanicalAnalysis::System::Executor::instance();
+
+    // Prefix sums over the frames, element (i + 1) * nrOfNodes + k is the sum of the first i + 1
+    // frames for the node k:
+    // - squared angular speed between the frame i and the previous one
+    // - distance from the reference posture
+    // - number of frames with missing nodes
+    std::vector<double> speedSums((nrOfFrames + 1) * nrOfNodes, 0.0);
+    std::vector<double> postureSums(hasReference ? (nrOfFrames + 1) * nrOfNodes : 0, 0.0);
+    std::vector<std::size_t> missingSums(nrOfFrames + 1, 0);
+
+    // First pass: the statistics of each frame, accumulated within each chunk
+    const std::size_t nrOfChunks = (nrOfFrames + m_chunkSize - 1) / m_chunkSize;
+    executor.parallelFor(0, nrOfChunks, [&](std::size_t chunk) {
+        const std::size_t begin = chunk * m_chunkSize;
+        const std::size_t end = std::min(begin + m_chunkSize, nrOfFrames);
+        std::vector<Eigen::Matrix3d> orientations(nrOfNodes);
+        std::vector<Eigen::Matrix3d> previousOrientations(nrOfNodes);
+        bool previousComplete = false;
+        if (begin > 0)
+        {
+            previousComplete = true;
+            for (std::size_t k = 0; k < nrOfNodes && previousComplete; k++)
+            {
+                const auto it = frames[begin - 1].find(m_nodeNumbers[k]);
+                previousComplete = it != frames[begin - 1].end();
+                if (previousComplete)
+                {
+                    previousOrientations[k] = it->second.I_R_IMU.rotation();
+                }
+            }
+        }
+        for (std::size_t i = begin; i < end; i++)
+        {
+            double* speed = &speedSums[(i + 1) * nrOfNodes];
+            const double* previousSpeed = &speedSums[i * nrOfNodes];
+            bool complete = true;
+            for (std::size_t k = 0; k < nrOfNodes && complete; k++)
+            {
+                const auto it = frames[i].find(m_nodeNumbers[k]);
+                complete = it != frames[i].end();
+                if (complete)
+                {
+                    orientations[k] = it->second.I_R_IMU.rotation();
+                }
+            }
+            missingSums[i + 1] = (i > begin ? missingSums[i] : 0) + (complete ? 0 : 1);
+            for (std::size_t k = 0; k < nrOfNodes; k++)
+            {
+                double value = 0.0;
+                if (complete && previousComplete)
+                {
+                    value = rotationAngle(previousOrientations[k].transpose() * orientations[k]) / m_samplingTime;
+                }
+                speed[k] = (i > begin ? previousSpeed[k] : 0.0) + value * value;
+            }
+            if (hasReference)
+            {
+                double* posture = &postureSums[(i + 1) * nrOfNodes];
+                const double* previousPosture = &postureSums[i * nrOfNodes];
+                for (std::size_t k = 0; k < nrOfNodes; k++)
+                {
+                    const double value
+                        = complete ? rotationAngle(m_referencePosture[k].transpose() * orientations[0].transpose() * orientations[k]) : 0.0;
+                    posture[k] = (i > begin ? previousPosture[k] : 0.0) + value;
+                }
+            }
+            std::swap(orientations, previousOrientations);
+            previousComplete = complete;
+        }
+    });
+
+    // Second pass: the offsets of the chunks, computed sequentially, are added to their frames
+    std::vector<double> speedOffsets(nrOfChunks * nrOfNodes, 0.0);
+    std::vector<double> postureOffsets(hasReference ? nrOfChunks * nrOfNodes : 0, 0.0);
+    std::vector<std::size_t> missingOffsets(nrOfChunks, 0);
+    for (std::size_t chunk = 1; chunk < nrOfChunks; chunk++)
+    {
+        const std::size_t last = chunk * m_chunkSize;
+        missingOffsets[chunk] = missingOffsets[chunk - 1] + missingSums[last];
+        for (std::size_t k = 0; k < nrOfNodes; k++)
+        {
+            speedOffsets[chunk * nrOfNodes + k] = speedOffsets[(chunk - 1) * nrOfNodes + k] + speedSums[last * nrOfNodes + k];
+            if (hasReference)
+            {
+                postureOffsets[chunk * nrOfNodes + k] = postureOffsets[(chunk - 1) * nrOfNodes + k] + postureSums[last * nrOfNodes + k];
+            }
+        }
+    }
+    executor.parallelFor(1, nrOfChunks, [&](std::size_t chunk) {
+        const std::size_t begin = chunk * m_chunkSize;
+        const std::size_t end = std::min(begin + m_chunkSize, nrOfFrames);
+        for (std::size_t i = begin; i < end; i++)
+        {
+            missingSums[i + 1] += missingOffsets[chunk];
+            for (std::size_t k = 0; k < nrOfNodes; k++)
+            {
+                speedSums[(i + 1) * nrOfNodes + k] += speedOffsets[chunk * nrOfNodes + k];
+                if (hasReference)
+                {
+                    postureSums[(i + 1) * nrOfNodes + k] += postureOffsets[chunk * nrOfNodes + k];
+                }
+            }
+        }
+    });
+
+    // Statistics of the windows, the speed is averaged over the W - 1 differences of the window
+    const std::size_t nrOfWindows = (nrOfFrames - m_windowFrames) / m_strideFrames + 1;
+    std::vector<CalibrationWindow> windows(nrOfWindows);
+    std::vector<char> accepted(nrOfWindows, 0);
+    const std::size_t windowsPerChunk = std::max<std::size_t>(1, m_chunkSize / m_strideFrames);
+    const std::size_t nrOfWindowChunks = (nrOfWindows + windowsPerChunk - 1) / windowsPerChunk;
+    executor.parallelFor(0, nrOfWindowChunks, [&](std::size_t chunk) {
+        const std::size_t end = std::min((chunk + 1) * windowsPerChunk, nrOfWindows);
+        for (std::size_t w = chunk * windowsPerChunk; w < end; w++)
+        {
+            const std::size_t first = w * m_strideFrames;
+            const std::size_t last = first + m_windowFrames - 1;
+            if (missingSums[last + 1] != missingSums[first])
+            {
+                continue;
+            }
+            CalibrationWindow& window = windows[w];
+            window.firstFrame = first;
+            window.lastFrame = last;
+            window.calibrationFrame = first + m_windowFrames / 2;
+            for (std::size_t k = 0; k < nrOfNodes; k++)
+            {
+                const double speed = speedSums[(last + 1) * nrOfNodes + k] - speedSums[(first + 1) * nrOfNodes + k];
+                window.angularSpeed = std::max(window.angularSpeed, std::sqrt(std::max(speed, 0.0) / static_cast<double>(m_windowFrames - 1)));
+                if (hasReference)
+                {
+                    const double posture = postureSums[(last + 1) * nrOfNodes + k] - postureSums[first * nrOfNodes + k];
+                    window.postureDistance = std::max(window.postureDistance, posture / static_cast<double>(m_windowFrames));
+                }
+            }
+            window.score = window.angularSpeed / m_maxAngularSpeed + (hasReference ? window.postureDistance / m_maxPostureDistance : 0.0);
+            accepted[w] = window.angularSpeed <= m_maxAngularSpeed && window.postureDistance <= m_maxPostureDistance;
+        }
+    });
+
+    // Ranking, the windows overlapping a better candidate are suppressed
+    std::vector<std::size_t> order;
+    for (std::size_t w = 0; w < nrOfWindows; w++)
+    {
+        if (accepted[w])
+        {
+            order.push_back(w);
+        }
+    }
+    std::stable_sort(order.begin(), order.end(), [&windows](std::size_t a, std::size_t b) { return windows[a].score < windows[b].score; });
+    for (const std::size_t w : order)
+    {
+        if (candidates.size() == m_maxCandidates)
+        {
+            break;
+        }
+        const CalibrationWindow& window = windows[w];
+        const bool overlaps = std::any_of(candidates.begin(), candidates.end(), [&window](const CalibrationWindow& candidate) {
+            return window.firstFrame <= candidate.lastFrame && candidate.firstFrame <= window.lastFrame;
+        });
+        if (!overlaps)
+        {
+            candidates.push_back(window);
+        }
+    }
+
+    return true;
+}
@@ -0,0 +1,156 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <BiomechanicalAnalysis/Offline/ContactSegmentation.h>
+#include <BipedalLocomotion/ParametersHandler/StdImplementation.h>
+#include <BipedalLocomotion/ParametersHandler/TomlImplementation.h>
+#include <iDynTree/KinDynComputations.h>
+#include <iDynTree/ModelTestUtils.h>
+
+using namespace BiomechanicalAnalysis::Offline;
+
+TEST_CASE("ContactSegmentation test")
+{
+    auto handler = std::make_shared<BipedalLocomotion::ParametersHandler::StdImplementation>();
+    handler->setParameter("node_numbers", std::vector<int>{1, 2});
+    handler->setParameter("wrench_sources", std::vector<std::string>{"LeftFoot", "RightFoot"});
+    handler->setParameter("sampling_time", 0.01);
+    handler->setParameter("contact_threshold", 60.0);
+    handler->setParameter("release_threshold", 30.0);
+    handler->setParameter("min_contact_duration", 0.1);
+    handler->setParameter("min_swing_duration", 0.05);
+
+    ContactSegmentation segmentation;
+    REQUIRE(segmentation.initialize(handler));
+
+    // left shoe: a contact with a one frame dip, a spike of three frames, and a contact whose force
+    // stays for a while in the hysteresis band; the right shoe is never in contact
+    std::unordered_map<int, Eigen::VectorXd> verticalForces;
+    Eigen::VectorXd& left = verticalForces[1];
+    left = Eigen::VectorXd::Zero(1000);
+    left.segment(100, 200).setConstant(500.0);
+    left(150) = 20.0;
+    left.segment(400, 3).setConstant(500.0);
+    left.segment(600, 400).setConstant(500.0);
+    left.segment(700, 10).setConstant(40.0);
+    verticalForces[2] = Eigen::VectorXd::Zero(1000);
+
+    ContactSchedule schedule;
+    REQUIRE(segmentation.segment(verticalForces, schedule));
+    REQUIRE(schedule.getNrOfFrames() == 1000);
+    REQUIRE(schedule.getNodeNumbers() == std::vector<int>{1, 2});
+
+    const auto& phases = schedule.getPhases(1);
+    REQUIRE(phases.size() == 2);
+    REQUIRE(phases[0].firstFrame == 100);
+    REQUIRE(phases[0].lastFrame == 299);
+    REQUIRE(phases[1].firstFrame == 600);
+    REQUIRE(phases[1].lastFrame == 999);
+    REQUIRE(schedule.getPhases(2).empty());
+    REQUIRE(schedule.getPhases(3).empty());
+
+    REQUIRE_FALSE(schedule.isInContact(1, 99));
+    REQUIRE(schedule.isInContact(1, 150));
+    REQUIRE_FALSE(schedule.isInContact(1, 401));
+    REQUIRE(schedule.isInContact(1, 705));
+    REQUIRE_FALSE(schedule.isInContact(2, 705));
+    REQUIRE_FALSE(schedule.isInContact(1, 1000));
+
+    // the same schedule is obtained from the wrenches of the frames
+    std::vector<std::unordered_map<int, Eigen::Matrix<double, 6, 1>>> wrenches(1000);
+    for (std::size_t i = 0; i < wrenches.size(); i++)
+    {
+        for (const int node : {1, 2})
+        {
+            wrenches[i][node].setZero();
+            wrenches[i][node](2) = verticalForces[node](i);
+        }
+    }
+    ContactSchedule wrenchSchedule;
+    REQUIRE(segmentation.segment(wrenches, wrenchSchedule));
+    REQUIRE(wrenchSchedule.getPhases(1).size() == 2);
+    for (std::size_t i = 0; i < 1000; i++)
+    {
+        REQUIRE(wrenchSchedule.isInContact(1, i) == schedule.isInContact(1, i));
+    }
+
+    // the streams must have the same length
+    verticalForces[2].resize(999);
+    REQUIRE_FALSE(segmentation.segment(verticalForces, schedule));
+    verticalForces.erase(2);
+    REQUIRE_FALSE(segmentation.segment(verticalForces, schedule));
+
+    // the release threshold cannot be larger than the contact one
+    handler->setParameter("release_threshold", 70.0);
+    REQUIRE_FALSE(segmentation.initialize(handler));
+}
+
+TEST_CASE("ContactSchedule applied to HumanIK and HumanID test")
+{
+    // HumanIK and HumanID of the same model, the IK configuration has a floor contact task for the
+    // node 10 and the ID one has the wrench sources link0 and link1
+    auto kinDyn = std::make_shared<iDynTree::KinDynComputations>();
+    REQUIRE(kinDyn->loadRobotModel(iDynTree::getRandomModel(20)));
+    auto ikHandler = std::make_shared<BipedalLocomotion::ParametersHandler::TomlImplementation>();
+    REQUIRE(ikHandler->setFromFile(CONTACT_SEGMENTATION_IK_CONFIG));
+    auto idHandler = std::make_shared<BipedalLocomotion::ParametersHandler::TomlImplementation>();
+    REQUIRE(idHandler->setFromFile(CONTACT_SEGMENTATION_ID_CONFIG));
+    BiomechanicalAnalysis::IK::HumanIK ik;
+    REQUIRE(ik.initialize(ikHandler, kinDyn));
+    BiomechanicalAnalysis::ID::HumanID id;
+    REQUIRE(id.initialize(idHandler, kinDyn));
+
+    // the shoe of the node 10 is in contact in the frames [10, 29], the one of the node 11 in the
+    // frames [20, 39]
+    std::unordered_map<int, Eigen::VectorXd> verticalForces;
+    verticalForces[10] = Eigen::VectorXd::Zero(50);
+    verticalForces[10].segment(10, 20).setConstant(500.0);
+    verticalForces[11] = Eigen::VectorXd::Zero(50);
+    verticalForces[11].segment(20, 20).setConstant(500.0);
+
+    auto handler = std::make_shared<BipedalLocomotion::ParametersHandler::StdImplementation>();
+    handler->setParameter("node_numbers", std::vector<int>{10});
+    handler->setParameter("sampling_time", 0.01);
+    handler->setParameter("contact_threshold", 60.0);
+
+    // the floor contact task follows the schedule
+    ContactSegmentation segmentation;
+    REQUIRE(segmentation.initialize(handler));
+    ContactSchedule ikSchedule;
+    REQUIRE(segmentation.segment(verticalForces, ikSchedule));
+    bool inContact{true};
+    REQUIRE(ik.getFloorContact(10, inContact));
+    REQUIRE_FALSE(inContact);
+    for (const std::size_t frame : {5, 10, 29, 30})
+    {
+        REQUIRE(ikSchedule.applyToHumanIK(frame, ik));
+        REQUIRE(ik.getFloorContact(10, inContact));
+        REQUIRE(inContact == ikSchedule.isInContact(10, frame));
+    }
+    REQUIRE(ik.getFloorContact(10, inContact));
+    REQUIRE_FALSE(inContact);
+    REQUIRE_FALSE(ikSchedule.applyToHumanIK(50, ik));
+    REQUIRE_FALSE(ik.getFloorContact(11, inContact));
+
+    // the schedule has no wrench sources
+    REQUIRE_FALSE(ikSchedule.applyToHumanID(10, id));
+
+    // the active wrench sources are the ones of the shoes in contact
+    handler->setParameter("node_numbers", std::vector<int>{10, 11});
+    handler->setParameter("wrench_sources", std::vector<std::string>{"link0", "link1"});
+    REQUIRE(segmentation.initialize(handler));
+    ContactSchedule idSchedule;
+    REQUIRE(segmentation.segment(verticalForces, idSchedule));
+    REQUIRE(idSchedule.applyToHumanID(5, id));
+    REQUIRE(id.getActiveWrenchSources().empty());
+    REQUIRE(idSchedule.applyToHumanID(15, id));
+    REQUIRE(id.getActiveWrenchSources() == std::vector<std::string>{"link0"});
+    REQUIRE(idSchedule.applyToHumanID(25, id));
+    REQUIRE(id.getActiveWrenchSources() == std::vector<std::string>{"link0", "link1"});
+    REQUIRE(idSchedule.applyToHumanID(35, id));
+    REQUIRE(id.getActiveWrenchSources() == std::vector<std::string>{"link1"});
+    REQUIRE_FALSE(idSchedule.applyToHumanID(50, id));
+    REQUIRE(id.getActiveWrenchSources() == std::vector<std::string>{"link1"});
+
+    // HumanIK has no floor contact task for the node 11
+    REQUIRE_FALSE(idSchedule.applyToHumanIK(25, ik));
+}
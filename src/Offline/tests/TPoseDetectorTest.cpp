@@ -0,0 +1,139 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <BiomechanicalAnalysis/Offline/TPoseDetector.h>
+#include <BipedalLocomotion/ParametersHandler/StdImplementation.h>
+#include <manif/SO3.h>
+
+#include <cmath>
+#include <random>
+
+using namespace BiomechanicalAnalysis::Offline;
+
+namespace
+{
+
+constexpr double samplingTime = 0.01;
+const std::vector<int> nodeNumbers = {3, 6, 7};
+
+manif::SO3d toSO3(const Eigen::Vector3d& rotationVector)
+{
+    const double angle = rotationVector.norm();
+    if (angle < 1e-12)
+    {
+        return manif::SO3d(Eigen::Quaterniond::Identity());
+    }
+    return manif::SO3d(Eigen::Quaterniond(Eigen::AngleAxisd(angle, rotationVector / angle)));
+}
+
+// 60 s of motion with a T-pose between 10 s and 13 s and a still posture, e.g. sitting, between
+// 30 s and 33 s; the nodes have a small measurement noise
+std::vector<std::unordered_map<int, BiomechanicalAnalysis::IK::nodeData>> makeRecording()
+{
+    std::mt19937 generator(7);
+    std::normal_distribution<double> noise(0.0, 2e-4);
+    const std::vector<Eigen::Vector3d> tPose = {Eigen::Vector3d(0.0, 0.0, 0.3), Eigen::Vector3d(1.5, 0.0, 0.3), Eigen::Vector3d(-1.5, 0.0, 0.3)};
+    const std::vector<Eigen::Vector3d> sitting
+        = {Eigen::Vector3d(0.0, 0.0, 0.3), Eigen::Vector3d(0.0, 0.2, 0.3), Eigen::Vector3d(0.0, -0.2, 0.3)};
+
+    std::vector<std::unordered_map<int, BiomechanicalAnalysis::IK::nodeData>> frames(6000);
+    for (std::size_t i = 0; i < frames.size(); i++)
+    {
+        const double time = samplingTime * static_cast<double>(i);
+        for (std::size_t k = 0; k < nodeNumbers.size(); k++)
+        {
+            Eigen::Vector3d rotationVector;
+            if (time >= 10.0 && time < 13.0)
+            {
+                rotationVector = tPose[k];
+            } else if (time >= 30.0 && time < 33.0)
+            {
+                rotationVector = sitting[k];
+            } else
+            {
+                const double phase = 2.0 * time + static_cast<double>(k);
+                rotationVector = Eigen::Vector3d(0.6 * std::sin(phase), 0.4 * std::cos(phase), 0.3 + 0.2 * std::sin(0.5 * phase));
+            }
+            rotationVector += Eigen::Vector3d(noise(generator), noise(generator), noise(generator));
+            frames[i][nodeNumbers[k]].I_R_IMU = toSO3(rotationVector);
+        }
+    }
+    return frames;
+}
+
+bool isInside(const CalibrationWindow& window, double begin, double end)
+{
+    return window.firstFrame >= static_cast<std::size_t>(begin / samplingTime)
+           && window.lastFrame < static_cast<std::size_t>(end / samplingTime) && window.calibrationFrame >= window.firstFrame
+           && window.calibrationFrame <= window.lastFrame;
+}
+
+std::shared_ptr<BipedalLocomotion::ParametersHandler::IParametersHandler> makeHandler(int chunkSize)
+{
+    auto handler = std::make_shared<BipedalLocomotion::ParametersHandler::StdImplementation>();
+    handler->setParameter("node_numbers", nodeNumbers);
+    handler->setParameter("sampling_time", samplingTime);
+    handler->setParameter("window_duration", 1.0);
+    handler->setParameter("window_stride", 0.05);
+    handler->setParameter("chunk_size", chunkSize);
+    return handler;
+}
+
+} // namespace
+
+TEST_CASE("TPoseDetector test")
+{
+    TPoseDetector detector;
+    REQUIRE(detector.initialize(makeHandler(333)));
+
+    auto frames = makeRecording();
+    std::vector<CalibrationWindow> candidates;
+
+    // without a reference posture both the still segments are candidates
+    REQUIRE(detector.detect(frames, candidates));
+    REQUIRE(candidates.size() >= 2);
+    for (std::size_t i = 0; i < candidates.size(); i++)
+    {
+        REQUIRE((isInside(candidates[i], 10.0, 13.0) || isInside(candidates[i], 30.0, 33.0)));
+        REQUIRE(candidates[i].angularSpeed <= 0.15);
+        if (i > 0)
+        {
+            REQUIRE(candidates[i - 1].score <= candidates[i].score);
+            REQUIRE(candidates[i - 1].lastFrame < candidates[i].firstFrame || candidates[i].lastFrame < candidates[i - 1].firstFrame);
+        }
+    }
+
+    // the result does not depend on the size of the chunks
+    TPoseDetector singleChunkDetector;
+    REQUIRE(singleChunkDetector.initialize(makeHandler(100000)));
+    std::vector<CalibrationWindow> singleChunkCandidates;
+    REQUIRE(singleChunkDetector.detect(frames, singleChunkCandidates));
+    REQUIRE(singleChunkCandidates.size() == candidates.size());
+    for (std::size_t i = 0; i < candidates.size(); i++)
+    {
+        REQUIRE(singleChunkCandidates[i].firstFrame == candidates[i].firstFrame);
+        REQUIRE(std::abs(singleChunkCandidates[i].score - candidates[i].score) < 1e-6);
+    }
+
+    // with the reference posture only the T-pose is a candidate
+    REQUIRE(detector.setReferencePosture(frames[1100]));
+    REQUIRE(detector.detect(frames, candidates));
+    REQUIRE_FALSE(candidates.empty());
+    for (const auto& candidate : candidates)
+    {
+        REQUIRE(isInside(candidate, 10.0, 13.0));
+        REQUIRE(candidate.postureDistance <= 0.35);
+    }
+
+    // the windows with a missing node are discarded
+    for (std::size_t i = 1000; i < 1300; i += 50)
+    {
+        frames[i].erase(6);
+    }
+    REQUIRE(detector.detect(frames, candidates));
+    REQUIRE(candidates.empty());
+
+    // a recording shorter than a window has no candidates
+    frames.resize(50);
+    REQUIRE(detector.detect(frames, candidates));
+    REQUIRE(candidates.empty());
+}
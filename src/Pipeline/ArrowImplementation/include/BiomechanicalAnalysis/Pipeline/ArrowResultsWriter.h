@@ -0,0 +1,170 @@
+/**
+ * @file ArrowResultsWriter.h
+ * @authors Davide Gorbani <davide.gorbani@iit.it>
+ */
+
+#ifndef BIOMECHANICAL_ANALYSIS_PIPELINE_ARROW_RESULTS_WRITER_H
+#define BIOMECHANICAL_ANALYSIS_PIPELINE_ARROW_RESULTS_WRITER_H
+
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Eigen headers
+#include <Eigen/Dense>
+
+// Arrow headers
+#include <arrow/api.h>
+#include <arrow/io/api.h>
+#include <arrow/ipc/api.h>
+#include <parquet/arrow/writer.h>
+
+// BipedalLocomotion headers
+#include <BipedalLocomotion/ParametersHandler/IParametersHandler.h>
+
+#include <BiomechanicalAnalysis/ID/InverseDynamics.h>
+#include <BiomechanicalAnalysis/IK/InverseKinematics.h>
+
+namespace BiomechanicalAnalysis
+{
+namespace Pipeline
+{
+
+/**
+ * @brief Results of the estimation at one time instant
+ */
+struct ResultsSample
+{
+    double timestamp{0.0}; /** time instant of the results, in seconds */
+    Eigen::Vector3d basePosition{Eigen::Vector3d::Zero()}; /** base position */
+    Eigen::Vector4d baseOrientation{1.0, 0.0, 0.0, 0.0}; /** base quaternion (w, x, y, z) */
+    Eigen::VectorXd jointPositions; /** joint positions, ordered as `jointsList` */
+    Eigen::VectorXd jointVelocities; /** joint velocities, ordered as `jointsList` */
+    Eigen::VectorXd jointTorques; /** joint torques, ordered as `jointsList`, used only if
+                                     `writeTorques` is true */
+    std::vector<Eigen::Matrix<double, 6, 1>> wrenches; /** force and torque of the wrenches, ordered
+                                                          as `wrenchesList` */
+};
+
+// clang-format off
+/**
+ * @brief ArrowResultsWriter writes the results of HumanIK and HumanID as Arrow record batches, in
+ * an Arrow IPC file or in a Parquet file, so that they can be read directly by pandas or polars.
+ * Each quantity is a `float64` column, named after the joint or the frame it refers to:
+ * `timestamp`, `base/position_x`, ..., `base/orientation_w`, ..., `<joint>/position`,
+ * `<joint>/velocity`, `<joint>/torque` and `<frame>/force_x`, ..., `<frame>/torque_z`.
+ * The samples are appended to preallocated column builders by the calling thread, while the full
+ * batches are encoded and written by the I/O threads of the shared Executor, so that the solver
+ * loop never waits for the disk. An uncompressed Arrow IPC file can be memory-mapped by the readers
+ * without copies.
+ */
+// clang-format on
+class ArrowResultsWriter
+{
+public:
+    /**
+     * Destructor, it closes the file
+     */
+    ~ArrowResultsWriter();
+
+    // clang-format off
+    /**
+     * initialize the writer and create the file
+     * @param handler pointer to the parameters handler
+     * @return true if the writer is initialized correctly
+     * @note The following parameters are used:
+     * | Parameter name |       Type       |                                    Description                                     | Mandatory |
+     * |:--------------:|:----------------:|:----------------------------------------------------------------------------------:|:---------:|
+     * |   `filePath`   |     `string`     |                                path of the file                                    |    Yes    |
+     * |   `format`     |     `string`     |                  `ipc` (default) or `parquet`                                      |    No     |
+     * |  `jointsList`  | `vector<string>` |                       names of the joints, used as columns                         |    Yes    |
+     * | `writeTorques` |      `bool`      |               true to write the joint torques, by default false                    |    No     |
+     * | `wrenchesList` | `vector<string>` |                  frames of the wrenches, used as columns                           |    No     |
+     * |  `batchSize`   |      `int`       |               number of samples of each record batch, by default 1000              |    No     |
+     */
+    // clang-format on
+    bool initialize(std::weak_ptr<const BipedalLocomotion::ParametersHandler::IParametersHandler> handler);
+
+    /**
+     * initialize the writer and create the file, mapping the joints of HumanIK and HumanID to the
+     * columns of `jointsList`, so that the results can be written with write(double, const
+     * IK::HumanIK&, ID::HumanID*)
+     * @param handler pointer to the parameters handler, with the parameters of initialize()
+     * @param kinDyn pointer to the KinDynComputations object used by HumanIK, whose joints are
+     * ordered as the results of HumanIK
+     * @param id HumanID object, nullptr if the dynamics is not estimated
+     * @return true if the writer is initialized correctly, false if a joint of `jointsList` is not a
+     * one degree of freedom joint of the model of HumanIK or, when the torques are written, of the
+     * model of HumanID
+     */
+    bool initialize(std::weak_ptr<const BipedalLocomotion::ParametersHandler::IParametersHandler> handler,
+                    std::shared_ptr<iDynTree::KinDynComputations> kinDyn,
+                    ID::HumanID* id = nullptr);
+
+    /**
+     * append a sample to the current record batch, which is queued for writing once full
+     * @param sample results to be written
+     * @return true if the sample has been appended and no previous write failed
+     */
+    bool write(const ResultsSample& sample);
+
+    /**
+     * append the current results of HumanIK and, optionally, HumanID
+     * @param timestamp time instant of the results, in seconds
+     * @param ik HumanIK object
+     * @param id HumanID object, nullptr if the dynamics is not estimated
+     * @return true if the sample has been appended and no previous write failed
+     * @note the joints are taken by name, so the writer must be initialized with the
+     * KinDynComputations object of HumanIK and, if the torques are written, with HumanID. The
+     * wrenches are taken from the external wrenches estimated by HumanID whose frames are in
+     * `wrenchesList`
+     */
+    bool write(double timestamp, const IK::HumanIK& ik, ID::HumanID* id = nullptr);
+
+    /**
+     * write the samples still in the current batch, wait for all the batches to be written and
+     * close the file
+     * @return true if all the batches have been written correctly
+     */
+    bool close();
+
+private:
+    bool finishBatch();
+    void drain();
+    bool writeBatch(const std::shared_ptr<arrow::RecordBatch>& batch);
+
+    std::shared_ptr<arrow::Schema> m_schema; /** schema of the record batches */
+    std::vector<std::string> m_joints; /** joints written in the file */
+    std::vector<std::string> m_wrenches; /** frames of the wrenches written in the file */
+    bool m_writeTorques{false}; /** true if the joint torques are written */
+    bool m_parquet{false}; /** true if the file is a Parquet file */
+    std::size_t m_batchSize{1000}; /** number of samples of each record batch */
+    std::size_t m_nrOfRows{0}; /** number of samples in the current batch */
+    std::vector<std::unique_ptr<arrow::DoubleBuilder>> m_builders; /** builders of the columns */
+    ResultsSample m_sample; /** buffer used to collect the results of HumanIK and HumanID */
+    std::vector<Eigen::Index> m_ikJointIndices; /** index in the results of HumanIK of each joint of
+                                                   `jointsList`, empty if not mapped */
+    std::vector<Eigen::Index> m_idJointIndices; /** index in the joint torques of HumanID of each
+                                                   joint of `jointsList`, empty if not mapped */
+    Eigen::VectorXd m_ikJointPositions; /** joint positions of HumanIK */
+    Eigen::VectorXd m_ikJointVelocities; /** joint velocities of HumanIK */
+    Eigen::VectorXd m_idJointTorques; /** joint torques of HumanID */
+
+    std::shared_ptr<arrow::io::FileOutputStream> m_stream; /** stream of the file */
+    std::shared_ptr<arrow::ipc::RecordBatchWriter> m_ipcWriter; /** writer of the IPC file */
+    std::unique_ptr<parquet::arrow::FileWriter> m_parquetWriter; /** writer of the Parquet file */
+
+    std::mutex m_mutex; /** mutex protecting the queue of the batches and the flags below */
+    std::condition_variable m_drained; /** condition notified when the queue has been written */
+    std::deque<std::shared_ptr<arrow::RecordBatch>> m_batches; /** batches waiting to be written */
+    bool m_draining{false}; /** true if an I/O task is writing the queued batches */
+    bool m_failed{false}; /** true if a batch could not be written */
+};
+
+} // namespace Pipeline
+} // namespace BiomechanicalAnalysis
+
+#endif // BIOMECHANICAL_ANALYSIS_PIPELINE_ARROW_RESULTS_WRITER_H
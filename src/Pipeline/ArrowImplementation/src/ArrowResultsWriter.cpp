@@ -0,0 +1,448 @@
+#include <BiomechanicalAnalysis/Logging/Logger.h>
+#include <BiomechanicalAnalysis/Pipeline/ArrowResultsWriter.h>
+#include <BiomechanicalAnalysis/System/Executor.h>
+
+#include <parquet/properties.h>
+
+#include <algorithm>
+
+using namespace BiomechanicalAnalysis::Pipeline;
+
+ArrowResultsWriter::~ArrowResultsWriter()
+{
+    close();
+}
+
+bool ArrowResultsWriter::initialize(std::weak_ptr<const BipedalLocomotion::ParametersHandler::IParametersHandler> handler)
+{
+    constexpr auto logPrefix = "[ArrowResultsWriter::initialize]";
+
+    auto ptr = handler.lock();
+    if (ptr == nullptr)
+    {
+        BiomechanicalAnalysis::log()->error("{} Invalid parameters handler.", logPrefix);
+        return false;
+    }
+
+    std::string filePath;
+    if (!ptr->getParameter("filePath", filePath))
+    {
+        BiomechanicalAnalysis::log()->error("{} Parameter 'filePath' is missing.", logPrefix);
+        return false;
+    }
+    if (!ptr->getParameter("jointsList", m_joints))
+    {
+        BiomechanicalAnalysis::log()->error("{} Parameter 'jointsList' is missing.", logPrefix);
+        return false;
+    }
+
+    std::string format{"ipc"};
+    ptr->getParameter("format", format);
+    if (format != "ipc" && format != "parquet")
+    {
+        BiomechanicalAnalysis::log()->error("{} Unknown format '{}', the supported formats are 'ipc' and 'parquet'.", logPrefix, format);
+        return false;
+    }
+    m_parquet = format == "parquet";
+
+    m_writeTorques = false;
+    ptr->getParameter("writeTorques", m_writeTorques);
+    m_wrenches.clear();
+    ptr->getParameter("wrenchesList", m_wrenches);
+
+    int batchSize{1000};
+    ptr->getParameter("batchSize", batchSize);
+    if (batchSize <= 0)
+    {
+        BiomechanicalAnalysis::log()->error("{} The parameter 'batchSize' must be positive.", logPrefix);
+        return false;
+    }
+    m_batchSize = batchSize;
+
+    // create the schema, the order of the fields is the order used by write()
+    arrow::FieldVector fields;
+    fields.push_back(arrow::field("timestamp", arrow::float64()));
+    for (const auto& component : {"position_x", "position_y", "position_z", "orientation_w", "orientation_x", "orientation_y", "orientation_z"})
+    {
+        fields.push_back(arrow::field(std::string("base/") + component, arrow::float64()));
+    }
+    for (const auto& quantity : {"position", "velocity", "torque"})
+    {
+        if (std::string(quantity) == "torque" && !m_writeTorques)
+        {
+            continue;
+        }
+        for (const auto& joint : m_joints)
+        {
+            fields.push_back(arrow::field(joint + "/" + quantity, arrow::float64()));
+        }
+    }
+    for (const auto& frame : m_wrenches)
+    {
+        for (const auto& component : {"force_x", "force_y", "force_z", "torque_x", "torque_y", "torque_z"})
+        {
+            fields.push_back(arrow::field(frame + "/" + component, arrow::float64()));
+        }
+    }
+    m_schema = arrow::schema(fields);
+
+    m_builders.clear();
+    for (std::size_t i = 0; i < fields.size(); i++)
+    {
+        m_builders.push_back(std::make_unique<arrow::DoubleBuilder>());
+        if (!m_builders.back()->Reserve(m_batchSize).ok())
+        {
+            BiomechanicalAnalysis::log()->error("{} Unable to allocate the columns.", logPrefix);
+            return false;
+        }
+    }
+    m_nrOfRows = 0;
+    m_failed = false;
+    m_ikJointIndices.clear();
+    m_idJointIndices.clear();
+
+    auto stream = arrow::io::FileOutputStream::Open(filePath);
+    if (!stream.ok())
+    {
+        BiomechanicalAnalysis::log()->error("{} Unable to open the file '{}': {}", logPrefix, filePath, stream.status().ToString());
+        return false;
+    }
+    m_stream = *stream;
+
+    if (m_parquet)
+    {
+        auto writer = parquet::arrow::FileWriter::Open(*m_schema,
+                                                       arrow::default_memory_pool(),
+                                                       m_stream,
+                                                       parquet::default_writer_properties(),
+                                                       parquet::default_arrow_writer_properties());
+        if (!writer.ok())
+        {
+            BiomechanicalAnalysis::log()->error("{} Unable to create the Parquet writer: {}", logPrefix, writer.status().ToString());
+            return false;
+        }
+        m_parquetWriter = std::move(*writer);
+    } else
+    {
+        auto writer = arrow::ipc::MakeFileWriter(m_stream, m_schema);
+        if (!writer.ok())
+        {
+            BiomechanicalAnalysis::log()->error("{} Unable to create the IPC writer: {}", logPrefix, writer.status().ToString());
+            return false;
+        }
+        m_ipcWriter = *writer;
+    }
+
+    return true;
+}
+
+bool ArrowResultsWriter::initialize(std::weak_ptr<const BipedalLocomotion::ParametersHandler::IParametersHandler> handler,
+                                    std::shared_ptr<iDynTree::KinDynComputations> kinDyn,
+                                    ID::HumanID* id)
+{
+    constexpr auto logPrefix = "[ArrowResultsWriter::initialize]";
+
+    if (kinDyn == nullptr)
+    {
+        BiomechanicalAnalysis::log()->error("{} Invalid KinDynComputations object.", logPrefix);
+        return false;
+    }
+    if (!initialize(handler))
+    {
+        return false;
+    }
+    // the file has already been created, it is closed if the joints cannot be mapped
+    if (m_writeTorques && id == nullptr)
+    {
+        BiomechanicalAnalysis::log()->error("{} HumanID is needed to write the joint torques.", logPrefix);
+        close();
+        return false;
+    }
+
+    // the results of HumanIK are ordered as the degrees of freedom of the model
+    const iDynTree::Model& model = kinDyn->model();
+    std::vector<Eigen::Index> ikJointIndices;
+    for (const auto& joint : m_joints)
+    {
+        const iDynTree::JointIndex index = model.getJointIndex(joint);
+        if (index == iDynTree::JOINT_INVALID_INDEX || model.getJoint(index)->getNrOfDOFs() != 1)
+        {
+            BiomechanicalAnalysis::log()->error("{} The joint '{}' is not a joint with one degree of freedom of the model of HumanIK.",
+                                                logPrefix,
+                                                joint);
+            close();
+            return false;
+        }
+        ikJointIndices.push_back(model.getJoint(index)->getDOFsOffset());
+    }
+
+    std::vector<Eigen::Index> idJointIndices;
+    if (m_writeTorques)
+    {
+        // the joint torques of HumanID are ordered as the degrees of freedom of its model
+        const iDynTree::Model& idModel = id->getModel();
+        for (const auto& joint : m_joints)
+        {
+            const iDynTree::JointIndex index = idModel.getJointIndex(joint);
+            if (index == iDynTree::JOINT_INVALID_INDEX || idModel.getJoint(index)->getNrOfDOFs() != 1)
+            {
+                BiomechanicalAnalysis::log()->error("{} The joint '{}' is not a joint with one degree of freedom of the model of HumanID.",
+                                                    logPrefix,
+                                                    joint);
+                close();
+                return false;
+            }
+            idJointIndices.push_back(idModel.getJoint(index)->getDOFsOffset());
+        }
+        m_idJointTorques.resize(id->getNrOfDOFs());
+    }
+
+    m_ikJointIndices = std::move(ikJointIndices);
+    m_idJointIndices = std::move(idJointIndices);
+    m_ikJointPositions.resize(kinDyn->getNrOfDegreesOfFreedom());
+    m_ikJointVelocities.resize(kinDyn->getNrOfDegreesOfFreedom());
+    m_sample.jointPositions.resize(m_joints.size());
+    m_sample.jointVelocities.resize(m_joints.size());
+    m_sample.jointTorques.resize(m_writeTorques ? m_joints.size() : 0);
+    return true;
+}
+
+bool ArrowResultsWriter::write(const ResultsSample& sample)
+{
+    constexpr auto logPrefix = "[ArrowResultsWriter::write]";
+
+    if (m_schema == nullptr)
+    {
+        BiomechanicalAnalysis::log()->error("{} The writer is not initialized.", logPrefix);
+        return false;
+    }
+    const auto nrOfJoints = static_cast<Eigen::Index>(m_joints.size());
+    if (sample.jointPositions.size() != nrOfJoints || sample.jointVelocities.size() != nrOfJoints
+        || (m_writeTorques && sample.jointTorques.size() != nrOfJoints) || sample.wrenches.size() != m_wrenches.size())
+    {
+        BiomechanicalAnalysis::log()->error("{} The size of the sample does not match the columns of the file.", logPrefix);
+        return false;
+    }
+
+    // the builders have been reserved for a whole batch, so the values can be appended without
+    // checks
+    std::size_t column = 0;
+    m_builders[column++]->UnsafeAppend(sample.timestamp);
+    for (int i = 0; i < 3; i++)
+    {
+        m_builders[column++]->UnsafeAppend(sample.basePosition[i]);
+    }
+    for (int i = 0; i < 4; i++)
+    {
+        m_builders[column++]->UnsafeAppend(sample.baseOrientation[i]);
+    }
+    for (Eigen::Index i = 0; i < nrOfJoints; i++)
+    {
+        m_builders[column + i]->UnsafeAppend(sample.jointPositions[i]);
+        m_builders[column + nrOfJoints + i]->UnsafeAppend(sample.jointVelocities[i]);
+    }
+    column += 2 * nrOfJoints;
+    if (m_writeTorques)
+    {
+        for (Eigen::Index i = 0; i < nrOfJoints; i++)
+        {
+            m_builders[column++]->UnsafeAppend(sample.jointTorques[i]);
+        }
+    }
+    for (const auto& wrench : sample.wrenches)
+    {
+        for (int i = 0; i < 6; i++)
+        {
+            m_builders[column++]->UnsafeAppend(wrench[i]);
+        }
+    }
+
+    if (++m_nrOfRows == m_batchSize && !finishBatch())
+    {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return !m_failed;
+}
+
+bool ArrowResultsWriter::write(double timestamp, const IK::HumanIK& ik, ID::HumanID* id)
+{
+    constexpr auto logPrefix = "[ArrowResultsWriter::write]";
+
+    if (m_ikJointIndices.size() != m_joints.size())
+    {
+        BiomechanicalAnalysis::log()->error("{} The joints of HumanIK are not mapped, initialize the writer with its "
+                                            "KinDynComputations object.",
+                                            logPrefix);
+        return false;
+    }
+
+    m_sample.timestamp = timestamp;
+    Eigen::Matrix3d baseOrientation;
+    bool ok = ik.getBasePosition(m_sample.basePosition);
+    ok = ok && ik.getBaseOrientation(baseOrientation);
+    ok = ok && ik.getJointPositions(m_ikJointPositions);
+    ok = ok && ik.getJointVelocities(m_ikJointVelocities);
+    if (!ok)
+    {
+        BiomechanicalAnalysis::log()->error("{} Unable to get the results of HumanIK.", logPrefix);
+        return false;
+    }
+    const Eigen::Quaterniond quaternion(baseOrientation);
+    m_sample.baseOrientation << quaternion.w(), quaternion.x(), quaternion.y(), quaternion.z();
+    for (std::size_t i = 0; i < m_joints.size(); i++)
+    {
+        m_sample.jointPositions[i] = m_ikJointPositions[m_ikJointIndices[i]];
+        m_sample.jointVelocities[i] = m_ikJointVelocities[m_ikJointIndices[i]];
+    }
+
+    if (m_writeTorques || !m_wrenches.empty())
+    {
+        if (id == nullptr)
+        {
+            BiomechanicalAnalysis::log()->error("{} HumanID is needed to write the joint torques and the wrenches.", logPrefix);
+            return false;
+        }
+        if (m_writeTorques)
+        {
+            if (m_idJointIndices.size() != m_joints.size())
+            {
+                BiomechanicalAnalysis::log()->error("{} The joints of HumanID are not mapped, initialize the writer with it.", logPrefix);
+                return false;
+            }
+            if (!id->getJointTorques(m_idJointTorques))
+            {
+                BiomechanicalAnalysis::log()->error("{} Unable to get the joint torques of HumanID.", logPrefix);
+                return false;
+            }
+            for (std::size_t i = 0; i < m_joints.size(); i++)
+            {
+                m_sample.jointTorques[i] = m_idJointTorques[m_idJointIndices[i]];
+            }
+        }
+
+        const std::vector<iDynTree::Wrench> wrenches = id->getEstimatedExtWrenches();
+        const std::vector<std::string> frames = id->getEstimatedExtWrenchesList();
+        m_sample.wrenches.resize(m_wrenches.size());
+        for (std::size_t i = 0; i < m_wrenches.size(); i++)
+        {
+            const auto frame = std::find(frames.begin(), frames.end(), m_wrenches[i]);
+            if (frame == frames.end())
+            {
+                BiomechanicalAnalysis::log()->error("{} HumanID does not estimate the wrench of the frame '{}'.", logPrefix, m_wrenches[i]);
+                return false;
+            }
+            const iDynTree::Wrench& wrench = wrenches[frame - frames.begin()];
+            for (int k = 0; k < 3; k++)
+            {
+                m_sample.wrenches[i][k] = wrench.getLinearVec3()(k);
+                m_sample.wrenches[i][3 + k] = wrench.getAngularVec3()(k);
+            }
+        }
+    }
+
+    return write(m_sample);
+}
+
+bool ArrowResultsWriter::finishBatch()
+{
+    constexpr auto logPrefix = "[ArrowResultsWriter::finishBatch]";
+
+    if (m_nrOfRows == 0)
+    {
+        return true;
+    }
+
+    std::vector<std::shared_ptr<arrow::Array>> columns(m_builders.size());
+    for (std::size_t i = 0; i < m_builders.size(); i++)
+    {
+        // Finish resets the builder, which is then reserved again for the next batch
+        if (!m_builders[i]->Finish(&columns[i]).ok() || !m_builders[i]->Reserve(m_batchSize).ok())
+        {
+            BiomechanicalAnalysis::log()->error("{} Unable to build the record batch.", logPrefix);
+            return false;
+        }
+    }
+    auto batch = arrow::RecordBatch::Make(m_schema, m_nrOfRows, std::move(columns));
+    m_nrOfRows = 0;
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_batches.push_back(std::move(batch));
+    if (!m_draining)
+    {
+        m_draining = true;
+        System::Executor::instance().submitIO([this] { drain(); });
+    }
+    return true;
+}
+
+void ArrowResultsWriter::drain()
+{
+    // the batches are written one at a time and in order by a single I/O task
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (!m_batches.empty())
+    {
+        auto batch = std::move(m_batches.front());
+        m_batches.pop_front();
+        lock.unlock();
+        const bool ok = writeBatch(batch);
+        lock.lock();
+        m_failed = m_failed || !ok;
+    }
+    m_draining = false;
+    m_drained.notify_all();
+}
+
+bool ArrowResultsWriter::writeBatch(const std::shared_ptr<arrow::RecordBatch>& batch)
+{
+    constexpr auto logPrefix = "[ArrowResultsWriter::writeBatch]";
+
+    arrow::Status status;
+    if (m_parquet)
+    {
+        // each batch is written as a row group
+        auto table = arrow::Table::FromRecordBatches({batch});
+        status = table.ok() ? m_parquetWriter->WriteTable(**table, batch->num_rows()) : table.status();
+    } else
+    {
+        status = m_ipcWriter->WriteRecordBatch(*batch);
+    }
+
+    if (!status.ok())
+    {
+        BiomechanicalAnalysis::log()->error("{} Unable to write the record batch: {}", logPrefix, status.ToString());
+        return false;
+    }
+    return true;
+}
+
+bool ArrowResultsWriter::close()
+{
+    constexpr auto logPrefix = "[ArrowResultsWriter::close]";
+
+    if (m_stream == nullptr)
+    {
+        return true;
+    }
+
+    bool ok = finishBatch();
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_drained.wait(lock, [this] { return !m_draining; });
+        ok = ok && !m_failed;
+    }
+
+    arrow::Status status = m_parquet ? m_parquetWriter->Close() : m_ipcWriter->Close();
+    status &= m_stream->Close();
+    if (!status.ok())
+    {
+        BiomechanicalAnalysis::log()->error("{} Unable to close the file: {}", logPrefix, status.ToString());
+        ok = false;
+    }
+
+    m_stream.reset();
+    m_ipcWriter.reset();
+    m_parquetWriter.reset();
+    return ok;
+}
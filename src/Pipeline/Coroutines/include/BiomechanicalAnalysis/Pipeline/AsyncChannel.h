@@ -0,0 +1,289 @@
+/**
+ * @file AsyncChannel.h
+ * @authors Davide Gorbani <davide.gorbani@iit.it>
+ */
+
+#ifndef BIOMECHANICAL_ANALYSIS_PIPELINE_ASYNC_CHANNEL_H
+#define BIOMECHANICAL_ANALYSIS_PIPELINE_ASYNC_CHANNEL_H
+
+#include <coroutine>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include <BiomechanicalAnalysis/System/Executor.h>
+
+namespace BiomechanicalAnalysis
+{
+namespace Pipeline
+{
+
+/**
+ * @brief Bounded channel connecting the coroutines of a pipeline, e.g. a receiving stage and the
+ * estimation stages of a subject.
+ * A coroutine receiving from an empty channel, or sending to a full one, is suspended without
+ * occupying a thread, and it is resumed on a compute thread of the Executor when the channel
+ * changes. The channel can be used by several senders and receivers.
+ */
+template <typename T> class AsyncChannel
+{
+public:
+    /**
+     * Awaiter returned by send()
+     */
+    class SendAwaiter
+    {
+    public:
+        SendAwaiter(AsyncChannel& channel, T value)
+            : m_channel(channel)
+            , m_value(std::move(value))
+        {
+        }
+
+        bool await_ready() const noexcept
+        {
+            return false;
+        }
+
+        bool await_suspend(std::coroutine_handle<> handle)
+        {
+            m_handle = handle;
+            return m_channel.suspendSender(*this);
+        }
+
+        bool await_resume() const noexcept
+        {
+            return m_sent;
+        }
+
+    private:
+        friend class AsyncChannel;
+
+        AsyncChannel& m_channel;
+        T m_value;
+        bool m_sent{false};
+        std::coroutine_handle<> m_handle;
+    };
+
+    /**
+     * Awaiter returned by receive()
+     */
+    class ReceiveAwaiter
+    {
+    public:
+        explicit ReceiveAwaiter(AsyncChannel& channel)
+            : m_channel(channel)
+        {
+        }
+
+        bool await_ready() const noexcept
+        {
+            return false;
+        }
+
+        bool await_suspend(std::coroutine_handle<> handle)
+        {
+            m_handle = handle;
+            return m_channel.suspendReceiver(*this);
+        }
+
+        std::optional<T> await_resume()
+        {
+            return std::move(m_value);
+        }
+
+    private:
+        friend class AsyncChannel;
+
+        AsyncChannel& m_channel;
+        std::optional<T> m_value;
+        std::coroutine_handle<> m_handle;
+    };
+
+    /**
+     * @brief Constructor
+     * @param capacity number of values that can be queued without suspending the senders
+     */
+    explicit AsyncChannel(std::size_t capacity)
+        : m_capacity(capacity)
+    {
+    }
+
+    AsyncChannel(const AsyncChannel&) = delete;
+    AsyncChannel& operator=(const AsyncChannel&) = delete;
+
+    /**
+     * @brief Function to send a value, to be used with co_await
+     * @param value value to be sent
+     * @return awaitable returning true if the value has been queued or delivered, false if the
+     * channel has been closed
+     */
+    SendAwaiter send(T value)
+    {
+        return SendAwaiter(*this, std::move(value));
+    }
+
+    /**
+     * @brief Function to receive a value, to be used with co_await
+     * @return awaitable returning the received value, or std::nullopt if the channel has been closed
+     * and there are no more values
+     */
+    ReceiveAwaiter receive()
+    {
+        return ReceiveAwaiter(*this);
+    }
+
+    /**
+     * @brief Function to send a value from a thread that is not a coroutine, it never blocks
+     * @param value value to be sent
+     * @return true if the value has been queued or delivered, false if the channel is full or closed
+     */
+    bool trySend(T value)
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        if (m_closed)
+        {
+            return false;
+        }
+        if (!m_receivers.empty())
+        {
+            ReceiveAwaiter* receiver = m_receivers.front();
+            m_receivers.pop_front();
+            receiver->m_value.emplace(std::move(value));
+            lock.unlock();
+            resume(receiver->m_handle);
+            return true;
+        }
+        if (m_values.size() >= m_capacity)
+        {
+            return false;
+        }
+        m_values.push_back(std::move(value));
+        return true;
+    }
+
+    /**
+     * @brief Function to close the channel, the suspended senders and receivers are resumed and the
+     * values already queued can still be received
+     */
+    void close()
+    {
+        std::vector<std::coroutine_handle<>> handles;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_closed = true;
+            for (ReceiveAwaiter* receiver : m_receivers)
+            {
+                handles.push_back(receiver->m_handle);
+            }
+            for (SendAwaiter* sender : m_senders)
+            {
+                handles.push_back(sender->m_handle);
+            }
+            m_receivers.clear();
+            m_senders.clear();
+        }
+        for (const auto& handle : handles)
+        {
+            resume(handle);
+        }
+    }
+
+    /**
+     * @brief Function to get the number of queued values
+     * @return number of values
+     */
+    std::size_t size() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_values.size();
+    }
+
+private:
+    static void resume(std::coroutine_handle<> handle)
+    {
+        System::Executor::instance().post([handle] { handle.resume(); });
+    }
+
+    // return false if the sender can continue without being suspended
+    bool suspendSender(SendAwaiter& sender)
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        if (m_closed)
+        {
+            return false;
+        }
+        if (!m_receivers.empty())
+        {
+            ReceiveAwaiter* receiver = m_receivers.front();
+            m_receivers.pop_front();
+            receiver->m_value.emplace(std::move(sender.m_value));
+            sender.m_sent = true;
+            lock.unlock();
+            resume(receiver->m_handle);
+            return false;
+        }
+        if (m_values.size() < m_capacity)
+        {
+            m_values.push_back(std::move(sender.m_value));
+            sender.m_sent = true;
+            return false;
+        }
+        // the value is moved in the queue by the receiver that makes room for it
+        m_senders.push_back(&sender);
+        return true;
+    }
+
+    // return false if the receiver can continue without being suspended
+    bool suspendReceiver(ReceiveAwaiter& receiver)
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        if (!m_values.empty())
+        {
+            receiver.m_value.emplace(std::move(m_values.front()));
+            m_values.pop_front();
+            if (!m_senders.empty())
+            {
+                SendAwaiter* sender = m_senders.front();
+                m_senders.pop_front();
+                m_values.push_back(std::move(sender->m_value));
+                sender->m_sent = true;
+                lock.unlock();
+                resume(sender->m_handle);
+            }
+            return false;
+        }
+        if (!m_senders.empty())
+        {
+            // possible only with a channel of capacity 0
+            SendAwaiter* sender = m_senders.front();
+            m_senders.pop_front();
+            receiver.m_value.emplace(std::move(sender->m_value));
+            sender->m_sent = true;
+            lock.unlock();
+            resume(sender->m_handle);
+            return false;
+        }
+        if (m_closed)
+        {
+            return false;
+        }
+        m_receivers.push_back(&receiver);
+        return true;
+    }
+
+    const std::size_t m_capacity; /** capacity of the queue */
+    mutable std::mutex m_mutex; /** mutex protecting the state of the channel */
+    std::deque<T> m_values; /** queued values */
+    std::deque<SendAwaiter*> m_senders; /** suspended senders, waiting for room in the queue */
+    std::deque<ReceiveAwaiter*> m_receivers; /** suspended receivers, waiting for a value */
+    bool m_closed{false}; /** true if the channel has been closed */
+};
+
+} // namespace Pipeline
+} // namespace BiomechanicalAnalysis
+
+#endif // BIOMECHANICAL_ANALYSIS_PIPELINE_ASYNC_CHANNEL_H
@@ -0,0 +1,356 @@
+/**
+ * @file Coroutines.h
+ * @authors Davide Gorbani <davide.gorbani@iit.it>
+ */
+
+#ifndef BIOMECHANICAL_ANALYSIS_PIPELINE_COROUTINES_H
+#define BIOMECHANICAL_ANALYSIS_PIPELINE_COROUTINES_H
+
+#include <condition_variable>
+#include <coroutine>
+#include <cstddef>
+#include <exception>
+#include <mutex>
+#include <optional>
+#include <type_traits>
+#include <utility>
+
+namespace BiomechanicalAnalysis
+{
+namespace Pipeline
+{
+
+template <typename T = void> class Task;
+
+namespace detail
+{
+
+/**
+ * Awaiter of the end of a Task, it transfers the execution to the coroutine awaiting the task
+ */
+struct TaskFinalAwaiter
+{
+    bool await_ready() const noexcept
+    {
+        return false;
+    }
+
+    template <typename Promise> std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> handle) const noexcept
+    {
+        const std::coroutine_handle<> continuation = handle.promise().continuation;
+        return continuation ? continuation : std::noop_coroutine();
+    }
+
+    void await_resume() const noexcept
+    {
+    }
+};
+
+struct TaskPromiseBase
+{
+    std::coroutine_handle<> continuation; /** coroutine awaiting the task */
+    std::exception_ptr exception; /** exception thrown by the task */
+
+    std::suspend_always initial_suspend() const noexcept
+    {
+        return {};
+    }
+
+    TaskFinalAwaiter final_suspend() const noexcept
+    {
+        return {};
+    }
+
+    void unhandled_exception() noexcept
+    {
+        exception = std::current_exception();
+    }
+};
+
+template <typename T> struct TaskPromise : TaskPromiseBase
+{
+    std::optional<T> value; /** value returned by the task */
+
+    Task<T> get_return_object() noexcept;
+
+    template <typename U> void return_value(U&& result)
+    {
+        value.emplace(std::forward<U>(result));
+    }
+};
+
+template <> struct TaskPromise<void> : TaskPromiseBase
+{
+    Task<void> get_return_object() noexcept;
+
+    void return_void() const noexcept
+    {
+    }
+};
+
+/**
+ * Coroutine started eagerly and destroyed at its end, used to run a Task without awaiting it
+ */
+struct DetachedCoroutine
+{
+    struct promise_type
+    {
+        DetachedCoroutine get_return_object() const noexcept
+        {
+            return {};
+        }
+
+        std::suspend_never initial_suspend() const noexcept
+        {
+            return {};
+        }
+
+        std::suspend_never final_suspend() const noexcept
+        {
+            return {};
+        }
+
+        void return_void() const noexcept
+        {
+        }
+
+        void unhandled_exception() const noexcept
+        {
+            std::terminate();
+        }
+    };
+};
+
+} // namespace detail
+
+/**
+ * @brief Lazy coroutine, e.g. a stage of a pipeline, returning a value of type T.
+ * The coroutine starts when the task is awaited, and the awaiting coroutine is resumed on the
+ * thread where the task completes. An exception thrown by the coroutine is rethrown to the
+ * awaiting coroutine. The tasks that are not awaited by another coroutine are run with
+ * TaskGroup::spawn() or syncWait().
+ */
+template <typename T> class [[nodiscard]] Task
+{
+public:
+    using promise_type = detail::TaskPromise<T>;
+
+    Task() = default;
+
+    explicit Task(std::coroutine_handle<promise_type> handle) noexcept
+        : m_handle(handle)
+    {
+    }
+
+    Task(Task&& other) noexcept
+        : m_handle(std::exchange(other.m_handle, {}))
+    {
+    }
+
+    Task& operator=(Task&& other) noexcept
+    {
+        if (this != &other)
+        {
+            if (m_handle)
+            {
+                m_handle.destroy();
+            }
+            m_handle = std::exchange(other.m_handle, {});
+        }
+        return *this;
+    }
+
+    Task(const Task&) = delete;
+    Task& operator=(const Task&) = delete;
+
+    /**
+     * @brief Destructor, it destroys the coroutine
+     */
+    ~Task()
+    {
+        if (m_handle)
+        {
+            m_handle.destroy();
+        }
+    }
+
+    bool await_ready() const noexcept
+    {
+        return !m_handle || m_handle.done();
+    }
+
+    std::coroutine_handle<> await_suspend(std::coroutine_handle<> continuation) noexcept
+    {
+        m_handle.promise().continuation = continuation;
+        return m_handle;
+    }
+
+    T await_resume()
+    {
+        promise_type& promise = m_handle.promise();
+        if (promise.exception)
+        {
+            std::rethrow_exception(promise.exception);
+        }
+        if constexpr (!std::is_void_v<T>)
+        {
+            return std::move(*promise.value);
+        }
+    }
+
+private:
+    std::coroutine_handle<promise_type> m_handle; /** handle of the coroutine */
+};
+
+namespace detail
+{
+
+template <typename T> Task<T> TaskPromise<T>::get_return_object() noexcept
+{
+    return Task<T>(std::coroutine_handle<TaskPromise<T>>::from_promise(*this));
+}
+
+inline Task<void> TaskPromise<void>::get_return_object() noexcept
+{
+    return Task<void>(std::coroutine_handle<TaskPromise<void>>::from_promise(*this));
+}
+
+} // namespace detail
+
+/**
+ * @brief Awaitable moving the awaiting coroutine to a compute thread of the Executor
+ */
+struct ComputeAwaitable
+{
+    bool await_ready() const noexcept
+    {
+        return false;
+    }
+
+    void await_suspend(std::coroutine_handle<> handle) const;
+
+    void await_resume() const noexcept
+    {
+    }
+};
+
+/**
+ * @brief Awaitable moving the awaiting coroutine to an I/O thread of the Executor
+ */
+struct IOAwaitable
+{
+    bool await_ready() const noexcept
+    {
+        return false;
+    }
+
+    void await_suspend(std::coroutine_handle<> handle) const;
+
+    void await_resume() const noexcept
+    {
+    }
+};
+
+/**
+ * @brief Function to continue the awaiting coroutine on a compute thread, e.g. before running the
+ * solvers of a stage
+ * @return awaitable to be used with co_await
+ */
+inline ComputeAwaitable resumeOnCompute() noexcept
+{
+    return {};
+}
+
+/**
+ * @brief Function to continue the awaiting coroutine on an I/O thread, e.g. before a blocking read
+ * of a file. The I/O threads are few, so the coroutine should move back to the compute threads
+ * with resumeOnCompute() once the blocking call is done.
+ * @return awaitable to be used with co_await
+ */
+inline IOAwaitable resumeOnIO() noexcept
+{
+    return {};
+}
+
+/**
+ * @brief Group of tasks running concurrently, e.g. the pipelines of the subjects.
+ * A spawned task runs on the calling thread until its first suspension, so it usually starts with
+ * co_await resumeOnCompute().
+ */
+class TaskGroup
+{
+public:
+    TaskGroup() = default;
+
+    /**
+     * @brief Destructor, it waits for the spawned tasks
+     */
+    ~TaskGroup();
+
+    TaskGroup(const TaskGroup&) = delete;
+    TaskGroup& operator=(const TaskGroup&) = delete;
+
+    /**
+     * @brief Function to start a task in the group
+     * @param task task to be started
+     */
+    void spawn(Task<void> task);
+
+    /**
+     * @brief Function to block the calling thread until all the spawned tasks are completed
+     * @note it must not be called from a compute thread, whose queue may contain the tasks of the
+     * group. The first exception thrown by a task is rethrown.
+     */
+    void wait();
+
+    /**
+     * @brief Function to get the number of tasks not completed yet
+     * @return number of running tasks
+     */
+    std::size_t getNrOfRunningTasks() const;
+
+private:
+    detail::DetachedCoroutine run(Task<void> task);
+
+    mutable std::mutex m_mutex; /** mutex protecting the state of the group */
+    std::condition_variable m_condition; /** condition variable notified when a task ends */
+    std::size_t m_running{0}; /** number of running tasks */
+    std::exception_ptr m_exception; /** first exception thrown by a task */
+};
+
+namespace detail
+{
+
+template <typename T> Task<void> storeResult(Task<T> task, std::optional<T>& result)
+{
+    result.emplace(co_await std::move(task));
+}
+
+} // namespace detail
+
+/**
+ * @brief Function to run a task blocking the calling thread until it is completed
+ * @param task task to be run
+ * @return value returned by the task, the exception thrown by the task is rethrown
+ * @note it must not be called from a compute thread
+ */
+template <typename T> T syncWait(Task<T> task)
+{
+    TaskGroup group;
+    if constexpr (std::is_void_v<T>)
+    {
+        group.spawn(std::move(task));
+        group.wait();
+    } else
+    {
+        std::optional<T> result;
+        group.spawn(detail::storeResult(std::move(task), result));
+        group.wait();
+        return std::move(*result);
+    }
+}
+
+} // namespace Pipeline
+} // namespace BiomechanicalAnalysis
+
+#endif // BIOMECHANICAL_ANALYSIS_PIPELINE_COROUTINES_H
@@ -0,0 +1,116 @@
+/**
+ * @file FdReactor.h
+ * @authors Davide Gorbani <davide.gorbani@iit.it>
+ */
+
+#ifndef BIOMECHANICAL_ANALYSIS_PIPELINE_FD_REACTOR_H
+#define BIOMECHANICAL_ANALYSIS_PIPELINE_FD_REACTOR_H
+
+#include <atomic>
+#include <coroutine>
+#include <thread>
+
+namespace BiomechanicalAnalysis
+{
+namespace Pipeline
+{
+
+/**
+ * @brief Reactor waiting for the readiness of file descriptors, e.g. sockets and pipes, on behalf
+ * of the coroutines of the pipelines.
+ * A single thread waits on epoll for all the registered descriptors, so a coroutine waiting for
+ * data does not occupy a thread of the Executor; it is resumed on a compute thread when the
+ * descriptor becomes ready.
+ * @note The regular files are always ready and are not supported by epoll, their reads should be
+ * done after resumeOnIO().
+ */
+class FdReactor
+{
+public:
+    /**
+     * Awaiter returned by readable() and writable()
+     */
+    class Awaiter
+    {
+    public:
+        Awaiter(FdReactor& reactor, int fd, unsigned int events)
+            : m_reactor(reactor)
+            , m_fd(fd)
+            , m_events(events)
+        {
+        }
+
+        bool await_ready() const noexcept
+        {
+            return false;
+        }
+
+        bool await_suspend(std::coroutine_handle<> handle);
+
+        /**
+         * @return true if the descriptor is ready, false if it could not be registered
+         */
+        bool await_resume() const noexcept
+        {
+            return m_registered;
+        }
+
+    private:
+        FdReactor& m_reactor;
+        int m_fd;
+        unsigned int m_events;
+        bool m_registered{false};
+    };
+
+    FdReactor() = default;
+
+    /**
+     * @brief Destructor, it stops the reactor
+     */
+    ~FdReactor();
+
+    FdReactor(const FdReactor&) = delete;
+    FdReactor& operator=(const FdReactor&) = delete;
+
+    /**
+     * @brief Function to start the thread of the reactor
+     * @return true if the reactor has been started, false otherwise
+     */
+    bool start();
+
+    /**
+     * @brief Function to stop the reactor, the coroutines still waiting are not resumed
+     */
+    void stop();
+
+    /**
+     * @brief Function to wait until a descriptor can be read without blocking, to be used with
+     * co_await
+     * @param fd file descriptor
+     * @return awaitable returning true when the descriptor is ready, false if it could not be
+     * registered, e.g. because it is a regular file or the reactor is not running
+     * @note a descriptor can be awaited by one coroutine at a time
+     */
+    Awaiter readable(int fd);
+
+    /**
+     * @brief Function to wait until a descriptor can be written without blocking, to be used with
+     * co_await
+     * @param fd file descriptor
+     * @return awaitable with the same semantics of readable()
+     */
+    Awaiter writable(int fd);
+
+private:
+    void loop();
+
+    int m_epoll{-1}; /** epoll descriptor */
+    int m_wakeup{-1}; /** eventfd used to stop the thread */
+    std::atomic<bool> m_running{false}; /** true if the thread is running */
+    std::thread m_thread; /** thread waiting on epoll */
+};
+
+} // namespace Pipeline
+} // namespace BiomechanicalAnalysis
+
+#endif // BIOMECHANICAL_ANALYSIS_PIPELINE_FD_REACTOR_H
@@ -0,0 +1,68 @@
+#include <BiomechanicalAnalysis/Pipeline/Coroutines.h>
+#include <BiomechanicalAnalysis/System/Executor.h>
+
+using namespace BiomechanicalAnalysis::Pipeline;
+
+void ComputeAwaitable::await_suspend(std::coroutine_handle<> handle) const
+{
+    System::Executor::instance().post([handle] { handle.resume(); });
+}
+
+void IOAwaitable::await_suspend(std::coroutine_handle<> handle) const
+{
+    System::Executor::instance().postIO([handle] { handle.resume(); });
+}
+
+TaskGroup::~TaskGroup()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_condition.wait(lock, [this] { return m_running == 0; });
+}
+
+void TaskGroup::spawn(Task<void> task)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_running++;
+    }
+    run(std::move(task));
+}
+
+void TaskGroup::wait()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_condition.wait(lock, [this] { return m_running == 0; });
+    if (m_exception)
+    {
+        std::rethrow_exception(std::exchange(m_exception, nullptr));
+    }
+}
+
+std::size_t TaskGroup::getNrOfRunningTasks() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_running;
+}
+
+detail::DetachedCoroutine TaskGroup::run(Task<void> task)
+{
+    std::exception_ptr exception;
+    try
+    {
+        co_await std::move(task);
+    } catch (...)
+    {
+        exception = std::current_exception();
+    }
+
+    // the task is destroyed before notifying the end, so that the group can be destroyed as soon as
+    // wait() returns
+    task = Task<void>();
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (exception && !m_exception)
+    {
+        m_exception = exception;
+    }
+    m_running--;
+    m_condition.notify_all();
+}
@@ -0,0 +1,136 @@
+#include <BiomechanicalAnalysis/Logging/Logger.h>
+#include <BiomechanicalAnalysis/Pipeline/FdReactor.h>
+#include <BiomechanicalAnalysis/System/Executor.h>
+
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+
+// POSIX headers
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+using namespace BiomechanicalAnalysis::Pipeline;
+
+namespace
+{
+constexpr int maxEvents = 64;
+} // namespace
+
+bool FdReactor::Awaiter::await_suspend(std::coroutine_handle<> handle)
+{
+    if (!m_reactor.m_running)
+    {
+        return false;
+    }
+
+    // the coroutine may be resumed by the reactor before epoll_ctl returns, so the awaiter must not
+    // be accessed after a successful registration
+    m_registered = true;
+    epoll_event event{};
+    event.events = m_events | EPOLLONESHOT;
+    event.data.ptr = handle.address();
+    if (epoll_ctl(m_reactor.m_epoll, EPOLL_CTL_MOD, m_fd, &event) == 0)
+    {
+        return true;
+    }
+    // the descriptor is registered the first time it is awaited and then rearmed
+    if (errno == ENOENT && epoll_ctl(m_reactor.m_epoll, EPOLL_CTL_ADD, m_fd, &event) == 0)
+    {
+        return true;
+    }
+    m_registered = false;
+    return false;
+}
+
+FdReactor::~FdReactor()
+{
+    stop();
+}
+
+bool FdReactor::start()
+{
+    constexpr auto logPrefix = "[FdReactor::start]";
+
+    if (m_running)
+    {
+        BiomechanicalAnalysis::log()->error("{} The reactor is already running.", logPrefix);
+        return false;
+    }
+
+    m_epoll = epoll_create1(EPOLL_CLOEXEC);
+    m_wakeup = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    epoll_event event{};
+    event.events = EPOLLIN;
+    event.data.ptr = nullptr;
+    if (m_epoll < 0 || m_wakeup < 0 || epoll_ctl(m_epoll, EPOLL_CTL_ADD, m_wakeup, &event) != 0)
+    {
+        BiomechanicalAnalysis::log()->error("{} Unable to create the epoll descriptors: {}.", logPrefix, std::strerror(errno));
+        stop();
+        return false;
+    }
+
+    m_running = true;
+    m_thread = std::thread(&FdReactor::loop, this);
+    return true;
+}
+
+void FdReactor::stop()
+{
+    m_running = false;
+    if (m_thread.joinable())
+    {
+        const std::uint64_t value = 1;
+        [[maybe_unused]] const ssize_t written = write(m_wakeup, &value, sizeof(value));
+        m_thread.join();
+    }
+    if (m_wakeup >= 0)
+    {
+        close(m_wakeup);
+        m_wakeup = -1;
+    }
+    if (m_epoll >= 0)
+    {
+        close(m_epoll);
+        m_epoll = -1;
+    }
+}
+
+FdReactor::Awaiter FdReactor::readable(int fd)
+{
+    return Awaiter(*this, fd, EPOLLIN);
+}
+
+FdReactor::Awaiter FdReactor::writable(int fd)
+{
+    return Awaiter(*this, fd, EPOLLOUT);
+}
+
+void FdReactor::loop()
+{
+    epoll_event events[maxEvents];
+    while (m_running)
+    {
+        const int nrOfEvents = epoll_wait(m_epoll, events, maxEvents, -1);
+        if (nrOfEvents < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            BiomechanicalAnalysis::log()->error("[FdReactor::loop] epoll_wait failed: {}.", std::strerror(errno));
+            return;
+        }
+        for (int i = 0; i < nrOfEvents; i++)
+        {
+            // the null pointer identifies the wakeup descriptor
+            if (events[i].data.ptr == nullptr)
+            {
+                continue;
+            }
+            const auto handle = std::coroutine_handle<>::from_address(events[i].data.ptr);
+            System::Executor::instance().post([handle] { handle.resume(); });
+        }
+    }
+}
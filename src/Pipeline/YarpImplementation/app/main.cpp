@@ -0,0 +1,133 @@
+/**
+ * @file main.cpp
+ * @authors Davide Gorbani <davide.gorbani@iit.it>
+ */
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <iDynTree/KinDynComputations.h>
+#include <iDynTree/ModelLoader.h>
+
+#include <yarp/os/Network.h>
+#include <yarp/os/RFModule.h>
+#include <yarp/os/ResourceFinder.h>
+
+#include <BiomechanicalAnalysis/ID/InverseDynamics.h>
+#include <BiomechanicalAnalysis/IK/InverseKinematics.h>
+#include <BiomechanicalAnalysis/Logging/Logger.h>
+#include <BiomechanicalAnalysis/Pipeline/YarpHumanEstimator.h>
+#include <BipedalLocomotion/ParametersHandler/YarpImplementation.h>
+
+namespace
+{
+
+/**
+ * Module running the YarpHumanEstimator at the period set in the configuration file, which contains
+ * the parameters of the estimator and:
+ * - `modelPath`: path of the URDF model of the human
+ * - `floatingBase`: floating base of the model
+ * - `jointsList`: optional list of the joints of the model to be considered
+ * - `period`: period of the module, in seconds
+ * - `ikConfig`: configuration file of HumanIK
+ * - `idConfig`: optional configuration file of HumanID
+ */
+class HumanEstimatorModule : public yarp::os::RFModule
+{
+public:
+    bool configure(yarp::os::ResourceFinder& rf) override
+    {
+        constexpr auto logPrefix = "[HumanEstimatorModule::configure]";
+
+        auto handler = std::make_shared<BipedalLocomotion::ParametersHandler::YarpImplementation>(rf);
+
+        std::string modelPath, floatingBase, ikConfig, idConfig;
+        std::vector<std::string> joints;
+        if (!handler->getParameter("modelPath", modelPath) || !handler->getParameter("floatingBase", floatingBase)
+            || !handler->getParameter("period", m_period) || !handler->getParameter("ikConfig", ikConfig))
+        {
+            BiomechanicalAnalysis::log()->error("{} The parameters 'modelPath', 'floatingBase', 'period' and 'ikConfig' are mandatory.",
+                                                logPrefix);
+            return false;
+        }
+        handler->getParameter("jointsList", joints);
+        handler->getParameter("idConfig", idConfig);
+
+        iDynTree::ModelLoader loader;
+        const bool loaded = joints.empty() ? loader.loadModelFromFile(rf.findFile(modelPath))
+                                           : loader.loadReducedModelFromFile(rf.findFile(modelPath), joints);
+        auto kinDyn = std::make_shared<iDynTree::KinDynComputations>();
+        if (!loaded || !kinDyn->loadRobotModel(loader.model()) || !kinDyn->setFloatingBase(floatingBase))
+        {
+            BiomechanicalAnalysis::log()->error("{} Unable to load the model '{}'.", logPrefix, modelPath);
+            return false;
+        }
+
+        auto ikHandler = std::make_shared<BipedalLocomotion::ParametersHandler::YarpImplementation>();
+        auto ik = std::make_shared<BiomechanicalAnalysis::IK::HumanIK>();
+        if (!ikHandler->setFromFile(rf.findFile(ikConfig)) || !ik->initialize(ikHandler, kinDyn) || !ik->setDt(m_period))
+        {
+            BiomechanicalAnalysis::log()->error("{} Unable to initialize HumanIK.", logPrefix);
+            return false;
+        }
+
+        std::shared_ptr<BiomechanicalAnalysis::ID::HumanID> id;
+        if (!idConfig.empty())
+        {
+            auto idHandler = std::make_shared<BipedalLocomotion::ParametersHandler::YarpImplementation>();
+            id = std::make_shared<BiomechanicalAnalysis::ID::HumanID>();
+            if (!idHandler->setFromFile(rf.findFile(idConfig)) || !id->initialize(idHandler, kinDyn))
+            {
+                BiomechanicalAnalysis::log()->error("{} Unable to initialize HumanID.", logPrefix);
+                return false;
+            }
+        }
+
+        return m_estimator.initialize(handler, kinDyn, ik, id);
+    }
+
+    double getPeriod() override
+    {
+        return m_period;
+    }
+
+    bool updateModule() override
+    {
+        // a bad frame, e.g. a diverged solver that has been reset, must not stop the module
+        if (!m_estimator.advance())
+        {
+            BiomechanicalAnalysis::log()->error("[HumanEstimatorModule::updateModule] Unable to process the last measurements.");
+        }
+        return true;
+    }
+
+    bool close() override
+    {
+        m_estimator.close();
+        return true;
+    }
+
+private:
+    BiomechanicalAnalysis::Pipeline::YarpHumanEstimator m_estimator;
+    double m_period{0.01};
+};
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    yarp::os::Network network;
+    if (!yarp::os::Network::checkNetwork())
+    {
+        BiomechanicalAnalysis::log()->error("[baf-yarp-human-estimator] Unable to find the YARP network.");
+        return EXIT_FAILURE;
+    }
+
+    yarp::os::ResourceFinder rf;
+    rf.setDefaultConfigFile("humanEstimator.ini");
+    rf.configure(argc, argv);
+
+    HumanEstimatorModule module;
+    return module.runModule(rf);
+}
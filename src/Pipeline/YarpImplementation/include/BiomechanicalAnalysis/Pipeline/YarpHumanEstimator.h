@@ -0,0 +1,140 @@
+/**
+ * @file YarpHumanEstimator.h
+ * @authors Davide Gorbani <davide.gorbani@iit.it>
+ */
+
+#ifndef BIOMECHANICAL_ANALYSIS_PIPELINE_YARP_HUMAN_ESTIMATOR_H
+#define BIOMECHANICAL_ANALYSIS_PIPELINE_YARP_HUMAN_ESTIMATOR_H
+
+#include <memory>
+#include <string>
+#include <vector>
+
+// Eigen headers
+#include <Eigen/Dense>
+
+// iDynTree headers
+#include <iDynTree/KinDynComputations.h>
+
+// YARP headers
+#include <yarp/os/BufferedPort.h>
+#include <yarp/os/Stamp.h>
+#include <yarp/sig/Vector.h>
+
+// BipedalLocomotion headers
+#include <BipedalLocomotion/ParametersHandler/IParametersHandler.h>
+
+#include <BiomechanicalAnalysis/ID/InverseDynamics.h>
+#include <BiomechanicalAnalysis/IK/InverseKinematics.h>
+#include <BiomechanicalAnalysis/Pipeline/SubjectPipeline.h>
+
+namespace BiomechanicalAnalysis
+{
+namespace Pipeline
+{
+
+// clang-format off
+/**
+ * @brief YarpHumanEstimator hosts HumanIK and, optionally, HumanID in a YARP network. It reads the
+ * IMU and the force/torque measurements from the input ports and publishes the joint state, the
+ * base pose and the joint torques on the output ports.
+ * All the ports carry a `yarp::sig::Vector` with the envelope set to the time stamp of the
+ * measurements:
+ * |         Port name          | Direction |                                       Content                                        |
+ * |:--------------------------:|:---------:|:------------------------------------------------------------------------------------:|
+ * |    `<portPrefix>/imu:i`    |   input   | for each node of `imuNodes`, the quaternion `(w, x, y, z)` and the angular velocity |
+ * | `<portPrefix>/wrenches:i`  |   input   | for each wrench, the force and the torque; opened if `wrenchNodes` or `wrenchSources` are set |
+ * | `<portPrefix>/jointState:o`|  output   | joint positions followed by the joint velocities                                      |
+ * | `<portPrefix>/basePose:o`  |  output   | base position followed by the base quaternion `(w, x, y, z)`                          |
+ * |`<portPrefix>/jointTorques:o`|  output  | one torque for each degree of freedom, opened if HumanID is set                       |
+ * The output vectors are taken from the preallocated buffers of the ports and written by the
+ * background thread of the ports, so that a slow reader never blocks the estimation; a reader that
+ * falls behind receives only the latest sample. The solvers are advanced for each IMU message, with
+ * the last wrenches received, which are zero until the first message of the wrenches port.
+ */
+// clang-format on
+class YarpHumanEstimator
+{
+public:
+    /**
+     * Destructor, it closes the ports
+     */
+    ~YarpHumanEstimator();
+
+    // clang-format off
+    /**
+     * initialize the estimator and open the ports
+     * @param handler pointer to the parameters handler
+     * @param kinDyn pointer to the KinDynComputations object used by HumanIK and HumanID
+     * @param ik initialized HumanIK object
+     * @param id initialized HumanID object, nullptr to estimate only the kinematics
+     * @return true if the estimator is initialized correctly
+     * @note The following parameters are used:
+     * |    Parameter name        |       Type       |                                  Description                                   | Mandatory |
+     * |:------------------------:|:----------------:|:------------------------------------------------------------------------------:|:---------:|
+     * |      `portPrefix`        |     `string`     |                        prefix of the names of the ports                        |    Yes    |
+     * |      `imuNodes`          |  `vector<int>`   |                 nodes whose measurements are in the IMU port                  |    Yes    |
+     * |     `wrenchNodes`        |  `vector<int>`   |   nodes of the floor contact tasks associated with the wrenches of the port    |    No     |
+     * |    `wrenchSources`       | `vector<string>` |     names of the HumanID wrench sources associated with the wrenches of the port  |    No     |
+     * | `floorContactLinkHeight` |     `double`     |         height of the links in contact with the floor, by default 0.0          |    No     |
+     * If both `wrenchNodes` and `wrenchSources` are set, they must have the same size.
+     */
+    // clang-format on
+    bool initialize(std::weak_ptr<const BipedalLocomotion::ParametersHandler::IParametersHandler> handler,
+                    std::shared_ptr<iDynTree::KinDynComputations> kinDyn,
+                    std::shared_ptr<IK::HumanIK> ik,
+                    std::shared_ptr<ID::HumanID> id = nullptr);
+
+    /**
+     * read the last measurements received, if any, advance the solvers and publish the results
+     * @return true if no new IMU measurement has been received or if the solvers have been advanced
+     * and the results published correctly
+     */
+    bool advance();
+
+    /**
+     * get the latency histograms of the frames processed by advance(), from the reception of the IMU
+     * measurements to the publication of the results
+     * @return latencies of the subject
+     */
+    const SubjectLatencies& getLatencies() const;
+
+    /**
+     * close the ports
+     */
+    void close();
+
+private:
+    bool readWrenches();
+    bool publish();
+
+    std::shared_ptr<IK::HumanIK> m_ik; /** HumanIK object */
+    std::shared_ptr<ID::HumanID> m_id; /** HumanID object, nullptr if the dynamics is not estimated */
+    SubjectStages m_stages; /** stages running HumanIK and HumanID */
+    SubjectFrame m_frame; /** last measurements received */
+    SubjectLatencies m_latencies; /** latencies of the processed frames */
+
+    std::vector<int> m_imuNodes; /** nodes whose measurements are in the IMU port */
+    std::vector<int> m_wrenchNodes; /** nodes associated with the wrenches of the wrenches port */
+    std::vector<std::string> m_wrenchSources; /** wrench sources associated with the wrenches of the
+                                                 wrenches port */
+    std::size_t m_nrOfWrenches{0}; /** number of wrenches in the wrenches port */
+
+    yarp::os::BufferedPort<yarp::sig::Vector> m_imuPort; /** port of the IMU measurements */
+    yarp::os::BufferedPort<yarp::sig::Vector> m_wrenchesPort; /** port of the wrench measurements */
+    yarp::os::BufferedPort<yarp::sig::Vector> m_jointStatePort; /** port of the joint state */
+    yarp::os::BufferedPort<yarp::sig::Vector> m_basePosePort; /** port of the base pose */
+    yarp::os::BufferedPort<yarp::sig::Vector> m_jointTorquesPort; /** port of the joint torques */
+    yarp::os::Stamp m_stamp; /** stamp of the last measurements */
+
+    Eigen::VectorXd m_jointPositions; /** joint positions */
+    Eigen::VectorXd m_jointVelocities; /** joint velocities */
+    Eigen::VectorXd m_jointTorques; /** joint torques */
+    Eigen::Vector3d m_basePosition; /** base position */
+    Eigen::Matrix3d m_baseOrientation; /** base orientation */
+};
+
+} // namespace Pipeline
+} // namespace BiomechanicalAnalysis
+
+#endif // BIOMECHANICAL_ANALYSIS_PIPELINE_YARP_HUMAN_ESTIMATOR_H
@@ -0,0 +1,280 @@
+#include <BiomechanicalAnalysis/Logging/Logger.h>
+#include <BiomechanicalAnalysis/Pipeline/HumanStages.h>
+#include <BiomechanicalAnalysis/Pipeline/YarpHumanEstimator.h>
+
+#include <algorithm>
+
+using namespace BiomechanicalAnalysis::Pipeline;
+
+YarpHumanEstimator::~YarpHumanEstimator()
+{
+    close();
+}
+
+bool YarpHumanEstimator::initialize(std::weak_ptr<const BipedalLocomotion::ParametersHandler::IParametersHandler> handler,
+                                    std::shared_ptr<iDynTree::KinDynComputations> kinDyn,
+                                    std::shared_ptr<IK::HumanIK> ik,
+                                    std::shared_ptr<ID::HumanID> id)
+{
+    constexpr auto logPrefix = "[YarpHumanEstimator::initialize]";
+
+    auto ptr = handler.lock();
+    if (ptr == nullptr)
+    {
+        BiomechanicalAnalysis::log()->error("{} Invalid parameters handler.", logPrefix);
+        return false;
+    }
+    if (kinDyn == nullptr || ik == nullptr)
+    {
+        BiomechanicalAnalysis::log()->error("{} The KinDynComputations and the HumanIK objects are mandatory.", logPrefix);
+        return false;
+    }
+
+    std::string portPrefix;
+    if (!ptr->getParameter("portPrefix", portPrefix))
+    {
+        BiomechanicalAnalysis::log()->error("{} Parameter 'portPrefix' is missing.", logPrefix);
+        return false;
+    }
+    if (!ptr->getParameter("imuNodes", m_imuNodes) || m_imuNodes.empty())
+    {
+        BiomechanicalAnalysis::log()->error("{} Parameter 'imuNodes' is missing or empty.", logPrefix);
+        return false;
+    }
+
+    m_wrenchNodes.clear();
+    m_wrenchSources.clear();
+    ptr->getParameter("wrenchNodes", m_wrenchNodes);
+    ptr->getParameter("wrenchSources", m_wrenchSources);
+    if (!m_wrenchNodes.empty() && !m_wrenchSources.empty() && m_wrenchNodes.size() != m_wrenchSources.size())
+    {
+        BiomechanicalAnalysis::log()->error("{} The parameters 'wrenchNodes' and 'wrenchSources' must have the same size.", logPrefix);
+        return false;
+    }
+    m_nrOfWrenches = std::max(m_wrenchNodes.size(), m_wrenchSources.size());
+
+    double floorContactLinkHeight{0.0};
+    ptr->getParameter("floorContactLinkHeight", floorContactLinkHeight);
+
+    m_ik = ik;
+    m_id = id;
+    m_stages = makeHumanStages(ik, id, floorContactLinkHeight);
+
+    // the entries of the frame are created once, then only their values are updated
+    m_frame = SubjectFrame();
+    for (const int node : m_imuNodes)
+    {
+        m_frame.nodes[node];
+    }
+    // the wrenches are zero until the first message of the wrenches port, so that the solvers can
+    // be advanced as soon as the IMU measurements arrive
+    for (const int node : m_wrenchNodes)
+    {
+        m_frame.nodeWrenches[node].setZero();
+    }
+    for (const auto& source : m_wrenchSources)
+    {
+        m_frame.externalWrenches[source].zero();
+    }
+
+    // preallocate the buffers used to publish the results
+    const std::size_t nrOfDoFs = kinDyn->getNrOfDegreesOfFreedom();
+    m_jointPositions.resize(nrOfDoFs);
+    m_jointVelocities.resize(nrOfDoFs);
+    if (m_id != nullptr)
+    {
+        // the joint torques are one for each degree of freedom, the fixed joints have none
+        m_jointTorques.resize(m_id->getNrOfDOFs());
+    }
+
+    // the direction of the ports must be set before opening them
+    m_imuPort.setReadOnly();
+    m_wrenchesPort.setReadOnly();
+    m_jointStatePort.setWriteOnly();
+    m_basePosePort.setWriteOnly();
+    m_jointTorquesPort.setWriteOnly();
+
+    bool ok = m_imuPort.open(portPrefix + "/imu:i");
+    ok = ok && (m_nrOfWrenches == 0 || m_wrenchesPort.open(portPrefix + "/wrenches:i"));
+    ok = ok && m_jointStatePort.open(portPrefix + "/jointState:o");
+    ok = ok && m_basePosePort.open(portPrefix + "/basePose:o");
+    ok = ok && (m_id == nullptr || m_jointTorquesPort.open(portPrefix + "/jointTorques:o"));
+    if (!ok)
+    {
+        BiomechanicalAnalysis::log()->error("{} Unable to open the ports with the prefix '{}'.", logPrefix, portPrefix);
+        close();
+        return false;
+    }
+    return true;
+}
+
+bool YarpHumanEstimator::readWrenches()
+{
+    constexpr auto logPrefix = "[YarpHumanEstimator::readWrenches]";
+
+    if (m_nrOfWrenches == 0)
+    {
+        return true;
+    }
+
+    // the last wrenches received are kept until new ones arrive
+    const yarp::sig::Vector* wrenches = m_wrenchesPort.read(false);
+    if (wrenches == nullptr)
+    {
+        return true;
+    }
+    if (wrenches->size() != 6 * m_nrOfWrenches)
+    {
+        BiomechanicalAnalysis::log()->error("{} Expected {} values in the wrenches port, received {}.",
+                                            logPrefix,
+                                            6 * m_nrOfWrenches,
+                                            wrenches->size());
+        return false;
+    }
+
+    for (std::size_t i = 0; i < m_nrOfWrenches; i++)
+    {
+        const double* data = wrenches->data() + 6 * i;
+        if (!m_wrenchNodes.empty())
+        {
+            m_frame.nodeWrenches[m_wrenchNodes[i]] = Eigen::Map<const Eigen::Matrix<double, 6, 1>>(data);
+        }
+        if (!m_wrenchSources.empty())
+        {
+            iDynTree::Wrench& wrench = m_frame.externalWrenches[m_wrenchSources[i]];
+            for (int k = 0; k < 3; k++)
+            {
+                wrench.getLinearVec3()(k) = data[k];
+                wrench.getAngularVec3()(k) = data[3 + k];
+            }
+        }
+    }
+    return true;
+}
+
+bool YarpHumanEstimator::advance()
+{
+    constexpr auto logPrefix = "[YarpHumanEstimator::advance]";
+
+    if (m_ik == nullptr)
+    {
+        BiomechanicalAnalysis::log()->error("{} The estimator is not initialized.", logPrefix);
+        return false;
+    }
+
+    if (!readWrenches())
+    {
+        return false;
+    }
+
+    const yarp::sig::Vector* imu = m_imuPort.read(false);
+    if (imu == nullptr)
+    {
+        return true;
+    }
+    if (imu->size() != 7 * m_imuNodes.size())
+    {
+        BiomechanicalAnalysis::log()->error("{} Expected {} values in the IMU port, received {}.", logPrefix, 7 * m_imuNodes.size(), imu->size());
+        return false;
+    }
+
+    for (std::size_t i = 0; i < m_imuNodes.size(); i++)
+    {
+        const double* data = imu->data() + 7 * i;
+        IK::nodeData& node = m_frame.nodes[m_imuNodes[i]];
+        node.I_R_IMU = manif::SO3d(Eigen::Quaterniond(data[0], data[1], data[2], data[3]).normalized());
+        node.I_omega_IMU = manif::SO3Tangentd(Eigen::Map<const Eigen::Vector3d>(data + 4));
+    }
+
+    // the results are stamped with the time of the measurements, or with the current time if the
+    // sender does not set the envelope
+    yarp::os::Stamp stamp;
+    if (m_imuPort.getEnvelope(stamp) && stamp.isValid())
+    {
+        m_stamp.update(stamp.getTime());
+    } else
+    {
+        m_stamp.update();
+    }
+    m_frame.timestamp = m_stamp.getTime();
+    m_frame.provenance = FrameProvenance();
+    m_frame.provenance.stamp(FrameStage::Received);
+    m_frame.provenance.stamp(FrameStage::Dequeued);
+
+    if (!m_stages.kinematics(m_frame))
+    {
+        BiomechanicalAnalysis::log()->error("{} Unable to advance the inverse kinematics.", logPrefix);
+        return false;
+    }
+    if (m_stages.dynamics && !m_stages.dynamics(m_frame))
+    {
+        BiomechanicalAnalysis::log()->error("{} Unable to solve the inverse dynamics.", logPrefix);
+        return false;
+    }
+
+    m_frame.provenance.stamp(FrameStage::Output);
+    if (!publish())
+    {
+        BiomechanicalAnalysis::log()->error("{} Unable to publish the results.", logPrefix);
+        return false;
+    }
+    m_latencies.record(m_frame.provenance);
+    return true;
+}
+
+const SubjectLatencies& YarpHumanEstimator::getLatencies() const
+{
+    return m_latencies;
+}
+
+bool YarpHumanEstimator::publish()
+{
+    if (!m_ik->getJointPositions(m_jointPositions) || !m_ik->getJointVelocities(m_jointVelocities))
+    {
+        return false;
+    }
+    yarp::sig::Vector& jointState = m_jointStatePort.prepare();
+    jointState.resize(m_jointPositions.size() + m_jointVelocities.size());
+    std::copy(m_jointPositions.data(), m_jointPositions.data() + m_jointPositions.size(), jointState.data());
+    std::copy(m_jointVelocities.data(), m_jointVelocities.data() + m_jointVelocities.size(), jointState.data() + m_jointPositions.size());
+    m_jointStatePort.setEnvelope(m_stamp);
+    m_jointStatePort.write();
+
+    if (!m_ik->getBasePosition(m_basePosition) || !m_ik->getBaseOrientation(m_baseOrientation))
+    {
+        return false;
+    }
+    const Eigen::Quaterniond baseQuaternion(m_baseOrientation);
+    yarp::sig::Vector& basePose = m_basePosePort.prepare();
+    basePose.resize(7);
+    std::copy(m_basePosition.data(), m_basePosition.data() + 3, basePose.data());
+    basePose[3] = baseQuaternion.w();
+    basePose[4] = baseQuaternion.x();
+    basePose[5] = baseQuaternion.y();
+    basePose[6] = baseQuaternion.z();
+    m_basePosePort.setEnvelope(m_stamp);
+    m_basePosePort.write();
+
+    if (m_id != nullptr)
+    {
+        if (!m_id->getJointTorques(m_jointTorques))
+        {
+            return false;
+        }
+        yarp::sig::Vector& jointTorques = m_jointTorquesPort.prepare();
+        jointTorques.resize(m_jointTorques.size());
+        std::copy(m_jointTorques.data(), m_jointTorques.data() + m_jointTorques.size(), jointTorques.data());
+        m_jointTorquesPort.setEnvelope(m_stamp);
+        m_jointTorquesPort.write();
+    }
+    return true;
+}
+
+void YarpHumanEstimator::close()
+{
+    m_imuPort.close();
+    m_wrenchesPort.close();
+    m_jointStatePort.close();
+    m_basePosePort.close();
+    m_jointTorquesPort.close();
+}
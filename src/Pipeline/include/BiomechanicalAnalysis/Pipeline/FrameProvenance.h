@@ -0,0 +1,148 @@
+/**
+ * @file FrameProvenance.h
+ * @authors Davide Gorbani <davide.gorbani@iit.it>
+ */
+
+#ifndef BIOMECHANICAL_ANALYSIS_PIPELINE_FRAME_PROVENANCE_H
+#define BIOMECHANICAL_ANALYSIS_PIPELINE_FRAME_PROVENANCE_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace BiomechanicalAnalysis
+{
+namespace Pipeline
+{
+
+/**
+ * @brief Boundaries of the stages crossed by a frame, in the order in which they are crossed
+ */
+enum class FrameStage : std::size_t
+{
+    Received = 0, /** the measurements have been received by the ingestion */
+    Dequeued = 1, /** the processing of the frame has started */
+    KinematicsUpdated = 2, /** the tasks of HumanIK have been updated */
+    KinematicsSolved = 3, /** HumanIK has been advanced */
+    DynamicsUpdated = 4, /** the measurements of HumanID have been updated */
+    DynamicsSolved = 5, /** HumanID has been solved */
+    Output = 6, /** the results have been handed to the output sinks */
+};
+
+/** number of values of FrameStage */
+constexpr std::size_t nrOfFrameStages = 7;
+
+/**
+ * @brief Monotonic timestamps of the stage boundaries crossed by a frame, carried by the frame
+ * from the ingestion to the output sinks
+ */
+struct FrameProvenance
+{
+    std::array<std::int64_t, nrOfFrameStages> timestamps{}; /** steady clock time, in nanoseconds, at
+                                                               which each boundary has been crossed,
+                                                               0 if it has not been crossed */
+
+    /**
+     * @brief Function to get the current time of the steady clock
+     * @return time in nanoseconds
+     */
+    static std::int64_t now();
+
+    /**
+     * @brief Function to record that a boundary has been crossed now
+     * @param stage crossed boundary
+     */
+    void stamp(FrameStage stage);
+
+    /**
+     * @brief Function to know if a boundary has been crossed
+     * @param stage boundary
+     * @return true if the boundary has been stamped
+     */
+    bool isStamped(FrameStage stage) const;
+
+    /**
+     * @brief Function to get the time elapsed between two boundaries
+     * @param from first boundary
+     * @param to second boundary
+     * @return elapsed time in seconds, negative if one of the boundaries has not been crossed
+     */
+    double getLatency(FrameStage from, FrameStage to) const;
+};
+
+/**
+ * @brief Histogram of latencies with logarithmic buckets, four per octave from 1 us to about 16 s,
+ * so that the percentiles are known with a relative error below 19%
+ */
+class LatencyHistogram
+{
+public:
+    /**
+     * @brief Function to add a latency
+     * @param latency latency in seconds
+     */
+    void record(double latency);
+
+    /**
+     * @brief Function to get the number of recorded latencies
+     * @return number of latencies
+     */
+    std::uint64_t getCount() const;
+
+    /**
+     * @brief Function to get a percentile of the recorded latencies
+     * @param percentile percentile, between 0 and 100
+     * @return upper bound of the bucket containing the percentile, in seconds, 0 if the histogram is
+     * empty
+     */
+    double getPercentile(double percentile) const;
+
+    /**
+     * @brief Function to get the mean of the recorded latencies
+     * @return mean in seconds, 0 if the histogram is empty
+     */
+    double getMean() const;
+
+    /**
+     * @brief Function to get the maximum recorded latency
+     * @return maximum in seconds
+     */
+    double getMax() const;
+
+    /**
+     * @brief Function to remove all the recorded latencies
+     */
+    void reset();
+
+private:
+    static constexpr std::size_t nrOfBuckets = 98; /** the first bucket contains the latencies below
+                                                      1 us, the last one the ones above 16 s */
+
+    std::array<std::uint64_t, nrOfBuckets> m_buckets{}; /** counts of the buckets */
+    std::uint64_t m_count{0}; /** number of recorded latencies */
+    double m_sum{0.0}; /** sum of the recorded latencies */
+    double m_max{0.0}; /** maximum recorded latency */
+};
+
+/**
+ * @brief Latency histograms of the frames of a subject
+ */
+struct SubjectLatencies
+{
+    std::array<LatencyHistogram, nrOfFrameStages> stages; /** the i-th histogram contains the time
+                                                             elapsed between the previous stamped
+                                                             boundary and the boundary i */
+    LatencyHistogram endToEnd; /** time elapsed between the reception of the frame and the last
+                                  stamped boundary */
+
+    /**
+     * @brief Function to add the latencies of a processed frame
+     * @param provenance provenance of the frame
+     */
+    void record(const FrameProvenance& provenance);
+};
+
+} // namespace Pipeline
+} // namespace BiomechanicalAnalysis
+
+#endif // BIOMECHANICAL_ANALYSIS_PIPELINE_FRAME_PROVENANCE_H
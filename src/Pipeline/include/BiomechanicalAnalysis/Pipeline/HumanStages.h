@@ -0,0 +1,49 @@
+/**
+ * @file HumanStages.h
+ * @authors Davide Gorbani <davide.gorbani@iit.it>
+ */
+
+#ifndef BIOMECHANICAL_ANALYSIS_PIPELINE_HUMAN_STAGES_H
+#define BIOMECHANICAL_ANALYSIS_PIPELINE_HUMAN_STAGES_H
+
+#include <memory>
+
+#include <BiomechanicalAnalysis/ID/InverseDynamics.h>
+#include <BiomechanicalAnalysis/IK/InverseKinematics.h>
+#include <BiomechanicalAnalysis/IK/SurrogateIK.h>
+#include <BiomechanicalAnalysis/Pipeline/QualityGovernor.h>
+#include <BiomechanicalAnalysis/Pipeline/SubjectPipeline.h>
+
+namespace BiomechanicalAnalysis
+{
+namespace Pipeline
+{
+
+/**
+ * @brief Function to create the stages of a subject estimated with HumanIK and HumanID
+ * @param ik initialized HumanIK object, the kinematics stage updates its orientation, gravity and,
+ * if the frame contains the node wrenches, floor contact tasks, and then advances it
+ * @param id initialized HumanID object, the dynamics stage updates its external wrenches and
+ * solves it; if nullptr the subject has no dynamics stage
+ * @param floorContactLinkHeight height of the links in contact with the floor, passed to
+ * HumanIK::updateFloorContactTasks
+ * @param governor optional quality governor of the subject, its level callback is set to disable
+ * the joint regularization and the joint velocity limits tasks of HumanIK at the ReducedKinematics
+ * and lower levels
+ * @param surrogate optional SurrogateIK of the subject, trained with samples added with ik; at the
+ * ApproximateKinematics level the kinematics stage sets the state of HumanIK to its prediction
+ * instead of advancing the QP, and without it that level behaves as KinematicsOnly
+ * @return stages of the subject
+ * @note HumanID reads the state of the KinDynComputations object updated by HumanIK, hence the two
+ * objects must be initialized with the same KinDynComputations object
+ */
+SubjectStages makeHumanStages(std::shared_ptr<IK::HumanIK> ik,
+                              std::shared_ptr<ID::HumanID> id,
+                              double floorContactLinkHeight = 0.0,
+                              std::shared_ptr<QualityGovernor> governor = nullptr,
+                              std::shared_ptr<IK::SurrogateIK> surrogate = nullptr);
+
+} // namespace Pipeline
+} // namespace BiomechanicalAnalysis
+
+#endif // BIOMECHANICAL_ANALYSIS_PIPELINE_HUMAN_STAGES_H
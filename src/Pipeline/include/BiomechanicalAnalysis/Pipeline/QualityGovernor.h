@@ -0,0 +1,144 @@
+/**
+ * @file QualityGovernor.h
+ * @authors Davide Gorbani <davide.gorbani@iit.it>
+ */
+
+#ifndef BIOMECHANICAL_ANALYSIS_PIPELINE_QUALITY_GOVERNOR_H
+#define BIOMECHANICAL_ANALYSIS_PIPELINE_QUALITY_GOVERNOR_H
+
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <string>
+
+// BipedalLocomotion headers
+#include <BipedalLocomotion/ParametersHandler/IParametersHandler.h>
+
+namespace BiomechanicalAnalysis
+{
+namespace Pipeline
+{
+
+/**
+ * @brief Quality levels of the estimation, sorted from the most to the least expensive
+ */
+enum class QualityLevel
+{
+    Full = 0, /** all the stages and tasks are run on each frame */
+    ReducedDynamicsRate = 1, /** the dynamics stage is run once every dynamicsDecimation frames */
+    ReducedKinematics = 2, /** as ReducedDynamicsRate, and the joint regularization and the joint
+                              velocity limits of the IK are disabled */
+    KinematicsOnly = 3, /** as ReducedKinematics, and the dynamics stage is not run */
+    ApproximateKinematics = 4, /** as KinematicsOnly, and the IK QP is replaced by a cheaper
+                                  approximate solver, e.g. a trained SurrogateIK */
+};
+
+/**
+ * @brief Function to get the name of a quality level
+ * @param level quality level
+ * @return name of the level
+ */
+std::string toString(QualityLevel level);
+
+/**
+ * @brief Parameters of the QualityGovernor
+ */
+struct QualityGovernorParameters
+{
+    double frameBudget{0.01}; /** time available to process a frame, in seconds */
+    double degradeRatio{0.9}; /** the quality is lowered when the average frame time is above
+                                 degradeRatio * frameBudget */
+    double restoreRatio{0.6}; /** the quality is raised when the average frame time is below
+                                 restoreRatio * frameBudget */
+    std::size_t degradeFrames{10}; /** consecutive frames above the degrade threshold needed to lower
+                                      the quality */
+    std::size_t restoreFrames{100}; /** consecutive frames below the restore threshold needed to
+                                       raise the quality */
+    double smoothingFactor{0.1}; /** weight of the last frame in the exponential moving average of
+                                    the frame time, in (0, 1] */
+    std::size_t dynamicsDecimation{2}; /** at the reduced levels the dynamics stage is run once every
+                                          dynamicsDecimation frames */
+    QualityLevel lowestLevel{QualityLevel::KinematicsOnly}; /** lowest quality level that can be
+                                                               reached */
+};
+
+/**
+ * @brief Governor lowering the cost of the estimation of a subject when the measured frame time
+ * approaches the budget, and restoring the quality when there is headroom again.
+ * The frame time is filtered with an exponential moving average, and the quality is changed by
+ * one level at a time after the average has been above the degrade threshold, or below the restore
+ * threshold, for the configured number of consecutive frames. The gap between the two thresholds
+ * and the numbers of frames provide the hysteresis that prevents the governor from oscillating.
+ * The governor is meant to be fed by the thread processing the subject, which is also the thread
+ * calling the level callback.
+ */
+class QualityGovernor
+{
+public:
+    /**
+     * @brief Function to initialize the governor
+     * @param parameters parameters of the governor
+     * @return true if the parameters are valid, false otherwise
+     */
+    bool initialize(const QualityGovernorParameters& parameters);
+
+    /**
+     * @brief Function to initialize the governor
+     * @param handler pointer to the ParametersHandler object, with the parameter `frameBudget` and
+     * the optional parameters `degradeRatio`, `restoreRatio`, `degradeFrames`, `restoreFrames`,
+     * `smoothingFactor`, `dynamicsDecimation` and `lowestLevel` (`full`, `reduced_dynamics_rate`,
+     * `reduced_kinematics`, `kinematics_only` or `approximate_kinematics`)
+     * @return true if the initialization is successful, false otherwise
+     */
+    bool initialize(std::weak_ptr<const BipedalLocomotion::ParametersHandler::IParametersHandler> handler);
+
+    /**
+     * @brief Function to set the callback called when the quality level changes
+     * @param callback function called with the new quality level, e.g. to disable or enable the
+     * low priority tasks of the inverse kinematics
+     */
+    void setLevelCallback(std::function<void(QualityLevel)> callback);
+
+    /**
+     * @brief Function to feed the governor with the time spent to process a frame
+     * @param frameTime time spent to process the last frame, in seconds
+     */
+    void update(double frameTime);
+
+    /**
+     * @brief Function to know if the dynamics stage has to be run on the current frame, it must be
+     * called once per frame
+     * @return true if the dynamics has to be run, false otherwise
+     */
+    bool shouldRunDynamics();
+
+    /**
+     * @brief Function to get the current quality level
+     * @return the current quality level
+     */
+    QualityLevel getLevel() const;
+
+    /**
+     * @brief Function to get the filtered frame time
+     * @return the exponential moving average of the frame time, in seconds
+     */
+    double getAverageFrameTime() const;
+
+private:
+    void setLevel(QualityLevel level);
+
+    QualityGovernorParameters m_parameters; /** parameters of the governor */
+    std::function<void(QualityLevel)> m_levelCallback; /** callback called at each level change */
+    std::atomic<QualityLevel> m_level{QualityLevel::Full}; /** current quality level */
+    std::atomic<double> m_averageFrameTime{0.0}; /** filtered frame time */
+    bool m_firstFrame{true}; /** true until the first frame time is received */
+    std::size_t m_framesAboveThreshold{0}; /** consecutive frames above the degrade threshold */
+    std::size_t m_framesBelowThreshold{0}; /** consecutive frames below the restore threshold */
+    std::size_t m_dynamicsCounter{0}; /** frames since the last run of the dynamics stage */
+};
+
+} // namespace Pipeline
+} // namespace BiomechanicalAnalysis
+
+#endif // BIOMECHANICAL_ANALYSIS_PIPELINE_QUALITY_GOVERNOR_H
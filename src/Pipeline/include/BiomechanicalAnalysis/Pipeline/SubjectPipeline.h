@@ -0,0 +1,271 @@
+/**
+ * @file SubjectPipeline.h
+ * @authors Davide Gorbani <davide.gorbani@iit.it>
+ */
+
+#ifndef BIOMECHANICAL_ANALYSIS_PIPELINE_SUBJECT_PIPELINE_H
+#define BIOMECHANICAL_ANALYSIS_PIPELINE_SUBJECT_PIPELINE_H
+
+#include <array>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+// Eigen headers
+#include <Eigen/Dense>
+
+// iDynTree headers
+#include <iDynTree/Wrench.h>
+
+// BipedalLocomotion headers
+#include <BipedalLocomotion/ParametersHandler/IParametersHandler.h>
+
+#include <BiomechanicalAnalysis/IK/InverseKinematics.h>
+#include <BiomechanicalAnalysis/Pipeline/FrameProvenance.h>
+#include <BiomechanicalAnalysis/Pipeline/QualityGovernor.h>
+
+namespace BiomechanicalAnalysis
+{
+namespace Pipeline
+{
+
+/**
+ * @brief Measurements of a subject at one time instant
+ */
+struct SubjectFrame
+{
+    double timestamp{0.0}; /** time instant of the measurements, in seconds */
+    std::unordered_map<int, IK::nodeData> nodes; /** orientation and angular velocity of the IMU
+                                                    nodes */
+    std::unordered_map<int, Eigen::Matrix<double, 6, 1>> nodeWrenches; /** wrenches measured by the
+                                                                          shoes nodes, used by the
+                                                                          floor contact tasks */
+    std::unordered_map<std::string, iDynTree::Wrench> externalWrenches; /** external wrenches used by
+                                                                           the inverse dynamics */
+    FrameProvenance provenance; /** times at which the frame crossed the stage boundaries, the
+                                   ingestion can stamp FrameStage::Received before pushing it */
+};
+
+/**
+ * @brief Stages run on each frame of a subject. The kinematics stage is mandatory, the dynamics and
+ * output ones are optional and they are run only after a successful kinematics stage. The stages
+ * can stamp the provenance of the frame at their internal boundaries.
+ */
+struct SubjectStages
+{
+    std::function<bool(SubjectFrame&)> kinematics; /** e.g. HumanIK update and advance */
+    std::function<bool(SubjectFrame&)> dynamics; /** e.g. HumanID update and solve */
+    std::function<bool(SubjectFrame&)> output; /** e.g. writing the results, it receives the frame
+                                                  stamped with FrameStage::Output */
+    std::shared_ptr<QualityGovernor> governor; /** optional governor fed with the time spent in the
+                                                  stages and deciding when to run the dynamics */
+};
+
+/**
+ * @brief Policy applied when a frame is pushed in the full queue of a subject
+ */
+enum class OverflowPolicy
+{
+    DropOldest, /** the oldest queued frame is discarded */
+    DropNewest, /** the pushed frame is discarded */
+    SkipDynamics, /** the dynamics stage is skipped while the queue is above the skipDynamicsBacklog,
+                     and the oldest frame is discarded if the queue is full */
+};
+
+/**
+ * @brief Priority class of a subject. The subjects with a higher priority are always processed
+ * first, so that an overload degrades the lower classes before the higher ones.
+ */
+enum class PriorityClass
+{
+    Critical = 0, /** e.g. subjects used for the control of an exoskeleton */
+    Normal = 1,
+    Monitoring = 2, /** e.g. subjects that are only visualized or logged */
+};
+
+/**
+ * @brief Parameters of a subject of the pipeline
+ */
+struct SubjectParameters
+{
+    std::string name; /** unique name of the subject */
+    std::size_t queueCapacity{1}; /** maximum number of frames waiting to be processed */
+    OverflowPolicy policy{OverflowPolicy::DropOldest}; /** policy applied when the queue is full */
+    PriorityClass priority{PriorityClass::Normal}; /** priority class of the subject */
+    std::size_t skipDynamicsBacklog{1}; /** number of frames still in the queue from which the
+                                           dynamics stage is skipped, used only by the SkipDynamics
+                                           policy */
+};
+
+/**
+ * @brief Counters of the frames and of the load shedding events of a subject
+ */
+struct SubjectStatistics
+{
+    std::size_t pushedFrames{0}; /** frames pushed in the pipeline */
+    std::size_t processedFrames{0}; /** frames whose kinematics stage has been run */
+    std::size_t droppedOldestFrames{0}; /** queued frames discarded to make room for a new one */
+    std::size_t droppedNewestFrames{0}; /** pushed frames discarded because the queue was full */
+    std::size_t skippedDynamics{0}; /** frames processed without the dynamics stage because of the
+                                       queue backlog */
+    std::size_t governedDynamicsSkips{0}; /** frames whose dynamics stage has been skipped by the
+                                             quality governor */
+    std::size_t kinematicsFailures{0}; /** frames whose kinematics stage failed */
+    std::size_t dynamicsFailures{0}; /** frames whose dynamics stage failed */
+    std::size_t outputFailures{0}; /** frames whose output stage failed */
+    std::size_t maxQueueSize{0}; /** maximum number of frames queued at the same time */
+    std::size_t swappedStages{0}; /** stages replaced by prepareStagesSwap() */
+    std::size_t failedSwaps{0}; /** prepared stages discarded because their creation failed */
+};
+
+/**
+ * @brief Streaming pipeline processing the frames of several subjects on the shared Executor.
+ * Each subject has a bounded queue and its frames are processed in order, one at a time, while
+ * different subjects are processed in parallel up to the maximum concurrency. When a subject
+ * becomes ready, it is scheduled after the ready subjects of its own priority class and before the
+ * ones of the lower classes. The frames that cannot be processed in time are shed according to the
+ * overflow policy of the subject, and the events are counted in its statistics.
+ */
+class SubjectPipeline
+{
+public:
+    /**
+     * @brief Constructor
+     * @param maxConcurrency maximum number of subjects processed at the same time, if 0 the number
+     * of compute threads of the Executor is used
+     */
+    explicit SubjectPipeline(std::size_t maxConcurrency = 0);
+
+    /**
+     * @brief Destructor, it waits for the frames being processed and discards the queued ones
+     */
+    ~SubjectPipeline();
+
+    SubjectPipeline(const SubjectPipeline&) = delete;
+    SubjectPipeline& operator=(const SubjectPipeline&) = delete;
+
+    /**
+     * @brief Function to add a subject to the pipeline
+     * @param parameters parameters of the subject
+     * @param stages stages run on the frames of the subject
+     * @return true if the subject has been added, false otherwise
+     */
+    bool addSubject(const SubjectParameters& parameters, const SubjectStages& stages);
+
+    /**
+     * @brief Function to add a subject to the pipeline
+     * @param handler pointer to the ParametersHandler object, with the parameters `name`,
+     * `queueCapacity` and the optional parameters `overflowPolicy` (`drop_oldest`, `drop_newest` or
+     * `skip_dynamics`), `priority` (`critical`, `normal` or `monitoring`) and `skipDynamicsBacklog`
+     * @param stages stages run on the frames of the subject
+     * @return true if the subject has been added, false otherwise
+     */
+    bool addSubject(std::weak_ptr<const BipedalLocomotion::ParametersHandler::IParametersHandler> handler, const SubjectStages& stages);
+
+    /**
+     * @brief Function to push a frame of a subject, it never blocks
+     * @param subject name of the subject
+     * @param frame measurements of the subject
+     * @return true if the frame has been queued, false if the subject does not exist or the frame
+     * has been discarded by the DropNewest policy
+     */
+    bool push(const std::string& subject, SubjectFrame frame);
+
+    /**
+     * @brief Function to replace the stages of a subject without stopping it, e.g. when the subject
+     * changes or its scaled model is refined. The new stages are created by factory on an I/O thread
+     * of the Executor, while the frames keep being processed with the current stages. Once they are
+     * ready, the stages are swapped before the next frame of the subject, on the thread processing
+     * it, and handover is called to carry over the calibration and the state of the previous
+     * stages.
+     * @param subject name of the subject
+     * @param factory function creating the new stages, e.g. loading the model and initializing
+     * HumanIK and HumanID, and calling makeHumanStages(). The stages are discarded if it throws or
+     * if their kinematics stage is not set.
+     * @param handover optional function called just before the first frame processed with the new
+     * stages, e.g. calling HumanIK::transferStateFrom(); the swap is done even if it returns false
+     * @return true if the preparation has been started, false if the subject does not exist or
+     * another swap is pending
+     */
+    bool prepareStagesSwap(const std::string& subject, std::function<SubjectStages()> factory, std::function<bool()> handover = nullptr);
+
+    /**
+     * @brief Function to know if a subject has stages being prepared or waiting to be swapped
+     * @param subject name of the subject
+     * @return true if a swap is pending, false otherwise
+     */
+    bool isStagesSwapPending(const std::string& subject) const;
+
+    /**
+     * @brief Function to wait until all the queued frames have been processed
+     */
+    void waitIdle();
+
+    /**
+     * @brief Function to get the statistics of a subject
+     * @param subject name of the subject
+     * @param statistics statistics of the subject
+     * @return true if the subject exists, false otherwise
+     */
+    bool getStatistics(const std::string& subject, SubjectStatistics& statistics) const;
+
+    /**
+     * @brief Function to get the latency histograms of the processed frames of a subject
+     * @param subject name of the subject
+     * @param latencies latencies of the subject
+     * @return true if the subject exists, false otherwise
+     */
+    bool getLatencies(const std::string& subject, SubjectLatencies& latencies) const;
+
+    /**
+     * @brief Function to get the number of frames queued for a subject
+     * @param subject name of the subject
+     * @return number of frames waiting to be processed, 0 if the subject does not exist
+     */
+    std::size_t getQueueSize(const std::string& subject) const;
+
+private:
+    /**
+     * State of a subject, the queue, the statistics and the scheduled flag are protected by mutex
+     */
+    struct Subject
+    {
+        SubjectParameters parameters;
+        SubjectStages stages;
+        mutable std::mutex mutex;
+        std::deque<SubjectFrame> queue;
+        SubjectStatistics statistics;
+        SubjectLatencies latencies;
+        bool scheduled{false}; /** true if the subject is in a ready list or being processed */
+        std::future<SubjectStages> pendingStages; /** stages being prepared by prepareStagesSwap() */
+        std::function<bool()> pendingHandover; /** handover of the pending stages */
+    };
+
+    Subject* findSubject(const std::string& name) const;
+    void schedule(Subject* subject);
+    void dispatch(); /** to be called with m_schedulerMutex locked */
+    void process(Subject* subject);
+    void swapStages(Subject* subject, std::future<SubjectStages> pendingStages, const std::function<bool()>& handover);
+
+    std::size_t m_maxConcurrency; /** maximum number of subjects processed at the same time */
+    mutable std::mutex m_subjectsMutex; /** mutex protecting the map of the subjects */
+    std::unordered_map<std::string, std::unique_ptr<Subject>> m_subjects; /** subjects of the
+                                                                             pipeline */
+
+    std::mutex m_schedulerMutex; /** mutex protecting the ready lists and the running counter */
+    std::condition_variable m_idleCondition; /** condition notified when the pipeline is idle */
+    std::array<std::deque<Subject*>, 3> m_ready; /** ready subjects, one list per priority class */
+    std::size_t m_running{0}; /** number of subjects being processed */
+    bool m_stopping{false}; /** true when the pipeline is being destroyed */
+};
+
+} // namespace Pipeline
+} // namespace BiomechanicalAnalysis
+
+#endif // BIOMECHANICAL_ANALYSIS_PIPELINE_SUBJECT_PIPELINE_H
@@ -0,0 +1,194 @@
+/**
+ * @file SubjectSupervisor.h
+ * @authors Davide Gorbani <davide.gorbani@iit.it>
+ */
+
+#ifndef BIOMECHANICAL_ANALYSIS_PIPELINE_SUBJECT_SUPERVISOR_H
+#define BIOMECHANICAL_ANALYSIS_PIPELINE_SUBJECT_SUPERVISOR_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+// BipedalLocomotion headers
+#include <BipedalLocomotion/ParametersHandler/IParametersHandler.h>
+
+#include <BiomechanicalAnalysis/Pipeline/SubjectPipeline.h>
+
+namespace BiomechanicalAnalysis
+{
+namespace Pipeline
+{
+
+/**
+ * @brief Parameters of the SubjectSupervisor
+ */
+struct SupervisorParameters
+{
+    std::size_t nrOfWorkers{2}; /** number of worker processes */
+    std::size_t ringCapacity{16}; /** number of frames of the ring of each worker */
+    std::size_t maxNodes{32}; /** maximum number of IMU nodes of a frame */
+    std::size_t maxWrenches{4}; /** maximum number of node wrenches, and of external wrenches, of a
+                                   frame */
+    std::size_t virtualNodes{64}; /** points of each worker on the consistent hashing ring */
+    bool restartWorkers{true}; /** if true the workers that die are spawned again, as long as the
+                                  System::Executor has not been created in the supervisor process */
+    double rebalanceThreshold{0.75}; /** ring occupancy above which the share of subjects of a
+                                        worker is reduced */
+    std::size_t maxCrashesPerSubject{3}; /** number of times the frames of a subject can crash a
+                                            worker before the subject is quarantined, 0 to never
+                                            quarantine it */
+};
+
+/**
+ * @brief Status and counters of a worker process
+ */
+struct WorkerStatistics
+{
+    int pid{0}; /** process id of the worker, 0 if the worker is not running */
+    std::size_t virtualNodes{0}; /** current points of the worker on the hashing ring */
+    std::size_t queueSize{0}; /** frames waiting in the ring of the worker */
+    std::uint64_t processedFrames{0}; /** frames processed by the worker */
+    std::uint64_t failedFrames{0}; /** frames whose stages failed */
+    std::uint64_t droppedFrames{0}; /** frames discarded because the ring was full or the worker
+                                       died */
+    std::size_t restarts{0}; /** number of times the worker has been spawned again */
+};
+
+/**
+ * @brief Function called by a worker process the first time it receives a frame of a subject, it
+ * returns the stages used to process the frames of that subject in the worker, e.g. built with
+ * makeHumanStages() on a model loaded from a SharedModelStorage
+ */
+using WorkerStagesFactory = std::function<SubjectStages(const std::string& subject)>;
+
+/**
+ * @brief Supervisor sharding the subjects among worker processes.
+ * Each subject is assigned to a worker by consistent hashing and its frames are copied in the
+ * single-producer single-consumer shared-memory ring of that worker, so that a crash of the solvers
+ * of one subject only affects the subjects of the same worker. monitor() must be called periodically:
+ * it detects the workers that died, restarting them or removing them from the hashing ring, and
+ * reduces the share of subjects of the workers whose ring is filling up. In both cases only the
+ * subjects mapped to the affected worker change worker. A frame that makes the stages throw is
+ * counted as failed; a frame that crashes the worker is dropped, and the subject whose frames crash
+ * the workers `maxCrashesPerSubject` times is quarantined, i.e. its frames are discarded.
+ * @note The workers are created with fork(), both by initialize() and by monitor() when a dead
+ * worker is restarted, and a forked process contains only the thread that called fork(). Hence the
+ * supervisor process should not start other threads, and it must not create the System::Executor:
+ * once it exists, the workers are not spawned, i.e. initialize() fails and the dead workers are
+ * removed from the hashing ring as if `restartWorkers` were false. A subject that changes worker starts from a new state in the new worker, and the frames
+ * still queued in the previous worker may be processed out of order.
+ */
+class SubjectSupervisor
+{
+public:
+    SubjectSupervisor() = default;
+
+    /**
+     * @brief Destructor, it stops the workers
+     */
+    ~SubjectSupervisor();
+
+    SubjectSupervisor(const SubjectSupervisor&) = delete;
+    SubjectSupervisor& operator=(const SubjectSupervisor&) = delete;
+
+    /**
+     * @brief Function to allocate the rings and spawn the workers
+     * @param parameters parameters of the supervisor
+     * @param factory function creating the stages of a subject in a worker
+     * @return true if all the workers have been spawned, false otherwise
+     */
+    bool initialize(const SupervisorParameters& parameters, WorkerStagesFactory factory);
+
+    /**
+     * @brief Function to allocate the rings and spawn the workers
+     * @param handler pointer to the ParametersHandler object, with the parameters `nrOfWorkers` and
+     * the optional parameters `ringCapacity`, `maxNodes`, `maxWrenches`, `virtualNodes`,
+     * `restartWorkers`, `rebalanceThreshold` and `maxCrashesPerSubject`
+     * @param factory function creating the stages of a subject in a worker
+     * @return true if all the workers have been spawned, false otherwise
+     */
+    bool initialize(std::weak_ptr<const BipedalLocomotion::ParametersHandler::IParametersHandler> handler, WorkerStagesFactory factory);
+
+    /**
+     * @brief Function to route a frame of a subject to its worker, it never blocks
+     * @param subject name of the subject
+     * @param frame measurements of the subject
+     * @return true if the frame has been copied in the ring of the worker, false if the frame does not
+     * fit in a ring slot, no worker is alive, the ring is full or the subject is quarantined
+     */
+    bool push(const std::string& subject, const SubjectFrame& frame);
+
+    /**
+     * @brief Function to detect the dead workers and rebalance the subjects
+     * @return number of workers that died since the last call
+     * @note a dead worker is restarted with fork() from the thread calling monitor(), hence the
+     * restriction on the threads of the supervisor process described in the class documentation
+     * holds for the whole lifetime of the supervisor, not only for initialize()
+     */
+    std::size_t monitor();
+
+    /**
+     * @brief Function to get the worker of a subject
+     * @param subject name of the subject
+     * @return index of the worker, -1 if no worker is alive
+     */
+    int getWorker(const std::string& subject) const;
+
+    /**
+     * @brief Function to wait until the rings of the alive workers are empty
+     * @param timeout maximum waiting time, in seconds
+     * @return true if the rings are empty, false if the timeout expired
+     */
+    bool waitIdle(double timeout);
+
+    /**
+     * @brief Function to check if a subject is quarantined
+     * @param subject name of the subject
+     * @return true if the frames of the subject crashed the workers `maxCrashesPerSubject` times
+     */
+    bool isQuarantined(const std::string& subject) const;
+
+    /**
+     * @brief Function to get the status of the workers
+     * @return statistics of each worker
+     */
+    std::vector<WorkerStatistics> getStatistics() const;
+
+    /**
+     * @brief Function to stop the workers and release the rings
+     */
+    void shutdown();
+
+private:
+    struct Ring;
+
+    bool spawn(std::size_t worker);
+    void runWorker(std::size_t worker);
+    void buildHashRing();
+    Ring& ring(std::size_t worker) const;
+
+    SupervisorParameters m_parameters; /** parameters of the supervisor */
+    WorkerStagesFactory m_factory; /** factory of the stages, called in the workers */
+    unsigned char* m_memory{nullptr}; /** shared memory containing the rings */
+    std::size_t m_memorySize{0}; /** size of the shared memory */
+    std::size_t m_ringSize{0}; /** size of the ring of a worker */
+    std::size_t m_slotSize{0}; /** size of a frame slot of a ring */
+    std::vector<WorkerStatistics> m_workers; /** status of the workers seen by the supervisor */
+    std::map<std::uint64_t, std::size_t> m_hashRing; /** points of the alive workers on the hashing
+                                                        ring */
+    std::unordered_map<std::string, std::size_t> m_crashes; /** number of crashes of the workers
+                                                               caused by each subject */
+    std::unordered_set<std::string> m_quarantinedSubjects; /** subjects whose frames are discarded */
+};
+
+} // namespace Pipeline
+} // namespace BiomechanicalAnalysis
+
+#endif // BIOMECHANICAL_ANALYSIS_PIPELINE_SUBJECT_SUPERVISOR_H
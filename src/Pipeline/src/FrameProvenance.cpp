@@ -0,0 +1,115 @@
+#include <BiomechanicalAnalysis/Pipeline/FrameProvenance.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+using namespace BiomechanicalAnalysis::Pipeline;
+
+namespace
+{
+
+constexpr double minLatency = 1e-6;
+constexpr double bucketsPerOctave = 4.0;
+
+} // namespace
+
+std::int64_t FrameProvenance::now()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void FrameProvenance::stamp(FrameStage stage)
+{
+    timestamps[static_cast<std::size_t>(stage)] = now();
+}
+
+bool FrameProvenance::isStamped(FrameStage stage) const
+{
+    return timestamps[static_cast<std::size_t>(stage)] != 0;
+}
+
+double FrameProvenance::getLatency(FrameStage from, FrameStage to) const
+{
+    if (!isStamped(from) || !isStamped(to))
+    {
+        return -1.0;
+    }
+    return 1e-9 * static_cast<double>(timestamps[static_cast<std::size_t>(to)] - timestamps[static_cast<std::size_t>(from)]);
+}
+
+void LatencyHistogram::record(double latency)
+{
+    latency = std::max(latency, 0.0);
+    std::size_t bucket = 0;
+    if (latency >= minLatency)
+    {
+        const double index = std::floor(bucketsPerOctave * std::log2(latency / minLatency)) + 1.0;
+        bucket = std::min(static_cast<std::size_t>(index), nrOfBuckets - 1);
+    }
+    m_buckets[bucket]++;
+    m_count++;
+    m_sum += latency;
+    m_max = std::max(m_max, latency);
+}
+
+std::uint64_t LatencyHistogram::getCount() const
+{
+    return m_count;
+}
+
+double LatencyHistogram::getPercentile(double percentile) const
+{
+    if (m_count == 0)
+    {
+        return 0.0;
+    }
+    const double rank = std::clamp(percentile, 0.0, 100.0) / 100.0 * static_cast<double>(m_count);
+    std::uint64_t cumulative = 0;
+    for (std::size_t i = 0; i < nrOfBuckets; i++)
+    {
+        cumulative += m_buckets[i];
+        if (cumulative > 0 && static_cast<double>(cumulative) >= rank)
+        {
+            // the upper bound of the bucket, which cannot exceed the largest latency
+            return std::min(minLatency * std::exp2(static_cast<double>(i) / bucketsPerOctave), m_max);
+        }
+    }
+    return m_max;
+}
+
+double LatencyHistogram::getMean() const
+{
+    return m_count == 0 ? 0.0 : m_sum / static_cast<double>(m_count);
+}
+
+double LatencyHistogram::getMax() const
+{
+    return m_max;
+}
+
+void LatencyHistogram::reset()
+{
+    *this = LatencyHistogram();
+}
+
+void SubjectLatencies::record(const FrameProvenance& provenance)
+{
+    std::size_t previous = nrOfFrameStages;
+    for (std::size_t i = 0; i < nrOfFrameStages; i++)
+    {
+        if (provenance.timestamps[i] == 0)
+        {
+            continue;
+        }
+        if (previous < nrOfFrameStages)
+        {
+            stages[i].record(1e-9 * static_cast<double>(provenance.timestamps[i] - provenance.timestamps[previous]));
+        }
+        previous = i;
+    }
+    if (provenance.isStamped(FrameStage::Received) && previous > static_cast<std::size_t>(FrameStage::Received) && previous < nrOfFrameStages)
+    {
+        endToEnd.record(provenance.getLatency(FrameStage::Received, static_cast<FrameStage>(previous)));
+    }
+}
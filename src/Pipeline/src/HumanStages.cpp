@@ -0,0 +1,61 @@
+#include <BiomechanicalAnalysis/Pipeline/HumanStages.h>
+
+using namespace BiomechanicalAnalysis::Pipeline;
+
+SubjectStages BiomechanicalAnalysis::Pipeline::makeHumanStages(std::shared_ptr<IK::HumanIK> ik,
+                                                              std::shared_ptr<ID::HumanID> id,
+                                                              double floorContactLinkHeight,
+                                                              std::shared_ptr<QualityGovernor> governor,
+                                                              std::shared_ptr<IK::SurrogateIK> surrogate)
+{
+    SubjectStages stages;
+    // set by the level callback, which is called by the same thread running the stages
+    auto approximate = std::make_shared<bool>(false);
+    stages.kinematics = [ik,
+                         surrogate,
+                         approximate,
+                         floorContactLinkHeight,
+                         jointPositions = Eigen::VectorXd(Eigen::VectorXd::Zero(ik->getDoFsNumber())),
+                         baseOrientation = Eigen::Matrix3d()](SubjectFrame& frame) mutable {
+        if (*approximate)
+        {
+            // the prediction replaces the QP, HumanIK is warm started from it when the QP is used
+            // again
+            frame.provenance.stamp(FrameStage::KinematicsUpdated);
+            const bool ok = surrogate->predict(frame.nodes, *ik, jointPositions, baseOrientation)
+                            && ik->setState(jointPositions, baseOrientation);
+            frame.provenance.stamp(FrameStage::KinematicsSolved);
+            return ok;
+        }
+        bool ok = ik->updateOrientationAndGravityTasks(frame.nodes);
+        if (!frame.nodeWrenches.empty())
+        {
+            ok = ok && ik->updateFloorContactTasks(frame.nodeWrenches, floorContactLinkHeight);
+        }
+        frame.provenance.stamp(FrameStage::KinematicsUpdated);
+        ok = ok && ik->advance();
+        frame.provenance.stamp(FrameStage::KinematicsSolved);
+        return ok;
+    };
+    if (id != nullptr)
+    {
+        stages.dynamics = [id](SubjectFrame& frame) {
+            bool ok = id->updateExtWrenchesMeasurements(frame.externalWrenches);
+            frame.provenance.stamp(FrameStage::DynamicsUpdated);
+            ok = ok && id->solve();
+            frame.provenance.stamp(FrameStage::DynamicsSolved);
+            return ok;
+        };
+    }
+    if (governor != nullptr)
+    {
+        // the callback is called by the thread processing the subject, between two frames
+        governor->setLevelCallback([ik, surrogate, approximate](QualityLevel level) {
+            ik->setJointRegularizationTaskEnabled(level < QualityLevel::ReducedKinematics);
+            ik->setJointVelocityLimitsTaskEnabled(level < QualityLevel::ReducedKinematics);
+            *approximate = surrogate != nullptr && level >= QualityLevel::ApproximateKinematics;
+        });
+        stages.governor = governor;
+    }
+    return stages;
+}
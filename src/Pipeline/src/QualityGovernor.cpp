@@ -0,0 +1,218 @@
+#include <BiomechanicalAnalysis/Logging/Logger.h>
+#include <BiomechanicalAnalysis/Pipeline/QualityGovernor.h>
+
+using namespace BiomechanicalAnalysis::Pipeline;
+
+std::string BiomechanicalAnalysis::Pipeline::toString(QualityLevel level)
+{
+    switch (level)
+    {
+    case QualityLevel::Full:
+        return "full";
+    case QualityLevel::ReducedDynamicsRate:
+        return "reduced_dynamics_rate";
+    case QualityLevel::ReducedKinematics:
+        return "reduced_kinematics";
+    case QualityLevel::KinematicsOnly:
+        return "kinematics_only";
+    case QualityLevel::ApproximateKinematics:
+        return "approximate_kinematics";
+    }
+    return "unknown";
+}
+
+bool QualityGovernor::initialize(const QualityGovernorParameters& parameters)
+{
+    constexpr auto logPrefix = "[QualityGovernor::initialize]";
+
+    if (parameters.frameBudget <= 0.0)
+    {
+        BiomechanicalAnalysis::log()->error("{} The frame budget must be positive.", logPrefix);
+        return false;
+    }
+    if (parameters.restoreRatio <= 0.0 || parameters.restoreRatio >= parameters.degradeRatio)
+    {
+        BiomechanicalAnalysis::log()->error("{} The restore ratio must be positive and lower than the degrade ratio.", logPrefix);
+        return false;
+    }
+    if (parameters.degradeFrames == 0 || parameters.restoreFrames == 0)
+    {
+        BiomechanicalAnalysis::log()->error("{} The numbers of frames needed to change the quality must be positive.", logPrefix);
+        return false;
+    }
+    if (parameters.smoothingFactor <= 0.0 || parameters.smoothingFactor > 1.0)
+    {
+        BiomechanicalAnalysis::log()->error("{} The smoothing factor must be in (0, 1].", logPrefix);
+        return false;
+    }
+    if (parameters.dynamicsDecimation == 0)
+    {
+        BiomechanicalAnalysis::log()->error("{} The dynamics decimation must be positive.", logPrefix);
+        return false;
+    }
+
+    m_parameters = parameters;
+    m_level = QualityLevel::Full;
+    m_averageFrameTime = 0.0;
+    m_firstFrame = true;
+    m_framesAboveThreshold = 0;
+    m_framesBelowThreshold = 0;
+    m_dynamicsCounter = 0;
+    return true;
+}
+
+bool QualityGovernor::initialize(std::weak_ptr<const BipedalLocomotion::ParametersHandler::IParametersHandler> handler)
+{
+    constexpr auto logPrefix = "[QualityGovernor::initialize]";
+
+    auto ptr = handler.lock();
+    if (ptr == nullptr)
+    {
+        BiomechanicalAnalysis::log()->error("{} Invalid parameters handler.", logPrefix);
+        return false;
+    }
+
+    QualityGovernorParameters parameters;
+    if (!ptr->getParameter("frameBudget", parameters.frameBudget))
+    {
+        BiomechanicalAnalysis::log()->error("{} Parameter 'frameBudget' is missing.", logPrefix);
+        return false;
+    }
+    ptr->getParameter("degradeRatio", parameters.degradeRatio);
+    ptr->getParameter("restoreRatio", parameters.restoreRatio);
+    ptr->getParameter("smoothingFactor", parameters.smoothingFactor);
+
+    int frames;
+    if (ptr->getParameter("degradeFrames", frames))
+    {
+        parameters.degradeFrames = frames > 0 ? frames : 0;
+    }
+    if (ptr->getParameter("restoreFrames", frames))
+    {
+        parameters.restoreFrames = frames > 0 ? frames : 0;
+    }
+    if (ptr->getParameter("dynamicsDecimation", frames))
+    {
+        parameters.dynamicsDecimation = frames > 0 ? frames : 0;
+    }
+
+    std::string lowestLevel;
+    if (ptr->getParameter("lowestLevel", lowestLevel))
+    {
+        bool found{false};
+        for (auto level : {QualityLevel::Full,
+                           QualityLevel::ReducedDynamicsRate,
+                           QualityLevel::ReducedKinematics,
+                           QualityLevel::KinematicsOnly,
+                           QualityLevel::ApproximateKinematics})
+        {
+            if (toString(level) == lowestLevel)
+            {
+                parameters.lowestLevel = level;
+                found = true;
+            }
+        }
+        if (!found)
+        {
+            BiomechanicalAnalysis::log()->error("{} Unknown quality level '{}'.", logPrefix, lowestLevel);
+            return false;
+        }
+    }
+
+    return initialize(parameters);
+}
+
+void QualityGovernor::setLevelCallback(std::function<void(QualityLevel)> callback)
+{
+    m_levelCallback = std::move(callback);
+}
+
+void QualityGovernor::update(double frameTime)
+{
+    constexpr auto logPrefix = "[QualityGovernor::update]";
+
+    double average = frameTime;
+    if (!m_firstFrame)
+    {
+        average = m_parameters.smoothingFactor * frameTime + (1.0 - m_parameters.smoothingFactor) * m_averageFrameTime;
+    }
+    m_firstFrame = false;
+    m_averageFrameTime = average;
+
+    const QualityLevel level = m_level;
+    if (average > m_parameters.degradeRatio * m_parameters.frameBudget && level < m_parameters.lowestLevel)
+    {
+        m_framesBelowThreshold = 0;
+        if (++m_framesAboveThreshold >= m_parameters.degradeFrames)
+        {
+            const auto newLevel = static_cast<QualityLevel>(static_cast<int>(level) + 1);
+            BiomechanicalAnalysis::log()->info("{} Average frame time {:.3f} ms over {:.0f}% of the {:.3f} ms budget, quality lowered to '{}'.",
+                                               logPrefix,
+                                               average * 1e3,
+                                               m_parameters.degradeRatio * 100.0,
+                                               m_parameters.frameBudget * 1e3,
+                                               toString(newLevel));
+            setLevel(newLevel);
+        }
+    } else if (average < m_parameters.restoreRatio * m_parameters.frameBudget && level > QualityLevel::Full)
+    {
+        m_framesAboveThreshold = 0;
+        if (++m_framesBelowThreshold >= m_parameters.restoreFrames)
+        {
+            const auto newLevel = static_cast<QualityLevel>(static_cast<int>(level) - 1);
+            BiomechanicalAnalysis::log()->info("{} Average frame time {:.3f} ms under {:.0f}% of the {:.3f} ms budget, quality raised to '{}'.",
+                                               logPrefix,
+                                               average * 1e3,
+                                               m_parameters.restoreRatio * 100.0,
+                                               m_parameters.frameBudget * 1e3,
+                                               toString(newLevel));
+            setLevel(newLevel);
+        }
+    } else
+    {
+        m_framesAboveThreshold = 0;
+        m_framesBelowThreshold = 0;
+    }
+}
+
+void QualityGovernor::setLevel(QualityLevel level)
+{
+    m_level = level;
+    m_framesAboveThreshold = 0;
+    m_framesBelowThreshold = 0;
+    if (m_levelCallback)
+    {
+        m_levelCallback(level);
+    }
+}
+
+bool QualityGovernor::shouldRunDynamics()
+{
+    const QualityLevel level = m_level;
+    if (level >= QualityLevel::KinematicsOnly)
+    {
+        return false;
+    }
+    if (level == QualityLevel::Full)
+    {
+        m_dynamicsCounter = 0;
+        return true;
+    }
+    if (m_dynamicsCounter == 0)
+    {
+        m_dynamicsCounter = m_parameters.dynamicsDecimation - 1;
+        return true;
+    }
+    m_dynamicsCounter--;
+    return false;
+}
+
+QualityLevel QualityGovernor::getLevel() const
+{
+    return m_level;
+}
+
+double QualityGovernor::getAverageFrameTime() const
+{
+    return m_averageFrameTime;
+}
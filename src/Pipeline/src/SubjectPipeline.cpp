@@ -0,0 +1,485 @@
+#include <BiomechanicalAnalysis/Logging/Logger.h>
+#include <BiomechanicalAnalysis/Pipeline/SubjectPipeline.h>
+#include <BiomechanicalAnalysis/System/Executor.h>
+
+#include <algorithm>
+#include <chrono>
+#include <exception>
+
+using namespace BiomechanicalAnalysis::Pipeline;
+
+SubjectPipeline::SubjectPipeline(std::size_t maxConcurrency)
+    : m_maxConcurrency(maxConcurrency)
+{
+    if (m_maxConcurrency == 0)
+    {
+        m_maxConcurrency = System::Executor::instance().getNrOfComputeThreads();
+    }
+}
+
+SubjectPipeline::~SubjectPipeline()
+{
+    std::unique_lock<std::mutex> lock(m_schedulerMutex);
+    m_stopping = true;
+    for (auto& ready : m_ready)
+    {
+        ready.clear();
+    }
+    m_idleCondition.wait(lock, [this] { return m_running == 0; });
+}
+
+bool SubjectPipeline::addSubject(const SubjectParameters& parameters, const SubjectStages& stages)
+{
+    constexpr auto logPrefix = "[SubjectPipeline::addSubject]";
+
+    if (parameters.name.empty())
+    {
+        BiomechanicalAnalysis::log()->error("{} The name of the subject cannot be empty.", logPrefix);
+        return false;
+    }
+    if (parameters.queueCapacity == 0)
+    {
+        BiomechanicalAnalysis::log()->error("{} The queue capacity of the subject '{}' must be positive.", logPrefix, parameters.name);
+        return false;
+    }
+    if (!stages.kinematics)
+    {
+        BiomechanicalAnalysis::log()->error("{} The kinematics stage of the subject '{}' is not set.", logPrefix, parameters.name);
+        return false;
+    }
+
+    auto subject = std::make_unique<Subject>();
+    subject->parameters = parameters;
+    subject->stages = stages;
+
+    std::lock_guard<std::mutex> lock(m_subjectsMutex);
+    if (!m_subjects.emplace(parameters.name, std::move(subject)).second)
+    {
+        BiomechanicalAnalysis::log()->error("{} The subject '{}' already exists.", logPrefix, parameters.name);
+        return false;
+    }
+    return true;
+}
+
+bool SubjectPipeline::addSubject(std::weak_ptr<const BipedalLocomotion::ParametersHandler::IParametersHandler> handler,
+                                 const SubjectStages& stages)
+{
+    constexpr auto logPrefix = "[SubjectPipeline::addSubject]";
+
+    auto ptr = handler.lock();
+    if (ptr == nullptr)
+    {
+        BiomechanicalAnalysis::log()->error("{} Invalid parameters handler.", logPrefix);
+        return false;
+    }
+
+    SubjectParameters parameters;
+    if (!ptr->getParameter("name", parameters.name))
+    {
+        BiomechanicalAnalysis::log()->error("{} Parameter 'name' is missing.", logPrefix);
+        return false;
+    }
+
+    int capacity;
+    if (!ptr->getParameter("queueCapacity", capacity))
+    {
+        BiomechanicalAnalysis::log()->error("{} Parameter 'queueCapacity' is missing.", logPrefix);
+        return false;
+    }
+    if (capacity <= 0)
+    {
+        BiomechanicalAnalysis::log()->error("{} The parameter 'queueCapacity' must be positive.", logPrefix);
+        return false;
+    }
+    parameters.queueCapacity = capacity;
+
+    std::string policy{"drop_oldest"};
+    ptr->getParameter("overflowPolicy", policy);
+    if (policy == "drop_oldest")
+    {
+        parameters.policy = OverflowPolicy::DropOldest;
+    } else if (policy == "drop_newest")
+    {
+        parameters.policy = OverflowPolicy::DropNewest;
+    } else if (policy == "skip_dynamics")
+    {
+        parameters.policy = OverflowPolicy::SkipDynamics;
+    } else
+    {
+        BiomechanicalAnalysis::log()->error("{} Unknown overflow policy '{}'.", logPrefix, policy);
+        return false;
+    }
+
+    std::string priority{"normal"};
+    ptr->getParameter("priority", priority);
+    if (priority == "critical")
+    {
+        parameters.priority = PriorityClass::Critical;
+    } else if (priority == "normal")
+    {
+        parameters.priority = PriorityClass::Normal;
+    } else if (priority == "monitoring")
+    {
+        parameters.priority = PriorityClass::Monitoring;
+    } else
+    {
+        BiomechanicalAnalysis::log()->error("{} Unknown priority class '{}'.", logPrefix, priority);
+        return false;
+    }
+
+    // by default the dynamics is skipped as soon as a frame is waiting behind the processed one
+    int backlog{1};
+    ptr->getParameter("skipDynamicsBacklog", backlog);
+    if (backlog <= 0)
+    {
+        BiomechanicalAnalysis::log()->error("{} The parameter 'skipDynamicsBacklog' must be positive.", logPrefix);
+        return false;
+    }
+    parameters.skipDynamicsBacklog = backlog;
+
+    return addSubject(parameters, stages);
+}
+
+SubjectPipeline::Subject* SubjectPipeline::findSubject(const std::string& name) const
+{
+    std::lock_guard<std::mutex> lock(m_subjectsMutex);
+    auto it = m_subjects.find(name);
+    return it == m_subjects.end() ? nullptr : it->second.get();
+}
+
+bool SubjectPipeline::push(const std::string& subject, SubjectFrame frame)
+{
+    constexpr auto logPrefix = "[SubjectPipeline::push]";
+
+    // the subjects are never removed, so the pointer stays valid
+    Subject* ptr = findSubject(subject);
+    if (ptr == nullptr)
+    {
+        BiomechanicalAnalysis::log()->error("{} The subject '{}' does not exist.", logPrefix, subject);
+        return false;
+    }
+
+    if (!frame.provenance.isStamped(FrameStage::Received))
+    {
+        frame.provenance.stamp(FrameStage::Received);
+    }
+
+    bool queued{true};
+    bool needsScheduling{false};
+    {
+        std::lock_guard<std::mutex> lock(ptr->mutex);
+        SubjectStatistics& statistics = ptr->statistics;
+        statistics.pushedFrames++;
+
+        if (ptr->queue.size() >= ptr->parameters.queueCapacity)
+        {
+            if (ptr->parameters.policy == OverflowPolicy::DropNewest)
+            {
+                statistics.droppedNewestFrames++;
+                queued = false;
+            } else
+            {
+                ptr->queue.pop_front();
+                statistics.droppedOldestFrames++;
+            }
+        }
+        if (queued)
+        {
+            ptr->queue.push_back(std::move(frame));
+            statistics.maxQueueSize = std::max(statistics.maxQueueSize, ptr->queue.size());
+            needsScheduling = !ptr->scheduled;
+            ptr->scheduled = true;
+        }
+    }
+
+    if (needsScheduling)
+    {
+        schedule(ptr);
+    }
+    return queued;
+}
+
+void SubjectPipeline::schedule(Subject* subject)
+{
+    std::unique_lock<std::mutex> lock(m_schedulerMutex);
+    if (m_stopping)
+    {
+        return;
+    }
+    m_ready[static_cast<std::size_t>(subject->parameters.priority)].push_back(subject);
+    dispatch();
+}
+
+void SubjectPipeline::dispatch()
+{
+    while (m_running < m_maxConcurrency)
+    {
+        auto ready = std::find_if(m_ready.begin(), m_ready.end(), [](const auto& list) { return !list.empty(); });
+        if (ready == m_ready.end())
+        {
+            break;
+        }
+        Subject* subject = ready->front();
+        ready->pop_front();
+        m_running++;
+        System::Executor::instance().submit([this, subject] { process(subject); });
+    }
+
+    if (m_running == 0)
+    {
+        m_idleCondition.notify_all();
+    }
+}
+
+void SubjectPipeline::process(Subject* subject)
+{
+    constexpr auto logPrefix = "[SubjectPipeline::process]";
+
+    SubjectFrame frame;
+    bool runDynamics;
+    std::future<SubjectStages> pendingStages;
+    std::function<bool()> handover;
+    {
+        std::lock_guard<std::mutex> lock(subject->mutex);
+        // the prepared stages are swapped at the frame boundary, the ones still being created are
+        // checked again at the next frame
+        if (subject->pendingStages.valid() && subject->pendingStages.wait_for(std::chrono::seconds(0)) == std::future_status::ready)
+        {
+            pendingStages = std::move(subject->pendingStages);
+            handover = std::move(subject->pendingHandover);
+        }
+    }
+    if (pendingStages.valid())
+    {
+        swapStages(subject, std::move(pendingStages), handover);
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(subject->mutex);
+        frame = std::move(subject->queue.front());
+        subject->queue.pop_front();
+        runDynamics = static_cast<bool>(subject->stages.dynamics);
+        if (runDynamics && subject->parameters.policy == OverflowPolicy::SkipDynamics
+            && subject->queue.size() >= subject->parameters.skipDynamicsBacklog)
+        {
+            runDynamics = false;
+            subject->statistics.skippedDynamics++;
+        }
+    }
+
+    // the governor is asked on every frame, so that its decimation is not affected by the load
+    // shedding
+    const std::shared_ptr<QualityGovernor>& governor = subject->stages.governor;
+    const bool governorSkipsDynamics = governor != nullptr && !governor->shouldRunDynamics() && runDynamics;
+    runDynamics = runDynamics && !governorSkipsDynamics;
+
+    bool kinematicsOk{false};
+    bool dynamicsOk{true};
+    bool outputOk{true};
+    frame.provenance.stamp(FrameStage::Dequeued);
+    // an exception is counted as a failure of the stage that threw it
+    auto failThrowingStage = [&frame, &kinematicsOk, &dynamicsOk, &outputOk]() {
+        if (frame.provenance.isStamped(FrameStage::Output))
+        {
+            outputOk = false;
+        } else
+        {
+            dynamicsOk = !kinematicsOk;
+        }
+    };
+    const auto start = std::chrono::steady_clock::now();
+    try
+    {
+        kinematicsOk = subject->stages.kinematics(frame);
+        if (kinematicsOk && runDynamics)
+        {
+            dynamicsOk = subject->stages.dynamics(frame);
+        }
+        if (kinematicsOk && subject->stages.output)
+        {
+            frame.provenance.stamp(FrameStage::Output);
+            outputOk = subject->stages.output(frame);
+        }
+    } catch (const std::exception& e)
+    {
+        BiomechanicalAnalysis::log()->error("{} The subject '{}' threw an exception: {}", logPrefix, subject->parameters.name, e.what());
+        failThrowingStage();
+    } catch (...)
+    {
+        // any other exception must not skip the bookkeeping below, otherwise waitIdle() never returns
+        BiomechanicalAnalysis::log()->error("{} The subject '{}' threw an unknown exception.", logPrefix, subject->parameters.name);
+        failThrowingStage();
+    }
+    if (governor != nullptr)
+    {
+        governor->update(std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+    }
+
+    bool requeue;
+    {
+        std::lock_guard<std::mutex> lock(subject->mutex);
+        subject->statistics.processedFrames++;
+        if (governorSkipsDynamics)
+        {
+            subject->statistics.governedDynamicsSkips++;
+        }
+        if (!kinematicsOk)
+        {
+            subject->statistics.kinematicsFailures++;
+        } else if (!dynamicsOk)
+        {
+            subject->statistics.dynamicsFailures++;
+        }
+        if (!outputOk)
+        {
+            subject->statistics.outputFailures++;
+        }
+        subject->latencies.record(frame.provenance);
+        requeue = !subject->queue.empty();
+        subject->scheduled = requeue;
+    }
+
+    std::unique_lock<std::mutex> lock(m_schedulerMutex);
+    m_running--;
+    if (requeue && !m_stopping)
+    {
+        // the subject goes after the other ready subjects of its class, so that the subjects of the
+        // same class share the threads fairly
+        m_ready[static_cast<std::size_t>(subject->parameters.priority)].push_back(subject);
+    }
+    dispatch();
+}
+
+void SubjectPipeline::swapStages(Subject* subject, std::future<SubjectStages> pendingStages, const std::function<bool()>& handover)
+{
+    constexpr auto logPrefix = "[SubjectPipeline::swapStages]";
+
+    // the stages are used only by the thread processing the subject, so they can be replaced
+    // without locking
+    bool swapped{false};
+    try
+    {
+        SubjectStages stages = pendingStages.get();
+        if (!stages.kinematics)
+        {
+            BiomechanicalAnalysis::log()->error("{} The kinematics stage of the new stages of the subject '{}' is not set.",
+                                                logPrefix,
+                                                subject->parameters.name);
+        } else
+        {
+            if (handover && !handover())
+            {
+                BiomechanicalAnalysis::log()->warn("{} The state of the subject '{}' has not been carried over to the new stages.",
+                                                   logPrefix,
+                                                   subject->parameters.name);
+            }
+            subject->stages = std::move(stages);
+            swapped = true;
+        }
+    } catch (const std::exception& e)
+    {
+        BiomechanicalAnalysis::log()->error("{} The creation of the new stages of the subject '{}' threw an exception: {}",
+                                            logPrefix,
+                                            subject->parameters.name,
+                                            e.what());
+    } catch (...)
+    {
+        BiomechanicalAnalysis::log()->error("{} The swap of the stages of the subject '{}' threw an unknown exception.",
+                                            logPrefix,
+                                            subject->parameters.name);
+    }
+
+    std::lock_guard<std::mutex> lock(subject->mutex);
+    if (swapped)
+    {
+        subject->statistics.swappedStages++;
+    } else
+    {
+        subject->statistics.failedSwaps++;
+    }
+}
+
+bool SubjectPipeline::prepareStagesSwap(const std::string& subject, std::function<SubjectStages()> factory, std::function<bool()> handover)
+{
+    constexpr auto logPrefix = "[SubjectPipeline::prepareStagesSwap]";
+
+    Subject* ptr = findSubject(subject);
+    if (ptr == nullptr)
+    {
+        BiomechanicalAnalysis::log()->error("{} The subject '{}' does not exist.", logPrefix, subject);
+        return false;
+    }
+    if (!factory)
+    {
+        BiomechanicalAnalysis::log()->error("{} The factory of the stages of the subject '{}' is not set.", logPrefix, subject);
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(ptr->mutex);
+    if (ptr->pendingStages.valid())
+    {
+        BiomechanicalAnalysis::log()->error("{} A swap of the stages of the subject '{}' is already pending.", logPrefix, subject);
+        return false;
+    }
+    // the creation of the stages may last several frames, so it runs on an I/O thread to not take a
+    // compute thread from the frames
+    ptr->pendingStages = System::Executor::instance().submitIO(std::move(factory));
+    ptr->pendingHandover = std::move(handover);
+    return true;
+}
+
+bool SubjectPipeline::isStagesSwapPending(const std::string& subject) const
+{
+    const Subject* ptr = findSubject(subject);
+    if (ptr == nullptr)
+    {
+        return false;
+    }
+    std::lock_guard<std::mutex> lock(ptr->mutex);
+    return ptr->pendingStages.valid();
+}
+
+void SubjectPipeline::waitIdle()
+{
+    std::unique_lock<std::mutex> lock(m_schedulerMutex);
+    m_idleCondition.wait(lock, [this] {
+        return m_running == 0 && std::all_of(m_ready.begin(), m_ready.end(), [](const auto& list) { return list.empty(); });
+    });
+}
+
+bool SubjectPipeline::getStatistics(const std::string& subject, SubjectStatistics& statistics) const
+{
+    const Subject* ptr = findSubject(subject);
+    if (ptr == nullptr)
+    {
+        BiomechanicalAnalysis::log()->error("[SubjectPipeline::getStatistics] The subject '{}' does not exist.", subject);
+        return false;
+    }
+    std::lock_guard<std::mutex> lock(ptr->mutex);
+    statistics = ptr->statistics;
+    return true;
+}
+
+bool SubjectPipeline::getLatencies(const std::string& subject, SubjectLatencies& latencies) const
+{
+    const Subject* ptr = findSubject(subject);
+    if (ptr == nullptr)
+    {
+        BiomechanicalAnalysis::log()->error("[SubjectPipeline::getLatencies] The subject '{}' does not exist.", subject);
+        return false;
+    }
+    std::lock_guard<std::mutex> lock(ptr->mutex);
+    latencies = ptr->latencies;
+    return true;
+}
+
+std::size_t SubjectPipeline::getQueueSize(const std::string& subject) const
+{
+    const Subject* ptr = findSubject(subject);
+    if (ptr == nullptr)
+    {
+        return 0;
+    }
+    std::lock_guard<std::mutex> lock(ptr->mutex);
+    return ptr->queue.size();
+}
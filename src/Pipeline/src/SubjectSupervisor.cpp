@@ -0,0 +1,617 @@
+#include <BiomechanicalAnalysis/Logging/Logger.h>
+#include <BiomechanicalAnalysis/Pipeline/SubjectSupervisor.h>
+#include <BiomechanicalAnalysis/System/Executor.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <exception>
+#include <new>
+#include <thread>
+#include <unordered_map>
+
+// POSIX headers
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+using namespace BiomechanicalAnalysis::Pipeline;
+
+namespace
+{
+
+constexpr std::size_t maxNameLength = 64;
+constexpr std::size_t cacheLineSize = 64;
+
+// the frames are copied in fixed size slots, made of the header followed by maxNodes node records,
+// maxWrenches node wrench records and maxWrenches external wrench records
+struct SlotHeader
+{
+    char subject[maxNameLength];
+    double timestamp;
+    std::int64_t provenance[nrOfFrameStages]; // the steady clock is shared by the processes
+    std::uint32_t nrOfNodes;
+    std::uint32_t nrOfNodeWrenches;
+    std::uint32_t nrOfExternalWrenches;
+};
+
+struct NodeRecord
+{
+    std::int64_t node;
+    double quaternion[4]; // x, y, z, w
+    double angularVelocity[3];
+};
+
+struct NodeWrenchRecord
+{
+    std::int64_t node;
+    double wrench[6];
+};
+
+struct ExternalWrenchRecord
+{
+    char name[maxNameLength];
+    double wrench[6];
+};
+
+std::size_t alignToCacheLine(std::size_t size)
+{
+    return (size + cacheLineSize - 1) / cacheLineSize * cacheLineSize;
+}
+
+// FNV-1a followed by a final mixing step, it does not depend on the process, unlike std::hash
+std::uint64_t hash(const std::string& key)
+{
+    std::uint64_t h = 14695981039346656037ULL;
+    for (const char c : key)
+    {
+        h = (h ^ static_cast<unsigned char>(c)) * 1099511628211ULL;
+    }
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    return h;
+}
+
+} // namespace
+
+/**
+ * Control block at the beginning of the ring of a worker, followed by the frame slots. head is
+ * written only by the supervisor and tail only by the worker. busy is set by the worker while it
+ * runs the stages of the subject, so that the supervisor knows which subject was being processed
+ * if the worker dies.
+ */
+struct SubjectSupervisor::Ring
+{
+    alignas(cacheLineSize) std::atomic<std::uint64_t> head;
+    alignas(cacheLineSize) std::atomic<std::uint64_t> tail;
+    std::atomic<std::uint64_t> processedFrames;
+    std::atomic<std::uint64_t> failedFrames;
+    std::atomic<std::uint32_t> stop;
+    std::atomic<std::uint32_t> busy;
+    char subject[maxNameLength];
+};
+
+static_assert(std::atomic<std::uint64_t>::is_always_lock_free, "The rings need lock free atomics to be shared among processes");
+
+SubjectSupervisor::~SubjectSupervisor()
+{
+    shutdown();
+}
+
+bool SubjectSupervisor::initialize(std::weak_ptr<const BipedalLocomotion::ParametersHandler::IParametersHandler> handler,
+                                   WorkerStagesFactory factory)
+{
+    constexpr auto logPrefix = "[SubjectSupervisor::initialize]";
+
+    auto ptr = handler.lock();
+    if (ptr == nullptr)
+    {
+        BiomechanicalAnalysis::log()->error("{} Invalid parameters handler.", logPrefix);
+        return false;
+    }
+
+    SupervisorParameters parameters;
+    int nrOfWorkers{0};
+    if (!ptr->getParameter("nrOfWorkers", nrOfWorkers) || nrOfWorkers <= 0)
+    {
+        BiomechanicalAnalysis::log()->error("{} Parameter 'nrOfWorkers' is missing or not positive.", logPrefix);
+        return false;
+    }
+    parameters.nrOfWorkers = nrOfWorkers;
+
+    // optional parameters
+    auto getSize = [&ptr](const std::string& name, std::size_t& value) {
+        int parameter{0};
+        if (ptr->getParameter(name, parameter))
+        {
+            value = parameter > 0 ? parameter : 0;
+        }
+    };
+    getSize("ringCapacity", parameters.ringCapacity);
+    getSize("maxNodes", parameters.maxNodes);
+    getSize("maxWrenches", parameters.maxWrenches);
+    getSize("virtualNodes", parameters.virtualNodes);
+    getSize("maxCrashesPerSubject", parameters.maxCrashesPerSubject);
+    ptr->getParameter("restartWorkers", parameters.restartWorkers);
+    ptr->getParameter("rebalanceThreshold", parameters.rebalanceThreshold);
+
+    return initialize(parameters, std::move(factory));
+}
+
+bool SubjectSupervisor::initialize(const SupervisorParameters& parameters, WorkerStagesFactory factory)
+{
+    constexpr auto logPrefix = "[SubjectSupervisor::initialize]";
+
+    if (parameters.nrOfWorkers == 0 || parameters.ringCapacity == 0 || parameters.virtualNodes == 0 || !factory)
+    {
+        BiomechanicalAnalysis::log()->error("{} The number of workers, the ring capacity, the number of virtual nodes and the factory must be "
+                                            "valid.",
+                                            logPrefix);
+        return false;
+    }
+
+    shutdown();
+    m_parameters = parameters;
+    m_factory = std::move(factory);
+
+    m_slotSize = alignToCacheLine(sizeof(SlotHeader) + parameters.maxNodes * sizeof(NodeRecord)
+                                  + parameters.maxWrenches * (sizeof(NodeWrenchRecord) + sizeof(ExternalWrenchRecord)));
+    m_ringSize = alignToCacheLine(sizeof(Ring)) + parameters.ringCapacity * m_slotSize;
+    m_memorySize = parameters.nrOfWorkers * m_ringSize;
+
+    // the mapping is anonymous and shared, so it is inherited by the workers created with fork()
+    void* memory = mmap(nullptr, m_memorySize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (memory == MAP_FAILED)
+    {
+        BiomechanicalAnalysis::log()->error("{} Unable to allocate {} bytes of shared memory.", logPrefix, m_memorySize);
+        m_memorySize = 0;
+        return false;
+    }
+    m_memory = static_cast<unsigned char*>(memory);
+
+    m_workers.assign(parameters.nrOfWorkers, WorkerStatistics());
+    for (std::size_t i = 0; i < parameters.nrOfWorkers; i++)
+    {
+        new (&ring(i)) Ring();
+        ring(i).head = 0;
+        ring(i).tail = 0;
+        ring(i).processedFrames = 0;
+        ring(i).failedFrames = 0;
+        ring(i).stop = 0;
+        ring(i).busy = 0;
+        m_workers[i].virtualNodes = parameters.virtualNodes;
+        if (!spawn(i))
+        {
+            BiomechanicalAnalysis::log()->error("{} Unable to spawn the worker {}.", logPrefix, i);
+            shutdown();
+            return false;
+        }
+    }
+    buildHashRing();
+
+    return true;
+}
+
+SubjectSupervisor::Ring& SubjectSupervisor::ring(std::size_t worker) const
+{
+    return *reinterpret_cast<Ring*>(m_memory + worker * m_ringSize);
+}
+
+bool SubjectSupervisor::spawn(std::size_t worker)
+{
+    // fork() copies only the calling thread, so a worker would inherit an executor whose threads do
+    // not exist and wait forever on the tasks submitted to it
+    if (System::Executor::isCreated())
+    {
+        BiomechanicalAnalysis::log()->error("[SubjectSupervisor::spawn] The executor has been created in the supervisor process, the "
+                                            "worker {} cannot be forked.",
+                                            worker);
+        return false;
+    }
+
+    const pid_t pid = fork();
+    if (pid < 0)
+    {
+        return false;
+    }
+    if (pid == 0)
+    {
+        runWorker(worker);
+        // the worker must not run the destructors of the objects of the supervisor
+        _exit(EXIT_SUCCESS);
+    }
+    m_workers[worker].pid = pid;
+    return true;
+}
+
+void SubjectSupervisor::runWorker(std::size_t worker)
+{
+    Ring& r = ring(worker);
+    const unsigned char* slots = reinterpret_cast<const unsigned char*>(&r) + alignToCacheLine(sizeof(Ring));
+    const pid_t supervisor = getppid();
+
+    std::unordered_map<std::string, SubjectStages> stages;
+    SubjectFrame frame;
+
+    // the worker exits when it is stopped or when the supervisor dies
+    while (r.stop.load(std::memory_order_acquire) == 0 && getppid() == supervisor)
+    {
+        const std::uint64_t tail = r.tail.load(std::memory_order_relaxed);
+        if (tail == r.head.load(std::memory_order_acquire))
+        {
+            std::this_thread::sleep_for(std::chrono::microseconds(100));
+            continue;
+        }
+
+        const unsigned char* slot = slots + (tail % m_parameters.ringCapacity) * m_slotSize;
+        const auto* header = reinterpret_cast<const SlotHeader*>(slot);
+        const auto* nodes = reinterpret_cast<const NodeRecord*>(slot + sizeof(SlotHeader));
+        const auto* nodeWrenches = reinterpret_cast<const NodeWrenchRecord*>(nodes + m_parameters.maxNodes);
+        const auto* externalWrenches = reinterpret_cast<const ExternalWrenchRecord*>(nodeWrenches + m_parameters.maxWrenches);
+
+        frame.timestamp = header->timestamp;
+        std::copy(header->provenance, header->provenance + nrOfFrameStages, frame.provenance.timestamps.begin());
+        frame.provenance.stamp(FrameStage::Dequeued);
+        frame.nodes.clear();
+        frame.nodeWrenches.clear();
+        frame.externalWrenches.clear();
+        for (std::size_t i = 0; i < header->nrOfNodes; i++)
+        {
+            IK::nodeData& node = frame.nodes[static_cast<int>(nodes[i].node)];
+            node.I_R_IMU = manif::SO3d(Eigen::Quaterniond(nodes[i].quaternion[3], nodes[i].quaternion[0], nodes[i].quaternion[1], nodes[i].quaternion[2]));
+            node.I_omega_IMU = manif::SO3Tangentd(Eigen::Map<const Eigen::Vector3d>(nodes[i].angularVelocity));
+        }
+        for (std::size_t i = 0; i < header->nrOfNodeWrenches; i++)
+        {
+            frame.nodeWrenches[static_cast<int>(nodeWrenches[i].node)] = Eigen::Map<const Eigen::Matrix<double, 6, 1>>(nodeWrenches[i].wrench);
+        }
+        for (std::size_t i = 0; i < header->nrOfExternalWrenches; i++)
+        {
+            iDynTree::Wrench& wrench = frame.externalWrenches[externalWrenches[i].name];
+            for (int k = 0; k < 3; k++)
+            {
+                wrench.getLinearVec3()(k) = externalWrenches[i].wrench[k];
+                wrench.getAngularVec3()(k) = externalWrenches[i].wrench[3 + k];
+            }
+        }
+        const std::string subject(header->subject);
+
+        // the frame has been copied, so the slot can be reused by the supervisor; if the stages
+        // crash the worker, the restarted worker continues from the next frame
+        r.tail.store(tail + 1, std::memory_order_release);
+        std::memcpy(r.subject, subject.c_str(), subject.size() + 1);
+        r.busy.store(1, std::memory_order_release);
+
+        bool ok = false;
+        try
+        {
+            auto it = stages.find(subject);
+            if (it == stages.end())
+            {
+                it = stages.emplace(subject, m_factory(subject)).first;
+            }
+            const SubjectStages& subjectStages = it->second;
+            ok = subjectStages.kinematics && subjectStages.kinematics(frame);
+            const bool runDynamics = subjectStages.governor == nullptr || subjectStages.governor->shouldRunDynamics();
+            if (ok && subjectStages.dynamics && runDynamics)
+            {
+                ok = subjectStages.dynamics(frame);
+            }
+            if (ok && subjectStages.output)
+            {
+                frame.provenance.stamp(FrameStage::Output);
+                ok = subjectStages.output(frame);
+            }
+        } catch (const std::exception& e)
+        {
+            BiomechanicalAnalysis::log()->error("[SubjectSupervisor::runWorker] Worker {}, subject '{}': {}", worker, subject, e.what());
+            ok = false;
+        } catch (...)
+        {
+            BiomechanicalAnalysis::log()->error("[SubjectSupervisor::runWorker] Worker {}, subject '{}': unknown exception.", worker, subject);
+            ok = false;
+        }
+        r.busy.store(0, std::memory_order_release);
+        r.processedFrames.fetch_add(1, std::memory_order_relaxed);
+        if (!ok)
+        {
+            r.failedFrames.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+}
+
+void SubjectSupervisor::buildHashRing()
+{
+    m_hashRing.clear();
+    for (std::size_t i = 0; i < m_workers.size(); i++)
+    {
+        if (m_workers[i].pid == 0)
+        {
+            continue;
+        }
+        for (std::size_t v = 0; v < m_workers[i].virtualNodes; v++)
+        {
+            m_hashRing[hash("worker" + std::to_string(i) + "#" + std::to_string(v))] = i;
+        }
+    }
+}
+
+int SubjectSupervisor::getWorker(const std::string& subject) const
+{
+    if (m_hashRing.empty())
+    {
+        return -1;
+    }
+    auto it = m_hashRing.lower_bound(hash(subject));
+    if (it == m_hashRing.end())
+    {
+        it = m_hashRing.begin();
+    }
+    return static_cast<int>(it->second);
+}
+
+bool SubjectSupervisor::push(const std::string& subject, const SubjectFrame& frame)
+{
+    constexpr auto logPrefix = "[SubjectSupervisor::push]";
+
+    const int worker = getWorker(subject);
+    if (worker < 0)
+    {
+        BiomechanicalAnalysis::log()->error("{} No worker is alive.", logPrefix);
+        return false;
+    }
+    if (subject.size() >= maxNameLength || frame.nodes.size() > m_parameters.maxNodes
+        || frame.nodeWrenches.size() > m_parameters.maxWrenches || frame.externalWrenches.size() > m_parameters.maxWrenches)
+    {
+        BiomechanicalAnalysis::log()->error("{} The frame of the subject '{}' does not fit in a slot of the ring.", logPrefix, subject);
+        return false;
+    }
+    if (!m_quarantinedSubjects.empty() && m_quarantinedSubjects.count(subject) != 0)
+    {
+        m_workers[worker].droppedFrames++;
+        return false;
+    }
+
+    Ring& r = ring(worker);
+    const std::uint64_t head = r.head.load(std::memory_order_relaxed);
+    if (head - r.tail.load(std::memory_order_acquire) >= m_parameters.ringCapacity)
+    {
+        m_workers[worker].droppedFrames++;
+        return false;
+    }
+
+    unsigned char* slot = reinterpret_cast<unsigned char*>(&r) + alignToCacheLine(sizeof(Ring)) + (head % m_parameters.ringCapacity) * m_slotSize;
+    auto* header = reinterpret_cast<SlotHeader*>(slot);
+    auto* nodes = reinterpret_cast<NodeRecord*>(slot + sizeof(SlotHeader));
+    auto* nodeWrenches = reinterpret_cast<NodeWrenchRecord*>(nodes + m_parameters.maxNodes);
+    auto* externalWrenches = reinterpret_cast<ExternalWrenchRecord*>(nodeWrenches + m_parameters.maxWrenches);
+
+    std::memcpy(header->subject, subject.c_str(), subject.size() + 1);
+    header->timestamp = frame.timestamp;
+    std::copy(frame.provenance.timestamps.begin(), frame.provenance.timestamps.end(), header->provenance);
+    if (header->provenance[static_cast<std::size_t>(FrameStage::Received)] == 0)
+    {
+        header->provenance[static_cast<std::size_t>(FrameStage::Received)] = FrameProvenance::now();
+    }
+    header->nrOfNodes = static_cast<std::uint32_t>(frame.nodes.size());
+    header->nrOfNodeWrenches = static_cast<std::uint32_t>(frame.nodeWrenches.size());
+    header->nrOfExternalWrenches = static_cast<std::uint32_t>(frame.externalWrenches.size());
+
+    std::size_t i = 0;
+    for (const auto& [node, data] : frame.nodes)
+    {
+        nodes[i].node = node;
+        Eigen::Map<Eigen::Vector4d>(nodes[i].quaternion) = data.I_R_IMU.coeffs();
+        Eigen::Map<Eigen::Vector3d>(nodes[i].angularVelocity) = data.I_omega_IMU.coeffs();
+        i++;
+    }
+    i = 0;
+    for (const auto& [node, wrench] : frame.nodeWrenches)
+    {
+        nodeWrenches[i].node = node;
+        Eigen::Map<Eigen::Matrix<double, 6, 1>>(nodeWrenches[i].wrench) = wrench;
+        i++;
+    }
+    i = 0;
+    for (const auto& [name, wrench] : frame.externalWrenches)
+    {
+        if (name.size() >= maxNameLength)
+        {
+            BiomechanicalAnalysis::log()->error("{} The name of the wrench '{}' is too long.", logPrefix, name);
+            return false;
+        }
+        std::memcpy(externalWrenches[i].name, name.c_str(), name.size() + 1);
+        for (int k = 0; k < 3; k++)
+        {
+            externalWrenches[i].wrench[k] = wrench.getLinearVec3()(k);
+            externalWrenches[i].wrench[3 + k] = wrench.getAngularVec3()(k);
+        }
+        i++;
+    }
+
+    r.head.store(head + 1, std::memory_order_release);
+    return true;
+}
+
+std::size_t SubjectSupervisor::monitor()
+{
+    constexpr auto logPrefix = "[SubjectSupervisor::monitor]";
+
+    std::size_t deadWorkers = 0;
+    bool changed = false;
+    for (std::size_t i = 0; i < m_workers.size(); i++)
+    {
+        WorkerStatistics& worker = m_workers[i];
+        int status = 0;
+        if (worker.pid == 0 || waitpid(worker.pid, &status, WNOHANG) != worker.pid)
+        {
+            continue;
+        }
+
+        deadWorkers++;
+        worker.pid = 0;
+        BiomechanicalAnalysis::log()->warn("{} The worker {} died.", logPrefix, i);
+
+        // the frame being processed is counted as failed, and the subject whose frames crash the
+        // worker too many times is quarantined, so that it cannot make the worker restart forever
+        Ring& deadRing = ring(i);
+        if (deadRing.busy.load(std::memory_order_acquire) != 0)
+        {
+            deadRing.busy.store(0, std::memory_order_relaxed);
+            deadRing.processedFrames.fetch_add(1, std::memory_order_relaxed);
+            deadRing.failedFrames.fetch_add(1, std::memory_order_relaxed);
+            const std::string subject(deadRing.subject);
+            const std::size_t crashes = ++m_crashes[subject];
+            if (m_parameters.maxCrashesPerSubject > 0 && crashes >= m_parameters.maxCrashesPerSubject
+                && m_quarantinedSubjects.insert(subject).second)
+            {
+                BiomechanicalAnalysis::log()->error("{} The subject '{}' crashed the workers {} times, its frames are discarded.",
+                                                    logPrefix,
+                                                    subject,
+                                                    crashes);
+            }
+        }
+
+        // the frames left in the ring are processed by the restarted worker, otherwise they are
+        // discarded and the subjects of the worker are moved to the others
+        if (m_parameters.restartWorkers && spawn(i))
+        {
+            worker.restarts++;
+            continue;
+        }
+        const std::uint64_t head = deadRing.head.load(std::memory_order_relaxed);
+        worker.droppedFrames += head - deadRing.tail.load(std::memory_order_acquire);
+        deadRing.tail.store(head, std::memory_order_release);
+        changed = true;
+    }
+
+    // reduce the share of subjects of the workers whose ring is filling up more than the others,
+    // and restore it once their ring is empty
+    std::vector<double> occupancy(m_workers.size(), 0.0);
+    double meanOccupancy = 0.0;
+    std::size_t aliveWorkers = 0;
+    for (std::size_t i = 0; i < m_workers.size(); i++)
+    {
+        if (m_workers[i].pid != 0)
+        {
+            Ring& r = ring(i);
+            occupancy[i] = static_cast<double>(r.head.load(std::memory_order_relaxed) - r.tail.load(std::memory_order_acquire))
+                           / m_parameters.ringCapacity;
+            meanOccupancy += occupancy[i];
+            aliveWorkers++;
+        }
+    }
+    if (aliveWorkers > 1)
+    {
+        meanOccupancy /= aliveWorkers;
+        for (std::size_t i = 0; i < m_workers.size(); i++)
+        {
+            WorkerStatistics& worker = m_workers[i];
+            if (worker.pid == 0)
+            {
+                continue;
+            }
+            if (occupancy[i] >= m_parameters.rebalanceThreshold && occupancy[i] > meanOccupancy && worker.virtualNodes > 1)
+            {
+                worker.virtualNodes /= 2;
+                changed = true;
+                BiomechanicalAnalysis::log()->info("{} The worker {} is overloaded, virtual nodes reduced to {}.",
+                                                   logPrefix,
+                                                   i,
+                                                   worker.virtualNodes);
+            } else if (occupancy[i] == 0.0 && worker.virtualNodes < m_parameters.virtualNodes)
+            {
+                worker.virtualNodes = std::min(2 * worker.virtualNodes, m_parameters.virtualNodes);
+                changed = true;
+            }
+        }
+    }
+
+    if (changed)
+    {
+        buildHashRing();
+    }
+    return deadWorkers;
+}
+
+bool SubjectSupervisor::waitIdle(double timeout)
+{
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::duration<double>(timeout);
+    while (true)
+    {
+        bool idle = true;
+        for (std::size_t i = 0; i < m_workers.size() && idle; i++)
+        {
+            const Ring& r = ring(i);
+            idle = m_workers[i].pid == 0 || r.head.load(std::memory_order_relaxed) == r.tail.load(std::memory_order_acquire);
+        }
+        if (idle)
+        {
+            return true;
+        }
+        if (std::chrono::steady_clock::now() > deadline)
+        {
+            return false;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+}
+
+bool SubjectSupervisor::isQuarantined(const std::string& subject) const
+{
+    return m_quarantinedSubjects.count(subject) != 0;
+}
+
+std::vector<WorkerStatistics> SubjectSupervisor::getStatistics() const
+{
+    std::vector<WorkerStatistics> statistics = m_workers;
+    for (std::size_t i = 0; i < statistics.size(); i++)
+    {
+        const Ring& r = ring(i);
+        statistics[i].queueSize = r.head.load(std::memory_order_relaxed) - r.tail.load(std::memory_order_acquire);
+        statistics[i].processedFrames = r.processedFrames.load(std::memory_order_relaxed);
+        statistics[i].failedFrames = r.failedFrames.load(std::memory_order_relaxed);
+    }
+    return statistics;
+}
+
+void SubjectSupervisor::shutdown()
+{
+    if (m_memory == nullptr)
+    {
+        return;
+    }
+
+    for (std::size_t i = 0; i < m_workers.size(); i++)
+    {
+        ring(i).stop.store(1, std::memory_order_release);
+    }
+
+    // the workers are killed if they are stuck in a stage
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(1);
+    for (auto& worker : m_workers)
+    {
+        while (worker.pid != 0 && waitpid(worker.pid, nullptr, WNOHANG) == 0)
+        {
+            if (std::chrono::steady_clock::now() > deadline)
+            {
+                kill(worker.pid, SIGKILL);
+                waitpid(worker.pid, nullptr, 0);
+                break;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        worker.pid = 0;
+    }
+
+    munmap(m_memory, m_memorySize);
+    m_memory = nullptr;
+    m_memorySize = 0;
+    m_workers.clear();
+    m_hashRing.clear();
+    m_crashes.clear();
+    m_quarantinedSubjects.clear();
+}
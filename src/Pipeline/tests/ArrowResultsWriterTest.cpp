@@ -0,0 +1,182 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <BiomechanicalAnalysis/Pipeline/ArrowResultsWriter.h>
+#include <BipedalLocomotion/ParametersHandler/StdImplementation.h>
+#include <BipedalLocomotion/ParametersHandler/TomlImplementation.h>
+#include <iDynTree/ModelTestUtils.h>
+
+#include <arrow/io/file.h>
+#include <arrow/ipc/reader.h>
+
+#include <fstream>
+
+TEST_CASE("ArrowResultsWriter test")
+{
+    auto handler = std::make_shared<BipedalLocomotion::ParametersHandler::StdImplementation>();
+    BiomechanicalAnalysis::Pipeline::ArrowResultsWriter writer;
+
+    // missing parameters
+    REQUIRE_FALSE(writer.initialize(handler));
+
+    const std::vector<std::string> joints{"jLeftKnee", "jRightKnee"};
+    handler->setParameter("jointsList", joints);
+    handler->setParameter("writeTorques", true);
+    handler->setParameter("wrenchesList", std::vector<std::string>{"LeftFoot"});
+    handler->setParameter("batchSize", 4);
+
+    BiomechanicalAnalysis::Pipeline::ResultsSample sample;
+    sample.jointPositions = Eigen::VectorXd::Zero(joints.size());
+    sample.jointVelocities = Eigen::VectorXd::Zero(joints.size());
+    sample.jointTorques = Eigen::VectorXd::Zero(joints.size());
+    sample.wrenches.resize(1, Eigen::Matrix<double, 6, 1>::Zero());
+
+    // 10 samples, written in two full batches and a partial one
+    const int nrOfSamples = 10;
+
+    SECTION("Arrow IPC file")
+    {
+        const std::string filePath = "ArrowResultsWriterTest.arrow";
+        handler->setParameter("filePath", filePath);
+        handler->setParameter("format", "ipc");
+        REQUIRE(writer.initialize(handler));
+
+        // wrong size of the sample
+        BiomechanicalAnalysis::Pipeline::ResultsSample wrongSample;
+        REQUIRE_FALSE(writer.write(wrongSample));
+
+        for (int i = 0; i < nrOfSamples; i++)
+        {
+            sample.timestamp = 0.01 * i;
+            sample.jointPositions[1] = i;
+            sample.jointTorques[0] = -i;
+            sample.wrenches[0][2] = 100.0 + i;
+            REQUIRE(writer.write(sample));
+        }
+        REQUIRE(writer.close());
+
+        auto file = arrow::io::MemoryMappedFile::Open(filePath, arrow::io::FileMode::READ);
+        REQUIRE(file.ok());
+        auto reader = arrow::ipc::RecordBatchFileReader::Open(*file);
+        REQUIRE(reader.ok());
+
+        const auto schema = (*reader)->schema();
+        REQUIRE(schema->num_fields() == 1 + 7 + 3 * joints.size() + 6);
+        REQUIRE(schema->field(0)->name() == "timestamp");
+        REQUIRE(schema->GetFieldIndex("base/orientation_w") == 4);
+        REQUIRE(schema->GetFieldIndex("jRightKnee/position") >= 0);
+        REQUIRE(schema->GetFieldIndex("jLeftKnee/torque") >= 0);
+        REQUIRE(schema->GetFieldIndex("LeftFoot/force_z") >= 0);
+
+        REQUIRE((*reader)->num_record_batches() == 3);
+        int row = 0;
+        for (int b = 0; b < (*reader)->num_record_batches(); b++)
+        {
+            auto batch = (*reader)->ReadRecordBatch(b);
+            REQUIRE(batch.ok());
+            const auto timestamp = std::static_pointer_cast<arrow::DoubleArray>((*batch)->GetColumnByName("timestamp"));
+            const auto position = std::static_pointer_cast<arrow::DoubleArray>((*batch)->GetColumnByName("jRightKnee/position"));
+            const auto torque = std::static_pointer_cast<arrow::DoubleArray>((*batch)->GetColumnByName("jLeftKnee/torque"));
+            const auto force = std::static_pointer_cast<arrow::DoubleArray>((*batch)->GetColumnByName("LeftFoot/force_z"));
+            const auto orientation = std::static_pointer_cast<arrow::DoubleArray>((*batch)->GetColumnByName("base/orientation_w"));
+            for (int64_t i = 0; i < (*batch)->num_rows(); i++, row++)
+            {
+                REQUIRE(timestamp->Value(i) == 0.01 * row);
+                REQUIRE(position->Value(i) == row);
+                REQUIRE(torque->Value(i) == -row);
+                REQUIRE(force->Value(i) == 100.0 + row);
+                REQUIRE(orientation->Value(i) == 1.0);
+            }
+        }
+        REQUIRE(row == nrOfSamples);
+    }
+
+    SECTION("Parquet file")
+    {
+        const std::string filePath = "ArrowResultsWriterTest.parquet";
+        handler->setParameter("filePath", filePath);
+        handler->setParameter("format", "parquet");
+        REQUIRE(writer.initialize(handler));
+        for (int i = 0; i < nrOfSamples; i++)
+        {
+            sample.timestamp = 0.01 * i;
+            REQUIRE(writer.write(sample));
+        }
+        REQUIRE(writer.close());
+
+        // a Parquet file starts with the magic number "PAR1"
+        std::ifstream file(filePath, std::ios::binary);
+        std::string magic(4, '\0');
+        file.read(magic.data(), 4);
+        REQUIRE(magic == "PAR1");
+    }
+
+    SECTION("Results of HumanIK")
+    {
+        const iDynTree::Model model = iDynTree::getRandomModel(20);
+        auto kinDyn = std::make_shared<iDynTree::KinDynComputations>();
+        REQUIRE(kinDyn->loadRobotModel(model));
+        auto ikHandler = std::make_shared<BipedalLocomotion::ParametersHandler::TomlImplementation>();
+        REQUIRE(ikHandler->setFromFile(ARROW_RESULTS_WRITER_IK_CONFIG));
+        BiomechanicalAnalysis::IK::HumanIK ik;
+        REQUIRE(ik.initialize(ikHandler, kinDyn));
+        const Eigen::VectorXd jointPositions = Eigen::VectorXd::LinSpaced(kinDyn->getNrOfDegreesOfFreedom(), 0.1, 0.5);
+        REQUIRE(ik.setState(jointPositions, Eigen::Matrix3d::Identity()));
+
+        // the columns are in a different order than the degrees of freedom of the model
+        std::vector<std::string> ikJoints;
+        for (iDynTree::JointIndex i = model.getNrOfJoints(); i-- > 0 && ikJoints.size() < 3;)
+        {
+            if (model.getJoint(i)->getNrOfDOFs() == 1)
+            {
+                ikJoints.push_back(model.getJointName(i));
+            }
+        }
+        handler->setParameter("jointsList", ikJoints);
+        handler->setParameter("writeTorques", false);
+        handler->setParameter("wrenchesList", std::vector<std::string>{});
+        const std::string filePath = "ArrowResultsWriterTestIK.arrow";
+        handler->setParameter("filePath", filePath);
+        handler->setParameter("format", "ipc");
+
+        // the results of HumanIK need the mapping of the joints
+        REQUIRE(writer.initialize(handler));
+        REQUIRE_FALSE(writer.write(0.0, ik));
+        REQUIRE(writer.close());
+
+        // the torques need HumanID
+        handler->setParameter("writeTorques", true);
+        REQUIRE_FALSE(writer.initialize(handler, kinDyn));
+        handler->setParameter("writeTorques", false);
+
+        // a joint missing in the model
+        handler->setParameter("jointsList", std::vector<std::string>{ikJoints[0], "notAJoint"});
+        REQUIRE_FALSE(writer.initialize(handler, kinDyn));
+        handler->setParameter("jointsList", ikJoints);
+
+        REQUIRE(writer.initialize(handler, kinDyn));
+        REQUIRE(writer.write(0.0, ik));
+        REQUIRE(writer.close());
+
+        auto file = arrow::io::MemoryMappedFile::Open(filePath, arrow::io::FileMode::READ);
+        REQUIRE(file.ok());
+        auto reader = arrow::ipc::RecordBatchFileReader::Open(*file);
+        REQUIRE(reader.ok());
+        REQUIRE((*reader)->num_record_batches() == 1);
+        auto batch = (*reader)->ReadRecordBatch(0);
+        REQUIRE(batch.ok());
+        for (const auto& joint : ikJoints)
+        {
+            const auto position = std::static_pointer_cast<arrow::DoubleArray>((*batch)->GetColumnByName(joint + "/position"));
+            REQUIRE(position != nullptr);
+            const auto dof = model.getJoint(model.getJointIndex(joint))->getDOFsOffset();
+            REQUIRE(position->Value(0) == jointPositions[dof]);
+        }
+    }
+
+    SECTION("Unknown format")
+    {
+        handler->setParameter("filePath", "ArrowResultsWriterTest.csv");
+        handler->setParameter("format", "csv");
+        REQUIRE_FALSE(writer.initialize(handler));
+    }
+}
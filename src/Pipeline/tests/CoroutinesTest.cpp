@@ -0,0 +1,155 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <BiomechanicalAnalysis/Pipeline/AsyncChannel.h>
+#include <BiomechanicalAnalysis/Pipeline/Coroutines.h>
+#include <BiomechanicalAnalysis/Pipeline/FdReactor.h>
+
+#include <atomic>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+// POSIX headers
+#include <unistd.h>
+
+using namespace BiomechanicalAnalysis::Pipeline;
+
+namespace
+{
+
+Task<int> square(int value)
+{
+    co_await resumeOnCompute();
+    co_return value * value;
+}
+
+Task<int> sumOfSquares(int count)
+{
+    int sum = 0;
+    for (int i = 0; i < count; i++)
+    {
+        sum += co_await square(i);
+    }
+    co_return sum;
+}
+
+Task<void> throwing()
+{
+    co_await resumeOnIO();
+    throw std::runtime_error("stage failed");
+}
+
+// pipeline of a subject: it waits for the frames without occupying a thread and processes them on
+// the compute threads
+Task<void> subjectPipeline(AsyncChannel<int>& frames, AsyncChannel<int>& results)
+{
+    co_await resumeOnCompute();
+    while (auto frame = co_await frames.receive())
+    {
+        const int estimate = co_await square(*frame);
+        co_await results.send(estimate);
+    }
+}
+
+Task<void> collect(AsyncChannel<int>& results, std::size_t count, std::atomic<long>& sum)
+{
+    co_await resumeOnCompute();
+    for (std::size_t i = 0; i < count; i++)
+    {
+        auto result = co_await results.receive();
+        sum += *result;
+    }
+}
+
+Task<int> readPipe(FdReactor& reactor, int fd)
+{
+    co_await resumeOnCompute();
+    if (!co_await reactor.readable(fd))
+    {
+        co_return -1;
+    }
+    char value = 0;
+    if (read(fd, &value, 1) != 1)
+    {
+        co_return -1;
+    }
+    co_return value;
+}
+
+} // namespace
+
+TEST_CASE("Coroutines test")
+{
+    SECTION("Tasks")
+    {
+        REQUIRE(syncWait(sumOfSquares(10)) == 285);
+        REQUIRE_THROWS_AS(syncWait(throwing()), std::runtime_error);
+    }
+
+    SECTION("Subject pipelines")
+    {
+        // thousands of suspended pipelines do not need a thread each
+        const std::size_t nrOfSubjects = 2000;
+        const int nrOfFrames = 5;
+        std::vector<std::unique_ptr<AsyncChannel<int>>> frames;
+        AsyncChannel<int> results(16);
+        std::atomic<long> sum{0};
+
+        TaskGroup group;
+        group.spawn(collect(results, nrOfSubjects * nrOfFrames, sum));
+        for (std::size_t i = 0; i < nrOfSubjects; i++)
+        {
+            frames.push_back(std::make_unique<AsyncChannel<int>>(2));
+            group.spawn(subjectPipeline(*frames.back(), results));
+        }
+
+        long expected = 0;
+        for (int frame = 0; frame < nrOfFrames; frame++)
+        {
+            for (auto& channel : frames)
+            {
+                while (!channel->trySend(frame))
+                {
+                    std::this_thread::yield();
+                }
+                expected += frame * frame;
+            }
+        }
+        for (auto& channel : frames)
+        {
+            channel->close();
+        }
+        group.wait();
+        REQUIRE(group.getNrOfRunningTasks() == 0);
+        REQUIRE(sum == expected);
+
+        // a closed channel does not accept values
+        REQUIRE_FALSE(frames.front()->trySend(1));
+    }
+
+    SECTION("Reactor")
+    {
+        FdReactor reactor;
+        REQUIRE(reactor.start());
+
+        int fds[2];
+        REQUIRE(pipe(fds) == 0);
+        TaskGroup group;
+        std::atomic<int> received{0};
+        auto reader = [](FdReactor& reactor, int fd, std::atomic<int>& received) -> Task<void> {
+            received = co_await readPipe(reactor, fd);
+        };
+        group.spawn(reader(reactor, fds[0], received));
+
+        const char value = 42;
+        REQUIRE(write(fds[1], &value, 1) == 1);
+        group.wait();
+        REQUIRE(received == 42);
+
+        reactor.stop();
+        REQUIRE(syncWait(readPipe(reactor, fds[0])) == -1);
+        close(fds[0]);
+        close(fds[1]);
+    }
+}
@@ -0,0 +1,147 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <BiomechanicalAnalysis/Pipeline/QualityGovernor.h>
+#include <BipedalLocomotion/ParametersHandler/StdImplementation.h>
+
+#include <cmath>
+#include <vector>
+
+using namespace BiomechanicalAnalysis::Pipeline;
+
+TEST_CASE("Quality governor test")
+{
+    QualityGovernorParameters parameters;
+    parameters.frameBudget = 0.01;
+    parameters.degradeRatio = 0.9;
+    parameters.restoreRatio = 0.5;
+    parameters.degradeFrames = 3;
+    parameters.restoreFrames = 5;
+    parameters.smoothingFactor = 1.0;
+    parameters.dynamicsDecimation = 3;
+
+    QualityGovernor governor;
+    std::vector<QualityLevel> levels;
+    governor.setLevelCallback([&levels](QualityLevel level) { levels.push_back(level); });
+
+    SECTION("Degradation and restoration")
+    {
+        REQUIRE(governor.initialize(parameters));
+        REQUIRE(governor.getLevel() == QualityLevel::Full);
+
+        // the quality is lowered one level at a time, after degradeFrames frames over the threshold
+        for (int i = 0; i < 2; i++)
+        {
+            governor.update(0.0095);
+        }
+        REQUIRE(governor.getLevel() == QualityLevel::Full);
+        governor.update(0.0095);
+        REQUIRE(governor.getLevel() == QualityLevel::ReducedDynamicsRate);
+
+        // the dynamics is run once every dynamicsDecimation frames
+        std::vector<bool> runs;
+        for (int i = 0; i < 6; i++)
+        {
+            runs.push_back(governor.shouldRunDynamics());
+        }
+        REQUIRE(runs == std::vector<bool>{true, false, false, true, false, false});
+
+        for (int i = 0; i < 6; i++)
+        {
+            governor.update(0.02);
+        }
+        REQUIRE(governor.getLevel() == QualityLevel::KinematicsOnly);
+        REQUIRE_FALSE(governor.shouldRunDynamics());
+
+        // the lowest level cannot be exceeded
+        for (int i = 0; i < 10; i++)
+        {
+            governor.update(0.02);
+        }
+        REQUIRE(governor.getLevel() == QualityLevel::KinematicsOnly);
+
+        // inside the hysteresis band the level does not change
+        for (int i = 0; i < 20; i++)
+        {
+            governor.update(0.007);
+        }
+        REQUIRE(governor.getLevel() == QualityLevel::KinematicsOnly);
+
+        // a frame over the restore threshold resets the count of the frames with headroom
+        for (int i = 0; i < 4; i++)
+        {
+            governor.update(0.001);
+        }
+        governor.update(0.007);
+        for (int i = 0; i < 4; i++)
+        {
+            governor.update(0.001);
+        }
+        REQUIRE(governor.getLevel() == QualityLevel::KinematicsOnly);
+        governor.update(0.001);
+        REQUIRE(governor.getLevel() == QualityLevel::ReducedKinematics);
+
+        for (int i = 0; i < 10; i++)
+        {
+            governor.update(0.001);
+        }
+        REQUIRE(governor.getLevel() == QualityLevel::Full);
+        REQUIRE(governor.shouldRunDynamics());
+
+        REQUIRE(levels
+                == std::vector<QualityLevel>{QualityLevel::ReducedDynamicsRate,
+                                             QualityLevel::ReducedKinematics,
+                                             QualityLevel::KinematicsOnly,
+                                             QualityLevel::ReducedKinematics,
+                                             QualityLevel::ReducedDynamicsRate,
+                                             QualityLevel::Full});
+    }
+
+    SECTION("Smoothing")
+    {
+        parameters.smoothingFactor = 0.5;
+        REQUIRE(governor.initialize(parameters));
+        governor.update(0.004);
+        governor.update(0.008);
+        REQUIRE(std::abs(governor.getAverageFrameTime() - 0.006) < 1e-12);
+
+        // a single slow frame does not lower the quality
+        governor.update(0.02);
+        governor.update(0.001);
+        governor.update(0.001);
+        governor.update(0.001);
+        REQUIRE(governor.getLevel() == QualityLevel::Full);
+    }
+
+    SECTION("Configuration")
+    {
+        auto handler = std::make_shared<BipedalLocomotion::ParametersHandler::StdImplementation>();
+        REQUIRE_FALSE(governor.initialize(handler));
+
+        handler->setParameter("frameBudget", 0.01);
+        handler->setParameter("degradeFrames", 1);
+        handler->setParameter("lowestLevel", "reduced_dynamics_rate");
+        REQUIRE(governor.initialize(handler));
+        for (int i = 0; i < 5; i++)
+        {
+            governor.update(0.05);
+        }
+        REQUIRE(governor.getLevel() == QualityLevel::ReducedDynamicsRate);
+
+        // the approximate kinematics is reached only if it is configured, and it skips the dynamics
+        handler->setParameter("lowestLevel", "approximate_kinematics");
+        REQUIRE(governor.initialize(handler));
+        for (int i = 0; i < 5; i++)
+        {
+            governor.update(0.05);
+        }
+        REQUIRE(governor.getLevel() == QualityLevel::ApproximateKinematics);
+        REQUIRE_FALSE(governor.shouldRunDynamics());
+
+        handler->setParameter("lowestLevel", "minimum");
+        REQUIRE_FALSE(governor.initialize(handler));
+
+        // the restore threshold must be lower than the degrade one
+        parameters.restoreRatio = 0.95;
+        REQUIRE_FALSE(governor.initialize(parameters));
+    }
+}
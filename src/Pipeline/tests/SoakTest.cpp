@@ -0,0 +1,173 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <BiomechanicalAnalysis/Logging/Logger.h>
+#include <BiomechanicalAnalysis/Pipeline/FrameProvenance.h>
+#include <BiomechanicalAnalysis/Pipeline/HumanStages.h>
+#include <BiomechanicalAnalysis/System/ResourceUsage.h>
+#include <BipedalLocomotion/ParametersHandler/TomlImplementation.h>
+#include <iDynTree/KinDynComputations.h>
+#include <iDynTree/ModelTestUtils.h>
+#include <manif/SO3.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+using namespace BiomechanicalAnalysis::Pipeline;
+using BiomechanicalAnalysis::System::ResourceUsage;
+
+namespace
+{
+
+// The number of frames is read from the BAF_SOAK_FRAMES environment variable, the default is the
+// short variant run in CI; the SoakTestLongUnitTests test runs the same executable for 10^7 frames
+// and sets BAF_SOAK_CHECK_LATENCY, since the wall-clock latency is checked only on a dedicated
+// machine
+constexpr std::size_t defaultNrOfFrames = 20000;
+constexpr std::size_t nrOfWindows = 10;
+constexpr double dt = 0.01;
+
+// Thresholds on the drift between the first window after the warm-up and the last windows
+constexpr std::size_t maxResidentSetGrowth = 16 * 1024 * 1024;
+constexpr double maxRelativeResidentSetGrowth = 0.1;
+constexpr std::size_t maxAllocatedGrowth = 4 * 1024 * 1024;
+constexpr double maxRelativeLatencyGrowth = 0.5;
+constexpr double latencySlack = 50e-6;
+
+// IMU nodes of the IK configuration used by the tests
+const std::vector<int> nodeNumbers = {3, 4, 5, 6, 7, 8, 9, 10, 11, 12};
+
+struct SoakSample
+{
+    std::size_t frame{0}; /** frames processed at the end of the window */
+    ResourceUsage usage; /** memory used at the end of the window */
+    double medianLatency{0.0}; /** median latency of the frames of the window */
+    double tailLatency{0.0}; /** 99th percentile of the latency of the frames of the window */
+};
+
+std::size_t getNrOfFrames()
+{
+    const char* value = std::getenv("BAF_SOAK_FRAMES");
+    if (value == nullptr)
+    {
+        return defaultNrOfFrames;
+    }
+    return std::max<std::size_t>(std::strtoull(value, nullptr, 10), nrOfWindows * 10);
+}
+
+bool isLatencyChecked()
+{
+    const char* value = std::getenv("BAF_SOAK_CHECK_LATENCY");
+    return value != nullptr && std::string(value) != "0";
+}
+
+// synthetic frame of a slow periodic motion, the same motion repeats every 20 s
+SubjectFrame makeFrame(std::size_t index)
+{
+    SubjectFrame frame;
+    frame.timestamp = dt * static_cast<double>(index);
+    const double phase = 2.0 * M_PI * std::fmod(frame.timestamp, 20.0) / 20.0;
+    for (std::size_t i = 0; i < nodeNumbers.size(); i++)
+    {
+        const double offset = 0.3 * static_cast<double>(i);
+        auto& node = frame.nodes[nodeNumbers[i]];
+        node.I_R_IMU = manif::SO3d(0.2 * std::sin(phase + offset), 0.1 * std::cos(phase + offset), 0.3 * std::sin(2.0 * phase));
+        node.I_omega_IMU = manif::SO3Tangentd(Eigen::Vector3d(0.2 * std::cos(phase + offset), -0.1 * std::sin(phase + offset), 0.6 * std::cos(2.0 * phase)));
+    }
+    Eigen::Matrix<double, 6, 1> shoeWrench = Eigen::Matrix<double, 6, 1>::Zero();
+    shoeWrench(2) = 350.0 + 50.0 * std::sin(phase);
+    frame.nodeWrenches[10] = shoeWrench;
+
+    iDynTree::Wrench footWrench;
+    footWrench.zero();
+    footWrench(2) = 350.0 + 50.0 * std::sin(phase);
+    frame.externalWrenches["link0"] = footWrench;
+    footWrench(2) = 350.0 - 50.0 * std::sin(phase);
+    frame.externalWrenches["link1"] = footWrench;
+    return frame;
+}
+
+double toMiB(std::size_t bytes)
+{
+    return static_cast<double>(bytes) / (1024.0 * 1024.0);
+}
+
+} // namespace
+
+TEST_CASE("Soak test")
+{
+    const std::size_t nrOfFrames = getNrOfFrames();
+    const std::size_t windowFrames = nrOfFrames / nrOfWindows;
+
+    // HumanIK and HumanID share the same model, as in the services
+    auto kinDyn = std::make_shared<iDynTree::KinDynComputations>();
+    REQUIRE(kinDyn->loadRobotModel(iDynTree::getRandomModel(20)));
+    auto ikHandler = std::make_shared<BipedalLocomotion::ParametersHandler::TomlImplementation>();
+    REQUIRE(ikHandler->setFromFile(SOAK_IK_CONFIG));
+    auto idHandler = std::make_shared<BipedalLocomotion::ParametersHandler::TomlImplementation>();
+    REQUIRE(idHandler->setFromFile(SOAK_ID_CONFIG));
+    auto ik = std::make_shared<BiomechanicalAnalysis::IK::HumanIK>();
+    REQUIRE(ik->initialize(ikHandler, kinDyn));
+    REQUIRE(ik->setDt(dt));
+    auto id = std::make_shared<BiomechanicalAnalysis::ID::HumanID>();
+    REQUIRE(id->initialize(idHandler, kinDyn));
+    const SubjectStages stages = makeHumanStages(ik, id);
+
+    std::vector<SoakSample> samples;
+    LatencyHistogram windowLatencies;
+    std::size_t failures = 0;
+    for (std::size_t i = 0; i < windowFrames * nrOfWindows; i++)
+    {
+        SubjectFrame frame = makeFrame(i);
+        frame.provenance.stamp(FrameStage::Received);
+        frame.provenance.stamp(FrameStage::Dequeued);
+        if (!stages.kinematics(frame) || !stages.dynamics(frame))
+        {
+            failures++;
+        }
+        frame.provenance.stamp(FrameStage::Output);
+        windowLatencies.record(frame.provenance.getLatency(FrameStage::Received, FrameStage::Output));
+
+        if ((i + 1) % windowFrames == 0)
+        {
+            SoakSample sample;
+            sample.frame = i + 1;
+            REQUIRE(BiomechanicalAnalysis::System::getResourceUsage(sample.usage));
+            sample.medianLatency = windowLatencies.getPercentile(50.0);
+            sample.tailLatency = windowLatencies.getPercentile(99.0);
+            windowLatencies.reset();
+            samples.push_back(sample);
+            BiomechanicalAnalysis::log()->debug("[SoakTest] frame {}: RSS {:.1f} MiB, allocated {:.1f} MiB, latency p50 {:.1f} us, "
+                                                "p99 {:.1f} us",
+                                                sample.frame,
+                                                toMiB(sample.usage.residentSetSize),
+                                                toMiB(sample.usage.allocatedBytes),
+                                                1e6 * sample.medianLatency,
+                                                1e6 * sample.tailLatency);
+        }
+    }
+    REQUIRE(failures == 0);
+    REQUIRE(samples.size() == nrOfWindows);
+
+    // the first window contains the warm-up, e.g. the lazy allocations of the solvers
+    const SoakSample& baseline = samples[1];
+    const SoakSample& last = samples.back();
+
+    const std::size_t residentSetThreshold
+        = std::max(maxResidentSetGrowth, static_cast<std::size_t>(maxRelativeResidentSetGrowth * baseline.usage.residentSetSize));
+    REQUIRE(last.usage.residentSetSize <= baseline.usage.residentSetSize + residentSetThreshold);
+    if (last.usage.hasAllocatorStatistics)
+    {
+        REQUIRE(last.usage.allocatedBytes <= baseline.usage.allocatedBytes + maxAllocatedGrowth);
+    }
+
+    // the best of the last two windows, so that a single slow window due to the machine load is
+    // not reported as a drift
+    if (isLatencyChecked())
+    {
+        const double lastMedianLatency = std::min(samples[nrOfWindows - 2].medianLatency, last.medianLatency);
+        REQUIRE(lastMedianLatency <= (1.0 + maxRelativeLatencyGrowth) * baseline.medianLatency + latencySlack);
+    }
+}
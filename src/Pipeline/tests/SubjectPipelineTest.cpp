@@ -0,0 +1,402 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <BiomechanicalAnalysis/Pipeline/SubjectPipeline.h>
+#include <BipedalLocomotion/ParametersHandler/StdImplementation.h>
+
+#include <condition_variable>
+#include <future>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+
+using namespace BiomechanicalAnalysis::Pipeline;
+
+namespace
+{
+
+/**
+ * Stage recording the processed frames, which can be blocked to simulate an overloaded CPU
+ */
+class RecordingStage
+{
+public:
+    bool operator()(const SubjectFrame& frame)
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_running = true;
+        m_condition.notify_all();
+        m_condition.wait(lock, [this] { return !m_blocked; });
+        m_running = false;
+        m_timestamps.push_back(frame.timestamp);
+        return true;
+    }
+
+    void block()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_blocked = true;
+    }
+
+    void waitRunning()
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_condition.wait(lock, [this] { return m_running; });
+    }
+
+    void release()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_blocked = false;
+        m_condition.notify_all();
+    }
+
+    std::vector<double> timestamps()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_timestamps;
+    }
+
+private:
+    std::mutex m_mutex;
+    std::condition_variable m_condition;
+    bool m_blocked{false};
+    bool m_running{false};
+    std::vector<double> m_timestamps;
+};
+
+SubjectFrame frameAt(double timestamp)
+{
+    SubjectFrame frame;
+    frame.timestamp = timestamp;
+    return frame;
+}
+
+} // namespace
+
+TEST_CASE("Subject pipeline test")
+{
+    SubjectPipeline pipeline(1);
+    auto kinematics = std::make_shared<RecordingStage>();
+    auto dynamics = std::make_shared<RecordingStage>();
+    SubjectStages stages;
+    stages.kinematics = [kinematics](const SubjectFrame& frame) { return (*kinematics)(frame); };
+    stages.dynamics = [dynamics](const SubjectFrame& frame) { return (*dynamics)(frame); };
+
+    SubjectParameters parameters;
+    parameters.name = "subject";
+    parameters.queueCapacity = 2;
+    SubjectStatistics statistics;
+
+    SECTION("Drop oldest")
+    {
+        parameters.policy = OverflowPolicy::DropOldest;
+        REQUIRE(pipeline.addSubject(parameters, stages));
+
+        kinematics->block();
+        REQUIRE(pipeline.push("subject", frameAt(1.0)));
+        kinematics->waitRunning();
+        for (double t : {2.0, 3.0, 4.0})
+        {
+            REQUIRE(pipeline.push("subject", frameAt(t)));
+        }
+        REQUIRE(pipeline.getQueueSize("subject") == 2);
+        kinematics->release();
+        pipeline.waitIdle();
+
+        REQUIRE(kinematics->timestamps() == std::vector<double>{1.0, 3.0, 4.0});
+        REQUIRE(dynamics->timestamps() == std::vector<double>{1.0, 3.0, 4.0});
+        REQUIRE(pipeline.getStatistics("subject", statistics));
+        REQUIRE(statistics.pushedFrames == 4);
+        REQUIRE(statistics.processedFrames == 3);
+        REQUIRE(statistics.droppedOldestFrames == 1);
+        REQUIRE(statistics.droppedNewestFrames == 0);
+        REQUIRE(statistics.maxQueueSize == 2);
+    }
+
+    SECTION("Drop newest")
+    {
+        parameters.policy = OverflowPolicy::DropNewest;
+        REQUIRE(pipeline.addSubject(parameters, stages));
+
+        kinematics->block();
+        REQUIRE(pipeline.push("subject", frameAt(1.0)));
+        kinematics->waitRunning();
+        REQUIRE(pipeline.push("subject", frameAt(2.0)));
+        REQUIRE(pipeline.push("subject", frameAt(3.0)));
+        REQUIRE_FALSE(pipeline.push("subject", frameAt(4.0)));
+        kinematics->release();
+        pipeline.waitIdle();
+
+        REQUIRE(kinematics->timestamps() == std::vector<double>{1.0, 2.0, 3.0});
+        REQUIRE(pipeline.getStatistics("subject", statistics));
+        REQUIRE(statistics.droppedNewestFrames == 1);
+        REQUIRE(statistics.droppedOldestFrames == 0);
+    }
+
+    SECTION("Skip dynamics")
+    {
+        parameters.policy = OverflowPolicy::SkipDynamics;
+        parameters.queueCapacity = 3;
+        parameters.skipDynamicsBacklog = 1;
+        REQUIRE(pipeline.addSubject(parameters, stages));
+
+        kinematics->block();
+        REQUIRE(pipeline.push("subject", frameAt(1.0)));
+        kinematics->waitRunning();
+        REQUIRE(pipeline.push("subject", frameAt(2.0)));
+        REQUIRE(pipeline.push("subject", frameAt(3.0)));
+        kinematics->release();
+        pipeline.waitIdle();
+
+        // the kinematics is computed for all the frames, the dynamics only when the queue is empty
+        REQUIRE(kinematics->timestamps() == std::vector<double>{1.0, 2.0, 3.0});
+        REQUIRE(dynamics->timestamps() == std::vector<double>{1.0, 3.0});
+        REQUIRE(pipeline.getStatistics("subject", statistics));
+        REQUIRE(statistics.skippedDynamics == 1);
+        REQUIRE(statistics.droppedOldestFrames == 0);
+    }
+
+    SECTION("Priority classes")
+    {
+        std::mutex mutex;
+        std::vector<std::string> order;
+        auto recordingStages = [&mutex, &order](const std::string& name) {
+            SubjectStages subjectStages;
+            subjectStages.kinematics = [&mutex, &order, name](const SubjectFrame&) {
+                std::lock_guard<std::mutex> lock(mutex);
+                order.push_back(name);
+                return true;
+            };
+            return subjectStages;
+        };
+
+        REQUIRE(pipeline.addSubject(parameters, stages));
+        parameters.name = "monitoring";
+        parameters.priority = PriorityClass::Monitoring;
+        REQUIRE(pipeline.addSubject(parameters, recordingStages("monitoring")));
+        parameters.name = "normal";
+        parameters.priority = PriorityClass::Normal;
+        REQUIRE(pipeline.addSubject(parameters, recordingStages("normal")));
+        parameters.name = "critical";
+        parameters.priority = PriorityClass::Critical;
+        REQUIRE(pipeline.addSubject(parameters, recordingStages("critical")));
+
+        // while the only slot is busy, the subjects become ready from the lowest priority class
+        kinematics->block();
+        REQUIRE(pipeline.push("subject", frameAt(1.0)));
+        kinematics->waitRunning();
+        REQUIRE(pipeline.push("monitoring", frameAt(1.0)));
+        REQUIRE(pipeline.push("normal", frameAt(1.0)));
+        REQUIRE(pipeline.push("critical", frameAt(1.0)));
+        kinematics->release();
+        pipeline.waitIdle();
+
+        REQUIRE(order == std::vector<std::string>{"critical", "normal", "monitoring"});
+    }
+
+    SECTION("Quality governor")
+    {
+        QualityGovernorParameters governorParameters;
+        governorParameters.frameBudget = 1e-9;
+        governorParameters.restoreRatio = 0.5;
+        governorParameters.degradeFrames = 1;
+        governorParameters.dynamicsDecimation = 2;
+        governorParameters.lowestLevel = QualityLevel::ReducedDynamicsRate;
+        stages.governor = std::make_shared<QualityGovernor>();
+        REQUIRE(stages.governor->initialize(governorParameters));
+        REQUIRE(pipeline.addSubject(parameters, stages));
+
+        // any frame exceeds the budget, so the dynamics rate is reduced after the first frame
+        for (double t : {1.0, 2.0, 3.0, 4.0, 5.0})
+        {
+            REQUIRE(pipeline.push("subject", frameAt(t)));
+            pipeline.waitIdle();
+        }
+
+        REQUIRE(stages.governor->getLevel() == QualityLevel::ReducedDynamicsRate);
+        REQUIRE(kinematics->timestamps() == std::vector<double>{1.0, 2.0, 3.0, 4.0, 5.0});
+        REQUIRE(dynamics->timestamps() == std::vector<double>{1.0, 2.0, 4.0});
+        REQUIRE(pipeline.getStatistics("subject", statistics));
+        REQUIRE(statistics.governedDynamicsSkips == 2);
+        REQUIRE(statistics.skippedDynamics == 0);
+    }
+
+    SECTION("Failures")
+    {
+        stages.kinematics = [](const SubjectFrame& frame) {
+            if (frame.timestamp > 5.0)
+            {
+                // an exception not derived from std::exception
+                throw 5;
+            }
+            return frame.timestamp > 0.0;
+        };
+        stages.dynamics = [](const SubjectFrame&) -> bool { throw std::runtime_error("dynamics error"); };
+        REQUIRE(pipeline.addSubject(parameters, stages));
+
+        REQUIRE(pipeline.push("subject", frameAt(-1.0)));
+        pipeline.waitIdle();
+        REQUIRE(pipeline.push("subject", frameAt(1.0)));
+        pipeline.waitIdle();
+        REQUIRE(pipeline.push("subject", frameAt(6.0)));
+        pipeline.waitIdle();
+
+        REQUIRE(pipeline.getStatistics("subject", statistics));
+        REQUIRE(statistics.processedFrames == 3);
+        REQUIRE(statistics.kinematicsFailures == 2);
+        REQUIRE(statistics.dynamicsFailures == 1);
+    }
+
+    SECTION("Stages swap")
+    {
+        REQUIRE(pipeline.addSubject(parameters, stages));
+        REQUIRE(pipeline.push("subject", frameAt(1.0)));
+        pipeline.waitIdle();
+
+        // the new stages are created while the frames are processed with the current ones
+        auto newKinematics = std::make_shared<RecordingStage>();
+        std::promise<void> factoryRelease;
+        auto factoryReleased = factoryRelease.get_future().share();
+        bool handedOver{false};
+        REQUIRE(pipeline.prepareStagesSwap(
+            "subject",
+            [newKinematics, factoryReleased] {
+                factoryReleased.wait();
+                SubjectStages newStages;
+                newStages.kinematics = [newKinematics](const SubjectFrame& frame) { return (*newKinematics)(frame); };
+                return newStages;
+            },
+            [&handedOver] {
+                handedOver = true;
+                return true;
+            }));
+        REQUIRE_FALSE(pipeline.prepareStagesSwap("subject", [] { return SubjectStages(); }));
+        REQUIRE(pipeline.isStagesSwapPending("subject"));
+        REQUIRE(pipeline.push("subject", frameAt(2.0)));
+        pipeline.waitIdle();
+
+        factoryRelease.set_value();
+        while (pipeline.isStagesSwapPending("subject"))
+        {
+            // the swap happens at the next frame
+            REQUIRE(pipeline.push("subject", frameAt(3.0)));
+            pipeline.waitIdle();
+        }
+        REQUIRE(handedOver);
+        REQUIRE(kinematics->timestamps().front() == 1.0);
+        REQUIRE(newKinematics->timestamps().size() == 1);
+
+        // a failed creation keeps the current stages
+        REQUIRE(pipeline.prepareStagesSwap("subject", []() -> SubjectStages { throw std::runtime_error("model error"); }));
+        while (pipeline.isStagesSwapPending("subject"))
+        {
+            REQUIRE(pipeline.push("subject", frameAt(4.0)));
+            pipeline.waitIdle();
+        }
+        REQUIRE(newKinematics->timestamps().back() == 4.0);
+
+        // as well as a handover throwing an exception not derived from std::exception
+        REQUIRE(pipeline.prepareStagesSwap(
+            "subject",
+            [] {
+                SubjectStages newStages;
+                newStages.kinematics = [](const SubjectFrame&) { return true; };
+                return newStages;
+            },
+            []() -> bool { throw 5; }));
+        while (pipeline.isStagesSwapPending("subject"))
+        {
+            REQUIRE(pipeline.push("subject", frameAt(5.0)));
+            pipeline.waitIdle();
+        }
+        REQUIRE(newKinematics->timestamps().back() == 5.0);
+
+        REQUIRE(pipeline.getStatistics("subject", statistics));
+        REQUIRE(statistics.swappedStages == 1);
+        REQUIRE(statistics.failedSwaps == 2);
+        REQUIRE(statistics.droppedOldestFrames == 0);
+        REQUIRE_FALSE(pipeline.prepareStagesSwap("unknown", [] { return SubjectStages(); }));
+    }
+
+    SECTION("Latencies")
+    {
+        FrameProvenance outputProvenance;
+        stages.dynamics = [](SubjectFrame& frame) {
+            frame.provenance.stamp(FrameStage::DynamicsSolved);
+            return true;
+        };
+        stages.output = [&outputProvenance](SubjectFrame& frame) {
+            outputProvenance = frame.provenance;
+            return true;
+        };
+        REQUIRE(pipeline.addSubject(parameters, stages));
+
+        // the ingestion stamps the reception before the frame is pushed
+        SubjectFrame frame = frameAt(1.0);
+        frame.provenance.stamp(FrameStage::Received);
+        REQUIRE(pipeline.push("subject", frame));
+        pipeline.waitIdle();
+        REQUIRE(pipeline.push("subject", frameAt(2.0)));
+        pipeline.waitIdle();
+
+        // the output stage reads the provenance of the frame it writes
+        REQUIRE(outputProvenance.isStamped(FrameStage::Received));
+        REQUIRE(outputProvenance.isStamped(FrameStage::Dequeued));
+        REQUIRE_FALSE(outputProvenance.isStamped(FrameStage::KinematicsSolved));
+        REQUIRE(outputProvenance.getLatency(FrameStage::Received, FrameStage::Output) >= 0.0);
+        REQUIRE(outputProvenance.getLatency(FrameStage::Received, FrameStage::KinematicsSolved) < 0.0);
+
+        SubjectLatencies latencies;
+        REQUIRE(pipeline.getLatencies("subject", latencies));
+        REQUIRE(latencies.endToEnd.getCount() == 2);
+        REQUIRE(latencies.stages[static_cast<std::size_t>(FrameStage::Dequeued)].getCount() == 2);
+        REQUIRE(latencies.stages[static_cast<std::size_t>(FrameStage::DynamicsSolved)].getCount() == 2);
+        REQUIRE(latencies.stages[static_cast<std::size_t>(FrameStage::KinematicsSolved)].getCount() == 0);
+        REQUIRE_FALSE(pipeline.getLatencies("unknown", latencies));
+
+        // the percentiles are the upper bounds of logarithmic buckets
+        LatencyHistogram histogram;
+        REQUIRE(histogram.getPercentile(50.0) == 0.0);
+        for (int i = 1; i <= 100; i++)
+        {
+            histogram.record(1e-3 * i);
+        }
+        REQUIRE(histogram.getCount() == 100);
+        REQUIRE(histogram.getMax() == 0.1);
+        REQUIRE(histogram.getPercentile(50.0) >= 0.05);
+        REQUIRE(histogram.getPercentile(50.0) < 0.05 * 1.2);
+        REQUIRE(histogram.getPercentile(100.0) == 0.1);
+        REQUIRE(histogram.getMean() > 0.0505 - 1e-9);
+        histogram.reset();
+        REQUIRE(histogram.getCount() == 0);
+    }
+
+    SECTION("Configuration")
+    {
+        auto handler = std::make_shared<BipedalLocomotion::ParametersHandler::StdImplementation>();
+        handler->setParameter("name", "exoskeleton");
+        handler->setParameter("queueCapacity", 4);
+        handler->setParameter("overflowPolicy", "skip_dynamics");
+        handler->setParameter("priority", "critical");
+        REQUIRE(pipeline.addSubject(handler, stages));
+
+        // duplicated subject
+        REQUIRE_FALSE(pipeline.addSubject(handler, stages));
+
+        handler->setParameter("name", "wrongPolicy");
+        handler->setParameter("overflowPolicy", "drop_all");
+        REQUIRE_FALSE(pipeline.addSubject(handler, stages));
+
+        handler->setParameter("name", "wrongCapacity");
+        handler->setParameter("overflowPolicy", "drop_newest");
+        handler->setParameter("queueCapacity", 0);
+        REQUIRE_FALSE(pipeline.addSubject(handler, stages));
+
+        // missing kinematics stage
+        parameters.name = "noKinematics";
+        REQUIRE_FALSE(pipeline.addSubject(parameters, SubjectStages()));
+
+        REQUIRE_FALSE(pipeline.push("unknown", frameAt(1.0)));
+        REQUIRE_FALSE(pipeline.getStatistics("unknown", statistics));
+    }
+}
@@ -0,0 +1,251 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <BiomechanicalAnalysis/Pipeline/SubjectSupervisor.h>
+#include <BiomechanicalAnalysis/System/Executor.h>
+#include <BipedalLocomotion/ParametersHandler/StdImplementation.h>
+
+#include <chrono>
+#include <cstdlib>
+#include <thread>
+
+using namespace BiomechanicalAnalysis::Pipeline;
+
+namespace
+{
+
+/**
+ * Stages run in the workers: the subject "failing" fails, the subject "throwing" throws an object
+ * that is not an exception, the subject "crash" kills its worker and the subject "slow" takes
+ * 100 ms per frame
+ */
+SubjectStages makeTestStages(const std::string& subject)
+{
+    SubjectStages stages;
+    stages.kinematics = [subject](const SubjectFrame& frame) {
+        if (subject == "crash")
+        {
+            std::abort();
+        }
+        if (subject == "throwing")
+        {
+            throw 42;
+        }
+        if (subject == "slow")
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        }
+        return subject != "failing" && frame.nodes.size() == 2 && frame.externalWrenches.size() == 1;
+    };
+    return stages;
+}
+
+SubjectFrame makeFrame(double timestamp)
+{
+    SubjectFrame frame;
+    frame.timestamp = timestamp;
+    frame.nodes[3].I_omega_IMU = manif::SO3Tangentd(Eigen::Vector3d(0.1, 0.2, 0.3));
+    frame.nodes[6];
+    frame.nodeWrenches[10] = Eigen::Matrix<double, 6, 1>::Ones();
+    frame.externalWrenches["LeftFoot"];
+    return frame;
+}
+
+std::size_t waitForDeadWorker(SubjectSupervisor& supervisor)
+{
+    std::size_t deadWorkers = 0;
+    for (int i = 0; i < 5000 && deadWorkers == 0; i++)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        deadWorkers = supervisor.monitor();
+    }
+    return deadWorkers;
+}
+
+} // namespace
+
+TEST_CASE("SubjectSupervisor test")
+{
+    SupervisorParameters parameters;
+    parameters.nrOfWorkers = 3;
+    parameters.ringCapacity = 8;
+    parameters.maxNodes = 4;
+    parameters.maxWrenches = 2;
+
+    SubjectSupervisor supervisor;
+
+    SECTION("Parameters")
+    {
+        auto handler = std::make_shared<BipedalLocomotion::ParametersHandler::StdImplementation>();
+        REQUIRE_FALSE(supervisor.initialize(handler, makeTestStages));
+        handler->setParameter("nrOfWorkers", 2);
+        handler->setParameter("ringCapacity", 4);
+        REQUIRE(supervisor.initialize(handler, makeTestStages));
+        REQUIRE(supervisor.getStatistics().size() == 2);
+        REQUIRE(supervisor.getStatistics()[0].pid > 0);
+    }
+
+    SECTION("Routing")
+    {
+        REQUIRE(supervisor.initialize(parameters, makeTestStages));
+
+        const int nrOfFrames = 5;
+        const std::vector<std::string> subjects{"s0", "s1", "s2", "s3", "s4", "s5", "failing", "throwing"};
+        for (int i = 0; i < nrOfFrames; i++)
+        {
+            for (const auto& subject : subjects)
+            {
+                REQUIRE(supervisor.push(subject, makeFrame(i)));
+                REQUIRE(supervisor.waitIdle(5.0));
+            }
+        }
+
+        std::uint64_t processedFrames = 0;
+        std::uint64_t failedFrames = 0;
+        for (const auto& worker : supervisor.getStatistics())
+        {
+            processedFrames += worker.processedFrames;
+            failedFrames += worker.failedFrames;
+            REQUIRE(worker.droppedFrames == 0);
+        }
+        REQUIRE(processedFrames == nrOfFrames * subjects.size());
+        REQUIRE(failedFrames == 2 * nrOfFrames);
+        for (const auto& worker : supervisor.getStatistics())
+        {
+            REQUIRE(worker.restarts == 0);
+        }
+
+        // frames that do not fit in a slot
+        SubjectFrame bigFrame = makeFrame(0.0);
+        for (int node = 0; node < 10; node++)
+        {
+            bigFrame.nodes[node];
+        }
+        REQUIRE_FALSE(supervisor.push("s0", bigFrame));
+    }
+
+    SECTION("Restart of a dead worker")
+    {
+        REQUIRE(supervisor.initialize(parameters, makeTestStages));
+        const int worker = supervisor.getWorker("crash");
+        REQUIRE(worker >= 0);
+        const int pid = supervisor.getStatistics()[worker].pid;
+
+        REQUIRE(supervisor.push("crash", makeFrame(0.0)));
+        REQUIRE(waitForDeadWorker(supervisor) == 1);
+
+        const auto statistics = supervisor.getStatistics();
+        REQUIRE(statistics[worker].restarts == 1);
+        REQUIRE(statistics[worker].pid > 0);
+        REQUIRE(statistics[worker].pid != pid);
+        REQUIRE(supervisor.getWorker("crash") == worker);
+
+        REQUIRE(statistics[worker].processedFrames == 1);
+        REQUIRE(statistics[worker].failedFrames == 1);
+
+        // the restarted worker processes the new frames
+        REQUIRE(supervisor.push("s0", makeFrame(1.0)));
+        REQUIRE(supervisor.waitIdle(5.0));
+    }
+
+    SECTION("Quarantine of a subject crashing the workers")
+    {
+        parameters.maxCrashesPerSubject = 2;
+        REQUIRE(supervisor.initialize(parameters, makeTestStages));
+        const int worker = supervisor.getWorker("crash");
+
+        for (std::size_t i = 0; i < parameters.maxCrashesPerSubject; i++)
+        {
+            REQUIRE_FALSE(supervisor.isQuarantined("crash"));
+            REQUIRE(supervisor.push("crash", makeFrame(i)));
+            REQUIRE(waitForDeadWorker(supervisor) == 1);
+        }
+        REQUIRE(supervisor.isQuarantined("crash"));
+        REQUIRE(supervisor.getStatistics()[worker].restarts == parameters.maxCrashesPerSubject);
+
+        // the frames of the subject are discarded, so the worker is not restarted again, and the
+        // other subjects are still processed
+        REQUIRE_FALSE(supervisor.push("crash", makeFrame(10.0)));
+        REQUIRE(supervisor.getStatistics()[worker].droppedFrames == 1);
+        REQUIRE(supervisor.push("s0", makeFrame(11.0)));
+        REQUIRE(supervisor.waitIdle(5.0));
+        REQUIRE(supervisor.monitor() == 0);
+        REQUIRE(supervisor.getStatistics()[worker].restarts == parameters.maxCrashesPerSubject);
+    }
+
+    SECTION("Subjects moved from a dead worker")
+    {
+        parameters.restartWorkers = false;
+        REQUIRE(supervisor.initialize(parameters, makeTestStages));
+
+        std::vector<int> workers;
+        for (int i = 0; i < 50; i++)
+        {
+            workers.push_back(supervisor.getWorker("subject" + std::to_string(i)));
+        }
+        const int deadWorker = supervisor.getWorker("crash");
+
+        REQUIRE(supervisor.push("crash", makeFrame(0.0)));
+        REQUIRE(waitForDeadWorker(supervisor) == 1);
+        REQUIRE(supervisor.getStatistics()[deadWorker].pid == 0);
+        REQUIRE(supervisor.getWorker("crash") != deadWorker);
+
+        // only the subjects of the dead worker change worker
+        for (int i = 0; i < 50; i++)
+        {
+            const int worker = supervisor.getWorker("subject" + std::to_string(i));
+            REQUIRE(worker != deadWorker);
+            if (workers[i] != deadWorker)
+            {
+                REQUIRE(worker == workers[i]);
+            }
+        }
+        REQUIRE(supervisor.push("crash", makeFrame(1.0)) == true);
+    }
+
+    SECTION("Rebalancing of an overloaded worker")
+    {
+        REQUIRE(supervisor.initialize(parameters, makeTestStages));
+        const int worker = supervisor.getWorker("slow");
+
+        // the ring of the worker fills up while the other rings are empty
+        int pushedFrames = 0;
+        while (supervisor.push("slow", makeFrame(pushedFrames)))
+        {
+            pushedFrames++;
+        }
+        REQUIRE(pushedFrames >= static_cast<int>(parameters.ringCapacity));
+        REQUIRE(supervisor.getStatistics()[worker].droppedFrames == 1);
+
+        REQUIRE(supervisor.monitor() == 0);
+        REQUIRE(supervisor.getStatistics()[worker].virtualNodes == parameters.virtualNodes / 2);
+    }
+}
+
+// the executor lives until the end of the process, hence this test case must be the last one of the file
+TEST_CASE("SubjectSupervisor with the executor created")
+{
+    SupervisorParameters parameters;
+    parameters.nrOfWorkers = 2;
+    parameters.ringCapacity = 8;
+    parameters.maxNodes = 4;
+    parameters.maxWrenches = 2;
+
+    SubjectSupervisor supervisor;
+    REQUIRE(supervisor.initialize(parameters, makeTestStages));
+    const int worker = supervisor.getWorker("crash");
+
+    // once the executor exists the workers are not forked, a dead worker is removed instead of
+    // being restarted
+    BiomechanicalAnalysis::System::Executor::instance();
+    REQUIRE(BiomechanicalAnalysis::System::Executor::isCreated());
+    REQUIRE(supervisor.push("crash", makeFrame(0.0)));
+    REQUIRE(waitForDeadWorker(supervisor) == 1);
+    REQUIRE(supervisor.getStatistics()[worker].restarts == 0);
+    REQUIRE(supervisor.getStatistics()[worker].pid == 0);
+    REQUIRE(supervisor.getWorker("crash") != worker);
+    REQUIRE(supervisor.push("s0", makeFrame(1.0)));
+    REQUIRE(supervisor.waitIdle(5.0));
+
+    SubjectSupervisor otherSupervisor;
+    REQUIRE_FALSE(otherSupervisor.initialize(parameters, makeTestStages));
+}
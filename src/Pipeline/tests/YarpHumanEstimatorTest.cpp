@@ -0,0 +1,140 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <BiomechanicalAnalysis/Pipeline/YarpHumanEstimator.h>
+#include <BipedalLocomotion/ParametersHandler/StdImplementation.h>
+#include <BipedalLocomotion/ParametersHandler/TomlImplementation.h>
+#include <iDynTree/ModelTestUtils.h>
+
+#include <yarp/os/Network.h>
+#include <yarp/os/Time.h>
+
+#include <ConfigFolderPath.h>
+
+#include <algorithm>
+#include <cmath>
+
+TEST_CASE("YarpHumanEstimator test")
+{
+    // the ports are registered in a name server local to the process, so no yarpserver is needed
+    yarp::os::Network network;
+    yarp::os::Network::setLocalMode(true);
+
+    const int nrDoFs = 20;
+    auto kinDyn = std::make_shared<iDynTree::KinDynComputations>();
+    REQUIRE(kinDyn->loadRobotModel(iDynTree::getRandomModel(nrDoFs)));
+
+    auto ikHandler = std::make_shared<BipedalLocomotion::ParametersHandler::TomlImplementation>();
+    REQUIRE(ikHandler->setFromFile(getConfigPath() + "/configTestYarpHumanEstimator.toml"));
+    auto ik = std::make_shared<BiomechanicalAnalysis::IK::HumanIK>();
+    REQUIRE(ik->initialize(ikHandler, kinDyn));
+    REQUIRE(ik->setDt(0.01));
+
+    auto handler = std::make_shared<BipedalLocomotion::ParametersHandler::StdImplementation>();
+    BiomechanicalAnalysis::Pipeline::YarpHumanEstimator estimator;
+
+    // missing parameters
+    REQUIRE_FALSE(estimator.initialize(handler, kinDyn, ik));
+
+    handler->setParameter("portPrefix", "/humanEstimator");
+    handler->setParameter("imuNodes", std::vector<int>{3, 6, 10});
+    handler->setParameter("wrenchNodes", std::vector<int>{10});
+    REQUIRE(estimator.initialize(handler, kinDyn, ik));
+
+    yarp::os::BufferedPort<yarp::sig::Vector> imuWriter, wrenchesWriter, jointStateReader, basePoseReader;
+    REQUIRE(imuWriter.open("/test/imu:o"));
+    REQUIRE(wrenchesWriter.open("/test/wrenches:o"));
+    REQUIRE(jointStateReader.open("/test/jointState:i"));
+    REQUIRE(basePoseReader.open("/test/basePose:i"));
+    REQUIRE(yarp::os::Network::connect("/test/imu:o", "/humanEstimator/imu:i"));
+    REQUIRE(yarp::os::Network::connect("/test/wrenches:o", "/humanEstimator/wrenches:i"));
+    REQUIRE(yarp::os::Network::connect("/humanEstimator/jointState:o", "/test/jointState:i"));
+    REQUIRE(yarp::os::Network::connect("/humanEstimator/basePose:o", "/test/basePose:i"));
+
+    // without measurements nothing is published
+    REQUIRE(estimator.advance());
+    REQUIRE(jointStateReader.read(false) == nullptr);
+
+    // wait until the estimator receives the measurements and publishes the results
+    auto waitForResult = [](BiomechanicalAnalysis::Pipeline::YarpHumanEstimator& estimator,
+                            yarp::os::BufferedPort<yarp::sig::Vector>& reader) {
+        yarp::sig::Vector* result = nullptr;
+        for (int i = 0; i < 500 && result == nullptr; i++)
+        {
+            REQUIRE(estimator.advance());
+            yarp::os::Time::delay(0.001);
+            result = reader.read(false);
+        }
+        return result;
+    };
+
+    yarp::sig::Vector& wrenches = wrenchesWriter.prepare();
+    wrenches = yarp::sig::Vector(6, 0.0);
+    wrenches[2] = 100.0;
+    wrenchesWriter.writeStrict();
+    wrenchesWriter.waitForWrite();
+
+    const yarp::sig::Vector imuMeasurements{1.0, 0.0, 0.0, 0.0, 0.1, 0.0, 0.0, 1.0, 0.0, 0.0, 0.0, 0.0, 0.1, 0.0, 1.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.1};
+    yarp::sig::Vector& imu = imuWriter.prepare();
+    imu = imuMeasurements;
+    yarp::os::Stamp stamp(1, 12.5);
+    imuWriter.setEnvelope(stamp);
+    imuWriter.writeStrict();
+    imuWriter.waitForWrite();
+
+    yarp::sig::Vector* jointState = waitForResult(estimator, jointStateReader);
+    REQUIRE(jointState != nullptr);
+    REQUIRE(jointState->size() == 2 * nrDoFs);
+    yarp::os::Stamp receivedStamp;
+    REQUIRE(jointStateReader.getEnvelope(receivedStamp));
+    REQUIRE(receivedStamp.getTime() == 12.5);
+
+    yarp::sig::Vector* basePose = basePoseReader.read(true);
+    REQUIRE(basePose != nullptr);
+    REQUIRE(basePose->size() == 7);
+
+    // measurements of the wrong size
+    yarp::sig::Vector& wrongImu = imuWriter.prepare();
+    wrongImu = yarp::sig::Vector(5, 0.0);
+    imuWriter.writeStrict();
+    imuWriter.waitForWrite();
+    bool failed = false;
+    for (int i = 0; i < 500 && !failed; i++)
+    {
+        failed = !estimator.advance();
+        yarp::os::Time::delay(0.001);
+    }
+    REQUIRE(failed);
+
+    estimator.close();
+
+    // with HumanID the joint torques are published as soon as the IMU measurements arrive, the
+    // wrenches are zero until the first message of the wrenches port
+    auto idHandler = std::make_shared<BipedalLocomotion::ParametersHandler::TomlImplementation>();
+    REQUIRE(idHandler->setFromFile(YARP_HUMAN_ESTIMATOR_ID_CONFIG));
+    auto id = std::make_shared<BiomechanicalAnalysis::ID::HumanID>();
+    REQUIRE(id->initialize(idHandler, kinDyn));
+
+    handler->setParameter("portPrefix", "/humanDynamicsEstimator");
+    handler->setParameter("wrenchNodes", std::vector<int>{});
+    handler->setParameter("wrenchSources", std::vector<std::string>{"link0", "link1"});
+    BiomechanicalAnalysis::Pipeline::YarpHumanEstimator dynamicsEstimator;
+    REQUIRE(dynamicsEstimator.initialize(handler, kinDyn, ik, id));
+
+    yarp::os::BufferedPort<yarp::sig::Vector> jointTorquesReader;
+    REQUIRE(jointTorquesReader.open("/test/jointTorques:i"));
+    REQUIRE(yarp::os::Network::connect("/test/imu:o", "/humanDynamicsEstimator/imu:i"));
+    REQUIRE(yarp::os::Network::connect("/humanDynamicsEstimator/jointTorques:o", "/test/jointTorques:i"));
+
+    yarp::sig::Vector& dynamicsImu = imuWriter.prepare();
+    dynamicsImu = imuMeasurements;
+    imuWriter.writeStrict();
+    imuWriter.waitForWrite();
+
+    yarp::sig::Vector* jointTorques = waitForResult(dynamicsEstimator, jointTorquesReader);
+    REQUIRE(jointTorques != nullptr);
+    REQUIRE(jointTorques->size() == id->getNrOfDOFs());
+    REQUIRE(std::all_of(jointTorques->begin(), jointTorques->end(), [](double torque) { return std::isfinite(torque); }));
+    REQUIRE(jointTorquesReader.getEnvelope(receivedStamp));
+
+    dynamicsEstimator.close();
+}
@@ -0,0 +1,201 @@
+/**
+ * @file Executor.h
+ * @authors Davide Gorbani <davide.gorbani@iit.it>
+ */
+
+#ifndef BIOMECHANICAL_ANALYSIS_SYSTEM_EXECUTOR_H
+#define BIOMECHANICAL_ANALYSIS_SYSTEM_EXECUTOR_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+// BipedalLocomotion headers
+#include <BipedalLocomotion/ParametersHandler/IParametersHandler.h>
+
+namespace BiomechanicalAnalysis
+{
+namespace System
+{
+
+/**
+ * @brief Parameters of the Executor
+ */
+struct ExecutorParameters
+{
+    std::size_t computeThreads{0}; /** number of threads of the compute pool, if 0 the number of
+                                      hardware threads is used */
+    std::size_t ioThreads{1}; /** number of threads dedicated to blocking I/O tasks */
+    std::vector<int> computeAffinity; /** cores where the compute threads are pinned, the i-th
+                                         thread is pinned to the core computeAffinity[i %
+                                         computeAffinity.size()]; empty to not pin them */
+    std::vector<int> ioAffinity; /** cores where the I/O threads are pinned, with the same rule of
+                                    computeAffinity */
+};
+
+/**
+ * @brief Executor shared by all the parallel components of the framework, so that combining them
+ * in one process does not oversubscribe the cores.
+ * The executor owns a work-stealing pool for the compute tasks, where each thread has its own
+ * queue and steals from the others when it runs out of work, and a separate set of threads for the
+ * blocking I/O tasks, so that waiting on a file or a port does not stall the computations.
+ * The executor is created at the first call to instance(). Its size and affinity can be set once
+ * with configure() before that call, e.g. at the startup of the application.
+ */
+class Executor
+{
+public:
+    /**
+     * @brief Function to configure the executor
+     * @param parameters parameters of the executor
+     * @return true if the configuration is successful, false if the executor has already been
+     * created
+     */
+    static bool configure(const ExecutorParameters& parameters);
+
+    /**
+     * @brief Function to configure the executor
+     * @param handler pointer to the ParametersHandler object, with the optional parameters
+     * `computeThreads`, `ioThreads`, `computeAffinity` and `ioAffinity`
+     * @return true if the configuration is successful, false otherwise
+     */
+    static bool configure(std::weak_ptr<const BipedalLocomotion::ParametersHandler::IParametersHandler> handler);
+
+    /**
+     * @brief Function to get the executor, creating it if needed
+     * @return reference to the executor
+     */
+    static Executor& instance();
+
+    /**
+     * @brief Function to check if the executor has been created, i.e. if its threads are running
+     * @return true if instance() has been called
+     * @note the threads are not duplicated by fork(), hence a child process of a process where the
+     * executor has been created must not use it
+     */
+    static bool isCreated();
+
+    /**
+     * @brief Destructor, it waits for the queued tasks to be completed
+     */
+    ~Executor();
+
+    Executor(const Executor&) = delete;
+    Executor& operator=(const Executor&) = delete;
+
+    /**
+     * @brief Function to submit a compute task
+     * @param task callable without arguments
+     * @return future of the result of the task
+     * @note a task submitted from a compute thread is pushed in the queue of that thread
+     */
+    template <typename Task> auto submit(Task&& task) -> std::future<std::invoke_result_t<std::decay_t<Task>>>
+    {
+        auto packagedTask = makePackagedTask(std::forward<Task>(task));
+        auto future = packagedTask->get_future();
+        pushComputeTask([packagedTask] { (*packagedTask)(); });
+        return future;
+    }
+
+    /**
+     * @brief Function to submit a blocking I/O task
+     * @param task callable without arguments
+     * @return future of the result of the task
+     */
+    template <typename Task> auto submitIO(Task&& task) -> std::future<std::invoke_result_t<std::decay_t<Task>>>
+    {
+        auto packagedTask = makePackagedTask(std::forward<Task>(task));
+        auto future = packagedTask->get_future();
+        pushIOTask([packagedTask] { (*packagedTask)(); });
+        return future;
+    }
+
+    /**
+     * @brief Function to submit a compute job whose result is not needed, without the allocation of
+     * the future, e.g. to resume a suspended coroutine
+     * @param job callable without arguments, it must not throw
+     */
+    void post(std::function<void()> job);
+
+    /**
+     * @brief Function to submit a blocking I/O job whose result is not needed
+     * @param job callable without arguments, it must not throw
+     */
+    void postIO(std::function<void()> job);
+
+    /**
+     * @brief Function to run a loop in parallel on the compute threads
+     * @param begin first index of the loop
+     * @param end index after the last one of the loop
+     * @param body function called for each index
+     * @note the calling thread takes part to the loop, so the function can be used also from a
+     * compute task. The first exception thrown by body is rethrown after all the iterations are
+     * completed.
+     */
+    void parallelFor(std::size_t begin, std::size_t end, const std::function<void(std::size_t)>& body);
+
+    /**
+     * @brief Function to get the number of compute threads
+     * @return number of compute threads
+     */
+    std::size_t getNrOfComputeThreads() const;
+
+    /**
+     * @brief Function to get the number of I/O threads
+     * @return number of I/O threads
+     */
+    std::size_t getNrOfIOThreads() const;
+
+private:
+    using Job = std::function<void()>;
+
+    /**
+     * Queue of a compute thread, the owner pops from the back and the others steal from the front
+     */
+    struct WorkerQueue
+    {
+        std::mutex mutex;
+        std::deque<Job> jobs;
+    };
+
+    explicit Executor(const ExecutorParameters& parameters);
+
+    template <typename Task> static auto makePackagedTask(Task&& task)
+    {
+        using Result = std::invoke_result_t<std::decay_t<Task>>;
+        return std::make_shared<std::packaged_task<Result()>>(std::forward<Task>(task));
+    }
+
+    void pushComputeTask(Job job);
+    void pushIOTask(Job job);
+    bool popComputeTask(std::size_t worker, Job& job);
+    void computeLoop(std::size_t worker);
+    void ioLoop();
+
+    std::vector<std::unique_ptr<WorkerQueue>> m_queues; /** queues of the compute threads */
+    std::vector<std::thread> m_computeThreads; /** threads of the compute pool */
+    std::atomic<std::size_t> m_pendingComputeJobs{0}; /** number of queued compute jobs */
+    std::atomic<std::size_t> m_nextQueue{0}; /** queue receiving the next external submission */
+    std::mutex m_computeMutex; /** mutex used to put the idle compute threads to sleep */
+    std::condition_variable m_computeCondition; /** condition variable of the idle compute threads */
+
+    std::vector<std::thread> m_ioThreads; /** threads dedicated to the I/O tasks */
+    std::deque<Job> m_ioJobs; /** queue of the I/O jobs */
+    std::mutex m_ioMutex; /** mutex of the I/O queue */
+    std::condition_variable m_ioCondition; /** condition variable of the I/O threads */
+
+    bool m_stop{false}; /** flag to stop the threads, protected by both the mutexes */
+};
+
+} // namespace System
+} // namespace BiomechanicalAnalysis
+
+#endif // BIOMECHANICAL_ANALYSIS_SYSTEM_EXECUTOR_H
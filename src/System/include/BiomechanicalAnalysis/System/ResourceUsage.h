@@ -0,0 +1,42 @@
+/**
+ * @file ResourceUsage.h
+ * @authors Davide Gorbani <davide.gorbani@iit.it>
+ */
+
+#ifndef BIOMECHANICAL_ANALYSIS_SYSTEM_RESOURCE_USAGE_H
+#define BIOMECHANICAL_ANALYSIS_SYSTEM_RESOURCE_USAGE_H
+
+#include <cstddef>
+
+namespace BiomechanicalAnalysis
+{
+namespace System
+{
+
+/**
+ * @brief Memory used by the process, sampled by long running services and tests to detect leaks
+ * and fragmentation
+ */
+struct ResourceUsage
+{
+    std::size_t residentSetSize{0}; /** resident set size, in bytes */
+    bool hasAllocatorStatistics{false}; /** true if the allocator statistics are available, i.e.
+                                           with glibc 2.33 or later */
+    std::size_t allocatedBytes{0}; /** bytes allocated with malloc and not yet freed, including the
+                                      ones served with mmap */
+    std::size_t allocatorHeapBytes{0}; /** bytes obtained by the allocator from the system for its
+                                          heap, i.e. the allocated and the free chunks */
+};
+
+/**
+ * @brief Function to sample the memory used by the process
+ * @param usage sampled memory usage
+ * @return true if the resident set size has been read, false otherwise, e.g. on systems without
+ * the /proc filesystem
+ */
+bool getResourceUsage(ResourceUsage& usage);
+
+} // namespace System
+} // namespace BiomechanicalAnalysis
+
+#endif // BIOMECHANICAL_ANALYSIS_SYSTEM_RESOURCE_USAGE_H
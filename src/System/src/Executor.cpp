@@ -0,0 +1,346 @@
+#include <BiomechanicalAnalysis/Logging/Logger.h>
+#include <BiomechanicalAnalysis/System/Executor.h>
+
+#include <algorithm>
+#include <exception>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+using namespace BiomechanicalAnalysis::System;
+
+namespace
+{
+
+std::mutex instanceMutex;
+std::unique_ptr<Executor> executorInstance;
+ExecutorParameters executorParameters;
+
+// executor and index of the compute thread running the current code, if any
+thread_local const Executor* currentExecutor = nullptr;
+thread_local std::size_t currentWorker = 0;
+
+void setAffinity(std::thread& thread, const std::vector<int>& cores, const std::size_t index)
+{
+    if (cores.empty())
+    {
+        return;
+    }
+#ifdef __linux__
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cores[index % cores.size()], &set);
+    if (pthread_setaffinity_np(thread.native_handle(), sizeof(cpu_set_t), &set) != 0)
+    {
+        BiomechanicalAnalysis::log()->warn("[Executor] Unable to pin a thread to the core {}.", cores[index % cores.size()]);
+    }
+#else
+    BiomechanicalAnalysis::log()->warn("[Executor] The thread affinity is not supported on this platform.");
+#endif
+}
+
+} // namespace
+
+bool Executor::configure(const ExecutorParameters& parameters)
+{
+    constexpr auto logPrefix = "[Executor::configure]";
+
+    std::lock_guard<std::mutex> lock(instanceMutex);
+    if (executorInstance != nullptr)
+    {
+        BiomechanicalAnalysis::log()->error("{} The executor has already been created, it must be configured before its first use.",
+                                            logPrefix);
+        return false;
+    }
+    executorParameters = parameters;
+    return true;
+}
+
+bool Executor::configure(std::weak_ptr<const BipedalLocomotion::ParametersHandler::IParametersHandler> handler)
+{
+    constexpr auto logPrefix = "[Executor::configure]";
+
+    auto ptr = handler.lock();
+    if (ptr == nullptr)
+    {
+        BiomechanicalAnalysis::log()->error("{} Invalid parameters handler.", logPrefix);
+        return false;
+    }
+
+    ExecutorParameters parameters;
+    int threads;
+    if (ptr->getParameter("computeThreads", threads))
+    {
+        if (threads < 0)
+        {
+            BiomechanicalAnalysis::log()->error("{} The parameter 'computeThreads' must be non negative.", logPrefix);
+            return false;
+        }
+        parameters.computeThreads = threads;
+    }
+    if (ptr->getParameter("ioThreads", threads))
+    {
+        if (threads < 0)
+        {
+            BiomechanicalAnalysis::log()->error("{} The parameter 'ioThreads' must be non negative.", logPrefix);
+            return false;
+        }
+        parameters.ioThreads = threads;
+    }
+    ptr->getParameter("computeAffinity", parameters.computeAffinity);
+    ptr->getParameter("ioAffinity", parameters.ioAffinity);
+
+    return configure(parameters);
+}
+
+Executor& Executor::instance()
+{
+    std::lock_guard<std::mutex> lock(instanceMutex);
+    if (executorInstance == nullptr)
+    {
+        executorInstance.reset(new Executor(executorParameters));
+    }
+    return *executorInstance;
+}
+
+bool Executor::isCreated()
+{
+    std::lock_guard<std::mutex> lock(instanceMutex);
+    return executorInstance != nullptr;
+}
+
+Executor::Executor(const ExecutorParameters& parameters)
+{
+    std::size_t computeThreads = parameters.computeThreads;
+    if (computeThreads == 0)
+    {
+        computeThreads = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    for (std::size_t i = 0; i < computeThreads; i++)
+    {
+        m_queues.push_back(std::make_unique<WorkerQueue>());
+    }
+    for (std::size_t i = 0; i < computeThreads; i++)
+    {
+        m_computeThreads.emplace_back(&Executor::computeLoop, this, i);
+        setAffinity(m_computeThreads.back(), parameters.computeAffinity, i);
+    }
+    for (std::size_t i = 0; i < parameters.ioThreads; i++)
+    {
+        m_ioThreads.emplace_back(&Executor::ioLoop, this);
+        setAffinity(m_ioThreads.back(), parameters.ioAffinity, i);
+    }
+
+    BiomechanicalAnalysis::log()->debug("[Executor] Started {} compute threads and {} I/O threads.", computeThreads, parameters.ioThreads);
+}
+
+Executor::~Executor()
+{
+    {
+        std::scoped_lock lock(m_computeMutex, m_ioMutex);
+        m_stop = true;
+    }
+    m_computeCondition.notify_all();
+    m_ioCondition.notify_all();
+
+    for (auto& thread : m_computeThreads)
+    {
+        thread.join();
+    }
+    for (auto& thread : m_ioThreads)
+    {
+        thread.join();
+    }
+}
+
+void Executor::post(std::function<void()> job)
+{
+    pushComputeTask(std::move(job));
+}
+
+void Executor::postIO(std::function<void()> job)
+{
+    pushIOTask(std::move(job));
+}
+
+void Executor::pushComputeTask(Job job)
+{
+    // the tasks submitted by a compute thread go in its own queue, the others are distributed
+    // among the queues in round robin
+    const std::size_t queue = currentExecutor == this ? currentWorker : m_nextQueue++ % m_queues.size();
+    // the counter is incremented under the lock of the queue, as it is decremented by the pop, so
+    // that a worker cannot take the job before it is counted
+    {
+        std::lock_guard<std::mutex> lock(m_queues[queue]->mutex);
+        m_pendingComputeJobs++;
+        m_queues[queue]->jobs.push_back(std::move(job));
+    }
+
+    // lock the mutex so that the notification cannot be lost by a thread going to sleep
+    {
+        std::lock_guard<std::mutex> lock(m_computeMutex);
+    }
+    m_computeCondition.notify_one();
+}
+
+void Executor::pushIOTask(Job job)
+{
+    if (m_ioThreads.empty())
+    {
+        // without I/O threads the task is run by the compute pool
+        pushComputeTask(std::move(job));
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(m_ioMutex);
+        m_ioJobs.push_back(std::move(job));
+    }
+    m_ioCondition.notify_one();
+}
+
+bool Executor::popComputeTask(std::size_t worker, Job& job)
+{
+    // the owner takes the most recent job, which is likely to be hot in cache
+    {
+        std::lock_guard<std::mutex> lock(m_queues[worker]->mutex);
+        if (!m_queues[worker]->jobs.empty())
+        {
+            job = std::move(m_queues[worker]->jobs.back());
+            m_queues[worker]->jobs.pop_back();
+            m_pendingComputeJobs--;
+            return true;
+        }
+    }
+
+    // steal the oldest job from the other queues
+    for (std::size_t i = 1; i < m_queues.size(); i++)
+    {
+        WorkerQueue& queue = *m_queues[(worker + i) % m_queues.size()];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (!queue.jobs.empty())
+        {
+            job = std::move(queue.jobs.front());
+            queue.jobs.pop_front();
+            m_pendingComputeJobs--;
+            return true;
+        }
+    }
+    return false;
+}
+
+void Executor::computeLoop(std::size_t worker)
+{
+    currentExecutor = this;
+    currentWorker = worker;
+
+    while (true)
+    {
+        Job job;
+        if (popComputeTask(worker, job))
+        {
+            job();
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(m_computeMutex);
+        m_computeCondition.wait(lock, [this] { return m_stop || m_pendingComputeJobs > 0; });
+        if (m_stop && m_pendingComputeJobs == 0)
+        {
+            return;
+        }
+    }
+}
+
+void Executor::ioLoop()
+{
+    while (true)
+    {
+        Job job;
+        {
+            std::unique_lock<std::mutex> lock(m_ioMutex);
+            m_ioCondition.wait(lock, [this] { return m_stop || !m_ioJobs.empty(); });
+            if (m_ioJobs.empty())
+            {
+                return;
+            }
+            job = std::move(m_ioJobs.front());
+            m_ioJobs.pop_front();
+        }
+        job();
+    }
+}
+
+void Executor::parallelFor(std::size_t begin, std::size_t end, const std::function<void(std::size_t)>& body)
+{
+    if (begin >= end)
+    {
+        return;
+    }
+
+    struct LoopState
+    {
+        std::atomic<std::size_t> next;
+        std::atomic<std::size_t> completed{0};
+        std::size_t end;
+        std::size_t iterations;
+        std::mutex mutex;
+        std::condition_variable condition;
+        std::exception_ptr exception;
+    };
+
+    auto state = std::make_shared<LoopState>();
+    state->next = begin;
+    state->end = end;
+    state->iterations = end - begin;
+
+    // the helpers stop as soon as all the iterations have been claimed, hence body is never called
+    // after this function returns
+    auto run = [state, &body] {
+        for (std::size_t i = state->next++; i < state->end; i = state->next++)
+        {
+            try
+            {
+                body(i);
+            } catch (...)
+            {
+                std::lock_guard<std::mutex> lock(state->mutex);
+                if (!state->exception)
+                {
+                    state->exception = std::current_exception();
+                }
+            }
+            if (++state->completed == state->iterations)
+            {
+                std::lock_guard<std::mutex> lock(state->mutex);
+                state->condition.notify_all();
+            }
+        }
+    };
+
+    const std::size_t helpers = std::min(m_computeThreads.size(), state->iterations - 1);
+    for (std::size_t i = 0; i < helpers; i++)
+    {
+        pushComputeTask(run);
+    }
+    run();
+
+    std::unique_lock<std::mutex> lock(state->mutex);
+    state->condition.wait(lock, [&state] { return state->completed == state->iterations; });
+    if (state->exception)
+    {
+        std::rethrow_exception(state->exception);
+    }
+}
+
+std::size_t Executor::getNrOfComputeThreads() const
+{
+    return m_computeThreads.size();
+}
+
+std::size_t Executor::getNrOfIOThreads() const
+{
+    return m_ioThreads.size();
+}
@@ -0,0 +1,36 @@
+#include <BiomechanicalAnalysis/System/ResourceUsage.h>
+
+#include <fstream>
+
+#if defined(__linux__)
+#include <malloc.h>
+#include <unistd.h>
+#endif
+
+bool BiomechanicalAnalysis::System::getResourceUsage(ResourceUsage& usage)
+{
+    usage = ResourceUsage();
+
+#if defined(__linux__)
+    // the second field of statm is the number of resident pages
+    std::ifstream statm("/proc/self/statm");
+    std::size_t size = 0;
+    std::size_t resident = 0;
+    if (!(statm >> size >> resident))
+    {
+        return false;
+    }
+    usage.residentSetSize = resident * static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 33))
+    const struct mallinfo2 info = mallinfo2();
+    usage.hasAllocatorStatistics = true;
+    usage.allocatedBytes = info.uordblks + info.hblkhd;
+    usage.allocatorHeapBytes = info.arena + info.hblkhd;
+#endif
+
+    return true;
+#else
+    return false;
+#endif
+}
@@ -0,0 +1,100 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <BiomechanicalAnalysis/System/Executor.h>
+#include <BipedalLocomotion/ParametersHandler/StdImplementation.h>
+
+#include <atomic>
+#include <numeric>
+#include <stdexcept>
+
+using namespace BiomechanicalAnalysis::System;
+
+TEST_CASE("Executor test")
+{
+    // the executor can be configured only once, before its first use
+    static const bool configured = [] {
+        auto handler = std::make_shared<BipedalLocomotion::ParametersHandler::StdImplementation>();
+        handler->setParameter("computeThreads", 3);
+        handler->setParameter("ioThreads", 2);
+        return Executor::configure(handler);
+    }();
+    REQUIRE(configured);
+
+    Executor& executor = Executor::instance();
+    REQUIRE(Executor::isCreated());
+    REQUIRE(executor.getNrOfComputeThreads() == 3);
+    REQUIRE(executor.getNrOfIOThreads() == 2);
+    REQUIRE_FALSE(Executor::configure(ExecutorParameters()));
+
+    SECTION("Tasks")
+    {
+        std::vector<std::future<int>> futures;
+        for (int i = 0; i < 100; i++)
+        {
+            futures.push_back(executor.submit([i] { return i * i; }));
+        }
+        for (int i = 0; i < 100; i++)
+        {
+            REQUIRE(futures[i].get() == i * i);
+        }
+
+        auto ioFuture = executor.submitIO([] { return std::string("io"); });
+        REQUIRE(ioFuture.get() == "io");
+
+        // the posted jobs do not return a future
+        std::promise<int> posted;
+        executor.post([&posted] { posted.set_value(1); });
+        REQUIRE(posted.get_future().get() == 1);
+        std::promise<int> postedIO;
+        executor.postIO([&postedIO] { postedIO.set_value(2); });
+        REQUIRE(postedIO.get_future().get() == 2);
+    }
+
+    SECTION("Parallel for")
+    {
+        std::vector<std::size_t> values(1000, 0);
+        executor.parallelFor(0, values.size(), [&values](std::size_t i) { values[i] = i; });
+        std::vector<std::size_t> expected(1000);
+        std::iota(expected.begin(), expected.end(), 0);
+        REQUIRE(values == expected);
+
+        // empty range
+        executor.parallelFor(5, 5, [](std::size_t) { FAIL("The body must not be called."); });
+    }
+
+    SECTION("Nested parallel for")
+    {
+        // the nested loops run on the compute threads, the callers take part to the loops so they
+        // cannot deadlock even if all the threads are busy
+        std::atomic<std::size_t> counter{0};
+        executor.parallelFor(0, 16, [&executor, &counter](std::size_t) {
+            executor.parallelFor(0, 16, [&counter](std::size_t) { counter++; });
+        });
+        REQUIRE(counter == 256);
+
+        auto future = executor.submit([&executor] {
+            std::atomic<std::size_t> count{0};
+            executor.parallelFor(0, 100, [&count](std::size_t) { count++; });
+            return count.load();
+        });
+        REQUIRE(future.get() == 100);
+    }
+
+    SECTION("Exceptions")
+    {
+        std::atomic<std::size_t> counter{0};
+        REQUIRE_THROWS_AS(executor.parallelFor(0, 50,
+                                               [&counter](std::size_t i) {
+                                                   counter++;
+                                                   if (i == 10)
+                                                   {
+                                                       throw std::runtime_error("error");
+                                                   }
+                                               }),
+                          std::runtime_error);
+        REQUIRE(counter == 50);
+
+        auto future = executor.submit([]() -> int { throw std::runtime_error("error"); });
+        REQUIRE_THROWS_AS(future.get(), std::runtime_error);
+    }
+}
@@ -0,0 +1,32 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <BiomechanicalAnalysis/System/ResourceUsage.h>
+
+#include <cstring>
+#include <memory>
+
+using namespace BiomechanicalAnalysis::System;
+
+TEST_CASE("Resource usage test")
+{
+    ResourceUsage before;
+    if (!getResourceUsage(before))
+    {
+        // the resident set size is not available on this system
+        return;
+    }
+    REQUIRE(before.residentSetSize > 0);
+
+    // a touched allocation is resident and accounted by the allocator
+    constexpr std::size_t size = 64 * 1024 * 1024;
+    auto buffer = std::make_unique<char[]>(size);
+    std::memset(buffer.get(), 1, size);
+    ResourceUsage after;
+    REQUIRE(getResourceUsage(after));
+    REQUIRE(after.residentSetSize >= before.residentSetSize + size / 2);
+    if (after.hasAllocatorStatistics)
+    {
+        REQUIRE(after.allocatedBytes >= before.allocatedBytes + size);
+        REQUIRE(after.allocatorHeapBytes >= after.allocatedBytes);
+    }
+}
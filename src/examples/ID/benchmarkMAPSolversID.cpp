@@ -0,0 +1,132 @@
+/**
+ * @file benchmarkMAPSolversID.cpp
+ * @authors Davide Gorbani <davide.gorbani@iit.it>
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <iDynTree/EigenHelpers.h>
+#include <iDynTree/ModelLoader.h>
+#include <yarp/os/ResourceFinder.h>
+
+#include <BiomechanicalAnalysis/ID/InverseDynamics.h>
+#include <BiomechanicalAnalysis/Logging/Logger.h>
+#include <BipedalLocomotion/ParametersHandler/YarpImplementation.h>
+
+#include <ConfigFolderPath.h>
+
+namespace
+{
+
+constexpr std::size_t nrOfFrames = 2000;
+
+// state of the frame i, a slow motion of all the joints while standing on both feet
+void setState(iDynTree::KinDynComputations& kinDyn, std::size_t i)
+{
+    const double time = 0.01 * static_cast<double>(i);
+    Eigen::VectorXd jointPos(kinDyn.getNrOfDegreesOfFreedom());
+    Eigen::VectorXd jointVel(kinDyn.getNrOfDegreesOfFreedom());
+    for (int j = 0; j < jointPos.size(); j++)
+    {
+        jointPos(j) = 0.3 * std::sin(time + 0.1 * j);
+        jointVel(j) = 0.3 * std::cos(time + 0.1 * j);
+    }
+    Eigen::Matrix<double, 6, 1> baseVelocity = Eigen::Matrix<double, 6, 1>::Zero();
+    Eigen::Vector3d gravity(0, 0, -9.81);
+    kinDyn.setRobotState(Eigen::Matrix4d::Identity(), jointPos, baseVelocity, jointVel, gravity);
+}
+
+// solve all the frames, return the mean time of a frame in seconds
+double run(BiomechanicalAnalysis::ID::HumanID& id, iDynTree::KinDynComputations& kinDyn, std::vector<Eigen::VectorXd>& torques)
+{
+    std::unordered_map<std::string, iDynTree::Wrench> wrenchesMap;
+    iDynTree::Wrench footWrench;
+    footWrench.zero();
+    footWrench(2) = 300.0;
+    wrenchesMap["RightFoot"] = footWrench;
+    wrenchesMap["LeftFoot"] = footWrench;
+
+    torques.resize(nrOfFrames);
+    std::chrono::duration<double> elapsed{0};
+    for (std::size_t i = 0; i < nrOfFrames; i++)
+    {
+        setState(kinDyn, i);
+        const auto start = std::chrono::steady_clock::now();
+        if (!id.updateExtWrenchesMeasurements(wrenchesMap) || !id.solve())
+        {
+            BiomechanicalAnalysis::log()->error("Error in solving the inverse dynamics");
+            return -1.0;
+        }
+        elapsed += std::chrono::steady_clock::now() - start;
+        torques[i] = iDynTree::toEigen(id.getJointTorques());
+    }
+    return elapsed.count() / nrOfFrames;
+}
+
+} // namespace
+
+int main()
+{
+    yarp::os::ResourceFinder rf;
+    iDynTree::ModelLoader mdlLoader;
+    std::string urdfPath = rf.findFileByName("humanSubject03_48dof.urdf");
+    if (!mdlLoader.loadModelFromFile(urdfPath))
+    {
+        BiomechanicalAnalysis::log()->error("Error in loading the model {}", urdfPath);
+        return -1;
+    }
+    auto kinDyn = std::make_shared<iDynTree::KinDynComputations>();
+    kinDyn->loadRobotModel(mdlLoader.model());
+    kinDyn->setFloatingBase("Pelvis");
+
+    // the same configuration is solved with the BerdySparseMAPSolver and with the specialized
+    // solvers enabled by the given parameters
+    const std::vector<std::pair<std::string, std::string>> solvers = {{"BerdySparseMAPSolver", ""},
+                                                                      {"DiagonalPriorsMAPSolver", "diagonalPriors"},
+                                                                      {"MixedPrecisionMAPSolver", "mixedPrecision"}};
+    std::vector<Eigen::VectorXd> referenceTorques;
+    double referenceTime = 0.0;
+    for (const auto& [name, parameter] : solvers)
+    {
+        auto paramHandler = std::make_shared<BipedalLocomotion::ParametersHandler::YarpImplementation>();
+        paramHandler->setFromFile(getConfigPath() + "/configExampleID.ini");
+        if (!parameter.empty())
+        {
+            paramHandler->setParameter(parameter, true);
+        }
+        BiomechanicalAnalysis::ID::HumanID id;
+        if (!id.initialize(paramHandler, kinDyn))
+        {
+            BiomechanicalAnalysis::log()->error("Error in initializing the HumanID object with the {}", name);
+            return -1;
+        }
+
+        std::vector<Eigen::VectorXd> torques;
+        const double time = run(id, *kinDyn, torques);
+        if (time < 0)
+        {
+            return -1;
+        }
+        if (referenceTorques.empty())
+        {
+            referenceTorques = torques;
+            referenceTime = time;
+        }
+
+        double maxDifference = 0.0;
+        for (std::size_t i = 0; i < nrOfFrames; i++)
+        {
+            maxDifference = std::max(maxDifference, (torques[i] - referenceTorques[i]).lpNorm<Eigen::Infinity>());
+        }
+        std::cout << name << ": " << 1e3 * time << " ms per frame, speedup " << referenceTime / time
+                  << ", max torque difference " << maxDifference << " Nm" << std::endl;
+    }
+
+    return 0;
+}